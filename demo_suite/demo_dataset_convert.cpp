@@ -0,0 +1,191 @@
+/**
+ * \file demo_dataset_convert.cpp
+ *
+ * Converts a dataset recorded as a directory of files (image_NNNNNNN.pgm/png
+ * with their .time file) into a single dataset file (see datasetContainer.hpp),
+ * or the text logs of the other sensors of a directory (MTI.log, GPS.log,
+ * mocap.log, extloc.log, image_NNNN.pos) into binary logs (<name>.rtds) in the
+ * same directory, that are then used instead of the text logs when replaying.
+ *
+ * usage: demo_dataset_convert <input directory> <output.rtds> [--png]
+ *   --png  compress images losslessly in the dataset file
+ * usage: demo_dataset_convert --logs <directory>
+ * usage: demo_dataset_convert --text <directory>
+ *   converts back the binary logs to text logs, eg for the plot scripts
+ *
+ * \author agent
+ * \date 17/10/2026
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+
+#include "kernel/jafarException.hpp"
+#include "image/Image.hpp"
+
+#include "rtslam/datasetContainer.hpp"
+#include "rtslam/hardwareEstimatorOdo.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam::hardware;
+
+
+/**
+Finds the first image of the directory the same way HardwareSensorCamera does.
+@return the extension of the images, or an empty string if there is none
+*/
+std::string findFirstImage(std::string const &path, int &ndigit, unsigned &first_index)
+{
+	image::Image img;
+	for(first_index = 0; first_index < 1000; ++first_index)
+		for(ndigit = 3; ndigit <= 7; ++ndigit)
+		{
+			std::ostringstream oss; oss << path << "/image_" << std::setw(ndigit) << std::setfill('0') << first_index;
+			if (img.load(oss.str() + std::string(".pgm"), 0)) return ".pgm";
+			if (img.load(oss.str() + std::string(".png"), 0)) return ".png";
+		}
+	return "";
+}
+
+
+/**
+Converts a text log whose lines are vectors, as written by jblas operator<<, optionally
+preceded by a line with a single integer that is stored as the stream parameter.
+Arrival dates were not recorded in text logs, they are left unknown.
+@return the number of readings, -1 if there is no such log
+*/
+int convertTextLog(std::string const &path, std::string const &name, std::string const &text_name, bool has_type = false)
+{
+	std::fstream f((path + "/" + text_name).c_str(), std::ios_base::in);
+	if (!f.is_open()) return -1;
+	std::vector<double> params;
+	if (has_type) { int type; f >> type; params.push_back(type); }
+
+	boost::shared_ptr<VectorLogWriter> writer;
+	jblas::vec reading;
+	int n;
+	for(n = 0; ; ++n)
+	{
+		f >> reading;
+		if (f.eof() || f.fail()) break;
+		if (!writer) writer.reset(new VectorLogWriter(path, name, reading.size(), params));
+		writer->write(reading);
+	}
+	return n;
+}
+
+/// converts the odometry positions, one .pos file per reading
+int convertPositions(std::string const &path)
+{
+	HardwareEstimatorOdo odo(0, 0., 0., 1, 2, path);
+	boost::shared_ptr<VectorLogWriter> writer;
+	Position pos;
+	jblas::vec reading(7);
+	int n;
+	for(n = 0; ; ++n)
+	{
+		std::ostringstream oss; oss << path << "/image_" << std::setw(4) << std::setfill('0') << n << ".pos";
+		if (!std::ifstream(oss.str().c_str()).is_open()) break;
+		odo.loadPosition(n, pos);
+		HardwareEstimatorOdo::positionToReading(pos, reading);
+		if (!writer) writer.reset(new VectorLogWriter(path, "odo", reading.size()));
+		writer->write(reading);
+	}
+	return (n ? n : -1);
+}
+
+const char *logNames[4] = { "MTI", "GPS", "mocap", "extloc" };
+const char *textLogNames[4] = { "MTI.log", "GPS.log", "mocap.log", "extloc.log" };
+
+int convertLogs(std::string const &path)
+{
+	const char **names = logNames, **text_names = textLogNames;
+	int nlogs = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		int n = convertTextLog(path, names[i], text_names[i], (i == 3));
+		if (n < 0) continue;
+		std::cout << text_names[i] << ": " << n << " readings written to " << dataset::vectorLogPath(path, names[i]) << std::endl;
+		++nlogs;
+	}
+	int n = convertPositions(path);
+	if (n >= 0)
+	{
+		std::cout << "positions: " << n << " readings written to " << dataset::vectorLogPath(path, "odo") << std::endl;
+		++nlogs;
+	}
+	if (nlogs == 0) { std::cout << "No text log found in " << path << std::endl; return 1; }
+	return 0;
+}
+
+int exportLogs(std::string const &path)
+{
+	int nlogs = 0;
+	for(int i = 0; i < 4; ++i)
+	{
+		if (!VectorLogReader::exists(path, logNames[i])) continue;
+		VectorLogReader reader(path, logNames[i]);
+		std::fstream f((path + "/" + textLogNames[i]).c_str(), std::ios_base::out);
+		if (reader.info().params.size()) f << (int)reader.info().params[0] << std::endl;
+		jblas::vec reading; double arrival;
+		int n;
+		// we put the maximum precision because we want repeatability with the original run
+		for(n = 0; reader.read(reading, arrival); ++n)
+			f << std::setprecision(50) << reading << std::endl;
+		std::cout << logNames[i] << ": " << n << " readings written to " << path << "/" << textLogNames[i] << std::endl;
+		++nlogs;
+	}
+	if (nlogs == 0) { std::cout << "No binary log found in " << path << std::endl; return 1; }
+	return 0;
+}
+
+
+int main(int argc, char* const* argv)
+{ try {
+	if (argc == 3 && strcmp(argv[1], "--logs") == 0)
+		return convertLogs(argv[2]);
+	if (argc == 3 && strcmp(argv[1], "--text") == 0)
+		return exportLogs(argv[2]);
+	if (argc < 3)
+	{
+		std::cout << "usage: " << argv[0] << " <input directory> <output.rtds> [--png]" << std::endl;
+		std::cout << "       " << argv[0] << " --logs <directory>" << std::endl;
+		std::cout << "       " << argv[0] << " --text <directory>" << std::endl;
+		return 1;
+	}
+	std::string input = argv[1], output = argv[2];
+	int encoding = (argc > 3 && strcmp(argv[3], "--png") == 0 ? dataset::encPng : dataset::encRaw);
+	if (!dataset::isDatasetPath(output))
+		std::cout << "Warning: the output file should have the .rtds extension to be recognized as a dataset" << std::endl;
+
+	int ndigit; unsigned first_index;
+	std::string ext = findFirstImage(input, ndigit, first_index);
+	if (ext.empty()) { std::cout << "No image found in " << input << std::endl; return 1; }
+
+	DatasetWriter writer(output);
+	int stream = -1;
+	image::Image img;
+	unsigned n;
+	for(n = 0; ; ++n)
+	{
+		std::ostringstream oss; oss << input << "/image_" << std::setw(ndigit) << std::setfill('0') << n+first_index;
+		if (!img.load(oss.str() + ext, 0)) break;
+		if (stream < 0)
+			stream = writer.addStream(DatasetStreamInfo(dataset::stCamera, "camera", img.width(), img.height(), 8, 1));
+
+		double timestamp = 0.;
+		std::fstream f((oss.str() + std::string(".time")).c_str(), std::ios_base::in);
+		f >> timestamp; f.close();
+
+		writer.writeImage(stream, timestamp, timestamp, (const uchar*)img.data(), img.step(), encoding);
+		if (n % 100 == 0) std::cout << "\r" << n << " images" << std::flush;
+	}
+	writer.close();
+	std::cout << "\r" << n << " images written to " << output << std::endl;
+	return 0;
+} catch (kernel::Exception &e) { std::cout << e.what(); return 1; } }
@@ -0,0 +1,144 @@
+/**
+ * \file demo_export_client.cpp
+ *
+ * Reference client for ExporterSocket (demo_slam --export=1 or 3): reads the
+ * messages, checks the protocol and their order, and reports the throughput,
+ * the messages dropped by the exporter for this client (gaps in the sequence
+ * numbers) and the latency from the export date. With --export=3 it also
+ * rebuilds the map from the keyframes and the deltas.
+ *
+ * usage: demo_export_client [--host 127.0.0.1] [--port 30000] [--count 0] [--verbose]
+ *   --host     address of the computer running rtslam
+ *   --port     30000 + index of the robot
+ *   --count    stop after this number of messages, 0 to run until the connection is closed
+ *   --verbose  print the position of each message
+ *
+ * \author agent
+ * \date 17/10/2026
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <map>
+
+#include <boost/asio.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/exportProtocol.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using boost::asio::ip::tcp;
+
+
+int main(int argc, char* const* argv)
+{ try {
+	std::string host = "127.0.0.1";
+	unsigned short port = 30000;
+	unsigned count = 0;
+	bool verbose = false;
+	for(int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--host") == 0 && i+1 < argc) host = argv[++i]; else
+		if (strcmp(argv[i], "--port") == 0 && i+1 < argc) port = atoi(argv[++i]); else
+		if (strcmp(argv[i], "--count") == 0 && i+1 < argc) count = atoi(argv[++i]); else
+		if (strcmp(argv[i], "--verbose") == 0) verbose = true; else
+			{ std::cout << "usage: " << argv[0] << " [--host 127.0.0.1] [--port 30000] [--count 0] [--verbose]" << std::endl; return 1; }
+	}
+
+	boost::asio::io_service io_service;
+	tcp::socket sock(io_service);
+	sock.connect(tcp::endpoint(boost::asio::ip::address::from_string(host), port));
+	std::cout << "Connected to " << host << ":" << port << std::endl;
+
+	std::vector<char> data;
+	ExportMessage msg;
+	unsigned nmsg = 0, nstate = 0, ndropped = 0, nunordered = 0;
+	// the map, valid from the first keyframe until a delta is missed
+	std::map<unsigned, ExportMessage::Landmark> lmks;
+	bool map_valid = false;
+	uint64_t map_seq = 0;
+	unsigned nkeyframes = 0, ndeltas = 0, nchanges = 0, nmapgaps = 0;
+	uint64_t last_seq = 0, nbytes = 0;
+	double max_latency = 0., sum_latency = 0., start = 0.;
+	bool closed = false;
+	while (count == 0 || nmsg < count)
+	{
+		data.resize(exportproto::headerSize);
+		boost::system::error_code error;
+		boost::asio::read(sock, boost::asio::buffer(data), error);
+		if (error) { closed = true; break; }
+		size_t size = exportMessageSize(&data[0]);
+		if (size == 0) { std::cout << "Invalid message header (wrong protocol or version), stopping" << std::endl; break; }
+		data.resize(size);
+		boost::asio::read(sock, boost::asio::buffer(&data[exportproto::headerSize], size - exportproto::headerSize), error);
+		if (error) { closed = true; break; }
+		double now = kernel::Clock::getTime();
+		if (!decodeExportMessage(&data[0], size, msg)) { std::cout << "Invalid message, stopping" << std::endl; break; }
+
+		if (nmsg == 0) start = now; else
+		{
+			if (msg.seq <= last_seq) ++nunordered; else
+				ndropped += msg.seq - last_seq - 1;
+		}
+		last_seq = msg.seq;
+		++nmsg; nbytes += size;
+		if (msg.type == exportproto::typeState) ++nstate;
+		if (msg.type == exportproto::typeMapKeyframe)
+		{
+			lmks.clear();
+			for(std::vector<ExportMessage::Landmark>::iterator it = msg.landmarks.begin(); it != msg.landmarks.end(); ++it)
+				lmks[it->id] = *it;
+			map_valid = true;
+			++nkeyframes;
+		} else
+		if (msg.type == exportproto::typeMapDelta)
+		{
+			++ndeltas;
+			nchanges += msg.landmarks.size();
+			if (map_valid && msg.map_seq != map_seq+1) { map_valid = false; ++nmapgaps; }
+			if (map_valid)
+				for(std::vector<ExportMessage::Landmark>::iterator it = msg.landmarks.begin(); it != msg.landmarks.end(); ++it)
+				{
+					if (it->op == exportproto::opDelete) lmks.erase(it->id); else lmks[it->id] = *it;
+				}
+		}
+		if (msg.type == exportproto::typeMapKeyframe || msg.type == exportproto::typeMapDelta) map_seq = msg.map_seq;
+		// only meaningful when the clocks are synchronized
+		double latency = now - msg.export_date;
+		sum_latency += latency;
+		if (latency > max_latency) max_latency = latency;
+
+		if (verbose)
+		{
+			std::cout << std::fixed << std::setprecision(4) << "#" << msg.seq << " t " << msg.time;
+			if (msg.type == exportproto::typeState || msg.type == exportproto::typePropagatedState)
+				std::cout << (msg.type == exportproto::typeState ? " state " : " propagated ")
+				          << "pos " << msg.x[0] << " " << msg.x[1] << " " << msg.x[2] << std::endl;
+			else
+				std::cout << (msg.type == exportproto::typeMapKeyframe ? " map keyframe " : " map delta ") << msg.map_seq
+				          << ", " << msg.landmarks.size() << " landmarks, map " << (map_valid ? "" : "not ") << "valid with "
+				          << lmks.size() << " landmarks" << std::endl;
+		}
+	}
+
+	double duration = kernel::Clock::getTime() - start;
+	if (closed) std::cout << "Connection closed by the exporter" << std::endl;
+	std::cout << nmsg << " messages (" << nstate << " filter updates, " << nkeyframes << " map keyframes, " << ndeltas << " map deltas) in "
+	          << std::setprecision(3) << duration << " s" << std::endl;
+	if (nmsg == 0) return 0;
+	std::cout << "throughput " << nmsg / duration << " msg/s, " << nbytes / duration / 1e6 << " MB/s" << std::endl;
+	std::cout << "dropped " << ndropped << ", out of order " << nunordered << std::endl;
+	if (nkeyframes || ndeltas)
+		std::cout << "map: " << lmks.size() << " landmarks" << (map_valid ? "" : " (not valid)") << ", "
+		          << (ndeltas ? nchanges / (double)ndeltas : 0.) << " changes per delta, " << nmapgaps << " deltas missed" << std::endl;
+	std::cout << "latency mean " << sum_latency / nmsg * 1000. << " ms, max " << max_latency * 1000. << " ms" << std::endl;
+	return (nunordered == 0 ? 0 : 2);
+} catch (kernel::Exception &e) { std::cout << e.what(); return 1; }
+  catch (std::exception &e) { std::cout << "Error: " << e.what() << std::endl; return 1; } }
@@ -0,0 +1,183 @@
+/**
+ * \file demo_log_reader.cpp
+ *
+ * Reader of the binary logs written by demo_slam --log=2 (see BinaryLogger):
+ * prints the tables that the log contains, and converts them to csv files or
+ * to numpy structured arrays (numpy.load gives one field per column).
+ *
+ * usage: demo_log_reader file.rtlog [--csv prefix] [--npy prefix]
+ *   --csv  writes each table to prefix_<table>.csv, with the log number in the first column
+ *   --npy  writes each table to prefix_<table>.npy, with the log number in the field "log"
+ *
+ * \author agent
+ * \date 17/10/2026
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cctype>
+#include <stdint.h>
+
+#include "kernel/jafarException.hpp"
+
+#include "rtslam/binaryLogger.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+/// the name of the table in a file name
+static std::string fileName(std::string const &prefix, std::string const &table, const char *extension)
+{
+	std::string name = table;
+	for(size_t i = 0; i < name.size(); ++i)
+		if (!isalnum(name[i])) name[i] = '_';
+	return prefix + "_" + name + extension;
+}
+
+
+static void writeCsv(std::string const &filename, std::string const &prefix)
+{
+	BinaryLogReader reader(filename);
+	BinaryLogReader::Rows rows;
+	std::vector<std::ofstream*> files;
+	while (reader.next(rows))
+	{
+		if (rows.table >= files.size()) files.resize(rows.table+1, NULL);
+		std::ofstream *&f = files[rows.table];
+		BinaryLogReader::Schema const &schema = reader.schemas[rows.table];
+		if (f == NULL)
+		{
+			std::string name = fileName(prefix, schema.name, ".csv");
+			f = new std::ofstream(name.c_str());
+			*f << "log";
+			for(size_t c = 0; c < schema.columns.size(); ++c) *f << "," << schema.columns[c];
+			*f << "\n" << std::setprecision(17);
+			std::cout << "writing " << name << std::endl;
+		}
+		for(unsigned r = 0; r < rows.nrows; ++r)
+		{
+			*f << rows.log;
+			for(size_t c = 0; c < rows.columns.size(); ++c) *f << "," << rows.value(c, r);
+			*f << "\n";
+		}
+	}
+	for(size_t i = 0; i < files.size(); ++i) delete files[i];
+}
+
+
+/// the header of a structured array in the npy format 1.0
+static std::string npyHeader(BinaryLogReader::Schema const &schema, uint64_t nrows)
+{
+	std::ostringstream dict;
+	dict << "{'descr': [('log', '<u4')";
+	for(size_t c = 0; c < schema.columns.size(); ++c)
+		dict << ", ('" << schema.columns[c] << "', '" << BinaryLogger::typeName(schema.types[c]) << "')";
+	dict << "], 'fortran_order': False, 'shape': (" << nrows << ",), }";
+	std::string header = dict.str();
+	size_t total = 10 + header.size() + 1;
+	header.append((64 - total % 64) % 64, ' '); // the data is aligned
+	header += '\n';
+
+	std::string npy("\x93NUMPY\x01\x00", 8);
+	uint16_t len = header.size();
+	npy.append((const char*)&len, 2);
+	return npy + header;
+}
+
+static void writeNpy(std::string const &filename, std::string const &prefix)
+{
+	// the header needs the number of rows of each table
+	std::vector<uint64_t> nrows;
+	{
+		BinaryLogReader reader(filename);
+		BinaryLogReader::Rows rows;
+		while (reader.next(rows))
+		{
+			if (rows.table >= nrows.size()) nrows.resize(rows.table+1, 0);
+			nrows[rows.table] += rows.nrows;
+		}
+	}
+
+	BinaryLogReader reader(filename);
+	BinaryLogReader::Rows rows;
+	std::vector<std::ofstream*> files;
+	while (reader.next(rows))
+	{
+		if (rows.table >= files.size()) files.resize(rows.table+1, NULL);
+		std::ofstream *&f = files[rows.table];
+		BinaryLogReader::Schema const &schema = reader.schemas[rows.table];
+		if (f == NULL)
+		{
+			std::string name = fileName(prefix, schema.name, ".npy");
+			f = new std::ofstream(name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			std::string header = npyHeader(schema, nrows[rows.table]);
+			f->write(header.data(), header.size());
+			std::cout << "writing " << name << std::endl;
+		}
+		// the columns of the log become the fields of the records
+		for(unsigned r = 0; r < rows.nrows; ++r)
+		{
+			uint32_t log = rows.log;
+			f->write((const char*)&log, 4);
+			for(size_t c = 0; c < rows.columns.size(); ++c)
+				f->write(rows.data(c, r), BinaryLogger::typeSize(schema.types[c]));
+		}
+	}
+	for(size_t i = 0; i < files.size(); ++i) delete files[i];
+}
+
+
+static void printSummary(std::string const &filename)
+{
+	BinaryLogReader reader(filename);
+	BinaryLogReader::Rows rows;
+	std::vector<uint64_t> nrows;
+	unsigned nlogs = 0;
+	while (reader.next(rows))
+	{
+		if (rows.table >= nrows.size()) nrows.resize(rows.table+1, 0);
+		nrows[rows.table] += rows.nrows;
+		if (rows.log+1 > nlogs) nlogs = rows.log+1;
+	}
+
+	for(size_t i = 0; i < reader.comments.size(); ++i)
+		std::cout << "# " << reader.comments[i] << std::endl;
+	std::cout << nlogs << " logs" << std::endl;
+	for(size_t t = 0; t < reader.schemas.size(); ++t)
+	{
+		BinaryLogReader::Schema const &schema = reader.schemas[t];
+		std::cout << "table " << t << " \"" << schema.name << "\": " << (t < nrows.size() ? nrows[t] : 0) << " rows" << std::endl;
+		for(size_t i = 0; i < schema.comments.size(); ++i)
+			std::cout << "  # " << schema.comments[i] << std::endl;
+		std::cout << " ";
+		for(size_t c = 0; c < schema.columns.size(); ++c)
+			std::cout << " " << schema.columns[c] << ":" << BinaryLogger::typeName(schema.types[c]);
+		std::cout << std::endl;
+	}
+}
+
+
+int main(int argc, char* const* argv)
+{ try {
+	std::string filename, csv, npy;
+	for(int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--csv") == 0 && i+1 < argc) csv = argv[++i]; else
+		if (strcmp(argv[i], "--npy") == 0 && i+1 < argc) npy = argv[++i]; else
+		if (argv[i][0] != '-' && filename.empty()) filename = argv[i]; else
+			{ filename.clear(); break; }
+	}
+	if (filename.empty())
+		{ std::cout << "usage: " << argv[0] << " file.rtlog [--csv prefix] [--npy prefix]" << std::endl; return 1; }
+
+	printSummary(filename);
+	if (!csv.empty()) writeCsv(filename, csv);
+	if (!npy.empty()) writeNpy(filename, npy);
+	return 0;
+} catch (kernel::Exception &e) { std::cout << e.what(); return 1; } }
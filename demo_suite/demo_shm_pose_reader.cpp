@@ -0,0 +1,78 @@
+/**
+ * \file demo_shm_pose_reader.cpp
+ *
+ * Reference reader of the pose published in shared memory by ExporterShm
+ * (demo_slam --export=4): prints the samples and the latency between their
+ * publication and their reading, as a controller on the same machine would see it.
+ *
+ * usage: demo_shm_pose_reader [--name /rtslam_pose0] [--count 0] [--quiet]
+ *   --name   name of the shared memory segment, /rtslam_pose followed by the index of the robot
+ *   --count  stop after this number of samples, 0 to run until slam stops
+ *   --quiet  only print the statistics at the end
+ *
+ * \author agent
+ * \date 17/10/2026
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include <boost/thread.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/shmPose.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+int main(int argc, char* const* argv)
+{ try {
+	std::string name = "/rtslam_pose0";
+	unsigned count = 0;
+	bool quiet = false;
+	for(int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--name") == 0 && i+1 < argc) name = argv[++i]; else
+		if (strcmp(argv[i], "--count") == 0 && i+1 < argc) count = atoi(argv[++i]); else
+		if (strcmp(argv[i], "--quiet") == 0) quiet = true; else
+			{ std::cout << "usage: " << argv[0] << " [--name /rtslam_pose0] [--count 0] [--quiet]" << std::endl; return 1; }
+	}
+
+	shm_pose_reader_ptr_t reader;
+	std::cout << "Waiting for " << name << "..." << std::endl;
+	while (!(reader = ShmPoseReader::open(name)))
+		boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+
+	ShmPose pose;
+	uint64_t last = 0;
+	unsigned nread = 0, nmissed = 0;
+	double sum_latency = 0., max_latency = 0.;
+	while ((count == 0 || nread < count) && reader->waitNew(last, pose, 10.))
+	{
+		double latency = kernel::Clock::getTime() - pose.export_date;
+		if (nread > 0) nmissed += pose.count - last - 1;
+		last = pose.count;
+		++nread;
+		sum_latency += latency;
+		if (latency > max_latency) max_latency = latency;
+		if (!quiet)
+			std::cout << std::fixed << std::setprecision(4) << "#" << pose.count << " t " << pose.time
+			          << (pose.type == shmpose::typeState ? " state " : " propagated ")
+			          << "pos " << pose.x[0] << " " << pose.x[1] << " " << pose.x[2]
+			          << " stdev " << sqrt(pose.P[0]) << " latency " << std::setprecision(1) << latency*1e6 << " us" << std::endl;
+	}
+
+	if (reader->isClosed()) std::cout << "Closed by slam" << std::endl;
+	std::cout << nread << " samples read, " << nmissed << " overwritten before being read" << std::endl;
+	if (nread)
+		std::cout << "latency mean " << sum_latency/nread*1e6 << " us, max " << max_latency*1e6 << " us" << std::endl;
+	return 0;
+} catch (kernel::Exception &e) { std::cout << e.what(); return 1; } }
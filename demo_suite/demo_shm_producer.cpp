@@ -0,0 +1,126 @@
+/**
+ * \file demo_shm_producer.cpp
+ *
+ * Reference producer for HardwareSensorCameraShm: replays a directory of
+ * images (image_NNNNNNN.pgm/png with their .time file, as dumped by rtslam)
+ * into a shared memory ring, at the rate given by the timestamps of the
+ * images, as an acquisition process would do with a real camera.
+ *
+ * usage: demo_shm_producer <input directory> [--name /rtslam_camera] [--slots 16] [--speed 1] [--loop]
+ *   --name   name of the shared memory segment (CAMERA_DEVICE in setup.cfg, with CAMERA_TYPE 4)
+ *   --slots  number of images in the ring, must be larger than the buffer of the camera in rtslam
+ *   --speed  replay speed factor, 0 to publish as fast as the consumer reads
+ *   --loop   restart from the first image at the end
+ *
+ * \author agent
+ * \date 17/10/2026
+ *
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+
+#include <boost/thread.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+#include "image/Image.hpp"
+
+#include "rtslam/shmImageRing.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam::hardware;
+
+
+/**
+Finds the first image of the directory the same way HardwareSensorCamera does.
+@return the extension of the images, or an empty string if there is none
+*/
+std::string findFirstImage(std::string const &path, int &ndigit, unsigned &first_index)
+{
+	image::Image img;
+	for(first_index = 0; first_index < 1000; ++first_index)
+		for(ndigit = 3; ndigit <= 7; ++ndigit)
+		{
+			std::ostringstream oss; oss << path << "/image_" << std::setw(ndigit) << std::setfill('0') << first_index;
+			if (img.load(oss.str() + std::string(".pgm"), 0)) return ".pgm";
+			if (img.load(oss.str() + std::string(".png"), 0)) return ".png";
+		}
+	return "";
+}
+
+
+int main(int argc, char* const* argv)
+{ try {
+	if (argc < 2)
+	{
+		std::cout << "usage: " << argv[0] << " <input directory> [--name /rtslam_camera] [--slots 16] [--speed 1] [--loop]" << std::endl;
+		return 1;
+	}
+	std::string input = argv[1], name = "/rtslam_camera";
+	unsigned nslots = 16;
+	double speed = 1.;
+	bool loop = false;
+	for(int i = 2; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--name") == 0 && i+1 < argc) name = argv[++i]; else
+		if (strcmp(argv[i], "--slots") == 0 && i+1 < argc) nslots = atoi(argv[++i]); else
+		if (strcmp(argv[i], "--speed") == 0 && i+1 < argc) speed = atof(argv[++i]); else
+		if (strcmp(argv[i], "--loop") == 0) loop = true; else
+			{ std::cout << "Unknown option " << argv[i] << std::endl; return 1; }
+	}
+
+	int ndigit; unsigned first_index;
+	std::string ext = findFirstImage(input, ndigit, first_index);
+	if (ext.empty()) { std::cout << "No image found in " << input << std::endl; return 1; }
+
+	shm_image_ring_ptr_t ring;
+	image::Image img;
+	unsigned n = 0, published = 0;
+	double first_timestamp = 0., start = 0.;
+	do
+	{
+		for(unsigned k = 0; ; ++k)
+		{
+			std::ostringstream oss; oss << input << "/image_" << std::setw(ndigit) << std::setfill('0') << k+first_index;
+			if (!img.load(oss.str() + ext, 0)) break;
+			if (!ring)
+			{
+				ring = ShmImageRing::create(name, nslots, img.width(), img.height(), 8, 1);
+				std::cout << "Publishing " << img.width() << "x" << img.height() << " images on " << name << " (" << nslots << " slots)" << std::endl;
+			}
+
+			double timestamp = 0.;
+			std::fstream f((oss.str() + std::string(".time")).c_str(), std::ios_base::in);
+			f >> timestamp; f.close();
+
+			// wait for the date of the image, and give it a live timestamp
+			double now = kernel::Clock::getTime();
+			if (k == 0) { first_timestamp = timestamp; start = now; }
+			if (speed > 0.)
+			{
+				double date = start + (timestamp - first_timestamp) / speed;
+				if (date > now) boost::this_thread::sleep(boost::posix_time::microseconds((long)((date-now)*1e6)));
+				now = kernel::Clock::getTime();
+			} else
+				while (ring->isFull()) // the consumer sets the pace
+					boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+
+			if (ring->write((const unsigned char*)img.data(), img.step(), (speed > 0. ? now : timestamp), now)) ++published;
+			if (++n % 100 == 0) std::cout << "\r" << n << " images, " << ring->dropped() << " dropped" << std::flush;
+		}
+	} while (loop && ring);
+
+	if (ring)
+	{
+		std::cout << "\r" << n << " images, " << published << " published, " << ring->dropped() << " dropped" << std::endl;
+		ring->close();
+		boost::this_thread::sleep(boost::posix_time::seconds(1)); // let the consumer see it is closed before the segment is removed
+	}
+	return 0;
+} catch (kernel::Exception &e) { std::cout << e.what(); return 1; } }
@@ -157,12 +157,18 @@
 
 #include "rtslam/hardwareSensorCameraFirewire.hpp"
 #include "rtslam/hardwareSensorCameraUeye.hpp"
+#include "rtslam/hardwareSensorCameraShm.hpp"
 #include "rtslam/hardwareEstimatorMti.hpp"
 #include "rtslam/hardwareSensorGpsGenom.hpp"
 #include "rtslam/hardwareSensorMocap.hpp"
 #include "rtslam/hardwareEstimatorOdo.hpp" 
 #include "rtslam/hardwareSensorExternalLoc.hpp"
 
+#include "rtslam/displaySnapshot.hpp"
+#include "rtslam/frameEncoder.hpp"
+#include "rtslam/binaryLogger.hpp"
+#include "rtslam/trace.hpp"
+#include <opencv/highgui.h> // cv::imread to read back the gdhe dumps
 #include "rtslam/display_qt.hpp"
 #include "rtslam/display_gdhe.hpp"
 
@@ -170,6 +176,9 @@
 #include "rtslam/hardwareSensorAdhocSimulator.hpp"
 #include "rtslam/hardwareEstimatorInertialAdhocSimulator.hpp"
 #include "rtslam/exporterSocket.hpp"
+#include "rtslam/exporterShm.hpp"
+#include "rtslam/posePropagator.hpp"
+#include "rtslam/startupCoordinator.hpp"
 
 
 /** ############################################################################
@@ -216,15 +225,15 @@ time_t rseed;
  * program parameters
  * ###########################################################################*/
 
-enum { iDispQt = 0, iDispGdhe, iRenderAll, iReplay, iDump, iRandSeed, iPause, iVerbose, iMap, iRobot, iCamera, iTrigger, iGps, iSimu, iExport, nIntOpts };
+enum { iDispQt = 0, iDispGdhe, iRenderAll, iReplay, iDump, iRandSeed, iPause, iVerbose, iMap, iRobot, iCamera, iTrigger, iGps, iSimu, iExport, iPrefetch, iPropagate, iPipeline, iRobots, nIntOpts };
 int intOpts[nIntOpts] = {0};
 const int nFirstIntOpt = 0, nLastIntOpt = nIntOpts-1;
 
-enum { fFreq = 0, fShutter, fHeading, nFloatOpts };
+enum { fFreq = 0, fShutter, fHeading, fReplayStart, fRealTime, fOosmWindow, fGroup, fDispRate, fDisp3dRate, nFloatOpts };
 double floatOpts[nFloatOpts] = {0.0};
 const int nFirstFloatOpt = nIntOpts, nLastFloatOpt = nIntOpts+nFloatOpts-1;
 
-enum { sDataPath = 0, sConfigSetup, sConfigEstimation, sLog, nStrOpts };
+enum { sDataPath = 0, sConfigSetup, sConfigEstimation, sLog, sDataset, sTrace, nStrOpts };
 std::string strOpts[nStrOpts];
 const int nFirstStrOpt = nIntOpts+nFloatOpts, nLastStrOpt = nIntOpts+nFloatOpts+nStrOpts-1;
 
@@ -252,15 +261,27 @@ struct option long_options[] = {
 	{"gps", 2, 0, 0},
 	{"simu", 2, 0, 0},
 	{"export", 2, 0, 0},
+	{"prefetch", 2, 0, 0}, // number of threads loading images in replay
+	{"propagate", 2, 0, 0}, // export the pose at each reading of the hardware estimator
+	{"pipeline", 2, 0, 0}, // prepare the next image in another thread while the current one is processed
+	{"robots", 2, 0, 0}, // number of robots, each one with its own map and processed in its own thread
 	// double options
 	{"freq", 2, 0, 0}, // should be in config file
 	{"shutter", 2, 0, 0}, // should be in config file
 	{"heading", 2, 0, 0},
+	{"replay-start", 2, 0, 0}, // seconds skipped at the beginning of a dataset file
+	{"realtime", 2, 0, 0}, // emulate real-time in replay at this rate of the recorded time (1 = real-time), 0 to process everything
+	{"oosm-window", 2, 0, 0}, // duration of the robot history used to process out-of-sequence gps readings (s)
+	{"group", 2, 0, 0}, // images of different cameras whose timestamps differ by less than this (s) are processed together
+	{"disp-rate", 2, 0, 0}, // maximal refresh rate of the camera views (Hz)
+	{"disp-3d-rate", 2, 0, 0}, // maximal refresh rate of the 3d view (Hz)
 	// string options
 	{"data-path", 1, 0, 0},
 	{"config-setup", 1, 0, 0},
 	{"config-estimation", 1, 0, 0},
 	{"log", 1, 0, 0},
+	{"dataset", 1, 0, 0}, // single file dataset (.rtds) used instead of data-path for images
+	{"trace", 1, 0, 0}, // chrome trace of the main phases, written at the end
 	// breaking options
 	{"help",0,0,0},
 	{"usage",0,0,0},
@@ -275,7 +296,8 @@ struct option long_options[] = {
 
 const int slam_priority = -20; // needs to be started as root to be < 0
 const int display_priority = 10;
-const int display_period = 100; // ms
+int display_period = 100; // ms, reduced if a view has a higher rate
+const double startup_timeout = 10.0; // s, max time to wait for the sensors to be ready
 const unsigned N_FRAMES = 500000;
 
 
@@ -288,8 +310,8 @@ class ConfigSetup: public kernel::KeyValueFileSaveLoad
 	jblas::vec6 GPS_POSE; /// GPS pose (x,y,z,roll,pitch,yaw) (m,deg)
 	jblas::vec6 ROBOT_POSE; /// the transformation between the slam robot (the main sensor, camera or imu) and the real robot = pose of the real robot in the slam robot frame, just like the other sensors
 
-	unsigned CAMERA_TYPE;      /// camera type (0 = firewire, 1 = firewire format7, 2 = USB, 3 = UEYE)
-	std::string CAMERA_DEVICE; /// camera device (firewire ID or device)
+	unsigned CAMERA_TYPE;      /// camera type (0 = firewire, 1 = firewire format7, 2 = USB, 3 = UEYE, 4 = shared memory)
+	std::string CAMERA_DEVICE; /// camera device (firewire ID or device, or shared memory name)
 	unsigned IMG_WIDTH;        /// image width
 	unsigned IMG_HEIGHT;       /// image height
 	jblas::vec4 INTRINSIC;     /// intrisic calibration parameters (u0,v0,alphaU,alphaV)
@@ -354,7 +376,7 @@ class ConfigSetup: public kernel::KeyValueFileSaveLoad
  public:
 	virtual void loadKeyValueFile(jafar::kernel::KeyValueFile const& keyValueFile);
 	virtual void saveKeyValueFile(jafar::kernel::KeyValueFile& keyValueFile);
-} configSetup;
+};
 
 
 
@@ -421,106 +443,65 @@ class ConfigEstimation: public kernel::KeyValueFileSaveLoad
  * ###########################################################################*/
 
 world_ptr_t worldPtr;
-boost::scoped_ptr<kernel::DataLogger> dataLogger;
-sensor_manager_ptr_t sensorManager;
-boost::shared_ptr<ExporterAbstract> exporter;
 #ifdef HAVE_MODULE_QDISPLAY
 display::ViewerQt *viewerQt = NULL;
 #endif
 #ifdef HAVE_MODULE_GDHE
 display::ViewerGdhe *viewerGdhe = NULL;
 #endif
-kernel::VariableCondition<int> rawdata_condition(0);
+display::WorldSnapshotBuffer *displaySnapshots = NULL; // published by slam, rendered by the display
+display::FrameEncoder *encoder2d = NULL, *encoder3d = NULL; // write the rendered views when dumping in replay
+uint64_t display_seq = 0; // last snapshot rendered
 
+/**
+ * A map with its robot, and everything needed to process it in its own thread.
+ */
+struct SlamRobot
+{
+	unsigned index;
+	std::string dataPath; ///< where the data of this robot are dumped and replayed
+	ConfigSetup configSetup;
+	map_ptr_t mapPtr;
+	robot_ptr_t robPtr;
+	boost::scoped_ptr<kernel::DataLogger> dataLogger;
+	boost::scoped_ptr<BinaryLogger> binaryLogger;
+	sensor_manager_ptr_t sensorManager;
+	boost::shared_ptr<ExporterAbstract> exporter;
+	boost::scoped_ptr<PosePropagator> posePropagator;
+	kernel::VariableCondition<int> rawdata_condition;
+	hardware::replay_clock_ptr_t replayClock;
+
+	// statistics
+	unsigned nframes;
+	double average_robot_innovation;
+	int n_innovation;
+
+	SlamRobot(unsigned index): index(index), rawdata_condition(0), nframes(0), average_robot_innovation(0.), n_innovation(0) {}
+};
+typedef boost::shared_ptr<SlamRobot> slam_robot_ptr_t;
+std::vector<slam_robot_ptr_t> slamRobots;
 
-void demo_slam_init()
-{ try {
-	// preprocess options
-	if (intOpts[iReplay] & 1) mode = 2; else
-		if (intOpts[iDump]) mode = 1; else
-			mode = 0;
-	if (strOpts[sConfigSetup] == "#!@")
-	{
-		if (intOpts[iReplay] & 1)
-			strOpts[sConfigSetup] = strOpts[sDataPath] + "/setup.cfg";
-		else
-			strOpts[sConfigSetup] = "data/setup.cfg";
-	}
-	if (intOpts[iReplay] & 1) intOpts[iExport] = 0;
-	if (strOpts[sConfigSetup][0] == '@' && strOpts[sConfigSetup][1] == '/')
-		strOpts[sConfigSetup] = strOpts[sDataPath] + strOpts[sConfigSetup].substr(1);
-	if (strOpts[sConfigEstimation][0] == '@' && strOpts[sConfigEstimation][1] == '/')
-		strOpts[sConfigEstimation] = strOpts[sDataPath] + strOpts[sConfigEstimation].substr(1);
-	if (!(intOpts[iReplay] & 1) && intOpts[iDump])
-	{
-		boost::filesystem::remove(strOpts[sDataPath] + "/setup.cfg");
-		boost::filesystem::remove(strOpts[sDataPath] + "/setup.cfg.maybe");
-		if (intOpts[iReplay] == 2)
-			boost::filesystem::copy_file(strOpts[sConfigSetup], strOpts[sDataPath] + "/setup.cfg.maybe"/*, boost::filesystem::copy_option::overwrite_if_exists*/);
-		else
-			boost::filesystem::copy_file(strOpts[sConfigSetup], strOpts[sDataPath] + "/setup.cfg"/*, boost::filesystem::copy_option::overwrite_if_exists*/);
-	}
-	#ifndef HAVE_MODULE_QDISPLAY
-	intOpts[iDispQt] = 0;
-	#endif
-	#ifndef HAVE_MODULE_GDHE
-	intOpts[iDispGdhe] = 0;
-	#endif
 
-	if (strOpts[sLog].size() == 1)
+void demo_slam_init_robot(SlamRobot &slam, boost::shared_ptr<ObservationFactory> obsFact)
+{ try {
+	// the first robot uses the data path itself, so that single robot data are unchanged
+	slam.dataPath = strOpts[sDataPath];
+	std::string setupPath = strOpts[sConfigSetup];
+	if (slam.index > 0)
 	{
-		if (strOpts[sLog][0] == '0') strOpts[sLog] = ""; else
-		if (strOpts[sLog][0] == '1') strOpts[sLog] = "rtslam.log";
-	}
-		
-		
-	// init
-	worldPtr.reset(new WorldAbstract());
-
-	std::cout << "Loading config files " << strOpts[sConfigSetup] << " and " << strOpts[sConfigEstimation] << std::endl;
-	configSetup.load(strOpts[sConfigSetup]);
-	configEstimation.load(strOpts[sConfigEstimation]);
-	
-	// deal with the random seed
-	rseed = jmath::get_srand();
-	if (intOpts[iRandSeed] != 0 && intOpts[iRandSeed] != 1)
-		rseed = intOpts[iRandSeed];
-	if (!(intOpts[iReplay] & 1) && intOpts[iDump]) {
-		std::fstream f((strOpts[sDataPath] + std::string("/rseed.log")).c_str(), std::ios_base::out);
-		f << rseed << std::endl;
-		f.close();
-	}
-	else if ((intOpts[iReplay] & 1) && intOpts[iRandSeed] == 1) {
-		std::fstream f((strOpts[sDataPath] + std::string("/rseed.log")).c_str(), std::ios_base::in);
-		f >> rseed;
-		f.close();
+		std::ostringstream oss; oss << strOpts[sDataPath] << "/robot" << slam.index;
+		slam.dataPath = oss.str();
+		if (!(intOpts[iReplay] & 1) && intOpts[iDump]) boost::filesystem::create_directories(slam.dataPath);
+		if (boost::filesystem::exists(slam.dataPath + "/setup.cfg")) setupPath = slam.dataPath + "/setup.cfg";
+		std::cout << "Robot " << slam.index << ": loading config file " << setupPath << std::endl;
 	}
-	intOpts[iRandSeed] = rseed;
-	std::cout << "Random seed " << rseed << std::endl;
-	rtslam::srand(rseed);
+	slam.configSetup.load(setupPath);
+	ConfigSetup &configSetup = slam.configSetup;
+	kernel::VariableCondition<int> &rawdata_condition = slam.rawdata_condition;
+	hardware::replay_clock_ptr_t &replayClock = slam.replayClock;
+	if ((intOpts[iReplay] & 1) && floatOpts[fRealTime] > 0.0)
+		replayClock.reset(new hardware::ReplayClock(rawdata_condition, floatOpts[fRealTime]));
 
-	#ifdef HAVE_MODULE_QDISPLAY
-	if (intOpts[iDispQt])
-	{
-		display::ViewerQt *viewerQt = new display::ViewerQt(8, configEstimation.MAHALANOBIS_TH, false, "data/rendered2D_%02d-%06d.png");
-		worldPtr->addDisplayViewer(viewerQt, display::ViewerQt::id());
-	}
-	#endif
-	#ifdef HAVE_MODULE_GDHE
-	if (intOpts[iDispGdhe])
-	{
-		#if ATRV
-		display::ViewerGdhe *viewerGdhe = new display::ViewerGdhe("atrv", configEstimation.MAHALANOBIS_TH, "localhost");
-		#else	
-		display::ViewerGdhe *viewerGdhe = new display::ViewerGdhe("camera", configEstimation.MAHALANOBIS_TH, "localhost");
-		#endif
-		boost::filesystem::path ram_path("/mnt/ram");
-		if (boost::filesystem::exists(ram_path) && boost::filesystem::is_directory(ram_path))
-			viewerGdhe->setConvertTempPath("/mnt/ram");
-		worldPtr->addDisplayViewer(viewerGdhe, display::ViewerGdhe::id());
-	}
-	#endif
-	
 	vec intrinsic, distortion;
 	int img_width, img_height;
 	if (intOpts[iSimu] != 0)
@@ -538,64 +519,41 @@ void demo_slam_init()
 		distortion = configSetup.DISTORTION;
 	}
 	
-	if (!strOpts[sLog].empty())
+	const std::string binaryLogSuffix = ".rtlog";
+	if (strOpts[sLog].size() > binaryLogSuffix.size() &&
+	    strOpts[sLog].compare(strOpts[sLog].size()-binaryLogSuffix.size(), binaryLogSuffix.size(), binaryLogSuffix) == 0)
 	{
-		dataLogger.reset(new kernel::DataLogger(strOpts[sDataPath] + "/" + strOpts[sLog]));
-		dataLogger->writeCurrentDate();
-		dataLogger->writeNewLine();
+		slam.binaryLogger.reset(new BinaryLogger(slam.dataPath + "/" + strOpts[sLog]));
+		slam.binaryLogger->writeCurrentDate();
 #ifndef GENOM
-// FIXME do it for genom
 		// write options to log
 		std::ostringstream oss;
 		for(int i = 0; i < nIntOpts; ++i)
-			{ oss << long_options[i+nFirstIntOpt].name << " = " << intOpts[i]; dataLogger->writeComment(oss.str()); oss.str(""); }
+			{ oss << long_options[i+nFirstIntOpt].name << " = " << intOpts[i]; slam.binaryLogger->writeComment(oss.str()); oss.str(""); }
 		for(int i = 0; i < nFloatOpts; ++i)
-			{ oss << long_options[i+nFirstFloatOpt].name << " = " << floatOpts[i]; dataLogger->writeComment(oss.str()); oss.str(""); }
+			{ oss << long_options[i+nFirstFloatOpt].name << " = " << floatOpts[i]; slam.binaryLogger->writeComment(oss.str()); oss.str(""); }
 		for(int i = 0; i < nStrOpts; ++i)
-			{ oss << long_options[i+nFirstStrOpt].name << " = " << strOpts[i]; dataLogger->writeComment(oss.str()); oss.str(""); }
-		dataLogger->writeNewLine();
+			{ oss << long_options[i+nFirstStrOpt].name << " = " << strOpts[i]; slam.binaryLogger->writeComment(oss.str()); oss.str(""); }
 #endif
-	}
-
-	switch (intOpts[iVerbose])
-	{
-		case 0: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Off); break;
-		case 1: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Trace); break;
-		case 2: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Warning); break;
-		case 3: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Debug); break;
-		case 4: debug::DebugStream::setLevel("rtslam", debug::DebugStream::VerboseDebug); break;
-		default: debug::DebugStream::setLevel("rtslam", debug::DebugStream::VeryVerboseDebug); break;
-	}
-
-	
-	// pin-hole parameters in BOOST format
-	boost::shared_ptr<ObservationFactory> obsFact(new ObservationFactory());
-#if SEGMENT_BASED
-	if (intOpts[iSimu] != 0)
-	{
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhplSimuObservationMaker(
-			configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5, configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
 	} else
+	if (!strOpts[sLog].empty())
 	{
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhplObservationMaker(
-			configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5, configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
-	}
+		slam.dataLogger.reset(new kernel::DataLogger(slam.dataPath + "/" + strOpts[sLog]));
+		slam.dataLogger->writeCurrentDate();
+		slam.dataLogger->writeNewLine();
+#ifndef GENOM
+// FIXME do it for genom
+		// write options to log
+		std::ostringstream oss;
+		for(int i = 0; i < nIntOpts; ++i)
+			{ oss << long_options[i+nFirstIntOpt].name << " = " << intOpts[i]; slam.dataLogger->writeComment(oss.str()); oss.str(""); }
+		for(int i = 0; i < nFloatOpts; ++i)
+			{ oss << long_options[i+nFirstFloatOpt].name << " = " << floatOpts[i]; slam.dataLogger->writeComment(oss.str()); oss.str(""); }
+		for(int i = 0; i < nStrOpts; ++i)
+			{ oss << long_options[i+nFirstStrOpt].name << " = " << strOpts[i]; slam.dataLogger->writeComment(oss.str()); oss.str(""); }
+		slam.dataLogger->writeNewLine();
 #endif
-#if SEGMENT_BASED != 1
-	if (intOpts[iSimu] != 0)
-	{
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpSimuObservationMaker(
-		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhpSimuObservationMaker(
-		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
-	} else
-	{
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpObservationMaker(
-		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
-		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhpObservationMaker(
-		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
 	}
-#endif
 
 	// ---------------------------------------------------------------------------
 	// --- INIT ------------------------------------------------------------------
@@ -776,7 +734,7 @@ void demo_slam_init()
 		{
 			// just to initialize the MTI as an external trigger controlling shutter time
 			hardware::HardwareEstimatorMti hardEst1(
-				configSetup.MTI_DEVICE, intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1, mode, strOpts[sDataPath]);
+				configSetup.MTI_DEVICE, intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1, mode, slam.dataPath);
 			floatOpts[fFreq] = hardEst1.getFreq();
 		}
 	}
@@ -820,7 +778,7 @@ void demo_slam_init()
 		} else
 		{
 			boost::shared_ptr<hardware::HardwareEstimatorMti> hardEst1_(new hardware::HardwareEstimatorMti(
-				configSetup.MTI_DEVICE, intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1024, mode, strOpts[sDataPath]));
+				configSetup.MTI_DEVICE, intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1024, mode, slam.dataPath));
 			if (intOpts[iTrigger] != 0) floatOpts[fFreq] = hardEst1_->getFreq();
 			hardEst1_->setSyncConfig(configSetup.IMU_TIMESTAMP_CORRECTION);
 			//hardEst1_->setUseForInit(true);
@@ -846,7 +804,7 @@ void demo_slam_init()
 		
 		hardware::hardware_estimator_ptr_t hardEst2;
 		boost::shared_ptr<hardware::HardwareEstimatorOdo> hardEst2_(new hardware::HardwareEstimatorOdo(
-				intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1024, mode, strOpts[sDataPath]));
+				intOpts[iTrigger], floatOpts[fFreq], floatOpts[fShutter], 1024, mode, slam.dataPath));
 		if (intOpts[iTrigger] != 0) floatOpts[fFreq] = hardEst2_->getFreq();
 		hardEst2_->setSyncConfig(configSetup.POS_TIMESTAMP_CORRECTION);
 		hardEst2 = hardEst2_;
@@ -859,12 +817,15 @@ void demo_slam_init()
 	robPtr1->setPoseStd(0,0,0, 0,0,floatOpts[fHeading], 
 	                    0,0,0, configSetup.UNCERT_ATTITUDE,configSetup.UNCERT_ATTITUDE,configSetup.UNCERT_HEADING);
 	robPtr1->robot_pose = configSetup.ROBOT_POSE;
-	if (dataLogger) dataLogger->addLoggable(*robPtr1.get());
+	robPtr1->history.setWindow(floatOpts[fOosmWindow]);
+	if (slam.dataLogger) slam.dataLogger->addLoggable(*robPtr1.get());
+	if (slam.binaryLogger) { slam.binaryLogger->addLoggable(*robPtr1.get()); slam.binaryLogger->addLoggable(*mapPtr.get()); }
 
 	if (intOpts[iSimu] != 0)
 	{
 		simu::Robot *rob = new simu::Robot(robPtr1->id(), 6);
-		if (dataLogger) dataLogger->addLoggable(*rob);
+		if (slam.dataLogger) slam.dataLogger->addLoggable(*rob);
+		if (slam.binaryLogger) slam.binaryLogger->addLoggable(*rob);
 		
 		switch (intOpts[iSimu]%10)
 		{
@@ -1041,6 +1002,7 @@ void demo_slam_init()
 		 {
 				boost::shared_ptr<DescriptorFactoryAbstract> pointDescFactory;
 				boost::shared_ptr<DescriptorFactoryAbstract> segDescFactory;
+				hardware::HardwareSensorCamera::preprocess_func_t preprocessImage; // nothing to prepare if empty
 				#if SEGMENT_BASED
 
 					 if (configEstimation.MULTIVIEW_DESCRIPTOR)
@@ -1066,12 +1028,25 @@ void demo_slam_init()
 					 boost::shared_ptr<ImagePointZnccMatcher> znccMatcher(new ImagePointZnccMatcher(configEstimation.MIN_SCORE, configEstimation.PARTIAL_POSITION, configEstimation.PATCH_SIZE, configEstimation.MAX_SEARCH_SIZE, configEstimation.RANSAC_LOW_INNOV, configEstimation.MATCH_TH, configEstimation.MAHALANOBIS_TH, configEstimation.RELEVANCE_TH, configEstimation.PIX_NOISE));
 
 					 boost::shared_ptr<DataManager_ImagePoint_Ransac> dmPt11(new DataManager_ImagePoint_Ransac(harrisDetector, znccMatcher, asGrid, configEstimation.N_UPDATES_TOTAL, configEstimation.N_UPDATES_RANSAC, ransac_ntries, configEstimation.N_INIT, configEstimation.N_RECOMP_GAINS));
+					 if (intOpts[iPipeline]) preprocessImage = boost::bind(&ImagePointHarrisDetector::prepare, harrisDetector, _1);
 
 					 dmPt11->linkToParentSensorSpec(senPtr11);
 					 dmPt11->linkToParentMapManager(mmPoint);
 					 dmPt11->setObservationFactory(obsFact);
 				#endif
 
+			std::string cameraDumpPath = (strOpts[sDataset].empty() ? slam.dataPath : strOpts[sDataset]);
+			if (slam.index > 0 && hardware::dataset::isDatasetPath(cameraDumpPath))
+			{ // each robot has its own dataset file, so that its images are neither mixed nor replayed by the other robots
+				std::ostringstream oss; oss << cameraDumpPath.substr(0, cameraDumpPath.size()-5) << ".robot" << slam.index << ".rtds";
+				cameraDumpPath = oss.str();
+			}
+			// when emulating real-time the images that would have been dropped must not block the next ones
+			const int replayBufferSize = (replayClock ? 200 : 3 + 4*intOpts[iPrefetch]);
+			const size_t replayMaxMemory = 256*1024*1024;
+			std::vector<double> cameraIntrinsics(intrinsic.begin(), intrinsic.end());
+			cameraIntrinsics.insert(cameraIntrinsics.end(), distortion.begin(), distortion.end());
+
 			if (configSetup.CAMERA_TYPE == 0 || configSetup.CAMERA_TYPE == 1)
 			{ // VIAM
 				#ifdef HAVE_VIAM
@@ -1084,13 +1059,22 @@ void demo_slam_init()
 				}
 				hardware::hardware_sensor_firewire_ptr_t hardSen11(new hardware::HardwareSensorCameraFirewire(rawdata_condition, 200,
 					configSetup.CAMERA_DEVICE, cv::Size(img_width,img_height), 0, 8, crop, floatOpts[fFreq], intOpts[iTrigger],
-					floatOpts[fShutter], mode, strOpts[sDataPath]));
+					floatOpts[fShutter], mode, cameraDumpPath));
 				hardSen11->setTimingInfos(1.0/hardSen11->getFreq(), 1.0/hardSen11->getFreq());
+				hardSen11->setDatasetOptions(0, hardware::dataset::encRaw, cameraIntrinsics);
+				hardSen11->seekDataset(floatOpts[fReplayStart]);
+				hardSen11->setPrefetch(intOpts[iPrefetch], replayMaxMemory);
+				hardSen11->setPreprocessing(preprocessImage);
+				hardSen11->setReplayClock(replayClock);
 				senPtr11->setHardwareSensor(hardSen11);
 				#else
 				if (intOpts[iReplay] & 1)
 				{
-					hardware::hardware_sensorext_ptr_t hardSen11(new hardware::HardwareSensorCameraFirewire(rawdata_condition, cv::Size(img_width,img_height),strOpts[sDataPath]));
+					hardware::hardware_sensor_firewire_ptr_t hardSen11(new hardware::HardwareSensorCameraFirewire(rawdata_condition, cv::Size(img_width,img_height),cameraDumpPath, replayBufferSize));
+					hardSen11->seekDataset(floatOpts[fReplayStart]);
+					hardSen11->setPrefetch(intOpts[iPrefetch], replayMaxMemory);
+					hardSen11->setPreprocessing(preprocessImage);
+					hardSen11->setReplayClock(replayClock);
 					senPtr11->setHardwareSensor(hardSen11);
 				}
 				#endif
@@ -1102,16 +1086,43 @@ void demo_slam_init()
 				#ifdef HAVE_UEYE
 				hardware::hardware_sensor_ueye_ptr_t hardSen11(new hardware::HardwareSensorCameraUeye(rawdata_condition, 200,
 					configSetup.CAMERA_DEVICE, cv::Size(img_width,img_height), floatOpts[fFreq], intOpts[iTrigger],
-					floatOpts[fShutter], mode, strOpts[sDataPath]));
+					floatOpts[fShutter], mode, cameraDumpPath));
 				hardSen11->setTimingInfos(1.0/hardSen11->getFreq(), 1.0/hardSen11->getFreq());
+				hardSen11->setDatasetOptions(0, hardware::dataset::encRaw, cameraIntrinsics);
+				hardSen11->seekDataset(floatOpts[fReplayStart]);
+				hardSen11->setPrefetch(intOpts[iPrefetch], replayMaxMemory);
+				hardSen11->setPreprocessing(preprocessImage);
+				hardSen11->setReplayClock(replayClock);
 				senPtr11->setHardwareSensor(hardSen11);
 				#else
 				if (intOpts[iReplay] & 1)
 				{
-					hardware::hardware_sensorext_ptr_t hardSen11(new hardware::HardwareSensorCameraUeye(rawdata_condition, cv::Size(img_width,img_height),strOpts[sDataPath]));
+					hardware::hardware_sensor_ueye_ptr_t hardSen11(new hardware::HardwareSensorCameraUeye(rawdata_condition, cv::Size(img_width,img_height),cameraDumpPath, replayBufferSize));
+					hardSen11->seekDataset(floatOpts[fReplayStart]);
+					hardSen11->setPrefetch(intOpts[iPrefetch], replayMaxMemory);
+					hardSen11->setPreprocessing(preprocessImage);
+					hardSen11->setReplayClock(replayClock);
 					senPtr11->setHardwareSensor(hardSen11);
 				}
 				#endif
+			} else if (configSetup.CAMERA_TYPE == 4)
+			{ // images written in shared memory by an acquisition process (see demo_shm_producer)
+				hardware::hardware_sensor_shm_ptr_t hardSen11;
+				if (intOpts[iReplay] & 1)
+					hardSen11.reset(new hardware::HardwareSensorCameraShm(rawdata_condition, cv::Size(img_width,img_height),cameraDumpPath, replayBufferSize));
+				else
+				{
+					// the ring of the producer must have more slots than this buffer
+					hardSen11.reset(new hardware::HardwareSensorCameraShm(rawdata_condition, 12, configSetup.CAMERA_DEVICE,
+						cv::Size(img_width,img_height), mode, cameraDumpPath));
+					if (floatOpts[fFreq] > 0.) hardSen11->setTimingInfos(1.0/floatOpts[fFreq], 1.0/floatOpts[fFreq]);
+				}
+				hardSen11->setDatasetOptions(0, hardware::dataset::encRaw, cameraIntrinsics);
+				hardSen11->seekDataset(floatOpts[fReplayStart]);
+				hardSen11->setPrefetch(intOpts[iPrefetch], replayMaxMemory);
+				hardSen11->setPreprocessing(preprocessImage);
+				hardSen11->setReplayClock(replayClock);
+				senPtr11->setHardwareSensor(hardSen11);
 			}
 
 			senPtr11->setIntegrationPolicy(false);
@@ -1131,16 +1142,17 @@ void demo_slam_init()
 		switch (intOpts[iGps])
 		{
 			case 1:
-				hardGps.reset(new hardware::HardwareSensorGpsGenom(rawdata_condition, 200, "mana-base", mode, strOpts[sDataPath]));
+				hardGps.reset(new hardware::HardwareSensorGpsGenom(rawdata_condition, 200, "mana-base", mode, slam.dataPath));
 			case 2:
-				hardGps.reset(new hardware::HardwareSensorGpsGenom(rawdata_condition, 200, "mana-base", mode, strOpts[sDataPath])); // TODO ask to ignore vel
+				hardGps.reset(new hardware::HardwareSensorGpsGenom(rawdata_condition, 200, "mana-base", mode, slam.dataPath)); // TODO ask to ignore vel
 			case 3:
-				hardGps.reset(new hardware::HardwareSensorMocap(rawdata_condition, 200, mode, strOpts[sDataPath]));
+				hardGps.reset(new hardware::HardwareSensorMocap(rawdata_condition, 200, mode, slam.dataPath));
 				init = false;
 		}
 
 		hardGps->setSyncConfig(configSetup.GPS_TIMESTAMP_CORRECTION);
 		hardGps->setTimingInfos(1.0/20.0, 1.5/20.0);
+		hardGps->setReplayClock(replayClock);
 		senPtr13->setHardwareSensor(hardGps);
 		senPtr13->setIntegrationPolicy(true);
 		senPtr13->setUseForInit(true);
@@ -1150,10 +1162,198 @@ void demo_slam_init()
 		//hardGps->start();
 	}
 	
-	if (intOpts[iReplay] == 1)
-		sensorManager.reset(new SensorManagerReplay(mapPtr));
-	else
-		sensorManager.reset(new SensorManagerOneAndOne(mapPtr));
+	// offline when replaying without emulating real-time, else same decisions as live
+	slam.sensorManager.reset(new SensorManagerScheduler(mapPtr, intOpts[iReplay] == 1 && !replayClock));
+	slam.sensorManager->setReplayClock(replayClock);
+
+	switch (intOpts[iExport])
+	{
+		case 1: slam.exporter.reset(new ExporterSocket(robPtr1, 30000 + slam.index)); break;
+		case 2: slam.exporter.reset(new ExporterPoster(robPtr1)); break;
+		case 3: slam.exporter.reset(new ExporterSocket(robPtr1, 30000 + slam.index, true)); break;
+		case 4: { std::ostringstream oss; oss << "/rtslam_pose" << slam.index;
+			slam.exporter.reset(new ExporterShm(robPtr1, oss.str())); break; }
+	}
+	if (slam.exporter && intOpts[iPropagate])
+	{
+		if (robPtr1->hardwareEstimatorPtr) slam.posePropagator.reset(new PosePropagator(robPtr1, slam.exporter));
+		else std::cout << "Warning: the pose can only be propagated with a robot using a hardware estimator" << std::endl;
+	}
+
+	slam.mapPtr = mapPtr;
+	slam.robPtr = robPtr1;
+} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // demo_slam_init_robot
+
+
+
+void demo_slam_init()
+{ try {
+	// preprocess options
+	if (intOpts[iReplay] & 1) mode = 2; else
+		if (intOpts[iDump]) mode = 1; else
+			mode = 0;
+	if (strOpts[sConfigSetup] == "#!@")
+	{
+		if (intOpts[iReplay] & 1)
+			strOpts[sConfigSetup] = strOpts[sDataPath] + "/setup.cfg";
+		else
+			strOpts[sConfigSetup] = "data/setup.cfg";
+	}
+	if (intOpts[iReplay] & 1) intOpts[iExport] = 0;
+	if (strOpts[sConfigSetup][0] == '@' && strOpts[sConfigSetup][1] == '/')
+		strOpts[sConfigSetup] = strOpts[sDataPath] + strOpts[sConfigSetup].substr(1);
+	if (strOpts[sConfigEstimation][0] == '@' && strOpts[sConfigEstimation][1] == '/')
+		strOpts[sConfigEstimation] = strOpts[sDataPath] + strOpts[sConfigEstimation].substr(1);
+	if (!(intOpts[iReplay] & 1) && intOpts[iDump])
+	{
+		boost::filesystem::remove(strOpts[sDataPath] + "/setup.cfg");
+		boost::filesystem::remove(strOpts[sDataPath] + "/setup.cfg.maybe");
+		if (intOpts[iReplay] == 2)
+			boost::filesystem::copy_file(strOpts[sConfigSetup], strOpts[sDataPath] + "/setup.cfg.maybe"/*, boost::filesystem::copy_option::overwrite_if_exists*/);
+		else
+			boost::filesystem::copy_file(strOpts[sConfigSetup], strOpts[sDataPath] + "/setup.cfg"/*, boost::filesystem::copy_option::overwrite_if_exists*/);
+	}
+	#ifndef HAVE_MODULE_QDISPLAY
+	intOpts[iDispQt] = 0;
+	#endif
+	#ifndef HAVE_MODULE_GDHE
+	intOpts[iDispGdhe] = 0;
+	#endif
+
+	if (strOpts[sLog].size() == 1)
+	{
+		if (strOpts[sLog][0] == '0') strOpts[sLog] = ""; else
+		if (strOpts[sLog][0] == '1') strOpts[sLog] = "rtslam.log"; else
+		if (strOpts[sLog][0] == '2') strOpts[sLog] = "rtslam.rtlog";
+	}
+	if (strOpts[sTrace].size() == 1)
+	{
+		if (strOpts[sTrace][0] == '0') strOpts[sTrace] = ""; else
+		if (strOpts[sTrace][0] == '1') strOpts[sTrace] = "rtslam_trace.json";
+	}
+		
+		
+	// init
+	worldPtr.reset(new WorldAbstract());
+
+	std::cout << "Loading config files " << strOpts[sConfigSetup] << " and " << strOpts[sConfigEstimation] << std::endl;
+	configEstimation.load(strOpts[sConfigEstimation]);
+	
+	// deal with the random seed
+	rseed = jmath::get_srand();
+	if (intOpts[iRandSeed] != 0 && intOpts[iRandSeed] != 1)
+		rseed = intOpts[iRandSeed];
+	if (!(intOpts[iReplay] & 1) && intOpts[iDump]) {
+		std::fstream f((strOpts[sDataPath] + std::string("/rseed.log")).c_str(), std::ios_base::out);
+		f << rseed << std::endl;
+		f.close();
+	}
+	else if ((intOpts[iReplay] & 1) && intOpts[iRandSeed] == 1) {
+		std::fstream f((strOpts[sDataPath] + std::string("/rseed.log")).c_str(), std::ios_base::in);
+		f >> rseed;
+		f.close();
+	}
+	intOpts[iRandSeed] = rseed;
+	std::cout << "Random seed " << rseed << std::endl;
+	rtslam::srand(rseed);
+
+	#ifdef HAVE_MODULE_QDISPLAY
+	if (intOpts[iDispQt])
+	{
+		display::ViewerQt *viewerQt = new display::ViewerQt(8, configEstimation.MAHALANOBIS_TH, false, "data/rendered2D_%02d-%06d.png");
+		viewerQt->setViewRate(floatOpts[fDispRate]);
+		worldPtr->addDisplayViewer(viewerQt, display::ViewerQt::id());
+	}
+	#endif
+	#ifdef HAVE_MODULE_GDHE
+	if (intOpts[iDispGdhe])
+	{
+		#if ATRV
+		display::ViewerGdhe *viewerGdhe = new display::ViewerGdhe("atrv", configEstimation.MAHALANOBIS_TH, "localhost");
+		#else	
+		display::ViewerGdhe *viewerGdhe = new display::ViewerGdhe("camera", configEstimation.MAHALANOBIS_TH, "localhost");
+		#endif
+		boost::filesystem::path ram_path("/mnt/ram");
+		if (boost::filesystem::exists(ram_path) && boost::filesystem::is_directory(ram_path))
+			viewerGdhe->setConvertTempPath("/mnt/ram");
+		viewerGdhe->view_refresh.setRate(floatOpts[fDisp3dRate]);
+		worldPtr->addDisplayViewer(viewerGdhe, display::ViewerGdhe::id());
+	}
+	#endif
+	// images only for the 2d display, euclidean landmarks only for the 3d display
+	if (intOpts[iDispQt] || intOpts[iDispGdhe])
+		displaySnapshots = new display::WorldSnapshotBuffer(intOpts[iDispQt] != 0, intOpts[iDispGdhe] != 0);
+	// the display loop runs at the rate of the fastest view, the others skip some of its iterations
+	double max_disp_rate = std::max(intOpts[iDispQt] ? floatOpts[fDispRate] : 0., intOpts[iDispGdhe] ? floatOpts[fDisp3dRate] : 0.);
+	if (max_disp_rate > 1000./display_period) display_period = std::max(10, (int)(1000./max_disp_rate));
+	// the rendered views are encoded and written in other threads
+	if (((intOpts[iReplay] & 1) || intOpts[iSimu]) && intOpts[iDump])
+	{
+		double fps = (floatOpts[fFreq] > 0. ? floatOpts[fFreq] : 10.);
+		if (intOpts[iDispQt])
+		{
+			if (intOpts[iDump] == 2)
+				encoder2d = new display::FrameEncoder(display::FrameEncoder::MjpegAvi, strOpts[sDataPath] + "/rendered-2D_%d.avi", fps); else
+				encoder2d = new display::FrameEncoder(display::FrameEncoder::ImageSequence, strOpts[sDataPath] + "/rendered-2D_%d-%06d.png", fps);
+		}
+		// gdhe writes the 3d images itself, they are only read back by the encoder for the video
+		if (intOpts[iDispGdhe] && intOpts[iDump] == 2)
+			encoder3d = new display::FrameEncoder(display::FrameEncoder::MjpegAvi, strOpts[sDataPath] + "/rendered-3D.avi", fps);
+	}
+	
+
+	switch (intOpts[iVerbose])
+	{
+		case 0: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Off); break;
+		case 1: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Trace); break;
+		case 2: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Warning); break;
+		case 3: debug::DebugStream::setLevel("rtslam", debug::DebugStream::Debug); break;
+		case 4: debug::DebugStream::setLevel("rtslam", debug::DebugStream::VerboseDebug); break;
+		default: debug::DebugStream::setLevel("rtslam", debug::DebugStream::VeryVerboseDebug); break;
+	}
+
+	
+	// pin-hole parameters in BOOST format
+	boost::shared_ptr<ObservationFactory> obsFact(new ObservationFactory());
+#if SEGMENT_BASED
+	if (intOpts[iSimu] != 0)
+	{
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhplSimuObservationMaker(
+			configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5, configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+	} else
+	{
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhplObservationMaker(
+			configEstimation.REPARAM_TH, configEstimation.KILL_SEARCH_SIZE, 30, 0.5, 0.5, configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+	}
+#endif
+#if SEGMENT_BASED != 1
+	if (intOpts[iSimu] != 0)
+	{
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpSimuObservationMaker(
+		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhpSimuObservationMaker(
+		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+	} else
+	{
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpObservationMaker(
+		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhpObservationMaker(
+		  configEstimation.D_MIN, configEstimation.PATCH_SIZE)));
+	}
+#endif
+
+
+	// ---------------------------------------------------------------------------
+	// --- INIT ------------------------------------------------------------------
+	// ---------------------------------------------------------------------------
+	// one map per robot, each one processed in its own thread
+	if (intOpts[iRobots] < 1) intOpts[iRobots] = 1;
+	for(int i = 0; i < intOpts[iRobots]; ++i)
+	{
+		slam_robot_ptr_t slam(new SlamRobot(i));
+		demo_slam_init_robot(*slam, obsFact);
+		slamRobots.push_back(slam);
+	}
 	
 	//--- force a first display with empty slam to ensure that all windows are loaded
 // std::cout << "SLAM: forcing first initialization display" << std::endl;
@@ -1161,7 +1361,6 @@ void demo_slam_init()
 	if (intOpts[iDispQt])
 	{
 		viewerQt = PTR_CAST<display::ViewerQt*> (worldPtr->getDisplayViewer(display::ViewerQt::id()));
-		viewerQt->bufferize(worldPtr);
 		
 		// initializing stuff for controlling run/pause from viewer
 		boost::unique_lock<boost::mutex> runStatus_lock(viewerQt->runStatus.mutex);
@@ -1174,9 +1373,13 @@ void demo_slam_init()
 	if (intOpts[iDispGdhe])
 	{
 		viewerGdhe = PTR_CAST<display::ViewerGdhe*> (worldPtr->getDisplayViewer(display::ViewerGdhe::id()));
-		viewerGdhe->bufferize(worldPtr);
 	}
 	#endif
+	if (displaySnapshots)
+	{
+		worldPtr->display_rendered = false;
+		displaySnapshots->publish(worldPtr, -1);
+	}
 
 // std::cout << "SLAM: starting slam" << std::endl;
 
@@ -1185,88 +1388,23 @@ void demo_slam_init()
 
 	//worldPtr->display_mutex.unlock();
 
-	switch (intOpts[iExport])
-	{
-		case 1: exporter.reset(new ExporterSocket(robPtr1, 30000)); break;
-		case 2: exporter.reset(new ExporterPoster(robPtr1)); break;
-	}
-
 } catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // demo_slam_init
 
 
 
 
-void demo_slam_main(world_ptr_t *world)
+/**
+ * Temporal loop of one map and its robot, in its own thread.
+ */
+void demo_slam_robot(world_ptr_t *world, SlamRobot *slam)
 { try {
 
-	robot_ptr_t robotPtr;
-		
-	// wait for display to be ready if enabled
-	if (intOpts[iDispQt] || intOpts[iDispGdhe])
-	{
-		boost::unique_lock<boost::mutex> display_lock(worldPtr->display_mutex);
-		worldPtr->display_rendered = false;
-		display_lock.unlock();
-		worldPtr->display_condition.notify_all();
-// std::cout << "SLAM: now waiting for this display to finish" << std::endl;
-		display_lock.lock();
-		while(!worldPtr->display_rendered) worldPtr->display_condition.wait(display_lock);
-		display_lock.unlock();
-	}
-
-	// start hardware sensors that need long init
-	map_ptr_t mapPtr = (*world)->mapList().front();
-	for (MapAbstract::RobotList::iterator robIter = mapPtr->robotList().begin();
-		robIter != mapPtr->robotList().end(); ++robIter)
-	{
-		if ((*robIter)->hardwareEstimatorPtr) (*robIter)->hardwareEstimatorPtr->start();
-		for (RobotAbstract::SensorList::iterator senIter = (*robIter)->sensorList().begin();
-			senIter != (*robIter)->sensorList().end(); ++senIter)
-		{
-			if ((*senIter)->getNeedInit())
-				(*senIter)->start();
-		}
-		robotPtr = *robIter;
-	}
+	// the random state is per thread, and this one may not be the thread of the init (Qt)
+	rtslam::srand(rseed + slam->index);
+	std::ostringstream thread_name; thread_name << "slam robot " << slam->index;
+	RTSLAM_TRACE_THREAD(thread_name.str());
 
-	// wait for their init
-	std::cout << "Sensors are calibrating..." << std::flush;
-	if ((intOpts[iRobot] == 1 || intOpts[iGps] == 1 || intOpts[iGps] == 2) && !(intOpts[iReplay] & 1)) sleep(2);
-	std::cout << " done." << std::endl;
-					
-	// set the start date
-	double start_date = kernel::Clock::getTime();
-	if (intOpts[iSimu]) start_date = 0.0;
-	if (!(intOpts[iReplay] & 1) && intOpts[iDump]) {
-		std::fstream f((strOpts[sDataPath] + std::string("/sdate.log")).c_str(), std::ios_base::out);
-		f << std::setprecision(19) << start_date << std::endl;
-		f.close();
-	}
-	else if (intOpts[iReplay] & 1) {
-		std::fstream f((strOpts[sDataPath] + std::string("/sdate.log")).c_str(), std::ios_base::in);
-		if (!f.is_open()) { std::cout << "Missing sdate.log file. Please copy the .time file of the first image to sdate.log" << std::endl; return; }
-		f >> start_date;
-		f.close();
-	}
-	std::cout << "slam start date: " << std::setprecision(16) << start_date << std::endl;
-	sensorManager->setStartDate(start_date);
-	
-	// start other hardware sensors
-	for (MapAbstract::RobotList::iterator robIter = mapPtr->robotList().begin();
-		robIter != mapPtr->robotList().end(); ++robIter)
-	{
-		for (RobotAbstract::SensorList::iterator senIter = (*robIter)->sensorList().begin();
-			senIter != (*robIter)->sensorList().end(); ++senIter)
-		{
-			if (!(*senIter)->getNeedInit())
-				(*senIter)->start();
-		}
-	}
-		
-		
 jblas::vec robot_prediction;
-double average_robot_innovation = 0.;
-int n_innovation = 0;
 	
 	// ---------------------------------------------------------------------------
 	// --- LOOP ------------------------------------------------------------------
@@ -1279,14 +1417,15 @@ int n_innovation = 0;
 	//if (dataLogger) dataLogger->log();
 	kernel::Chrono chrono;
 
-	for (; (*world)->t <= N_FRAMES;)
+	for (; slam->nframes <= N_FRAMES;)
 	{
 		if ((*world)->exit()) break;
 		
 		bool had_data = false;
 		chrono.reset();
 
-		SensorManagerAbstract::ProcessInfo pinfo = sensorManager->getNextDataToUse();
+		SensorManagerAbstract::ProcessInfo pinfo;
+		{ RTSLAM_TRACE_SCOPE("wait data"); pinfo = slam->sensorManager->getNextDataToUse(); }
 		bool no_more_data = pinfo.no_more_data;
 		
 		if (pinfo.sen)
@@ -1296,27 +1435,44 @@ int n_innovation = 0;
 				pinfo.sen->process_fake(pinfo.id); // just to release data
 			else
 			{
+				RTSLAM_TRACE_SCOPE("frame");
+				// the display must not read the map while it is modified
+				boost::unique_lock<boost::mutex> process_lock(slam->mapPtr->mutex_process);
 				double newt = pinfo.sen->getRawTimestamp(pinfo.id);
 				
-				JFR_DEBUG("************** FRAME : " << (*world)->t << " (" << std::setprecision(16) << newt << std::setprecision(6) << ") sensor " << pinfo.sen->id());
+				JFR_DEBUG("************** FRAME : " << slam->nframes << " (" << std::setprecision(16) << newt << std::setprecision(6) << ") sensor " << pinfo.sen->id());
 				
 				robot_ptr_t robPtr = pinfo.sen->robotPtr();
-//std::cout << "Frame " << (*world)->t << " using sen " << pinfo.sen->id() << " at time " << std::setprecision(16) << newt << std::endl;
-				robPtr->move(newt);
+//std::cout << "Frame " << slam->nframes << " using sen " << pinfo.sen->id() << " at time " << std::setprecision(16) << newt << std::endl;
+				{ RTSLAM_TRACE_SCOPE("robot move"); robPtr->move(newt); }
 				
 				JFR_DEBUG("Robot " << robPtr->id() << " state after move " << robPtr->state.x() << " ; euler " << quaternion::q2e(ublas::subrange(robPtr->state.x(), 3, 7)));
 				JFR_DEBUG("Robot state stdev after move " << stdevFromCov(robPtr->state.P()));
 				robot_prediction = robPtr->state.x();
 				
-				pinfo.sen->process(pinfo.id);
+				if (floatOpts[fGroup] > 0.)
+				{
+					std::vector<sensor_ptr_t> groupSensors; std::vector<unsigned> groupIds;
+					slam->sensorManager->getGroupedData(pinfo, floatOpts[fGroup], groupSensors, groupIds);
+					if (groupSensors.size() > 1)
+						SensorExteroAbstract::processGroup(groupSensors, groupIds);
+					else
+						pinfo.sen->process(pinfo.id);
+				} else
+					pinfo.sen->process(pinfo.id);
 				
 				JFR_DEBUG("Robot state after corrections of sensor " << pinfo.sen->id() << " : " << robPtr->state.x() << " ; euler " << quaternion::q2e(ublas::subrange(robPtr->state.x(), 3, 7)));
 				JFR_DEBUG("Robot state stdev after corrections " << stdevFromCov(robPtr->state.P()));
-				average_robot_innovation += ublas::norm_2(robPtr->state.x() - robot_prediction);
-				n_innovation++;
+				slam->average_robot_innovation += ublas::norm_2(robPtr->state.x() - robot_prediction);
+				slam->n_innovation++;
 				
-				if (exporter) exporter->exportCurrentState();
+				{
+					RTSLAM_TRACE_SCOPE("export");
+					if (slam->exporter) slam->exporter->exportCurrentState();
+					if (slam->posePropagator) slam->posePropagator->anchor();
+				}
 #ifdef GENOM // export genom
+				robot_ptr_t robotPtr = slam->robPtr;
 				jblas::vec euler_x(3);
 				jblas::sym_mat euler_P(3,3);
 				quaternion::q2e(ublas::subrange(robotPtr->state.x(), 3, 7), ublas::subrange(robotPtr->state.P(), 3,7, 3,7), euler_x, euler_P);
@@ -1326,15 +1482,16 @@ int n_innovation = 0;
 				jblas::vec stateP(6);
 				for(int i = 0; i < 3; ++i) stateP(i) = robotPtr->state.P(i,i);
 				for(int i = 0; i < 3; ++i) stateP(3+i) = euler_P(i,i);
-				updatePoster(newt, (*world)->t, stateX, stateP);
+				updatePoster(newt, slam->nframes, stateX, stateP);
 #endif
 			}
 		}
 		
 
-		// wait that display has finished if render all
-		if (had_data)
+		// publish the world for the display, that renders it in its own thread
+		if (displaySnapshots)
 		{
+			RTSLAM_TRACE_SCOPE("display sync");
 			// get render all status
 			bool renderAll;
 			#ifdef HAVE_MODULE_QDISPLAY
@@ -1347,48 +1504,30 @@ int n_innovation = 0;
 			#endif
 			renderAll = (intOpts[iRenderAll] != 0);
 
-			// if render all, wait display has finished
-			if ((intOpts[iDispQt] || intOpts[iDispGdhe]) && renderAll)
-			{
-				boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
-				while(!(*world)->display_rendered && !(*world)->exit()) (*world)->display_condition.wait(display_lock);
-				display_lock.unlock();
-			}
-		}
+			// if render all, wait that the display took the previous snapshot, but not that it rendered it
+			if (had_data && renderAll)
+				while(!displaySnapshots->waitAcquired(0.1) && !(*world)->exit());
 
-		
-		// asking for display if display has finished
-		unsigned processed_t = (had_data ? (*world)->t : (*world)->t-1);
-		if ((*world)->display_t+1 < processed_t+1)
-		{
-			boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
-			if ((*world)->display_rendered)
-			{
-				#ifdef HAVE_MODULE_QDISPLAY
-				display::ViewerQt *viewerQt = NULL;
-				if (intOpts[iDispQt]) viewerQt = PTR_CAST<display::ViewerQt*> ((*world)->getDisplayViewer(display::ViewerQt::id()));
-				if (intOpts[iDispQt]) viewerQt->bufferize(*world);
-				#endif
-				#ifdef HAVE_MODULE_GDHE
-				display::ViewerGdhe *viewerGdhe = NULL;
-				if (intOpts[iDispGdhe]) viewerGdhe = PTR_CAST<display::ViewerGdhe*> ((*world)->getDisplayViewer(display::ViewerGdhe::id()));
-				if (intOpts[iDispGdhe]) viewerGdhe->bufferize(*world);
-				#endif
-				
-				(*world)->display_t = (*world)->t;
-				(*world)->display_rendered = false;
-				display_lock.unlock();
-				(*world)->display_condition.notify_all();
-			} else
-			display_lock.unlock();
+			// otherwise only if the display already took the previous one, without waiting for the other robots
+			unsigned processed_t = (had_data ? (*world)->t : (*world)->t-1);
+			if (displaySnapshots->lastT()+1 < processed_t+1 && displaySnapshots->isAcquired())
+				displaySnapshots->publish(*world, processed_t, false);
 		}
 		
 		if (no_more_data) break;
 
 		if (!had_data)
 		{
-			rawdata_condition.wait(boost::lambda::_1 != 0);
-			rawdata_condition.set(0);
+			RTSLAM_TRACE_SCOPE("wait data");
+			// until new data arrive, or until the scheduler gives up a late sensor
+			double wake_date = slam->sensorManager->getWakeDate();
+			if (wake_date < std::numeric_limits<double>::infinity())
+			{
+				double timeout = std::max(0., wake_date - kernel::Clock::getTime());
+				slam->rawdata_condition.timed_wait(boost::lambda::_1 != 0, boost::posix_time::microseconds((long)(timeout*1e6)+1));
+			} else
+				slam->rawdata_condition.wait(boost::lambda::_1 != 0);
+			slam->rawdata_condition.set(0);
 		}
 		
 		bool doPause;
@@ -1421,16 +1560,118 @@ int n_innovation = 0;
 
 		if (had_data)
 		{
+			slam->nframes++;
+			boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
 			(*world)->t++;
-			if (dataLogger) dataLogger->log();
+			display_lock.unlock();
+			RTSLAM_TRACE_SCOPE("log");
+			if (slam->dataLogger) slam->dataLogger->log();
+			if (slam->binaryLogger) slam->binaryLogger->log();
 		}
 	} // temporal loop
 
+} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // demo_slam_robot
+
 
-	average_robot_innovation /= n_innovation;
-	std::cout << "average_robot_innovation " << average_robot_innovation << std::endl;
+void demo_slam_main(world_ptr_t *world)
+{ try {
 
-	if (exporter) exporter->stop();
+	// wait for display to be ready if enabled (it has rendered the snapshot published by the init)
+	if (intOpts[iDispQt] || intOpts[iDispGdhe])
+	{
+		boost::unique_lock<boost::mutex> display_lock(worldPtr->display_mutex);
+// std::cout << "SLAM: now waiting for this display to finish" << std::endl;
+		while(!worldPtr->display_rendered) worldPtr->display_condition.wait(display_lock);
+		display_lock.unlock();
+	}
+
+	// start hardware sensors that need long init
+	hardware::StartupCoordinator startup;
+	for (WorldAbstract::MapList::iterator mapIter = (*world)->mapList().begin();
+		mapIter != (*world)->mapList().end(); ++mapIter)
+	for (MapAbstract::RobotList::iterator robIter = (*mapIter)->robotList().begin();
+		robIter != (*mapIter)->robotList().end(); ++robIter)
+	{
+		if ((*robIter)->hardwareEstimatorPtr)
+		{
+			(*robIter)->hardwareEstimatorPtr->start();
+			std::ostringstream oss; oss << "estimator of robot " << (*robIter)->id();
+			startup.add(oss.str(), boost::bind(&hardware::HardwareEstimatorAbstract::waitReady, (*robIter)->hardwareEstimatorPtr, _1), startup_timeout);
+		}
+		for (RobotAbstract::SensorList::iterator senIter = (*robIter)->sensorList().begin();
+			senIter != (*robIter)->sensorList().end(); ++senIter)
+		{
+			if ((*senIter)->getNeedInit())
+			{
+				(*senIter)->start();
+				std::ostringstream oss; oss << "sensor " << (*senIter)->id() << " (" << (*senIter)->typeName() << ")";
+				startup.add(oss.str(), boost::bind(&SensorAbstract::waitReady, *senIter, _1), startup_timeout);
+			}
+		}
+	}
+
+	// wait for their init, until their data are ready (IMU biases, gps fix, first image...)
+	std::cout << "Sensors are calibrating..." << std::flush;
+	if (startup.wait())
+		std::cout << " done." << std::endl;
+	else
+	{
+		std::cout << " timeout, starting anyway:" << std::endl;
+		startup.printReport(std::cout);
+	}
+					
+	// set the start date
+	double start_date = kernel::Clock::getTime();
+	if (intOpts[iSimu]) start_date = 0.0;
+	if (!(intOpts[iReplay] & 1) && intOpts[iDump]) {
+		std::fstream f((strOpts[sDataPath] + std::string("/sdate.log")).c_str(), std::ios_base::out);
+		f << std::setprecision(19) << start_date << std::endl;
+		f.close();
+	}
+	else if (intOpts[iReplay] & 1) {
+		std::fstream f((strOpts[sDataPath] + std::string("/sdate.log")).c_str(), std::ios_base::in);
+		if (!f.is_open()) { std::cout << "Missing sdate.log file. Please copy the .time file of the first image to sdate.log" << std::endl; return; }
+		f >> start_date;
+		f.close();
+	}
+	std::cout << "slam start date: " << std::setprecision(16) << start_date << std::endl;
+	for(size_t i = 0; i < slamRobots.size(); ++i)
+		slamRobots[i]->sensorManager->setStartDate(start_date);
+	
+	// start other hardware sensors
+	for (WorldAbstract::MapList::iterator mapIter = (*world)->mapList().begin();
+		mapIter != (*world)->mapList().end(); ++mapIter)
+	for (MapAbstract::RobotList::iterator robIter = (*mapIter)->robotList().begin();
+		robIter != (*mapIter)->robotList().end(); ++robIter)
+	{
+		for (RobotAbstract::SensorList::iterator senIter = (*robIter)->sensorList().begin();
+			senIter != (*robIter)->sensorList().end(); ++senIter)
+		{
+			if (!(*senIter)->getNeedInit())
+				(*senIter)->start();
+		}
+	}
+	
+	if (!strOpts[sTrace].empty()) rtslam::trace::start();
+
+	// the first robot is processed in this thread, the others in their own threads with the same priority
+	boost::thread_group robotThreads;
+	for(size_t i = 1; i < slamRobots.size(); ++i)
+		robotThreads.create_thread(boost::bind(demo_slam_robot, world, slamRobots[i].get()));
+	demo_slam_robot(world, slamRobots[0].get());
+	robotThreads.join_all();
+
+	for(size_t i = 0; i < slamRobots.size(); ++i)
+	{
+		SlamRobot &slam = *slamRobots[i];
+		if (slamRobots.size() > 1)
+			std::cout << "---------- robot " << slam.index << " (" << slam.robPtr->typeName() << "), " << slam.nframes << " frames" << std::endl;
+		std::cout << "average_robot_innovation " << slam.average_robot_innovation / slam.n_innovation << std::endl;
+		slam.sensorManager->printStatistics(std::cout);
+		if (slam.posePropagator) { slam.posePropagator->stop(); slam.posePropagator->printStatistics(std::cout); }
+		if (slam.exporter) slam.exporter->stop();
+	}
+	hardware::DatasetWriter::closeAll(); // the datasets and binary logs written by the acquisition threads
 	(*world)->slam_blocked(true);
 //	std::cout << "\nFINISHED ! Press a key to terminate." << std::endl;
 //	getchar();
@@ -1445,116 +1686,91 @@ int n_innovation = 0;
 
 void demo_slam_display(world_ptr_t *world)
 { try {
-//	static unsigned prev_t = 0;
+	RTSLAM_TRACE_THREAD("display");
 	kernel::Timer timer(display_period*1000);
 	while(true)
 	{
-		/*
-		if (intOpts[iDispQt])
-		{
-			#ifdef HAVE_MODULE_QDISPLAY
-			qdisplay::qtMutexLock<kernel::FifoMutex>((*world)->display_mutex);
-			#endif
-		}
-		else
-		{
-			(*world)->display_mutex.lock();
-		}
-		*/
 		// just to display the last frame if slam is blocked or has finished
 		boost::unique_lock<kernel::VariableMutex<bool> > blocked_lock((*world)->slam_blocked);
 		if ((*world)->slam_blocked.var)
 		{
-			if ((*world)->display_t+1 < (*world)->t+1 && (*world)->display_rendered)
-			{
-				#ifdef HAVE_MODULE_QDISPLAY
-				display::ViewerQt *viewerQt = NULL;
-				if (intOpts[iDispQt]) viewerQt = PTR_CAST<display::ViewerQt*> ((*world)->getDisplayViewer(display::ViewerQt::id()));
-				if (intOpts[iDispQt]) viewerQt->bufferize(*world);
-				#endif
-				#ifdef HAVE_MODULE_GDHE
-				display::ViewerGdhe *viewerGdhe = NULL;
-				if (intOpts[iDispGdhe]) viewerGdhe = PTR_CAST<display::ViewerGdhe*> ((*world)->getDisplayViewer(display::ViewerGdhe::id()));
-				if (intOpts[iDispGdhe]) viewerGdhe->bufferize(*world);
-				#endif
-				
-				(*world)->display_t = (*world)->t;
-				(*world)->display_rendered = false;
-			}
+			// the other robots may still be running
+			unsigned t = (*world)->t;
+			if (displaySnapshots->lastT()+1 < t+1)
+				displaySnapshots->publish(*world, t);
 		}
 		blocked_lock.unlock();
 		
-		// waiting that display is ready
-// std::cout << "DISPLAY: waiting for data" << std::endl;
-		boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
+		// waiting for a new snapshot, slam never waits for the display
+		display::world_snapshot_cptr_t snapshot;
 		if (intOpts[iDispQt] == 0)
 		{
-			while((*world)->display_rendered)
-				(*world)->display_condition.wait(display_lock);
+			RTSLAM_TRACE_SCOPE("wait snapshot");
+			while(!(snapshot = displaySnapshots->acquire(display_seq, 0.1)))
+				if ((*world)->exit()) return;
 		} else
 		{
 			#ifdef HAVE_MODULE_QDISPLAY
 			int nwait = std::max(1,display_period/10-1);
-			for(int i = 0; (*world)->display_rendered && i < nwait; ++i)
+			for(int i = 0; !snapshot && i < nwait; ++i)
 			{
-				(*world)->display_condition.timed_wait(display_lock, boost::posix_time::milliseconds(10));
-				display_lock.unlock();
-				QApplication::instance()->processEvents();
-				display_lock.lock();
+				snapshot = displaySnapshots->acquire(display_seq, 0.01);
+				if (!snapshot) QApplication::instance()->processEvents();
 			}
-			if ((*world)->display_rendered) break;
+			if (!snapshot) break;
 			#endif
 		}
-		display_lock.unlock();
-// std::cout << "DISPLAY: ok data here, let's start!" << std::endl;
-
-//		if ((*world)->t != prev_t)
-//		{
-//			prev_t = (*world)->t;
-//			(*world)->display_rendered = (*world)->t;
-			
-//		!bufferize!
-
-//			if (!intOpts[iRenderAll]) // strange: if we always unlock here, qt.dump takes much more time...
-//				(*world)->display_mutex.unlock();
-				
+		display_seq = snapshot->seq;
+		
+		// each view is rendered at its own rate, except if all the frames must be rendered
+		bool dumping = (((intOpts[iReplay] & 1) || intOpts[iSimu]) && intOpts[iDump] && snapshot->t+1 != 0);
+		bool renderAll;
+		#ifdef HAVE_MODULE_QDISPLAY
+		if (intOpts[iDispQt])
+		{
+			boost::unique_lock<boost::mutex> runStatus_lock(display::ViewerQt::runStatus.mutex);
+			renderAll = display::ViewerQt::runStatus.render_all;
+		} else
+		#endif
+		renderAll = (intOpts[iRenderAll] != 0);
+		
+		// the snapshot is not modified while we hold it
+		#ifdef HAVE_MODULE_QDISPLAY
+		display::ViewerQt *viewerQt = NULL;
+		if (intOpts[iDispQt]) viewerQt = PTR_CAST<display::ViewerQt*> ((*world)->getDisplayViewer(display::ViewerQt::id()));
+		if (intOpts[iDispQt]) { RTSLAM_TRACE_SCOPE("render 2d"); viewerQt->bufferize(*snapshot); viewerQt->render(renderAll || dumping); }
+		#endif
+		#ifdef HAVE_MODULE_GDHE
+		display::ViewerGdhe *viewerGdhe = NULL;
+		if (intOpts[iDispGdhe]) viewerGdhe = PTR_CAST<display::ViewerGdhe*> ((*world)->getDisplayViewer(display::ViewerGdhe::id()));
+		if (intOpts[iDispGdhe]) { RTSLAM_TRACE_SCOPE("render 3d"); viewerGdhe->bufferize(*snapshot); viewerGdhe->render(renderAll || dumping); }
+		#endif
+		
+		if (dumping)
+		{
+			RTSLAM_TRACE_SCOPE("dump");
 			#ifdef HAVE_MODULE_QDISPLAY
-			display::ViewerQt *viewerQt = NULL;
-			if (intOpts[iDispQt]) viewerQt = PTR_CAST<display::ViewerQt*> ((*world)->getDisplayViewer(display::ViewerQt::id()));
-			if (intOpts[iDispQt]) viewerQt->render();
+			if (intOpts[iDispQt])
+				viewerQt->record(*encoder2d, snapshot->t);
 			#endif
 			#ifdef HAVE_MODULE_GDHE
-			display::ViewerGdhe *viewerGdhe = NULL;
-			if (intOpts[iDispGdhe]) viewerGdhe = PTR_CAST<display::ViewerGdhe*> ((*world)->getDisplayViewer(display::ViewerGdhe::id()));
-			if (intOpts[iDispGdhe]) viewerGdhe->render();
-			#endif
-			
-			if (((intOpts[iReplay] & 1) || intOpts[iSimu]) && intOpts[iDump] && (*world)->display_t+1 != 0)
+			if (intOpts[iDispGdhe])
 			{
-				#ifdef HAVE_MODULE_QDISPLAY
-				if (intOpts[iDispQt])
-				{
-					std::ostringstream oss; oss << strOpts[sDataPath] << "/rendered-2D_%d-" << std::setw(6) << std::setfill('0') << (*world)->display_t << ".png";
-					viewerQt->dump(oss.str());
-				}
-				#endif
-				#ifdef HAVE_MODULE_GDHE
-				if (intOpts[iDispGdhe])
-				{
-					std::ostringstream oss; oss << strOpts[sDataPath] << "/rendered-3D_" << std::setw(6) << std::setfill('0') << (*world)->display_t << ".png";
-					viewerGdhe->dump(oss.str());
-				}
-				#endif
-//				if (intOpts[iRenderAll])
-//					(*world)->display_mutex.unlock();
+				std::ostringstream oss; oss << strOpts[sDataPath] << "/rendered-3D_";
+				if (encoder3d) oss << "tmp-";
+				oss << std::setw(6) << std::setfill('0') << snapshot->t << ".png";
+				// gdhe can only write its view in a file, it is read back and removed by the thread of the encoder
+				viewerGdhe->dump(oss.str());
+				if (encoder3d) encoder3d->pushFile(0, snapshot->t, oss.str());
 			}
-//		} else
-//		{
-//			(*world)->display_mutex.unlock();
-//			boost::this_thread::yield();
-//		}
+			#endif
+		}
+		unsigned rendered_t = snapshot->t;
+		snapshot.reset();
+		
 // std::cout << "DISPLAY: finished display, marking rendered" << std::endl;
-		display_lock.lock();
+		boost::unique_lock<boost::mutex> display_lock((*world)->display_mutex);
+		(*world)->display_t = rendered_t;
 		(*world)->display_rendered = true;
 		display_lock.unlock();
 		(*world)->display_condition.notify_all();
@@ -1612,6 +1828,30 @@ void demo_slam_run() {
 		demo_slam_main(&worldPtr);
 	}
 
+	// write the frames still waiting and close the videos (the gdhe display thread may still
+	// push some frames, that are then ignored)
+	if (encoder2d) encoder2d->stop();
+	if (encoder3d) encoder3d->stop();
+
+	if (!strOpts[sTrace].empty())
+	{
+		rtslam::trace::stop();
+		std::string filename = strOpts[sDataPath] + "/" + strOpts[sTrace];
+		size_t nevents = rtslam::trace::writeChromeTrace(filename);
+		std::cout << "trace: " << nevents << " events written to " << filename;
+		if (rtslam::trace::nDropped()) std::cout << ", " << rtslam::trace::nDropped() << " dropped because a thread had more than its capacity";
+		std::cout << std::endl;
+	}
+
+	#ifdef HAVE_MODULE_GDHE
+	if (viewerGdhe)
+	{
+		display::ViewRefresh const &refresh = viewerGdhe->view_refresh;
+		std::cout << "3d display: " << refresh.nrendered << " renders (" << refresh.nskipped << " skipped), mean "
+		          << refresh.mean_duration*1000 << " ms, max " << refresh.max_duration*1000 << " ms" << std::endl;
+	}
+	#endif
+
 	JFR_DEBUG("Terminated");
 }
 
@@ -1630,11 +1870,12 @@ void demo_slam_run() {
 	* --disp-3d=0/1
 	* --render-all=0/1 (needs --replay 1)
 	* --replay=0/1/2/3 (off/on/off no slam/on true time) (needs --data-path)
-	* --dump=0/1  (needs --data-path)
+	* --dump=0/1/2  (needs --data-path) -> in replay or simulation, write the rendered views as images (1) or as mjpeg avi videos (2), in background threads
 	* --rand-seed=0/1/n, 0=generate new one, 1=in replay use the saved one, n=use seed n
 	* --pause=0/n 0=don't, n=pause for frames>n (needs --replay 1)
-	* --log=0/1/filename -> log result in text file
-	* --export=0/1/2 -> Off/socket/poster
+	* --log=0/1/2/filename -> log result in text file (1 or filename), or in typed binary tables written in a background thread (2 or filename.rtlog, see demo_log_reader)
+	* --export=0/1/2/3/4 -> Off/socket/poster/socket with the map (see exportProtocol.hpp, demo_export_client)/shared memory /rtslam_pose<robot> (see shmPose.hpp, demo_shm_pose_reader)
+	* --propagate=0/1 -> also export the pose propagated at each IMU/odometry reading between two filter updates (needs --export)
 	* --verbose=0/1/2/3/4/5 -> Off/Trace/Warning/Debug/VerboseDebug/VeryVerboseDebug
 	* --data-path=/mnt/ram/rtslam
 	* --config-setup=data/setup.cfg
@@ -1649,6 +1890,17 @@ void demo_slam_run() {
 	* --freq camera frequency in double Hz (with trigger==0/1)
 	* --shutter shutter time in double seconds (0=auto); for trigger modes 0,2,3 the value is relative between 0 and 1
 	* --gps=0/1/2/3 -> Off / Pos / Pos+Vel / Pos+Ori(mocap)
+	* --dataset=<file.rtds> single file dataset to record/replay images instead of data-path; with several robots, robot i>0 uses <file>.robot<i>.rtds
+	* --trace=0/1/filename -> record the duration of the main phases of each thread (data wait, robot move, projection, ransac, matching, updates, detection, map management, export, display), written at the end in <data-path>/rtslam_trace.json or filename, to open with chrome://tracing or ui.perfetto.dev; compiled out with -DRTSLAM_TRACE=0
+	* --replay-start=<s> seconds skipped at the beginning of the replayed images
+	* --prefetch=0/n number of threads loading images in advance in replay
+	* --pipeline=0/1 -> prepare the next image (Harris derivatives) in another thread while the current one is processed
+	* --realtime=0/rate -> process everything / emulate real-time in replay, rate being the speed relative to recording (1=real-time, 0.5=twice slower)
+	* --oosm-window=0/s -> apply gps readings that arrive late at their date, with a robot history of s seconds
+	* --group=0/s -> process the images of the different cameras whose timestamps differ by less than s seconds in a single filter step, matching them in parallel
+	* --disp-rate=0/r -> render each camera view at most r times per second (default 10), intermediate snapshots are skipped; 0 to render each one
+	* --disp-3d-rate=0/r -> same for the 3d view; with --render-all or --dump all the frames are rendered anyway
+	* --robots=n -> n robots with their own map, each one processed in its own thread; robot i>0 uses <data-path>/robot<i>, and its setup.cfg there if any
 	*
 	* You can use the following examples and only change values:
 	* online test (old mode=0):
@@ -1669,6 +1921,8 @@ int main(int argc, char* const* argv)
 	intOpts[iMap] = 1;
 	intOpts[iCamera] = 1;
 	floatOpts[fFreq] = 60.0;
+	floatOpts[fDispRate] = 10.0;
+	floatOpts[fDisp3dRate] = 10.0;
 	floatOpts[fShutter] = 0.0;
 	strOpts[sDataPath] = ".";
 	strOpts[sConfigSetup] = "#!@";
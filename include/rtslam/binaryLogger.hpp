@@ -0,0 +1,195 @@
+/**
+ * \file binaryLogger.hpp
+ *
+ * Header file for the logger that writes typed binary tables from a
+ * background thread, and for its reader.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef BINARY_LOGGER_HPP_
+#define BINARY_LOGGER_HPP_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread.hpp>
+
+namespace jafar {
+namespace rtslam {
+
+	class BinaryLogger;
+
+	/**
+	Interface of the objects logged by a BinaryLogger, each one in its own table.
+	It has the same functions as kernel::DataLoggable, so that an object can be
+	logged by both with the same code.
+	*/
+	class BinaryLoggable
+	{
+		public:
+			virtual ~BinaryLoggable() {}
+			/**
+			Declares the columns of the table with BinaryLogger::writeLegend, the first
+			comment (BinaryLogger::writeComment) being the name of the table.
+			*/
+			virtual void writeLogHeader(BinaryLogger& log) const = 0;
+			/**
+			Writes the values with BinaryLogger::writeData in the order of the columns,
+			a new row starting after the last column, so that several rows can be written.
+			*/
+			virtual void writeLogData(BinaryLogger& log) const = 0;
+	};
+
+
+	/**
+	Logs typed values in one table per loggable, in a binary file written by
+	its own thread, so that the slam thread only copies the values in memory.
+	The blocks of rows go to the writer thread through a lock-free queue, and
+	come back through another one to be reused. log() only waits when the
+	queue is full, that is when the disk is behind by queue_size logs.
+	log() must always be called by the same thread.
+
+	The file starts with "RTSLOG01" and the uint32 0x01020304 to check the byte
+	order, followed by records made of a uint8 kind, a uint32 size and the payload,
+	where the strings are a uint32 length followed by the characters:
+	- recComment: the characters of the comment
+	- recSchema: uint32 table, string name, uint32 number of comments, the comments,
+	  uint32 number of columns, and for each one its uint8 type and string name
+	- recRows: uint32 table, uint32 log number, uint32 number of rows, and the
+	  values column after column
+	*/
+	class BinaryLogger
+	{
+		public:
+			enum Type { Float64 = 0, Float32, Int32, UInt32, UInt8, nTypes };
+			enum RecordKind { recComment = 1, recSchema, recRows };
+			static size_t typeSize(Type type);
+			/// the numpy name of the type, as "<f8"
+			static const char* typeName(Type type);
+
+		private:
+			typedef std::vector<char> Block;
+
+			/// single producer single consumer lock-free ring
+			class BlockRing
+			{
+					std::vector<Block*> slots;
+					volatile size_t head, tail; ///< written by the producer and by the consumer
+				public:
+					BlockRing(size_t size): slots(size+1), head(0), tail(0) {}
+					bool push(Block *block);
+					Block* pop();
+			};
+
+			struct Column { std::string name; Type type; Block data; };
+			struct Table
+			{
+				BinaryLoggable *loggable;
+				std::string name;
+				std::vector<std::string> comments;
+				std::vector<Column> columns;
+				unsigned nrows;
+				size_t col; ///< the next column written
+			};
+
+			std::vector<Table> tables;
+			int current; ///< the table being declared or written, -1 if none
+			unsigned nlogs;
+
+			std::ofstream f;
+			BlockRing filled, recycled;
+			volatile bool stopping;
+			boost::thread *thread;
+			boost::mutex mutex_writer; ///< protects the sleep of the writer thread, and stopping
+			boost::condition_variable cond_filled; ///< notified when a block is pushed or when stopping
+			unsigned nwaits;
+			uint64_t nbytes; ///< only used by the writer thread until it stops
+			uint64_t nlost; ///< bytes that could not be written, only used by the writer thread until it stops
+
+			Table& currentTable(const char *caller);
+			template<typename T> void writeValue(T value);
+			Block* newBlock();
+			void pushBlock(Block *block);
+			void writeBlock(Block *block);
+			void writerTask();
+
+		public:
+			/**
+			@param queue_size the number of logs that can wait to be written
+			*/
+			BinaryLogger(std::string const &filename, size_t queue_size = 256);
+			~BinaryLogger();
+
+			/// comment of the table in writeLogHeader, of the file otherwise
+			void writeComment(std::string const &comment);
+			void writeCurrentDate();
+			/// adds a column to the table, only in writeLogHeader
+			void writeLegend(std::string const &name, Type type = Float64);
+			/// adds a column for each word of names, only in writeLogHeader
+			void writeLegendTokens(std::string const &names, Type type = Float64);
+			/// the value of the next column, converted to its type, only in writeLogData
+			void writeData(double value);
+			void writeData(float value);
+			void writeData(int value);
+			void writeData(unsigned value);
+
+			/// adds a table and writes its schema
+			void addLoggable(BinaryLoggable &loggable);
+			/// logs the rows of all the tables
+			void log();
+			/// writes what is still in the queue and closes the file
+			void stop();
+
+			unsigned nLogs() const { return nlogs; }
+			/// the number of times log() waited for the writer thread
+			unsigned nWaits() const { return nwaits; }
+			/// the number of bytes that could not be written (disk full...), known after stop()
+			uint64_t nLostBytes() const { return nlost; }
+	};
+
+
+	/**
+	Reads a file written by BinaryLogger, the rows being given block by block.
+	*/
+	class BinaryLogReader
+	{
+		public:
+			struct Schema
+			{
+				std::string name;
+				std::vector<std::string> comments;
+				std::vector<std::string> columns;
+				std::vector<BinaryLogger::Type> types;
+			};
+			/// the rows of one table written by one log
+			struct Rows
+			{
+				unsigned table, log, nrows;
+				std::vector<const char*> columns; ///< the values of each column, valid until the next read
+				std::vector<BinaryLogger::Type> const *types;
+				double value(size_t col, size_t row) const;
+				const char* data(size_t col, size_t row) const
+					{ return columns[col] + row*BinaryLogger::typeSize((*types)[col]); }
+			};
+
+			std::vector<Schema> schemas; ///< of the tables met so far
+			std::vector<std::string> comments; ///< of the file met so far
+
+		private:
+			std::ifstream f;
+			std::vector<char> payload;
+		public:
+			BinaryLogReader(std::string const &filename);
+			/// reads the next rows, storing the schemas and the comments met before, false at the end of the file
+			bool next(Rows &rows);
+	};
+
+}}
+
+#endif
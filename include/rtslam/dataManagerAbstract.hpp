@@ -50,6 +50,22 @@ namespace jafar {
 
 			virtual void processKnown(raw_ptr_t data) = 0;
 			virtual void detectNew(raw_ptr_t data) = 0;
+
+			/**
+			 * processKnown split in three steps, to process several sensors with the same date
+			 * in a single filter step (see SensorExteroAbstract::processGroup):
+			 * - matchKnown projects and matches the known observations against the current state
+			 *   without modifying the filter, so that it can run in parallel for different sensors,
+			 * - stackKnown stacks the corrections of the inliers in the filter,
+			 *   that are then applied for all the sensors with one correctAllStacked,
+			 * - finishKnown updates the observations after this correction.
+			 * The data managers that don't support it return false to supportsGroupedUpdate.
+			 * \param seed the seed of the random draws of matchKnown, that must not use rtslam::rand()
+			 */
+			virtual bool supportsGroupedUpdate() { return false; }
+			virtual void matchKnown(raw_ptr_t data, unsigned seed) {}
+			virtual unsigned stackKnown() { return 0; } ///< \return the number of stacked corrections
+			virtual void finishKnown(bool updated) {} ///< \param updated the stacked corrections were applied
       //virtual void process( boost::shared_ptr<RawAbstract> data ) = 0;
 
     };
@@ -49,7 +49,7 @@ namespace jafar {
 
 			public: // public interface
 				DataManagerOnePointRansac(const boost::shared_ptr<DetectorSpec> & _detector, const boost::shared_ptr<MatcherSpec> & _matcher, const boost::shared_ptr<FeatureManagerSpec> _featMan, int n_updates_total, int n_updates_ransac, int n_tries, int n_init, int n_recomp_gains):
-					detector(_detector), matcher(_matcher), featMan(_featMan)
+					detector(_detector), matcher(_matcher), featMan(_featMan), grouped(false), group_rand_state(0)
 				{
 					algorithmParams.n_updates_total = n_updates_total;
 					algorithmParams.n_updates_ransac = n_updates_ransac;
@@ -61,6 +61,15 @@ namespace jafar {
 				}
 				void processKnown(raw_ptr_t data);
 				void detectNew(raw_ptr_t data);
+
+				bool supportsGroupedUpdate() { return true; }
+				/**
+				 * Same Ransac sets and active search as processKnown, but all the inliers are
+				 * matched against the current state, as the corrections are only applied afterwards.
+				 */
+				void matchKnown(raw_ptr_t data, unsigned seed);
+				unsigned stackKnown();
+				void finishKnown(bool updated);
 //				void process(boost::shared_ptr<RawAbstract> data);
 
 			protected: // main data members
@@ -76,6 +85,10 @@ namespace jafar {
 				ObsList obsBaseList;
 				ObsList obsFailedList;
 				RansacSetList ransacSetList;
+				// the inliers found by matchKnown, to be stacked
+				ObsList obsStackedList;
+				bool grouped; ///< between matchKnown and finishKnown
+				unsigned group_rand_state;
 
 			protected: // parameters
 				struct alg_params_t {
@@ -100,6 +113,10 @@ namespace jafar {
 
 			protected: // helper functions
 				void projectAndCollectVisibleObs();
+				void buildRansacSets(boost::shared_ptr<RawSpec> rawData);
+				ransac_set_ptr_t selectBestSet(); ///< \return the set with the most inliers, reduced to n_updates_ransac
+				void updateObsCounters();
+				int drawRand();
 				void updateVisibleObs();
 				void getOneMatchedBaseObs(observation_ptr_t & obsBasePtr, boost::shared_ptr<RawSpec> rawData);
 				observation_ptr_t selectOneRandomObs();
@@ -110,6 +127,8 @@ namespace jafar {
 // 				bool match(const boost::shared_ptr<RawImage> & rawPtr, const appearance_ptr_t & targetApp, image::ConvexRoi &roi, Measurement & measure, const appearance_ptr_t & app);
 				bool matchWithLowInnovation(const observation_ptr_t obsPtr, double lowInnTh);
 				bool matchWithExpectedInnovation(boost::shared_ptr<RawSpec> rawData,  observation_ptr_t obsPtr);
+				/// matchWithExpectedInnovation once the appearance is predicted
+				bool matchPredictedAppearance(boost::shared_ptr<RawSpec> rawData,  observation_ptr_t obsPtr);
 
 		};
 
@@ -18,6 +18,7 @@
 #include "rtslam/observationAbstract.hpp"
 
 #include "rtslam/imageTools.hpp"
+#include "rtslam/trace.hpp"
 
 /*
  * STATUS: working fine, use it
@@ -42,6 +43,7 @@ namespace jafar {
 		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
 		processKnown(raw_ptr_t data)
 		{
+			RTSLAM_TRACE_SCOPE("known landmarks");
 			boost::shared_ptr<RawSpec> rawData = SPTR_CAST<RawSpec>(data);
 			//###
 			//### Init, collect visible observations
@@ -51,109 +53,11 @@ namespace jafar {
 
 			projectAndCollectVisibleObs();
 
-			unsigned n_tries = algorithmParams.n_tries;
-			if (obsVisibleList.size() < n_tries) n_tries = obsVisibleList.size();
-
 			
 			//###
 			//### Create the different Ransac sets
 			//### 
-			unsigned current_try = 0;
-			if (n_tries >= 2)
-			while (current_try < n_tries)
-			{
-				// select random obs and match it
-				observation_ptr_t obsBasePtr;
-				getOneMatchedBaseObs(obsBasePtr, rawData);
-				if (!obsBasePtr) break; // no more available matched obs
-
-				// 1b. base obs is now matched
-				ransac_set_ptr_t ransacSetPtr(new RansacSet);
-				ransacSetList.push_back(ransacSetPtr);
-				ransacSetPtr->obsBasePtr = obsBasePtr;
-				ransacSetPtr->inlierObs.push_back(obsBasePtr);
-
-				current_try ++;
-				vec x_copy = updateMean(obsBasePtr);
-
-				// for each other obs
-				for(ObsList::iterator obsIter = obsVisibleList.begin(); obsIter != obsVisibleList.end(); obsIter++)
-				{
-					observation_ptr_t obsCurrentPtr = *obsIter;
-					if (obsCurrentPtr == obsBasePtr) continue; // ignore the tested observation
-
-					// get obs things
-					jblas::vec lmk = obsCurrentPtr->landmarkPtr()->state.x();
-					vec exp(obsCurrentPtr->expectation.size());
-					vec nobs(obsCurrentPtr->prior.size());
-
-					// project
-					projectFromMean(exp, obsCurrentPtr, x_copy);
-
-					bool inlier = obsCurrentPtr->events.matched && 
-					              isLowInnovationInlier(obsCurrentPtr, exp, matcher->params.lowInnov);
-					
-					if (!inlier)
-						if (obsCurrentPtr->predictAppearance())
-						{
-							// try to match with low innovation
-							jblas::sym_mat P = jblas::identity_mat(obsCurrentPtr->expectation.size())*jmath::sqr(matcher->params.lowInnov);
-                     RoiSpec roi;
-                     if(obsCurrentPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and (due to the size4 expectation) the following roi computation fails. - TODO clean up all this, is should not mess with One point ransac
-                     {
-                        roi = RoiSpec(exp, P, 1.0);
-                        obsCurrentPtr->searchSize = roi.count();
-                     }
-							else // Segment
-							{
-								// Rough approximation, this won't be used by Dseg Matcher, only by the simulator
-								vec2 p1, p2;
-								vec2 var1, var2;
-								p1[0] = obsCurrentPtr->expectation.x()[0]; p1[1] = obsCurrentPtr->expectation.x()[1];
-								p2[0] = obsCurrentPtr->expectation.x()[2]; p2[1] = obsCurrentPtr->expectation.x()[3];
-								var1[0] = (obsCurrentPtr->expectation.P()(0,0) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-								var1[1] = (obsCurrentPtr->expectation.P()(1,1) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-								var2[0] = (obsCurrentPtr->expectation.P()(2,2) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-								var2[1] = (obsCurrentPtr->expectation.P()(3,3) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-
-								int basex = min(p1[0]-var1[0],p2[0]-var2[0]);
-								int basey = min(p1[1]-var1[1],p2[1]-var2[1]);
-								cv::Rect rect(
-									basex, basey,
-									max(p1[0]+var1[0],p2[0]+var2[0]) - basex,
-									max(p1[1]+var1[1],p2[1]+var2[1]) - basey
-								);
-								roi = RoiSpec(rect);
-							}
-							obsCurrentPtr->events.measured = true;
-							
-							matcher->match(rawData, obsCurrentPtr->predictedAppearance, roi, obsCurrentPtr->measurement, obsCurrentPtr->observedAppearance);
-							if (obsCurrentPtr->getMatchScore() > matcher->params.threshold)
-							{
-								#if PROJECT_MEAN_VISIBILITY
-								obsCurrentPtr->project();
-								#endif
-								if (isExpectedInnovationInlier(obsCurrentPtr, matcher->params.mahalanobisTh))
-								{
-									obsCurrentPtr->events.matched = true;
-								}
-							}
-							
-							inlier = obsCurrentPtr->events.matched && 
-							         isLowInnovationInlier(obsCurrentPtr, exp, matcher->params.lowInnov);
-						}
-					
-					if (inlier)
-					{
-						// declare inlier
-						ransacSetPtr->inlierObs.push_back(obsCurrentPtr);
-					}
-					else{
-						// declare pending
-						ransacSetPtr->pendingObs.push_back(obsCurrentPtr);
-					}
-				} // for each other obs
-			} // for i = 0:n_tries
+			buildRansacSets(rawData);
 
 			// TODO we should also store the measurement when building the sets,
 			// and take the right one when using the best set
@@ -161,25 +65,13 @@ namespace jafar {
 			//###
 			//### Process the best Ransac set
 			//### 
-			ransac_set_ptr_t best_set;
+			ransac_set_ptr_t best_set = selectBestSet();
 			bool pending_buffered_update = false;
 			if (ransacSetList.size() != 0)
 			{
-				// 1. select ransacSet.inliers.size() max
-				for(RansacSetList::iterator rsIter = ransacSetList.begin(); rsIter != ransacSetList.end(); ++rsIter)
-					if (!best_set || (*rsIter)->size() > best_set->size()) best_set = *rsIter;
-
-				// if there are too many updates to do bufferized, randomly move out some of them
-				// to pending, they may be processed in active search if really necessary
-				while (best_set->size() > 1 && best_set->size() > algorithmParams.n_updates_ransac)
-				{
-					int n = (rtslam::rand() % (best_set->size() - 1)) + 1; // keep the first one which is the base obs
-					best_set->pendingObs.push_back(best_set->inlierObs[n]);
-					kernel::fastErase(best_set->inlierObs, n);
-				}
-
 				if (best_set->size() > 1)
 				{
+					RTSLAM_TRACE_SCOPE("ransac update");
 					// 2. for each obs in inliers
 					JFR_DEBUG_BEGIN(); JFR_DEBUG_SEND("Updating with Ransac:");
 					#if RELEVANCE_TEST
@@ -247,6 +139,7 @@ namespace jafar {
 			ObsList activeSearchList = ((ransacSetList.size() == 0) || (best_set->size() <= 1) ? obsVisibleList : best_set->pendingObs);
 			// FIXME don't search again landmarks that failed as base
 			
+			RTSLAM_TRACE_SCOPE("active search");
 			JFR_DEBUG_BEGIN(); JFR_DEBUG_SEND("Updating with ActiveSearch:");
 			for (unsigned i = 0; i < algorithmParams.n_recomp_gains; ++i)
 			{
@@ -339,9 +232,7 @@ namespace jafar {
 									roi = RoiSpec(rect);
 								}
 								// 1d. match predicted feature in search area
-								//						kernel::Chrono match_chrono;
-								matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
-								//						total_match_time += match_chrono.elapsedMicrosecond();
+								{ RTSLAM_TRACE_SCOPE("match"); matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance); }
 
 								// 1e. if feature is found
 								if (obsPtr->getMatchScore() > matcher->params.threshold) {
@@ -365,9 +256,7 @@ namespace jafar {
 										obsPtr->events.updated = true;
 										numObs++;
 										JFR_DEBUG_SEND(" " << obsPtr->id());
-										//								kernel::Chrono update_chrono;
 										obsPtr->update();
-										//								total_update_time += update_chrono.elapsedMicrosecond();
 									} // obsPtr->compatibilityTest(M_TH)
 								} // obsPtr->getScoreMatchInPercent()>SC_TH
 
@@ -386,35 +275,90 @@ namespace jafar {
 			//###
 			//### Update obs counters and some other stuff
 			//### 
-			for(ObservationList::iterator obsIter = observationList().begin(); obsIter != observationList().end();obsIter++)
+			updateObsCounters();
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		matchKnown(raw_ptr_t data, unsigned seed)
+		{
+			boost::shared_ptr<RawSpec> rawData = SPTR_CAST<RawSpec>(data);
+			grouped = true;
+			group_rand_state = seed;
+			obsStackedList.clear();
+
+			// 1. Ransac sets as in processKnown, the inliers of the best one will be stacked
+			projectAndCollectVisibleObs();
+			buildRansacSets(rawData);
+			ransac_set_ptr_t best_set = selectBestSet();
+			if (best_set && best_set->size() > 1)
+				obsStackedList = best_set->inlierObs;
+
+			// 2. active search of the other observations, by decreasing information gain,
+			// but without intermediate updates the gains don't need to be recomputed
+			ObsList activeSearchList = (!best_set || best_set->size() <= 1 ? obsVisibleList : best_set->pendingObs);
+			for(ObsList::iterator obsIter = activeSearchList.begin(); obsIter != activeSearchList.end(); ++obsIter)
 			{
-				observation_ptr_t obs = *obsIter;
-				if (obs->events.visible) JFR_ASSERT(obs->events.predicted, "obs visible without previous steps");
-				if (obs->events.measured) JFR_ASSERT(obs->events.visible && obs->events.predicted, "obs measured without previous steps");
-				if (obs->events.matched) JFR_ASSERT(obs->events.measured && obs->events.visible && obs->events.predicted, "obs matched without previous steps");
-				if (obs->events.updated) JFR_ASSERT(obs->events.matched && obs->events.measured && obs->events.visible && obs->events.predicted, "obs updated without previous steps");
-				
-				obs->updateDescriptor();
-				#if VISIBILITY_MAP
-				obs->updateVisibilityMap();
-				#endif
-				
-				if (not (obs->events.measured && !obs->events.matched && !obs->isDescriptorValid()))
+				observation_ptr_t obsPtr = *obsIter;
+				obsPtr->clearFlags();
+				obsPtr->measurement.matchScore = 0;
+				obsPtr->project();
+				if (!obsPtr->predictVisibility()) continue;
+
+				bool valid = true; // see processKnown
+				for (unsigned i = 0; i < obsPtr->expectation.P().size1(); ++i)
+					if (obsPtr->expectation.P()(i,i) < 0.0) { valid = false; break; }
+				if (!valid) continue;
+
+				obsPtr->predictInfoGain();
+				obsListSorted[obsPtr->expectation.infoGain] = obsIter;
+			}
+
+			for (ObservationListSorted::reverse_iterator obsIter = obsListSorted.rbegin();
+				obsIter != obsListSorted.rend() && obsStackedList.size() < algorithmParams.n_updates_total; ++obsIter)
+			{
+				observation_ptr_t obsPtr = *(obsIter->second);
+				// as processKnown, only the observations whose appearance can be predicted are searched
+				if (!obsPtr->predictAppearance()) continue;
+				obsPtr->events.measured = true;
+				if (matchPredictedAppearance(rawData, obsPtr))
 				{
-					if (obs->events.measured) obs->counters.nSearch++;
-					if (obs->events.matched) obs->counters.nMatch++;
-					if (obs->events.updated) obs->counters.nInlier++;
+					obsPtr->events.matched = true;
+					obsStackedList.push_back(obsPtr);
 				}
-				
-				if (obs->events.measured) obs->counters.nSearchSinceLastInlier++;
-				if (obs->events.visible) obs->counters.nFrameSinceLastVisible = 0;
-				if (obs->events.updated) obs->counters.nSearchSinceLastInlier = 0;
 			}
+			obsListSorted.clear();
+		}
 
-			// clear all sets to liberate shared pointers
-			ransacSetList.clear();
-			obsBaseList.clear();
-			obsFailedList.clear();
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		unsigned DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		stackKnown()
+		{
+			map_ptr_t mapPtr = sensorPtr()->robotPtr()->mapPtr();
+			for(ObsList::iterator obsIter = obsStackedList.begin(); obsIter != obsStackedList.end(); ++obsIter)
+				mapPtr->filterPtr->stackCorrection((*obsIter)->innovation, (*obsIter)->INN_rsl, (*obsIter)->ia_rsl);
+			return obsStackedList.size();
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		finishKnown(bool updated)
+		{
+			JFR_DEBUG_BEGIN(); JFR_DEBUG_SEND("Updating grouped:");
+			for(ObsList::iterator obsIter = obsStackedList.begin(); obsIter != obsStackedList.end(); ++obsIter)
+				if (updated)
+				{
+					(*obsIter)->events.updated = true;
+					JFR_DEBUG_SEND(" " << (*obsIter)->id());
+				}
+			JFR_DEBUG_END();
+
+			updateObsCounters();
+			obsStackedList.clear();
+			grouped = false;
 		}
 
 
@@ -422,6 +366,7 @@ namespace jafar {
 		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
 		detectNew(raw_ptr_t data)
 		{
+			RTSLAM_TRACE_SCOPE("detection");
 			boost::shared_ptr<RawSpec> rawData = SPTR_CAST<RawSpec>(data);			
 			updateVisibleObs();
 			obsVisibleList.clear();
@@ -512,6 +457,7 @@ namespace jafar {
 		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
 		projectAndCollectVisibleObs()
 		{
+			RTSLAM_TRACE_SCOPE("projection");
 			obsVisibleList.clear();
 
 			for(ObservationList::iterator obsIter = observationList().begin(); obsIter != observationList().end();obsIter++)
@@ -541,7 +487,7 @@ namespace jafar {
 					else
 						{ if (visibility < 0.1) visibility = 0.1; } // allow closing the loop! maybe look at neighbors
 					if (viscertainty < 0.25) visibility = 0.25;
-					if (rtslam::rand()%1024 < visibility*1024) add = true;
+					if (drawRand()%1024 < visibility*1024) add = true;
 					#else
 					add = true;
 					#endif
@@ -584,7 +530,7 @@ namespace jafar {
 				// select one random obs
 //				obsBasePtr = selectOneRandomObs();
 				if (remainingObsCount <= 0) { obsBasePtr.reset(); return; }
-				int n = rtslam::rand()%remainingObsCount;
+				int n = drawRand()%remainingObsCount;
 				obsBasePtr = obsVisibleList[n];
 
 // JFR_DEBUG("getOneMatchedBaseObs: trying obs " << obsBasePtr->id() << " already matched " << obsBasePtr->events.matched);
@@ -683,42 +629,223 @@ namespace jafar {
 			#endif
 
 			if (obsPtr->predictAppearance())
-         {
-
-            RoiSpec roi;
-            if(obsPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and having a size4 expectation the following roi computation fails, hence the test  - TODO clean up all this, is should not mess with One point ransac
-            {
-               roi = RoiSpec(obsPtr->expectation.x(), obsPtr->expectation.P() + matcher->params.measVar*identity_mat(2), matcher->params.mahalanobisTh);
-               obsPtr->searchSize = roi.count();
-               if (obsPtr->searchSize > matcher->params.maxSearchSize) roi.scale(sqrt(matcher->params.maxSearchSize/(double)obsPtr->searchSize));
-				}
-				else // Segment
+				return matchPredictedAppearance(rawData, obsPtr);
+			else
+				return false;
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		bool DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		matchPredictedAppearance(boost::shared_ptr<RawSpec> rawData,  observation_ptr_t obsPtr)
+		{
+			RoiSpec roi;
+			if(obsPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and having a size4 expectation the following roi computation fails, hence the test  - TODO clean up all this, is should not mess with One point ransac
+			{
+				roi = RoiSpec(obsPtr->expectation.x(), obsPtr->expectation.P() + matcher->params.measVar*identity_mat(2), matcher->params.mahalanobisTh);
+				obsPtr->searchSize = roi.count();
+				if (obsPtr->searchSize > matcher->params.maxSearchSize) roi.scale(sqrt(matcher->params.maxSearchSize/(double)obsPtr->searchSize));
+			}
+			else // Segment
+			{
+				// Rough approximation, this won't be used by Dseg Matcher, only by the simulator
+				vec2 p1, p2;
+				vec2 var1, var2;
+				p1[0] = obsPtr->expectation.x()[0]; p1[1] = obsPtr->expectation.x()[1];
+				p2[0] = obsPtr->expectation.x()[2]; p2[1] = obsPtr->expectation.x()[3];
+				var1[0] = (obsPtr->expectation.P()(0,0) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+				var1[1] = (obsPtr->expectation.P()(1,1) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+				var2[0] = (obsPtr->expectation.P()(2,2) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+				var2[1] = (obsPtr->expectation.P()(3,3) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+
+				int basex = min(p1[0]-var1[0],p2[0]-var2[0]);
+				int basey = min(p1[1]-var1[1],p2[1]-var2[1]);
+				cv::Rect rect(
+					basex, basey,
+					max(p1[0]+var1[0],p2[0]+var2[0]) - basex,
+					max(p1[1]+var1[1],p2[1]+var2[1]) - basey
+				);
+				roi = RoiSpec(rect);
+			}
+			{ RTSLAM_TRACE_SCOPE("match"); matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance); }
+// JFR_DEBUG("obs " << obsPtr->id() << " expected at " << obsPtr->expectation.x() << " measured with innovation " << obsPtr->measurement.x()-obsPtr->expectation.x());
+
+			return (obsPtr->getMatchScore() > matcher->params.threshold && isExpectedInnovationInlier(obsPtr, matcher->params.mahalanobisTh));
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		buildRansacSets(boost::shared_ptr<RawSpec> rawData)
+		{
+			RTSLAM_TRACE_SCOPE("ransac");
+			unsigned n_tries = algorithmParams.n_tries;
+			if (obsVisibleList.size() < n_tries) n_tries = obsVisibleList.size();
+
+			unsigned current_try = 0;
+			if (n_tries >= 2)
+			while (current_try < n_tries)
+			{
+				// select random obs and match it
+				observation_ptr_t obsBasePtr;
+				getOneMatchedBaseObs(obsBasePtr, rawData);
+				if (!obsBasePtr) break; // no more available matched obs
+
+				// 1b. base obs is now matched
+				ransac_set_ptr_t ransacSetPtr(new RansacSet);
+				ransacSetList.push_back(ransacSetPtr);
+				ransacSetPtr->obsBasePtr = obsBasePtr;
+				ransacSetPtr->inlierObs.push_back(obsBasePtr);
+
+				current_try ++;
+				vec x_copy = updateMean(obsBasePtr);
+
+				// for each other obs
+				for(ObsList::iterator obsIter = obsVisibleList.begin(); obsIter != obsVisibleList.end(); obsIter++)
 				{
-					// Rough approximation, this won't be used by Dseg Matcher, only by the simulator
-					vec2 p1, p2;
-					vec2 var1, var2;
-					p1[0] = obsPtr->expectation.x()[0]; p1[1] = obsPtr->expectation.x()[1];
-					p2[0] = obsPtr->expectation.x()[2]; p2[1] = obsPtr->expectation.x()[3];
-					var1[0] = (obsPtr->expectation.P()(0,0) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-					var1[1] = (obsPtr->expectation.P()(1,1) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-					var2[0] = (obsPtr->expectation.P()(2,2) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-					var2[1] = (obsPtr->expectation.P()(3,3) + matcher->params.measVar) * matcher->params.mahalanobisTh;
-
-					int basex = min(p1[0]-var1[0],p2[0]-var2[0]);
-					int basey = min(p1[1]-var1[1],p2[1]-var2[1]);
-					cv::Rect rect(
-						basex, basey,
-						max(p1[0]+var1[0],p2[0]+var2[0]) - basex,
-						max(p1[1]+var1[1],p2[1]+var2[1]) - basey
-					);
-					roi = RoiSpec(rect);
+					observation_ptr_t obsCurrentPtr = *obsIter;
+					if (obsCurrentPtr == obsBasePtr) continue; // ignore the tested observation
+
+					// get obs things
+					jblas::vec lmk = obsCurrentPtr->landmarkPtr()->state.x();
+					vec exp(obsCurrentPtr->expectation.size());
+					vec nobs(obsCurrentPtr->prior.size());
+
+					// project
+					projectFromMean(exp, obsCurrentPtr, x_copy);
+
+					bool inlier = obsCurrentPtr->events.matched && 
+					              isLowInnovationInlier(obsCurrentPtr, exp, matcher->params.lowInnov);
+					
+					if (!inlier)
+						if (obsCurrentPtr->predictAppearance())
+						{
+							// try to match with low innovation
+							jblas::sym_mat P = jblas::identity_mat(obsCurrentPtr->expectation.size())*jmath::sqr(matcher->params.lowInnov);
+                     RoiSpec roi;
+                     if(obsCurrentPtr->expectation.P().size1() == 2) // basically DsegMatcher handles it's own roi and (due to the size4 expectation) the following roi computation fails. - TODO clean up all this, is should not mess with One point ransac
+                     {
+                        roi = RoiSpec(exp, P, 1.0);
+                        obsCurrentPtr->searchSize = roi.count();
+                     }
+							else // Segment
+							{
+								// Rough approximation, this won't be used by Dseg Matcher, only by the simulator
+								vec2 p1, p2;
+								vec2 var1, var2;
+								p1[0] = obsCurrentPtr->expectation.x()[0]; p1[1] = obsCurrentPtr->expectation.x()[1];
+								p2[0] = obsCurrentPtr->expectation.x()[2]; p2[1] = obsCurrentPtr->expectation.x()[3];
+								var1[0] = (obsCurrentPtr->expectation.P()(0,0) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+								var1[1] = (obsCurrentPtr->expectation.P()(1,1) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+								var2[0] = (obsCurrentPtr->expectation.P()(2,2) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+								var2[1] = (obsCurrentPtr->expectation.P()(3,3) + matcher->params.measVar) * matcher->params.mahalanobisTh;
+
+								int basex = min(p1[0]-var1[0],p2[0]-var2[0]);
+								int basey = min(p1[1]-var1[1],p2[1]-var2[1]);
+								cv::Rect rect(
+									basex, basey,
+									max(p1[0]+var1[0],p2[0]+var2[0]) - basex,
+									max(p1[1]+var1[1],p2[1]+var2[1]) - basey
+								);
+								roi = RoiSpec(rect);
+							}
+							obsCurrentPtr->events.measured = true;
+							
+							matcher->match(rawData, obsCurrentPtr->predictedAppearance, roi, obsCurrentPtr->measurement, obsCurrentPtr->observedAppearance);
+							if (obsCurrentPtr->getMatchScore() > matcher->params.threshold)
+							{
+								#if PROJECT_MEAN_VISIBILITY
+								obsCurrentPtr->project();
+								#endif
+								if (isExpectedInnovationInlier(obsCurrentPtr, matcher->params.mahalanobisTh))
+								{
+									obsCurrentPtr->events.matched = true;
+								}
+							}
+							
+							inlier = obsCurrentPtr->events.matched && 
+							         isLowInnovationInlier(obsCurrentPtr, exp, matcher->params.lowInnov);
+						}
+					
+					if (inlier)
+					{
+						// declare inlier
+						ransacSetPtr->inlierObs.push_back(obsCurrentPtr);
+					}
+					else{
+						// declare pending
+						ransacSetPtr->pendingObs.push_back(obsCurrentPtr);
+					}
+				} // for each other obs
+			} // for i = 0:n_tries
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		ransac_set_ptr_t DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		selectBestSet()
+		{
+			ransac_set_ptr_t best_set;
+			if (ransacSetList.size() == 0) return best_set;
+
+			// 1. select ransacSet.inliers.size() max
+			for(RansacSetList::iterator rsIter = ransacSetList.begin(); rsIter != ransacSetList.end(); ++rsIter)
+				if (!best_set || (*rsIter)->size() > best_set->size()) best_set = *rsIter;
+
+			// if there are too many updates to do bufferized, randomly move out some of them
+			// to pending, they may be processed in active search if really necessary
+			while (best_set->size() > 1 && best_set->size() > algorithmParams.n_updates_ransac)
+			{
+				int n = (drawRand() % (best_set->size() - 1)) + 1; // keep the first one which is the base obs
+				best_set->pendingObs.push_back(best_set->inlierObs[n]);
+				kernel::fastErase(best_set->inlierObs, n);
+			}
+			return best_set;
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		void DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		updateObsCounters()
+		{
+			for(ObservationList::iterator obsIter = observationList().begin(); obsIter != observationList().end();obsIter++)
+			{
+				observation_ptr_t obs = *obsIter;
+				if (obs->events.visible) JFR_ASSERT(obs->events.predicted, "obs visible without previous steps");
+				if (obs->events.measured) JFR_ASSERT(obs->events.visible && obs->events.predicted, "obs measured without previous steps");
+				if (obs->events.matched) JFR_ASSERT(obs->events.measured && obs->events.visible && obs->events.predicted, "obs matched without previous steps");
+				if (obs->events.updated) JFR_ASSERT(obs->events.matched && obs->events.measured && obs->events.visible && obs->events.predicted, "obs updated without previous steps");
+				
+				obs->updateDescriptor();
+				#if VISIBILITY_MAP
+				obs->updateVisibilityMap();
+				#endif
+				
+				if (not (obs->events.measured && !obs->events.matched && !obs->isDescriptorValid()))
+				{
+					if (obs->events.measured) obs->counters.nSearch++;
+					if (obs->events.matched) obs->counters.nMatch++;
+					if (obs->events.updated) obs->counters.nInlier++;
 				}
-				matcher->match(rawData, obsPtr->predictedAppearance, roi, obsPtr->measurement, obsPtr->observedAppearance);
-// JFR_DEBUG("obs " << obsPtr->id() << " expected at " << obsPtr->expectation.x() << " measured with innovation " << obsPtr->measurement.x()-obsPtr->expectation.x());
+				
+				if (obs->events.measured) obs->counters.nSearchSinceLastInlier++;
+				if (obs->events.visible) obs->counters.nFrameSinceLastVisible = 0;
+				if (obs->events.updated) obs->counters.nSearchSinceLastInlier = 0;
+			}
 
-				return (obsPtr->getMatchScore() > matcher->params.threshold && isExpectedInnovationInlier(obsPtr, matcher->params.mahalanobisTh));
-			} else
-				return false;
+			// clear all sets to liberate shared pointers
+			ransacSetList.clear();
+			obsBaseList.clear();
+			obsFailedList.clear();
+		}
+
+
+		template<class RawSpec,class SensorSpec, class FeatureSpec, class RoiSpec, class FeatureManagerSpec, class DetectorSpec, class MatcherSpec>
+		int DataManagerOnePointRansac<RawSpec,SensorSpec,FeatureSpec,RoiSpec,FeatureManagerSpec,DetectorSpec,MatcherSpec>::
+		drawRand()
+		{
+			// the data managers of a group run in parallel, so they can't share the global random state
+			return (grouped ? rand_r(&group_rand_state) : rtslam::rand());
 		}
 
 
@@ -0,0 +1,246 @@
+/**
+ * \file datasetContainer.hpp
+ *
+ * Header file for the single file dataset container, used to record and replay
+ * the data of all hardware sensors without one file per reading.
+ *
+ * The file is append-only and organized in chunks :
+ * - file header : magic "RTSLAMDS", version
+ * - stream chunks : one per sensor, describing it (type, image size, intrinsics...)
+ * - record chunks : one per reading, with timestamp, arrival date, encoding and data
+ * - index chunk : written when the file is closed, followed by a trailer giving its position.
+ *   It contains the descriptions of all the streams (as in their chunks) and the index entries
+ *   of all the records, so that an indexed file is opened without reading its other chunks.
+ * If the index is missing (the recording process crashed) it is rebuilt by scanning the chunks.
+ * Chunks are aligned on 16 bytes so that uncompressed record data can be used in place.
+ *
+ * The same container is used for the binary logs of proprioceptive and absolute
+ * sensors (see VectorLogWriter and VectorLogReader).
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef DATASET_CONTAINER_HPP_
+#define DATASET_CONTAINER_HPP_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <opencv/cv.h>
+
+#include "jmath/jblas.hpp"
+
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	namespace dataset {
+		enum ChunkTag { tagStream = 1, tagRecord = 2, tagIndex = 3 };
+		enum StreamType { stCamera = 1, stVector = 2 };
+		enum Encoding { encRaw = 0, encPng = 1 };
+
+		const char fileMagic[8] = { 'R','T','S','L','A','M','D','S' };
+		const char indexMagic[8] = { 'R','T','S','L','A','M','I','X' };
+		const uint32_t version = 2; ///< the index describes the streams since version 2
+		const unsigned alignment = 16;
+		const unsigned fileHeaderSize = 16;
+		const unsigned chunkHeaderSize = 16;  ///< u32 tag, u32 stream, u64 payload size
+		const unsigned recordHeaderSize = 32; ///< f64 timestamp, f64 arrival, u32 encoding, u32 reserved, u64 data size
+		const unsigned indexEntrySize = 40;   ///< after the u32 number of streams, u32 reserved, and for each stream its u64 size and description
+		const unsigned trailerSize = 16;      ///< u64 index chunk position, magic
+
+		/// tells if path designates a dataset file rather than a directory of files
+		bool isDatasetPath(std::string const &path);
+	}
+
+	/**
+	Description of one stream of the dataset, ie one sensor.
+	*/
+	struct DatasetStreamInfo
+	{
+		unsigned id;
+		int type;            ///< dataset::StreamType
+		std::string name;
+		int width, height;   ///< image size for cameras, width = vector size for vectors
+		int depth, channels;
+		std::vector<double> params; ///< intrinsic parameters, free content depending on the sensor
+		DatasetStreamInfo(): id(0), type(0), width(0), height(0), depth(0), channels(0) {}
+		DatasetStreamInfo(int type, std::string name, int width, int height = 1, int depth = 64, int channels = 1):
+			id(0), type(type), name(name), width(width), height(height), depth(depth), channels(channels) {}
+	};
+
+	/**
+	Index entry of a record.
+	*/
+	struct DatasetRecordInfo
+	{
+		unsigned stream;
+		int encoding;   ///< dataset::Encoding
+		double timestamp;
+		double arrival;
+		uint64_t offset; ///< position of the record data in the file
+		uint64_t size;   ///< size of the record data
+	};
+
+
+	/**
+	Writes a dataset file. Several hardware sensors can share the same writer
+	(see shared()), records are appended in the order they are written.
+	*/
+	class DatasetWriter
+	{
+		private:
+			std::string path;
+			std::fstream f;
+			boost::mutex mutex_file;
+			uint64_t pos;
+			std::vector<DatasetStreamInfo> streams;
+			std::vector<DatasetRecordInfo> index;
+			double flush_period, last_flush;
+
+			void writeChunk(uint32_t tag, uint32_t stream, const char *header, size_t header_size, const char *data, size_t size);
+		public:
+			DatasetWriter(std::string const &path);
+			~DatasetWriter();
+
+			unsigned addStream(DatasetStreamInfo info);
+			/// thread-safe
+			void write(unsigned stream, double timestamp, double arrival, const char *data, size_t size, int encoding = dataset::encRaw);
+			/// write an image of the size and format declared in the stream header, given its first pixel and row step
+			void writeImage(unsigned stream, double timestamp, double arrival, const uchar *data, int step, int encoding = dataset::encRaw);
+			void writeVector(unsigned stream, double timestamp, double arrival, jblas::vec const &data);
+			/// write the index and close the file, done automatically on destruction
+			void close();
+			/// the records are written to the file at least every period seconds (1 by default), 0 to write each one at once
+			void setFlushPeriod(double period) { flush_period = period; }
+
+			/// get the writer of this file, creating it if not already used by another sensor
+			static boost::shared_ptr<DatasetWriter> shared(std::string const &path);
+			/**
+			Close all the shared writers still used. The acquisition threads of the sensors
+			never end and don't destroy their writers, so this must be called before exiting.
+			*/
+			static void closeAll();
+	};
+	typedef boost::shared_ptr<DatasetWriter> dataset_writer_ptr_t;
+
+
+	/**
+	Reads a dataset file through its index. Several hardware sensors can share
+	the same reader (see shared()).
+	The file is memory-mapped when possible, so that records can be accessed
+	randomly and uncompressed records can be used in place (see data()).
+	*/
+	class DatasetReader
+	{
+		private:
+			std::string path;
+			std::ifstream f;
+			boost::mutex mutex_file;
+			std::vector<DatasetStreamInfo> streams;
+			std::vector<std::vector<DatasetRecordInfo> > records; ///< records of each stream, in file order
+			const char *map; ///< mapping of the whole file, NULL if it could not be mapped
+			uint64_t map_size;
+
+			/// @return false if there is no valid index, streams and records may then be partially filled
+			bool loadIndex(uint64_t file_size, uint32_t version);
+			void scanChunks(uint64_t file_size, bool read_records);
+			void addRecord(DatasetRecordInfo const &rec);
+		public:
+			DatasetReader(std::string const &path);
+			~DatasetReader();
+
+			size_t nStreams() { return streams.size(); }
+			DatasetStreamInfo const& stream(unsigned id) { return streams[id]; }
+			/// @return the id of the n-th stream of this type, -1 if there is none
+			int findStream(int type, int n = 0);
+			/// @return the id of the stream with this name, -1 if there is none
+			int findStream(std::string const &name);
+			size_t size(unsigned stream) { return records[stream].size(); }
+			DatasetRecordInfo const& record(unsigned stream, size_t i) { return records[stream][i]; }
+			/// @return the index of the first record of the stream with timestamp >= timestamp, size(stream) if none
+			size_t findRecord(unsigned stream, double timestamp);
+
+			/// @return a pointer to the record data inside the mapping (valid as long as the reader exists), NULL if the file is not mapped
+			const char* data(DatasetRecordInfo const &rec) { return (map ? map + rec.offset : NULL); }
+
+			/// thread-safe
+			void read(DatasetRecordInfo const &rec, std::vector<char> &data);
+			/// read an image of the size and format declared in the stream header, into a buffer with given row step
+			void readImage(DatasetRecordInfo const &rec, uchar *data, int step);
+			void readVector(DatasetRecordInfo const &rec, jblas::vec &data);
+
+			/// get the reader of this file, opening it if not already used by another sensor
+			static boost::shared_ptr<DatasetReader> shared(std::string const &path);
+	};
+	typedef boost::shared_ptr<DatasetReader> dataset_reader_ptr_t;
+
+
+	/**
+	Binary log of the readings of a proprioceptive or absolute sensor (MTI, GPS, odometry...),
+	replacing the text logs. Each reading is a vector whose first element is the timestamp,
+	recorded as a record of a dataset::stVector stream named after the sensor.
+	The stream is written in the file <dump_path>/<name>.rtds, or in dump_path itself if
+	it is a dataset file, shared with the other sensors (see dataset::vectorLogPath).
+	*/
+	class VectorLogWriter
+	{
+		private:
+			dataset_writer_ptr_t writer;
+			unsigned stream;
+		public:
+			/**
+			@param width the size of the reading vectors, timestamp included
+			@param params free parameters describing the readings (type...)
+			*/
+			VectorLogWriter(std::string const &dump_path, std::string const &name, int width, std::vector<double> const &params = std::vector<double>());
+			/// @param arrival the arrival date of the reading, 0 if unknown
+			void write(jblas::vec const &reading, double arrival = 0.) { writer->writeVector(stream, reading(0), arrival, reading); }
+	};
+
+	/**
+	Reads sequentially a binary log written by VectorLogWriter, through the memory mapping of the file.
+	*/
+	class VectorLogReader
+	{
+		private:
+			dataset_reader_ptr_t reader;
+			unsigned stream;
+			size_t next;
+		public:
+			VectorLogReader(std::string const &dump_path, std::string const &name);
+			/// tells if a binary log exists for this sensor, to fall back to the text log otherwise
+			static bool exists(std::string const &dump_path, std::string const &name);
+
+			DatasetStreamInfo const& info() { return reader->stream(stream); }
+			size_t size() { return reader->size(stream); }
+			/**
+			Read the next reading.
+			@param arrival the arrival date of the reading, 0 if unknown
+			@return false if there is no more reading
+			*/
+			bool read(jblas::vec &reading, double &arrival);
+	};
+
+
+	namespace dataset {
+		/// size in bytes of an image row without padding
+		size_t imageRowSize(DatasetStreamInfo const &info);
+		/// decode an encoded image of the stream into dst, with given row step
+		void decodeImage(DatasetStreamInfo const &info, const char *data, size_t size, int encoding, uchar *dst, int step);
+		/// file containing the binary log of a sensor
+		std::string vectorLogPath(std::string const &dump_path, std::string const &name);
+	}
+
+}}}
+
+#endif
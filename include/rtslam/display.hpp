@@ -13,10 +13,13 @@
 #include "rtslam/landmarkEuclideanPoint.hpp"
 #include "rtslam/sensorPinhole.hpp"
 #include "rtslam/robotAbstract.hpp"
+#include "rtslam/displaySnapshot.hpp"
 
 #include "kernel/IdFactory.hpp"
 #include "boost/variant.hpp"
-#include <boost/type_traits/is_same.hpp>
+
+#include <map>
+#include <vector>
 
 namespace jafar {
 namespace rtslam {
@@ -30,12 +33,13 @@ namespace display {
 	*/
 	class DisplayDataAbstract
 	{
-		// bufferized slam object data
+		// bufferized snapshot data
 		// +
 		// display objects
 			ViewerAbstract *viewer;
 		public:
-			DisplayDataAbstract(ViewerAbstract *viewer_): viewer(viewer_) {}
+			uint64_t snapshot_seq_; ///< the last snapshot in which the object was
+			DisplayDataAbstract(ViewerAbstract *viewer_): viewer(viewer_), snapshot_seq_(0) {}
 			virtual ~DisplayDataAbstract() {}
 			//virtual void bufferize() = 0; // not virtual, we want to allow inlining, and we are using templates
 			//virtual void render() = 0; 
@@ -47,9 +51,8 @@ namespace display {
 	class WorldDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::WorldAbstract *slamWor_; // cannot use shared_ptr or it will never be freed
-			WorldDisplay(ViewerAbstract *viewer_, rtslam::WorldAbstract *_slamWor, WorldDisplay *_garbage):
-				DisplayDataAbstract(viewer_), slamWor_(_slamWor) {}
+			WorldDisplay(ViewerAbstract *viewer_, WorldSnapshot const &_snapWor, WorldDisplay *_garbage):
+				DisplayDataAbstract(viewer_) {}
 	};
 	
 	/** **************************************************************************
@@ -58,10 +61,9 @@ namespace display {
 	class MapDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::MapAbstract *slamMap_;
 			WorldDisplay *dispWorld_;
-			MapDisplay(ViewerAbstract *viewer_, rtslam::MapAbstract *_slamMap, WorldDisplay *_dispWorld): 
-				DisplayDataAbstract(viewer_), slamMap_(_slamMap), dispWorld_(_dispWorld) {}
+			MapDisplay(ViewerAbstract *viewer_, MapSnapshot const &_snapMap, WorldDisplay *_dispWorld): 
+				DisplayDataAbstract(viewer_), dispWorld_(_dispWorld) {}
 	};
 
 	/** **************************************************************************
@@ -72,10 +74,10 @@ namespace display {
 	class RobotDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::RobotAbstract *slamRob_;
 			MapDisplay *dispMap_;
-			RobotDisplay(ViewerAbstract *viewer_, rtslam::RobotAbstract *_slamRob, MapDisplay *_dispMap): 
-				DisplayDataAbstract(viewer_), slamRob_(_slamRob), dispMap_(_dispMap) {}
+			unsigned id_;
+			RobotDisplay(ViewerAbstract *viewer_, RobotSnapshot const &_snapRob, MapDisplay *_dispMap): 
+				DisplayDataAbstract(viewer_), dispMap_(_dispMap), id_(_snapRob.id) {}
 	};
 
 	/** **************************************************************************
@@ -86,11 +88,10 @@ namespace display {
 	class SensorDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::SensorExteroAbstract *slamSen_;
 			RobotDisplay *dispRobot_;
 			SensorAbstract::type_enum type_;
-			SensorDisplay(ViewerAbstract *viewer_, rtslam::SensorExteroAbstract *_slamSen, RobotDisplay *_dispRobot): 
-				DisplayDataAbstract(viewer_), slamSen_(_slamSen), dispRobot_(_dispRobot), type_(_slamSen->type) {}
+			SensorDisplay(ViewerAbstract *viewer_, SensorSnapshot const &_snapSen, RobotDisplay *_dispRobot): 
+				DisplayDataAbstract(viewer_), dispRobot_(_dispRobot), type_(_snapSen.type) {}
 	};
 
 	/** **************************************************************************
@@ -101,27 +102,26 @@ namespace display {
 	class LandmarkDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::LandmarkAbstract *slamLmk_;
 			MapDisplay *dispMap_;
          enum Type { ltPoint, ltSeg };
 			enum Phase { init, converged };
 			Type  type_;
 			Phase phase_;
-			static Type convertType(rtslam::LandmarkAbstract *_slamLmk)
+			static Type convertType(rtslam::LandmarkAbstract::geometry_t geomType)
 			{
-				switch (_slamLmk->getGeomType())
+				switch (geomType)
 				{
 					case rtslam::LandmarkAbstract::POINT:
                   return ltPoint;
                case rtslam::LandmarkAbstract::LINE:
                   return ltSeg;
 					default:
-						JFR_ERROR(RtslamException, RtslamException::UNKNOWN_FEATURE_TYPE, "Don't know how to display this type of landmark" << _slamLmk->getGeomType());
+						JFR_ERROR(RtslamException, RtslamException::UNKNOWN_FEATURE_TYPE, "Don't know how to display this type of landmark" << geomType);
 				}
 			}
-			static Phase convertPhase(rtslam::LandmarkAbstract *_slamLmk)
+			static Phase convertPhase(rtslam::LandmarkAbstract::type_enum lmkType)
 			{
-				switch (_slamLmk->type)
+				switch (lmkType)
 				{
 					case rtslam::LandmarkAbstract::PNT_EUC:
 						return converged;
@@ -129,9 +129,9 @@ namespace display {
 						return init;
 				}
 			}
-			LandmarkDisplay(ViewerAbstract *viewer_, rtslam::LandmarkAbstract *_slamLmk, MapDisplay *_dispMap): 
-				DisplayDataAbstract(viewer_), slamLmk_(_slamLmk), dispMap_(_dispMap),
-				type_(convertType(_slamLmk)), phase_(convertPhase(_slamLmk)) {}
+			LandmarkDisplay(ViewerAbstract *viewer_, LandmarkSnapshot const &_snapLmk, MapDisplay *_dispMap): 
+				DisplayDataAbstract(viewer_), dispMap_(_dispMap),
+				type_(convertType(_snapLmk.geom)), phase_(convertPhase(_snapLmk.type)) {}
 	};
 
 
@@ -143,17 +143,106 @@ namespace display {
 	class ObservationDisplay : public DisplayDataAbstract
 	{
 		public:
-			rtslam::ObservationAbstract *slamObs_;
 			SensorDisplay *dispSen_;
 			SensorAbstract::type_enum sensorType_;
 			LandmarkDisplay::Type  landmarkGeomType_;
 			LandmarkDisplay::Phase landmarkPhase_;
-			ObservationDisplay(ViewerAbstract *viewer_, rtslam::ObservationAbstract *_slamObs, SensorDisplay *_dispSen): 
-				DisplayDataAbstract(viewer_), slamObs_(_slamObs), dispSen_(_dispSen)
+			ObservationDisplay(ViewerAbstract *viewer_, ObservationSnapshot const &_snapObs, SensorDisplay *_dispSen): 
+				DisplayDataAbstract(viewer_), dispSen_(_dispSen)
+			{
+				sensorType_ = _dispSen->type_;
+				landmarkGeomType_ = LandmarkDisplay::convertType(_snapObs.landmark_geom);
+				landmarkPhase_ = LandmarkDisplay::convertPhase(_snapObs.landmark_type);
+			}
+	};
+
+
+	/**
+	Identifies the display object of a slam object between the snapshots.
+	The type of the landmark is part of it, so that a reparametrized landmark gets
+	new display objects, as it used to be a new slam object.
+	*/
+	struct DisplayKey
+	{
+		unsigned map, id, sub, type;
+		DisplayKey(unsigned map, unsigned id, unsigned sub = 0, unsigned type = 0): map(map), id(id), sub(sub), type(type) {}
+		bool operator<(DisplayKey const &k) const
+		{
+			if (map != k.map) return map < k.map;
+			if (id != k.id) return id < k.id;
+			if (sub != k.sub) return sub < k.sub;
+			return type < k.type;
+		}
+	};
+
+	/**
+	The display objects of one kind that a viewer owns, and those that are in the last
+	bufferized snapshot, in order.
+	*/
+	template<class DisplayType>
+	class DisplayObjectList
+	{
+		public:
+			typedef std::map<DisplayKey, DisplayType*> Objects;
+			Objects objects;
+			std::vector<DisplayType*> current;
+			~DisplayObjectList()
 			{
-				sensorType_ = _slamObs->sensorPtr()->type;
-				landmarkGeomType_ = LandmarkDisplay::convertType(&*_slamObs->landmarkPtr());
-				landmarkPhase_ = LandmarkDisplay::convertPhase(&*_slamObs->landmarkPtr());
+				for(typename Objects::iterator it = objects.begin(); it != objects.end(); ++it) delete it->second;
+			}
+			/// deletes the objects that are not in the snapshot seq anymore
+			void removeOld(uint64_t seq)
+			{
+				for(typename Objects::iterator it = objects.begin(); it != objects.end(); )
+					if (it->second->snapshot_seq_ != seq) { delete it->second; objects.erase(it++); } else ++it;
+			}
+	};
+
+
+	/** **************************************************************************
+	Limits the rate at which a view is rendered, whatever the rate of the
+	snapshots, and measures how long its rendering takes.
+	The dates are given by the caller (s).
+	\ingroup rtslam
+	*/
+	class ViewRefresh
+	{
+		private:
+			double period;
+			double next; ///< date of the next render
+			double start;
+		public:
+			unsigned nrendered, nskipped;
+			double last_duration, mean_duration, max_duration; ///< s
+		public:
+			ViewRefresh(double rate = 0.): next(0.), start(0.), nrendered(0), nskipped(0),
+				last_duration(0.), mean_duration(0.), max_duration(0.) { setRate(rate); }
+			/// @param rate maximal rate (Hz), 0 to render each time
+			void setRate(double rate) { period = (rate > 0. ? 1./rate : 0.); }
+			double rate() const { return (period > 0. ? 1./period : 0.); }
+			/**
+			Whether the view must be rendered now, otherwise it is counted as skipped.
+			A quarter of period in advance is accepted, for the jitter of the display loop.
+			@param force for instance to render all the frames
+			*/
+			bool due(double now, bool force = false)
+			{
+				if (force || now >= next - period/4) return true;
+				++nskipped;
+				return false;
+			}
+			void begin(double now)
+			{
+				start = now;
+				// regular when slightly late, but does not catch up after a long pause
+				next = (now < next + period ? next + period : now + period);
+			}
+			void end(double now)
+			{
+				last_duration = now - start;
+				mean_duration = (nrendered == 0 ? last_duration : 0.9*mean_duration + 0.1*last_duration);
+				if (last_duration > max_duration) max_duration = last_duration;
+				++nrendered;
 			}
 	};
 
@@ -165,42 +254,22 @@ namespace display {
 	class ViewerAbstract
 	{
 		protected:
-			typedef boost::variant<rtslam::world_ptr_t, rtslam::map_ptr_t, rtslam::robot_ptr_t, 
-				rtslam::sensorext_ptr_t, rtslam::landmark_ptr_t, rtslam::observation_ptr_t> SlamObjectPtr;
-			typedef std::vector<SlamObjectPtr> SlamObjectsList;
-			SlamObjectsList slamObjects_; ///< all the slam objects at the time of bufferization (that must be displayed)
+			uint64_t snapshot_seq_; ///< the snapshot being bufferized
 
-			template<class DisplayType, class ParentDisplayType, class SlamPtrType, class ParentSlamPtrType>
-			inline void bufferizeObject(SlamPtrType slamObject, ParentSlamPtrType parentSlam, unsigned int id)
+			template<class DisplayType, class ParentDisplayType, class SnapshotType>
+			inline DisplayType* bufferizeObject(DisplayObjectList<DisplayType> &list, DisplayKey const &key,
+				SnapshotType const &snapshot, ParentDisplayType *parentDisp)
 			{
-				// add the object to the list
-				slamObjects_.push_back(slamObject);
-				// if the array hasn't been created
-				if (slamObject->displayData.size() <= id)
-				{
-					int oldsize = slamObject->displayData.size();
-					slamObject->displayData.resize(id+1);
-					for(unsigned int i = oldsize; i <= id; ++i)
-						slamObject->displayData[i] = NULL;
-				}
+				DisplayType *&objDisp = list.objects[key];
 				// if the object hasn't been created
-				if (slamObject->displayData[id] == NULL)
-				{
-					ParentDisplayType *parentDisp;
-					if (boost::is_same<ParentDisplayType,MapDisplay>::value)
-						parentDisp = NULL;
-					else
-					{
-						if (parentSlam->displayData.size() <= id) 
-							parentDisp = NULL;
-						else
-							parentDisp = PTR_CAST<ParentDisplayType*>(parentSlam->displayData[id]);
-					}
-					slamObject->displayData[id] = new DisplayType(this, &*slamObject, parentDisp);
-				}
+				if (objDisp == NULL)
+					objDisp = new DisplayType(this, snapshot, parentDisp);
+				// add the object to the list
+				objDisp->snapshot_seq_ = snapshot_seq_;
+				list.current.push_back(objDisp);
 				// bufferize the object
-				DisplayType *objDisp = PTR_CAST<DisplayType*>(slamObject->displayData[id]);
-				objDisp->bufferize();
+				objDisp->bufferize(snapshot);
+				return objDisp;
 			}
 			
 		public:
@@ -215,12 +284,12 @@ namespace display {
 		public:
 			//ViewerAbstract(): id_(idFactory().getId()-1) {}
 			//virtual ~ViewerAbstract() { idFactory().releaseId(id_); }
+			ViewerAbstract(): snapshot_seq_(0) {}
 			virtual ~ViewerAbstract() {}
 			/**
-			Put the objects in slamObjects_, bufferize all display objects and construct them if necessary.
-			Don't forget to clear slamObjects_ first.
+			Bufferize all display objects from a snapshot and construct them if necessary.
 			*/
-			//virtual void bufferize(rtslam::map_ptr_t _map) = 0;
+			//virtual void bufferize(WorldSnapshot const &snapshot) = 0;
 //			virtual void render() = 0;
 	};
 	
@@ -263,57 +332,27 @@ class ThreadSafeGarbageCollector
 	/** **************************************************************************
 	This is the base class for a viewer that can render the scene.
 	When writing a new viewer, it must be inherited from this.
+	Both bufferize and render are called by the display thread, from the last
+	snapshot published by the slam (see WorldSnapshotBuffer), so the display
+	objects never access the slam objects.
 	*/
 	template<class WorldDisplayType, class MapDisplayType, class RobotDisplayType, 
 		class SensorDisplayType, class LandmarkDisplayType, class ObservationDisplayType, class GarbageType>
 	class Viewer : public ViewerAbstract, public ThreadSafeGarbageCollector<GarbageType>
 	{
 		protected:
-			//template<class RobotDisplayType, class SensorDisplayType, class LandmarkDisplayType, class ObservationDisplayType>
-			class Render : public boost::static_visitor<>// : public RenderAbstract
-			{
-				public:
-					typedef Viewer<WorldDisplayType, MapDisplayType, RobotDisplayType, 
-						SensorDisplayType, LandmarkDisplayType, ObservationDisplayType, GarbageType> MyViewer;
-					
-					void operator()(rtslam::world_ptr_t const &wor) const {
-						if (!boost::is_same<WorldDisplayType,WorldDisplay>::value) {
-							WorldDisplayType &worDisp = *PTR_CAST<WorldDisplayType*>(wor->displayData[MyViewer::id()]);
-							worDisp.render();
-						}
-					}
-					void operator()(rtslam::map_ptr_t const &map) const {
-						if (!boost::is_same<MapDisplayType,MapDisplay>::value) {
-							MapDisplayType &mapDisp = *PTR_CAST<MapDisplayType*>(map->displayData[MyViewer::id()]);
-							mapDisp.render();
-						}
-					}
-					void operator()(rtslam::robot_ptr_t const &rob) const {
-						if (!boost::is_same<RobotDisplayType,RobotDisplay>::value) {
-							RobotDisplayType &robDisp = *PTR_CAST<RobotDisplayType*>(rob->displayData[MyViewer::id()]);
-							robDisp.render();
-						}
-					}
-					void operator()(rtslam::sensorext_ptr_t const &sen) const {
-						if (!boost::is_same<SensorDisplayType,SensorDisplay>::value) {
-							SensorDisplayType &senDisp = *PTR_CAST<SensorDisplayType*>(sen->displayData[MyViewer::id()]);
-							senDisp.render();
-						}
-					}
-					void operator()(rtslam::landmark_ptr_t const &lmk) const {
-						if (!boost::is_same<LandmarkDisplayType,LandmarkDisplay>::value) {
-							LandmarkDisplayType &lmkDisp = *PTR_CAST<LandmarkDisplayType*>(lmk->displayData[MyViewer::id()]);
-							lmkDisp.render();
-						}
-					}
-					void operator()(rtslam::observation_ptr_t const &obs) const {
-						if (!boost::is_same<ObservationDisplayType,ObservationDisplay>::value) {
-							ObservationDisplayType &obsDisp = *PTR_CAST<ObservationDisplayType*>(obs->displayData[MyViewer::id()]);
-							obsDisp.render();
-						}
-					}
-			};
+			DisplayObjectList<WorldDisplayType> worlds_;
+			DisplayObjectList<MapDisplayType> maps_;
+			DisplayObjectList<RobotDisplayType> robots_;
+			DisplayObjectList<SensorDisplayType> sensors_;
+			DisplayObjectList<LandmarkDisplayType> landmarks_;
+			DisplayObjectList<ObservationDisplayType> observations_;
 			
+			template<class DisplayType> static void renderList(DisplayObjectList<DisplayType> &list)
+			{
+				for(typename std::vector<DisplayType*>::iterator it = list.current.begin(); it != list.current.end(); ++it)
+					(*it)->render();
+			}
 			
 		public:
 			static IdFactory::storage_t& id()
@@ -322,81 +361,83 @@ class ThreadSafeGarbageCollector
 				return id;
 			}
 			
+			/**
+			Deletes all the display objects, that release their display lib objects to the garbage collector.
+			A viewer whose display objects use its own members must call it in its destructor.
+			*/
+			void removeAll()
+			{
+				observations_.removeOld(-1); landmarks_.removeOld(-1); sensors_.removeOld(-1);
+				robots_.removeOld(-1); maps_.removeOld(-1); worlds_.removeOld(-1);
+				this->garbageCollect();
+			}
+			
 		public:
-			~Viewer() { this->garbageCollect(); }
+			~Viewer()
+			{
+				removeAll();
+			}
 			inline void clear()
 			{
-				slamObjects_.clear();
+				worlds_.current.clear(); maps_.current.clear(); robots_.current.clear();
+				sensors_.current.clear(); landmarks_.current.clear(); observations_.current.clear();
 			}
 			
-			//virtual void garbageCollect() = 0;
+			typename DisplayObjectList<ObservationDisplayType>::Objects const& observationDisplays() const { return observations_.objects; }
 			
 			/**
-			This function bufferizes all the objects
+			This function bufferizes all the objects of the snapshot, and deletes
+			the display objects of the slam objects that disappeared.
+			The landmarks and the observations can skip the copy and the rendering
+			when the stamp of their snapshot did not change.
 			*/
-			inline void bufferize(rtslam::world_ptr_t wor)
+			inline void bufferize(WorldSnapshot const &snapshot)
 			{
+				clear();
+				snapshot_seq_ = snapshot.seq;
 				// bufferize world
-				if (!boost::is_same<WorldDisplayType,WorldDisplay>::value) // bufferize world
-					bufferizeObject<WorldDisplayType, WorldDisplayType, world_ptr_t, world_ptr_t>(wor, wor, id());
+				WorldDisplayType *worDisp = bufferizeObject<WorldDisplayType, WorldDisplayType, WorldSnapshot>(worlds_, DisplayKey(0,0), snapshot, NULL);
 				// bufferize maps
-				for(WorldAbstract::MapList::iterator map = wor->mapList().begin(); map != wor->mapList().end(); ++map)
-					bufferize(*map, wor);
+				for(size_t map = 0; map < snapshot.maps.size(); ++map)
+					bufferize(map, snapshot.maps[map], worDisp);
+				
+				observations_.removeOld(snapshot_seq_);
+				landmarks_.removeOld(snapshot_seq_);
+				sensors_.removeOld(snapshot_seq_);
+				robots_.removeOld(snapshot_seq_);
+				maps_.removeOld(snapshot_seq_);
 			}
 			
-			inline void bufferize(rtslam::map_ptr_t map, rtslam::world_ptr_t wor)
+			inline void bufferize(unsigned map, MapSnapshot const &snapMap, WorldDisplayType *worDisp)
 			{
 				// bufferize map
-				if (!boost::is_same<MapDisplayType,MapDisplay>::value)
-					bufferizeObject<MapDisplayType, WorldDisplayType, map_ptr_t, world_ptr_t>(map, wor, id());
+				MapDisplayType *mapDisp = bufferizeObject<MapDisplayType, WorldDisplayType, MapSnapshot>(maps_, DisplayKey(map,0), snapMap, worDisp);
 				// bufferize robots
-				for(MapAbstract::RobotList::iterator rob = map->robotList().begin(); rob != map->robotList().end(); ++rob)
-					bufferize(*rob,map);
+				for(std::vector<RobotSnapshot>::const_iterator rob = snapMap.robots.begin(); rob != snapMap.robots.end(); ++rob)
+					bufferize(map, *rob, mapDisp);
 				// bufferize landmarks
-				for(MapAbstract::MapManagerList::iterator mm = map->mapManagerList().begin(); mm!=map->mapManagerList().end(); ++mm )
-				  for(MapManagerAbstract::LandmarkList::iterator lmk = (*mm)->landmarkList().begin(); lmk != (*mm)->landmarkList().end(); ++lmk)
-				    bufferize(*lmk,map);
+				for(std::vector<landmark_snapshot_ptr_t>::const_iterator lmk = snapMap.landmarks.begin(); lmk != snapMap.landmarks.end(); ++lmk)
+					bufferizeObject<LandmarkDisplayType, MapDisplayType, LandmarkSnapshot>(landmarks_, DisplayKey(map, (*lmk)->id, 0, (*lmk)->type), **lmk, mapDisp);
 			}
 			
-			inline void bufferize(rtslam::robot_ptr_t rob, rtslam::map_ptr_t map)
+			inline void bufferize(unsigned map, RobotSnapshot const &snapRob, MapDisplayType *mapDisp)
 			{
 				// bufferize robot
-				if (!boost::is_same<RobotDisplayType,RobotDisplay>::value)
-					bufferizeObject<RobotDisplayType, MapDisplayType, robot_ptr_t, map_ptr_t>(rob, map, id());
+				RobotDisplayType *robDisp = bufferizeObject<RobotDisplayType, MapDisplayType, RobotSnapshot>(robots_, DisplayKey(map, snapRob.id), snapRob, mapDisp);
 				// bufferize exteroceptive sensors
-				for(RobotAbstract::SensorList::iterator sen = rob->sensorList().begin(); sen != rob->sensorList().end(); ++sen)
-					if ((*sen)->kind == SensorAbstract::EXTEROCEPTIVE) 
-					{
-						sensorext_ptr_t senPtr = SPTR_CAST<SensorExteroAbstract>(*sen);
-						bufferize(senPtr,rob);
-					}
+				for(std::vector<SensorSnapshot>::const_iterator sen = snapRob.sensors.begin(); sen != snapRob.sensors.end(); ++sen)
+					bufferize(map, *sen, robDisp);
 			}
 
-			inline void bufferize(rtslam::sensorext_ptr_t sen, rtslam::robot_ptr_t rob)
+			inline void bufferize(unsigned map, SensorSnapshot const &snapSen, RobotDisplayType *robDisp)
 			{
 				// bufferize sensor
-				if (!boost::is_same<SensorDisplayType,SensorDisplay>::value)
-					bufferizeObject<SensorDisplayType, RobotDisplayType, sensorext_ptr_t, robot_ptr_t>(sen, rob, id());
+				SensorDisplayType *senDisp = bufferizeObject<SensorDisplayType, RobotDisplayType, SensorSnapshot>(sensors_, DisplayKey(map, snapSen.id), snapSen, robDisp);
 				// bufferize observations
-				for(SensorExteroAbstract::DataManagerList::iterator dma = sen->dataManagerList().begin(); dma!=sen->dataManagerList().end();++dma)
-				  for(LandmarkAbstract::ObservationList::iterator obs = (*dma)->observationList().begin(); obs != (*dma)->observationList().end(); ++obs)
-				    bufferize(*obs,sen);
+				for(std::vector<observation_snapshot_ptr_t>::const_iterator obs = snapSen.observations.begin(); obs != snapSen.observations.end(); ++obs)
+					bufferizeObject<ObservationDisplayType, SensorDisplayType, ObservationSnapshot>(observations_,
+						DisplayKey(map, snapSen.id, (*obs)->landmark_id, (*obs)->landmark_type), **obs, senDisp);
 			}
-
-			inline void bufferize(rtslam::observation_ptr_t obs, rtslam::sensorext_ptr_t sen)
-			{
-				// bufferize observationbufferizeObject
-				if (!boost::is_same<ObservationDisplayType,ObservationDisplay>::value) // bufferize observation
-					bufferizeObject<ObservationDisplayType, SensorDisplayType, observation_ptr_t, sensorext_ptr_t>(obs, sen, id());
-			}
-
-			inline void bufferize(rtslam::landmark_ptr_t lmk, rtslam::map_ptr_t map)
-			{
-				// bufferize landmark
-				if (!boost::is_same<LandmarkDisplayType,LandmarkDisplay>::value) // bufferize landmark
-					bufferizeObject<LandmarkDisplayType, MapDisplayType, landmark_ptr_t, map_ptr_t>(lmk, map, id());
-			}
-			
 			
 
 			/**
@@ -406,21 +447,17 @@ class ThreadSafeGarbageCollector
 			void render()
 			{
 				/*
-				We need to clear at the end, because we must clear before bufferize, 
-				and bufferize is called by the slam thread so it cannot call it.
-				But then when if a landmark is destroyed, it is immediatly destroyed
-				as it is not retained by this list, so the display object is also destroyed,
-				and it is not thread safe. So when the display object is destroyed, display lib objects
-				are just moved to the garbage collector, and destroyed by this thread before the next rendering.
-				Anyway destroying the object can be long so it is better to do it here.
-				Maybe it is not neccessary anymore to have a vector of variants here, but just
-				a vector of display data.
+				The display objects of the slam objects that disappeared were deleted by bufferize,
+				and they moved their display lib objects to the garbage collector, that
+				destroys them before rendering.
 				*/
 				this->garbageCollect(); // strange, the "this" is necessary...
-				for(SlamObjectsList::iterator it = slamObjects_.begin(); it != slamObjects_.end(); ++it)
-				{
-					boost::apply_visitor(Render(), *it);
-				}
+				renderList(worlds_);
+				renderList(maps_);
+				renderList(robots_);
+				renderList(sensors_);
+				renderList(observations_);
+				renderList(landmarks_);
 				// clear viewer
 				clear();
 			}
@@ -0,0 +1,222 @@
+/**
+ * \file displaySnapshot.hpp
+ *
+ * Header file for the snapshots of the world that the slam thread publishes
+ * for the display, so that the display never reads the slam objects.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef DISPLAY_SNAPSHOT_HPP_
+#define DISPLAY_SNAPSHOT_HPP_
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "jmath/jblas.hpp"
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/rawImage.hpp"
+#include "rtslam/sensorAbstract.hpp"
+#include "rtslam/landmarkAbstract.hpp"
+#include "rtslam/observationAbstract.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+	/**
+	What the display needs of an observation, in the frame of its sensor.
+	It is shared between the snapshots as long as the observation does not change.
+	*/
+	struct ObservationSnapshot
+	{
+		uint64_t stamp; ///< changes each time it is copied again, so that the displays can skip it otherwise
+		unsigned landmark_id;
+		LandmarkAbstract::type_enum landmark_type;
+		LandmarkAbstract::geometry_t landmark_geom;
+		ObservationAbstract::Events events;
+		jblas::vec predObs;
+		jblas::sym_mat predObsCov; ///< innovation covariance if matched, expectation covariance otherwise
+		jblas::vec measObs;
+		double match_score;
+#ifdef HAVE_MODULE_DSEG
+		jblas::vec4 realObs; ///< extremities of the detected segment
+#endif
+	};
+	typedef boost::shared_ptr<const ObservationSnapshot> observation_snapshot_ptr_t;
+
+	/**
+	What the display needs of an exteroceptive sensor, with its observations.
+	*/
+	struct SensorSnapshot
+	{
+		unsigned id;
+		SensorAbstract::type_enum type;
+		unsigned framenumber; ///< -1 before the first processed raw
+		double timestamp;
+		jblas::vec7 robot_pose;
+		bool has_raw;
+		/// the last processed image, shared between the snapshots of the same frame and never modified
+		jafarImage_ptr_t image;
+		std::vector<observation_snapshot_ptr_t> observations;
+	};
+
+	struct RobotSnapshot
+	{
+		unsigned id;
+		jblas::vec7 pose;
+		jblas::sym_mat poseCov;
+		std::vector<SensorSnapshot> sensors;
+	};
+
+	/**
+	What the display needs of a landmark.
+	It is shared between the snapshots as long as the landmark does not change.
+	*/
+	struct LandmarkSnapshot
+	{
+		uint64_t stamp; ///< changes each time it is copied again, so that the displays can skip it otherwise
+		unsigned id;
+		LandmarkAbstract::type_enum type;
+		LandmarkAbstract::geometry_t geom;
+		ObservationAbstract::Events events; ///< union of the events of its observations
+		jblas::vec x;
+		jblas::sym_mat P;
+		/// euclidean parametrization (see LandmarkAbstract::reparametrize), empty if not requested
+		jblas::vec eucX;
+		jblas::sym_mat eucP;
+#ifdef HAVE_MODULE_DSEG
+		float left_extremity, right_extremity;
+#endif
+	};
+	typedef boost::shared_ptr<const LandmarkSnapshot> landmark_snapshot_ptr_t;
+
+	struct MapSnapshot
+	{
+		std::vector<RobotSnapshot> robots;
+		std::vector<landmark_snapshot_ptr_t> landmarks;
+	};
+
+	/**
+	A compact copy of what the display shows of the world.
+	It is not modified anymore once published, so that the display can read it
+	without any lock while the slam goes on.
+	*/
+	struct WorldSnapshot
+	{
+		uint64_t seq; ///< publication number, from 1
+		unsigned t; ///< the frame of the world it represents, -1 before the first one
+		std::vector<MapSnapshot> maps;
+	};
+
+	typedef boost::shared_ptr<WorldSnapshot> world_snapshot_ptr_t;
+	typedef boost::shared_ptr<const WorldSnapshot> world_snapshot_cptr_t;
+
+
+	/**
+	Double buffer of world snapshots between the slam threads and the display.
+	The slam copies the world in the back buffer and swaps it with the front
+	one, that the display acquires and holds while it renders it. A buffer is
+	reused only when the display released it, otherwise a new one is allocated,
+	so the slam never waits for the display, and the display never waits for
+	the slam to finish copying.
+
+	Only the landmarks and the observations whose change stamp (see
+	ObjectAbstract::touch) moved since they were last copied are copied again,
+	the others are shared with the previous snapshots. As the filter moves all
+	the correlated landmarks a little at each correction, a landmark that was
+	not touched is also copied again when its state moved or its uncertainty
+	changed by more than a threshold since its last copy, as
+	LandmarkExportTracker does for the export.
+
+	\ingroup rtslam
+	*/
+	class WorldSnapshotBuffer
+	{
+		private:
+			boost::mutex mutex_write; ///< serializes the slam threads of the different maps
+			boost::mutex mutex; ///< protects the swap
+			boost::condition_variable cond;
+			world_snapshot_ptr_t front, back;
+			uint64_t published, acquired;
+			unsigned published_t;
+
+			bool with_images, with_euclidean;
+			double pos_threshold, stdev_threshold;
+			struct SensorImage { unsigned framenumber; jafarImage_ptr_t image, spare; };
+			std::map<unsigned, SensorImage> images; ///< last image of each sensor
+
+			/// the last copy of a landmark or of an observation, and the stamps it was copied at
+			template<class SnapshotType> struct Cached
+				{ boost::shared_ptr<SnapshotType> snapshot; uint64_t change_stamp, seen; };
+			typedef Cached<LandmarkSnapshot> CachedLandmark;
+			typedef Cached<ObservationSnapshot> CachedObservation;
+			std::map<unsigned, CachedLandmark> landmarks; ///< by landmark id
+			std::map<std::pair<unsigned, unsigned>, CachedObservation> observations; ///< by sensor and landmark ids
+			uint64_t ncaptures, nstamps;
+
+			void capture(world_ptr_t const &world, WorldSnapshot &snapshot);
+			void capture(RobotAbstract &rob, RobotSnapshot &snapshot);
+			void capture(SensorExteroAbstract &sen, SensorSnapshot &snapshot);
+			landmark_snapshot_ptr_t capture(LandmarkAbstract &lmk);
+			/// whether the filter moved lmk too much since it was copied in snapshot
+			bool moved(LandmarkAbstract &lmk, LandmarkSnapshot const &snapshot);
+			void capture(LandmarkAbstract &lmk, LandmarkSnapshot &snapshot);
+			observation_snapshot_ptr_t capture(SensorExteroAbstract &sen, ObservationAbstract &obs);
+			void capture(ObservationAbstract &obs, ObservationSnapshot &snapshot);
+			/// the copy in cached if it can be written, otherwise a new one
+			template<class SnapshotType> SnapshotType& writable(Cached<SnapshotType> &cached);
+			template<class Key, class SnapshotType> void forgetOld(std::map<Key, Cached<SnapshotType> > &cache);
+		public:
+			/// what the last publication copied, to be read by the thread that publishes
+			struct Stats { unsigned landmarks, landmarks_copied, observations, observations_copied; };
+			Stats lastStats;
+
+			/**
+			@param with_images copy the last image of the sensors
+			@param with_euclidean also export the euclidean parametrization of the landmarks
+			@param pos_threshold a landmark that was not touched is copied again when one of
+			  its parameters moved by more
+			@param stdev_threshold or when the square root of the trace of its covariance
+			  changed by more than this ratio
+			*/
+			WorldSnapshotBuffer(bool with_images = true, bool with_euclidean = false, double pos_threshold = 0.001, double stdev_threshold = 0.05);
+
+			/**
+			Copies the world in the back buffer, each map with its mutex_process locked,
+			and makes it the last snapshot.
+			@param t the frame of the world
+			@param wait if false and another thread is already publishing, returns at once
+			@return whether it was published
+			*/
+			bool publish(world_ptr_t const &world, unsigned t, bool wait = true);
+			/**
+			The last published snapshot if it is newer than last_seq, waiting for it
+			at most timeout (s), or NULL.
+			*/
+			world_snapshot_cptr_t acquire(uint64_t last_seq, double timeout = 0.);
+			/**
+			Waits at most timeout (s) that the last snapshot is acquired.
+			@return whether it was acquired
+			*/
+			bool waitAcquired(double timeout);
+
+			/// whether the last snapshot was acquired, so that the display would take a new one
+			bool isAcquired() { boost::unique_lock<boost::mutex> l(mutex); return acquired == published; }
+			/// the frame of the last snapshot, -1 if none
+			unsigned lastT() { boost::unique_lock<boost::mutex> l(mutex); return published_t; }
+			uint64_t count() { boost::unique_lock<boost::mutex> l(mutex); return published; }
+	};
+
+}}}
+
+#endif
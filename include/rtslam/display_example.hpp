@@ -40,9 +40,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			WorldEx(ViewerAbstract *_viewer, rtslam::WorldAbstract *_slamWor, WorldDisplay *garbage): 
-				WorldDisplay(_viewer, _slamWor, garbage), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			WorldEx(ViewerAbstract *_viewer, WorldSnapshot const &_snapWor, WorldDisplay *garbage): 
+				WorldDisplay(_viewer, _snapWor, garbage), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(WorldSnapshot const &_snapWor) {}
 			void render() {}
 	};
 
@@ -50,9 +50,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			MapEx(ViewerAbstract *_viewer, rtslam::MapAbstract *_slamMap, WorldEx *_dispWorld): 
-				MapDisplay(_viewer, _slamMap, _dispWorld), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			MapEx(ViewerAbstract *_viewer, MapSnapshot const &_snapMap, WorldEx *_dispWorld): 
+				MapDisplay(_viewer, _snapMap, _dispWorld), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(MapSnapshot const &_snapMap) {}
 			void render() {}
 	};
 
@@ -60,9 +60,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			RobotEx(ViewerAbstract *_viewer, rtslam::RobotAbstract *_slamRob, MapEx *_dispMap): 
-				RobotDisplay(_viewer, _slamRob, _dispMap), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			RobotEx(ViewerAbstract *_viewer, RobotSnapshot const &_snapRob, MapEx *_dispMap): 
+				RobotDisplay(_viewer, _snapRob, _dispMap), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(RobotSnapshot const &_snapRob) {}
 			void render() {}
 	};
 
@@ -70,9 +70,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			SensorEx(ViewerAbstract *_viewer, rtslam::SensorExteroAbstract *_slamSen, RobotEx *_dispRob): 
-				SensorDisplay(_viewer, _slamSen, _dispRob), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			SensorEx(ViewerAbstract *_viewer, SensorSnapshot const &_snapSen, RobotEx *_dispRob): 
+				SensorDisplay(_viewer, _snapSen, _dispRob), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(SensorSnapshot const &_snapSen) {}
 			void render() {}
 	};
 
@@ -80,9 +80,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			LandmarkEx(ViewerAbstract *_viewer, rtslam::LandmarkAbstract *_slamLmk, MapEx *_dispMap): 
-				LandmarkDisplay(_viewer, _slamLmk, _dispMap), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			LandmarkEx(ViewerAbstract *_viewer, LandmarkSnapshot const &_snapLmk, MapEx *_dispMap): 
+				LandmarkDisplay(_viewer, _snapLmk, _dispMap), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(LandmarkSnapshot const &_snapLmk) {}
 			void render() {}
 	};
 
@@ -90,9 +90,9 @@ namespace display {
 	{
 			ViewerEx *viewerEx;
 		public:
-			ObservationEx(ViewerAbstract *_viewer, rtslam::ObservationAbstract *_slamObs, SensorEx *_dispSen): 
-				ObservationDisplay(_viewer, _slamObs, _dispSen), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
-			void bufferize() {}
+			ObservationEx(ViewerAbstract *_viewer, ObservationSnapshot const &_snapObs, SensorEx *_dispSen): 
+				ObservationDisplay(_viewer, _snapObs, _dispSen), viewerEx(PTR_CAST<ViewerEx*>(_viewer)) {}
+			void bufferize(ObservationSnapshot const &_snapObs) {}
 			void render() {}
 	};
 
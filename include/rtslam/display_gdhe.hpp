@@ -11,7 +11,11 @@
 #ifdef HAVE_MODULE_GDHE
 
 #include "rtslam/display.hpp"
+#include "rtslam/gdheCommandStream.hpp"
 #include "gdhe/client.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <boost/bind.hpp>
 
 /*
 TODO:
@@ -30,6 +34,7 @@ TODO:
 - [ok] add id
 - [ok] find why some euclidean ellipses are not toward the camera...
 - [ok] set robot ellipse
+- [ok] batch the commands of a refresh and only send the objects that changed
 */
 
 
@@ -44,6 +49,11 @@ namespace display {
 	class LandmarkGdhe;
 	class ObservationGdhe;
 
+	/**
+	The gdhe objects are not registered in the client, that would send each one
+	at each refresh: their scripts go through a GdheCommandStream, that sends
+	the ones that changed in a few scripts at the end of render.
+	*/
 	class ViewerGdhe: public Viewer<WorldGdhe,MapGdhe,RobotGdhe,SensorGdhe,LandmarkGdhe,ObservationGdhe,
 	                                boost::variant<gdhe::Object*> >
 	{
@@ -52,21 +62,59 @@ namespace display {
 			std::string robot_model;
 			gdhe::Client client;
 			double extent;
+			GdheCommandStream stream;
+			ViewRefresh view_refresh; ///< rate and render time of the 3d view
+		private:
+			GdheCommandStream::Sender sender;
+			void sendToClient(std::string const &script) { client.eval(script); }
 		public:
 			ViewerGdhe(std::string _robot_model = "", double _ellipsesScale = 3.0, std::string _host="localhost"):
 				ellipsesScale(_ellipsesScale), robot_model(_robot_model), client(_host)
 			{
+				sender = boost::bind(&ViewerGdhe::sendToClient, this, _1);
 				client.launch_server();
 				client.connect();
 				client.clear();
 				client.setCameraTarget(0.04,0,0.15);
 				client.setCameraPos(80, 20, 0.5);
 			}
+			~ViewerGdhe() { removeAll(); }
 			void setConvertTempPath(std::string path) { client.setConvertTempPath(path); }
 			void dump(std::string filename)
 			{
 				client.dump(filename);
 			}
+			/// sends the scripts somewhere else than to the client, eg to a GdheStubServer to measure the refresh
+			void setSender(GdheCommandStream::Sender const &_sender) { sender = _sender; }
+
+			/// a name for the new object in the scene
+			std::string addObject(std::string const &prefix) { return stream.newName(prefix); }
+			/// the object will be sent at the end of render if it changed
+			void refresh(std::string const &name, gdhe::Object *object) { stream.update(name, object->construct_string()); }
+			/// removes the object from the scene and destroys it
+			void releaseObject(std::string const &name, gdhe::Object *object)
+			{
+				if (object == NULL) return;
+				stream.remove(name);
+				release(object);
+			}
+
+			/**
+			Renders the scene if it is due (see ViewRefresh), the landmarks that
+			changed in the skipped snapshots are sent at the next render.
+			@param force for instance to render all the frames
+			*/
+			void render(bool force = false)
+			{
+				double now = kernel::Clock::getTime();
+				if (!view_refresh.due(now, force)) return;
+				view_refresh.begin(now);
+				Viewer<WorldGdhe,MapGdhe,RobotGdhe,SensorGdhe,LandmarkGdhe,ObservationGdhe,boost::variant<gdhe::Object*> >::render();
+				stream.flush(sender);
+				view_refresh.end(kernel::Clock::getTime());
+			}
+			/// statistics of the last refresh
+			GdheCommandStream::Stats const& lastRefresh() const { return stream.lastStats(); }
 	};
 
 
@@ -74,22 +122,21 @@ namespace display {
 	{
 			ViewerGdhe *viewerGdhe;
 		public:
-			WorldGdhe(ViewerAbstract *viewer_, rtslam::WorldAbstract *_slamWor, WorldDisplay *garbage);
-			void bufferize() {}
+			WorldGdhe(ViewerAbstract *viewer_, WorldSnapshot const &_snapWor, WorldDisplay *garbage);
+			void bufferize(WorldSnapshot const &_snapWor) {}
 			void render() {}
 	};
 
 	class MapGdhe : public MapDisplay
 	{
-			// bufferized data
-			jblas::vec poseQuat;
 			// gdhe objects
 			ViewerGdhe *viewerGdhe;
 			gdhe::Frame *frame;
+			std::string frameName;
 		public:
-			MapGdhe(ViewerAbstract *viewer_, rtslam::MapAbstract *_slamMap, WorldGdhe *_dispWorld);
+			MapGdhe(ViewerAbstract *viewer_, MapSnapshot const &_snapMap, WorldGdhe *_dispWorld);
 			~MapGdhe();
-			void bufferize();
+			void bufferize(MapSnapshot const &_snapMap) {}
 			void render();
 	};
 
@@ -103,10 +150,17 @@ namespace display {
 			gdhe::Robot *robot;
 			gdhe::EllipsoidWire *uncertEll;
 			gdhe::Trajectory *traj;
+			std::string robotName, uncertEllName, trajName;
+			/// the trajectory is cut in pieces of trajChunkSize points, that are not sent anymore once complete
+			static const unsigned trajChunkSize = 100;
+			unsigned trajPoints;
+			jblas::vec3 lastTrajPoint;
+			typedef std::list<std::pair<std::string, gdhe::Trajectory*> > TrajList;
+			TrajList trajChunks;
 		public:
-			RobotGdhe(ViewerAbstract *viewer_, rtslam::RobotAbstract *_slamRob, MapGdhe *_dispMap);
+			RobotGdhe(ViewerAbstract *viewer_, RobotSnapshot const &_snapRob, MapGdhe *_dispMap);
 			~RobotGdhe();
-			void bufferize();
+			void bufferize(RobotSnapshot const &_snapRob);
 			void render();
 	};
 
@@ -114,8 +168,8 @@ namespace display {
 	{
 			ViewerGdhe *viewerGdhe;
 		public:
-			SensorGdhe(ViewerAbstract *viewer_, rtslam::SensorExteroAbstract *_slamSen, RobotGdhe *_dispRob);
-			void bufferize() {}
+			SensorGdhe(ViewerAbstract *viewer_, SensorSnapshot const &_snapSen, RobotGdhe *_dispRob);
+			void bufferize(SensorSnapshot const &_snapSen) {}
 			void render() {}
 	};
 
@@ -131,16 +185,27 @@ namespace display {
 */		
 			jblas::vec state_;
 			jblas::sym_mat cov_;
+			jblas::vec eucState_; // euclidean parametrization, if not euclidean
+			jblas::sym_mat eucCov_;
+#ifdef HAVE_MODULE_DSEG
+			float left_extremity_, right_extremity_;
+#endif
 			unsigned int id_;
 			LandmarkAbstract::type_enum lmkType_;
+			uint64_t stamp_; ///< of the last bufferized snapshot
+			bool changed_; ///< since the last render
 			// gdhe objects
 			ViewerGdhe *viewerGdhe;
 			typedef std::list<gdhe::Object*> ItemList;
 			ItemList items_;
+			std::list<std::string> names_;
+			void addItem(gdhe::Object *item);
+			/// removes the objects from the scene, before building them again
+			void clearItems();
 		public:
-			LandmarkGdhe(ViewerAbstract *viewer_, rtslam::LandmarkAbstract *_slamLmk, MapGdhe *_dispMap);
+			LandmarkGdhe(ViewerAbstract *viewer_, LandmarkSnapshot const &_snapLmk, MapGdhe *_dispMap);
 			~LandmarkGdhe();
-			void bufferize();
+			void bufferize(LandmarkSnapshot const &_snapLmk);
 			void render();
 	};
 
@@ -148,8 +213,8 @@ namespace display {
 	{
 			ViewerGdhe *viewerGdhe;
 		public:
-			ObservationGdhe(ViewerAbstract *viewer_, rtslam::ObservationAbstract *_slamObs, SensorGdhe *_dispSen);
-			void bufferize() {}
+			ObservationGdhe(ViewerAbstract *viewer_, ObservationSnapshot const &_snapObs, SensorGdhe *_dispSen);
+			void bufferize(ObservationSnapshot const &_snapObs) {}
 			void render() {}
 	};
 
@@ -19,14 +19,12 @@
 
 #include "rtslam/display.hpp"
 #include "rtslam/rawImage.hpp"
+#include "rtslam/frameEncoder.hpp"
 
 #include "jmath/misc.hpp"
 
 #define DEFINE_USELESS_OBJECTS 1
 
-// FIXME for EMBED_PREDICTED_APP: the image is modified (in obs) after it is displayed (in sensor)...
-#define EMBED_PREDICTED_APP 0
-
 namespace jafar {
 namespace rtslam {
 namespace display {
@@ -61,12 +59,33 @@ class ViewerQt: public Viewer<WorldQt,MapQt,RobotQt,SensorQt,LandmarkQt,Observat
 		double ellipsesScale;
 		bool doDump;
 		std::string dump_pattern; // pattern with %d for sensor id and frame id
-		std::map<int,SensorQt*> sensorsList;
+		typedef DisplayObjectList<ObservationQt>::Objects ObservationObjects;
+	private:
+		double view_rate; ///< default rate of the sensor views
+		std::map<unsigned, double> view_rates; ///< rate of some sensor views
 	public:
 		ViewerQt(int _fontSize = 8, double _ellipsesScale = 3.0, bool _dump = false, std::string _dump_pattern = "data/rendered2D_%02d-%06d.png"): 
-			fontSize(_fontSize), ellipsesScale(_ellipsesScale), doDump(_dump), dump_pattern(_dump_pattern) {}
+			fontSize(_fontSize), ellipsesScale(_ellipsesScale), doDump(_dump), dump_pattern(_dump_pattern), view_rate(0.) {}
 		void dump(std::string filepattern); // pattern with %d for sensor id
+		/// grabs the views rendered last and gives them to encoder, that writes them in its thread
+		void record(FrameEncoder &encoder, unsigned frame);
 		static RunStatus runStatus;
+		
+		/// maximal rate (Hz) of the views of the sensors, 0 to render each snapshot
+		void setViewRate(double rate) { view_rate = rate; }
+		/// maximal rate (Hz) of the view of sensor sensor_id
+		void setViewRate(unsigned sensor_id, double rate) { view_rates[sensor_id] = rate; }
+		double viewRate(unsigned sensor_id) const
+		{
+			std::map<unsigned, double>::const_iterator it = view_rates.find(sensor_id);
+			return (it == view_rates.end() ? view_rate : it->second);
+		}
+		/**
+		Renders the views of the sensors that are due (see ViewRefresh), each one
+		with its observations.
+		@param force render all of them, for instance to render all the frames
+		*/
+		void render(bool force = false);
 };
 #else
 #error "does not work"
@@ -86,8 +105,8 @@ class WorldQt : public WorldDisplay
 {
 		ViewerQt *viewerQt;
 	public:
-		WorldQt(ViewerAbstract *_viewer, rtslam::WorldAbstract *_slamWor, WorldDisplay *garbage);
-		void bufferize() {}
+		WorldQt(ViewerAbstract *_viewer, WorldSnapshot const &_snapWor, WorldDisplay *garbage);
+		void bufferize(WorldSnapshot const &_snapWor) {}
 		void render() {}
 };
 
@@ -98,8 +117,8 @@ class MapQt : public MapDisplay
 {
 		ViewerQt *viewerQt;
 	public:
-		MapQt(ViewerAbstract *_viewer, rtslam::MapAbstract *_slamMap, WorldQt *_dispWorld);
-		void bufferize() {}
+		MapQt(ViewerAbstract *_viewer, MapSnapshot const &_snapMap, WorldQt *_dispWorld);
+		void bufferize(MapSnapshot const &_snapMap) {}
 		void render() {}
 };
 
@@ -115,8 +134,8 @@ class RobotQt : public RobotDisplay
 		//std::string model3d_;
 		// graphical objects
 	public:
-		RobotQt(ViewerAbstract *_viewer, rtslam::RobotAbstract *_slamRob, MapQt *_dispMap);
-		void bufferize() {}
+		RobotQt(ViewerAbstract *_viewer, RobotSnapshot const &_snapRob, MapQt *_dispMap);
+		void bufferize(RobotSnapshot const &_snapRob) {}
 		void render() {}
 };
 #endif
@@ -131,7 +150,7 @@ class SensorQt : public QObject, public SensorDisplay
 		ViewerQt *viewerQt;
 	public:
 		// buffered data
-		image::Image image;
+		jafarImage_ptr_t image; // shared with the snapshots, not modified
 		unsigned framenumber;
 		double avg_framerate;
 		double t;
@@ -145,12 +164,15 @@ class SensorQt : public QObject, public SensorDisplay
 		QGraphicsTextItem* framenumber_label;
 		QGraphicsTextItem* sensorpose_label;
 		qdisplay::ImageView* view();
+		ViewRefresh refresh_; ///< rate and render time of its view
 	public:
-		SensorQt(ViewerAbstract *_viewer, rtslam::SensorExteroAbstract *_slamSen, RobotQt *_dispRob);
+		SensorQt(ViewerAbstract *_viewer, SensorSnapshot const &_snapSen, RobotQt *_dispRob);
 		~SensorQt();
-		void bufferize();
+		void bufferize(SensorSnapshot const &_snapSen);
 		void render();
 		void dump(std::string filename);
+		/// the view as rendered, in a new BGR image
+		cv::Mat grab();
 	public slots:
 		void onKeyPress(QKeyEvent *event);
 		void onMouseClick(QGraphicsSceneMouseEvent *mouseEvent, bool isClick);
@@ -168,8 +190,8 @@ class LandmarkQt : public LandmarkDisplay
 		// jmath::vec data_;
 		// graphical objects
 	public:
-		LandmarkQt(ViewerAbstract *_viewer, rtslam::LandmarkAbstract *_slamLmk, MapQt *_dispMap);
-		void bufferize() {}
+		LandmarkQt(ViewerAbstract *_viewer, LandmarkSnapshot const &_snapLmk, MapQt *_dispMap);
+		void bufferize(LandmarkSnapshot const &_snapLmk) {}
 		void render() {}
 };
 #endif
@@ -191,20 +213,22 @@ class ObservationQt : public ObservationDisplay
 		jblas::vec predObs_;
 		jblas::sym_mat predObsCov_;
 		jblas::vec measObs_;
-#if EMBED_PREDICTED_APP
-		AppearanceAbstract *predictedApp_;
+#ifdef HAVE_MODULE_DSEG
+		jblas::vec4 realObs_;
 #endif
 		unsigned int id_;
 		double match_score;
+		uint64_t stamp_; ///< of the last bufferized snapshot
+		bool changed_; ///< since the last render
 		// TODO grid
 		// graphical objects
 		SensorQt *dispSen_; // not owner
 		typedef std::list<qdisplay::Shape*> ItemList;
       ItemList items_;
    public:
-		ObservationQt(ViewerAbstract *_viewer, rtslam::ObservationAbstract *_slamObs, SensorQt *_dispSen);
+		ObservationQt(ViewerAbstract *_viewer, ObservationSnapshot const &_snapObs, SensorQt *_dispSen);
 		~ObservationQt();
-		void bufferize();
+		void bufferize(ObservationSnapshot const &_snapObs);
 		void render();
 };
 
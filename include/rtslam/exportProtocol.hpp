@@ -0,0 +1,129 @@
+/**
+ * \file exportProtocol.hpp
+ *
+ * Header file for the binary protocol of the state exporter (see ExporterSocket).
+ *
+ * Each message is made of a fixed header followed by the payload :
+ * - header (48 bytes) : magic "RTSE", u16 version, u16 type, u32 message size,
+ *   u32 flags, u64 sequence number, f64 state date, f64 export date,
+ *   u32 robot id, u32 robot state size n
+ * - mean : n f64, robot state with the position in the export frame (p q v...)
+ * - covariance (flagCovariance) : n(n+1)/2 f64, upper triangle row by row
+ * Values are in the byte order of the host (little endian on all supported platforms),
+ * without padding. The sequence number is incremented for each message built by an
+ * exporter, so that clients can detect the messages dropped for them.
+ *
+ * The map is sent incrementally in messages of their own (n = 0), after the state
+ * of the same filter update :
+ * - u64 map sequence number, u32 count, then for each landmark u32 operation,
+ *   u32 id, u32 landmark type (LandmarkAbstract::type_enum), u32 size m,
+ *   m f64 for the euclidean parameters and m(m+1)/2 f64 for their covariance
+ *   (m = 0 for a deletion).
+ * A delta (typeMapDelta) with map sequence number k applies to the map of number k-1,
+ * a keyframe (typeMapKeyframe) gives the whole map of number k (all operations are
+ * opAdd). A client joining late, or that missed a map message, waits for the next keyframe.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef EXPORT_PROTOCOL_HPP_
+#define EXPORT_PROTOCOL_HPP_
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/jblas.hpp"
+
+
+namespace jafar {
+namespace rtslam {
+
+	namespace exportproto {
+		enum MessageType { typeState = 1, typePropagatedState = 2, typeMapKeyframe = 3, typeMapDelta = 4 };
+		enum Flags { flagCovariance = 1 };
+		enum LandmarkOperation { opAdd = 1, opUpdate = 2, opReparametrize = 3, opDelete = 4 };
+
+		const char magic[4] = { 'R','T','S','E' };
+		const uint16_t version = 2;
+		const unsigned headerSize = 48;
+		const unsigned sizeOffset = 8; ///< position of the message size in the header
+		const unsigned seqOffset = 16; ///< position of the sequence number in the header
+	}
+
+	typedef boost::shared_ptr<const std::vector<char> > export_message_ptr_t;
+
+	/**
+	Decoded message, see exportproto for the content.
+	*/
+	struct ExportMessage
+	{
+		struct Landmark
+		{
+			unsigned op;   ///< exportproto::LandmarkOperation
+			unsigned id;
+			unsigned type; ///< LandmarkAbstract::type_enum
+			std::vector<double> x;
+			std::vector<double> P; ///< upper triangle
+		};
+		uint16_t version;
+		uint16_t type;
+		uint32_t flags;
+		uint64_t seq;
+		double time;
+		double export_date;
+		unsigned robot;
+		std::vector<double> x;
+		std::vector<double> P; ///< upper triangle, empty without flagCovariance
+		uint64_t map_seq;      ///< for the map messages
+		std::vector<Landmark> landmarks;
+	};
+
+
+	/**
+	Builds a message, the parts being added in the order of the protocol.
+	*/
+	class ExportMessageBuilder
+	{
+		private:
+			std::vector<char> *buf;
+			export_message_ptr_t msg;
+			template<typename T> void put(T v)
+				{ size_t s = buf->size(); buf->resize(s+sizeof(T)); memcpy(&(*buf)[s], &v, sizeof(T)); }
+			void putSymUpper(jblas::sym_mat const &P);
+		public:
+			/// starts a new message, with its header and the mean (positions already in the export frame)
+			ExportMessageBuilder(uint16_t type, uint32_t flags, uint64_t seq, double time, double export_date,
+				unsigned robot, jblas::vec const &x);
+			void addCovariance(jblas::sym_mat const &P);
+			/// changes the sequence number given to the constructor, before finish
+			void setSeq(uint64_t seq) { memcpy(&(*buf)[exportproto::seqOffset], &seq, sizeof(seq)); }
+			/// starts the map of a typeMapKeyframe or typeMapDelta message
+			void beginLandmarks(uint64_t map_seq, unsigned count);
+			void addLandmark(unsigned op, unsigned id, unsigned type, jblas::vec const &x, jblas::sym_mat const &P);
+			void addLandmarkDeletion(unsigned id, unsigned type);
+			/// completes the header, and returns the message, that cannot be modified anymore
+			export_message_ptr_t finish();
+	};
+
+	/**
+	Decodes a full message.
+	@return false if the message is invalid (magic, version, size)
+	*/
+	bool decodeExportMessage(const char *data, size_t size, ExportMessage &msg);
+
+	/**
+	Reads the size of the message from its header, so that a client can read
+	the whole message from a stream.
+	@return 0 if the header is invalid
+	*/
+	size_t exportMessageSize(const char *header);
+
+}}
+
+#endif
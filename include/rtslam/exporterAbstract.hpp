@@ -25,6 +25,13 @@ namespace rtslam {
 		public:
 			ExporterAbstract(robot_ptr_t robPtr): robPtr(robPtr) {}
 			virtual void exportCurrentState() = 0;
+			/**
+			Export a robot state propagated without the filter between two updates
+			(see PosePropagator), only the mean being available.
+			@param time the date of the state
+			@param x the robot state
+			*/
+			virtual void exportPropagatedState(double time, jblas::vec const &x) {}
 			virtual void stop() {}
 	};
 	
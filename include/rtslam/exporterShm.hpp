@@ -0,0 +1,80 @@
+/**
+ * \file exporterShm.hpp
+ *
+ * Header file for the state exporter in shared memory
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef EXPORTER_SHM_HPP_
+#define EXPORTER_SHM_HPP_
+
+#include <boost/thread/mutex.hpp>
+
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/exporterAbstract.hpp"
+#include "rtslam/shmPose.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+	/**
+	Publishes the latest robot state in a shared memory segment (see ShmPoseWriter),
+	without any copy or system call for the readers, and without ever waiting
+	for them. Only the last state is available, readers that need all of them
+	must use ExporterSocket.
+	*/
+	class ExporterShm: public ExporterAbstract
+	{
+		protected:
+			shm_pose_writer_ptr_t writer;
+			boost::mutex mutex_write; ///< the filter and the pose propagator may export at the same time
+			jblas::vec x;
+
+			void toExportFrame()
+			{
+				for(int i = 0; i < 3; ++i) x(i) += robPtr->origin_sensors(i) - robPtr->origin_export(i);
+			}
+
+		public:
+			/// @param name name of the segment, eg "/rtslam_pose"
+			ExporterShm(robot_ptr_t robPtr, std::string const &name): ExporterAbstract(robPtr)
+			{
+				writer = ShmPoseWriter::create(name, robPtr->state.size());
+			}
+
+			virtual void exportCurrentState()
+			{
+				boost::unique_lock<boost::mutex> l(mutex_write);
+				if (!writer) return;
+				x = robPtr->state.x();
+				toExportFrame();
+				jblas::sym_mat P = robPtr->state.P();
+				writer->write(shmpose::typeState, robPtr->id(), robPtr->self_time, kernel::Clock::getTime(), x, &P);
+			}
+
+			/// the covariance stays the one of the last filter update
+			virtual void exportPropagatedState(double time, jblas::vec const &x_)
+			{
+				boost::unique_lock<boost::mutex> l(mutex_write);
+				if (!writer) return;
+				x = x_;
+				toExportFrame();
+				writer->write(shmpose::typePropagatedState, robPtr->id(), time, kernel::Clock::getTime(), x, NULL);
+			}
+
+			/// the segment is removed, readers see that it is closed
+			virtual void stop()
+			{
+				boost::unique_lock<boost::mutex> l(mutex_write);
+				writer.reset();
+			}
+	};
+
+}}
+
+#endif
@@ -1,5 +1,5 @@
 /**
- * \file exporterAbstract.hpp
+ * \file exporterSocket.hpp
  *
  * Header file state exporter on a network socket
  *
@@ -13,122 +13,130 @@
 #ifndef EXPORTER_SOCKET_HPP_
 #define EXPORTER_SOCKET_HPP_
 
+#include <deque>
+#include <list>
+
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
 
-#include "kernel/threads.hpp"
-
 #include "rtslam/exporterAbstract.hpp"
+#include "rtslam/exportProtocol.hpp"
+#include "rtslam/landmarkExportTracker.hpp"
 
 namespace jafar {
 namespace rtslam {
 
-	
+
 	using boost::asio::ip::tcp;
 	typedef boost::shared_ptr<tcp::socket> socket_ptr;
-	
+
+	/**
+	Bounded queue of the messages waiting to be sent to one client.
+	When it is full the oldest message is dropped, so that a slow client
+	receives the most recent states and never blocks the filter.
+	*/
+	class ExportClientQueue
+	{
+		private:
+			boost::mutex mutex;
+			boost::condition_variable cond;
+			std::deque<export_message_ptr_t> messages;
+			size_t capacity;
+			bool closed;
+			unsigned dropped_;
+		public:
+			ExportClientQueue(size_t capacity): capacity(capacity), closed(false), dropped_(0) {}
+			/// @return false if the oldest message had to be dropped
+			bool push(export_message_ptr_t const &msg);
+			/**
+			Waits for the next message.
+			@return false if the queue was closed
+			*/
+			bool pop(export_message_ptr_t &msg);
+			/// wakes up and terminates pop, the remaining messages are discarded
+			void close();
+			unsigned dropped() { boost::unique_lock<boost::mutex> l(mutex); return dropped_; }
+			size_t size() { boost::unique_lock<boost::mutex> l(mutex); return messages.size(); }
+	};
+
+
+	/**
+	Exports the robot state to the clients connected on a tcp port, with the
+	protocol described in exportproto.
+	The message is built once in the filter thread and added to the queue of
+	each client, that has its own thread to send it, so that a slow or stalled
+	client only loses its own oldest messages (the gap of the sequence numbers
+	tells it how many).
+	The map can be exported too, incrementally (see LandmarkExportTracker), with
+	a keyframe of the whole map periodically and when a new client connects.
+	*/
 	class ExporterSocket: public ExporterAbstract
 	{
 		protected:
-			void connectionTask()
-			{
-				boost::asio::io_service io_service;
-				tcp::acceptor a(io_service, tcp::endpoint(tcp::v4(), port));
-				while (true)
-				{
-					// wait for new connection
-					socket_ptr mysock(new tcp::socket(io_service));
-					a.accept(*mysock);
-					std::cout << "ExporterSocket: new client connected." << std::endl;
-					
-					boost::unique_lock<boost::mutex> l(mutex_data);
-					socks.push_back(mysock);
-				}
-				
-			}
-	
-			void sendTask()
+			struct Client
 			{
-				bool stop = false;
-				while (!stop)
-				{
-					condition_send.wait(boost::lambda::_1 != 0, false);
-					if (condition_send.var < 0) stop = true;
-					condition_send.var = 0;
-					condition_send.unlock();
-					if (stop) break;
-					
-					boost::unique_lock<boost::mutex> l(mutex_data);
-					bool remove_sock = false;
-					for(std::vector<socket_ptr>::iterator it = socks.begin(); it != socks.end(); it = (remove_sock ? socks.erase(it) : it+1))
-					{
-						remove_sock = false;
-						try {
-							boost::asio::write(**it, boost::asio::buffer(message, message_size*sizeof(double)));
-						} catch (std::exception &e)
-						{
-							std::cout << "client disconnected" << std::endl;
-							remove_sock = true;
-						}
-					}
-				}
-			}
-			
-			boost::mutex mutex_data;
-			kernel::VariableCondition<int> condition_send;
-			
-			static const int message_size = 36;
-			short port;
-			std::vector<socket_ptr> socks;
-			double message[message_size];
-			
+				socket_ptr sock;
+				ExportClientQueue queue;
+				boost::thread *thread;
+				bool dead; ///< the connection was lost, set by its thread
+				unsigned sent;
+				Client(socket_ptr sock, size_t queue_size): sock(sock), queue(queue_size), thread(NULL), dead(false), sent(0) {}
+			};
+			typedef boost::shared_ptr<Client> client_ptr_t;
+
+			void connectionTask();
+			void clientTask(client_ptr_t client);
+			/// position in the export frame of the 3d points of v from position pos
+			void toExportFrame(jblas::vec &v, size_t pos, size_t npoints);
+			/**
+			Gives the message its sequence number and adds it to the queues of the clients, together,
+			so that the clients get the messages of the filter and of the propagation in sequence order.
+			*/
+			void broadcast(ExportMessageBuilder &builder);
+			bool isStopping() { boost::unique_lock<boost::mutex> l(mutex_clients); return stopping; }
+			void exportMap();
+
+			unsigned short port;
+			bool with_map;
+			size_t queue_size;
+			uint64_t seq; ///< protected by mutex_clients
+
+			LandmarkExportTracker tracker;
+			unsigned keyframe_period;
+			unsigned updates_since_keyframe;
+			bool keyframe_requested; ///< a client connected, protected by mutex_clients
+			uint64_t map_seq;
+			std::vector<LandmarkExportTracker::Change> changes;
+
+			boost::asio::io_service io_service;
+			tcp::acceptor acceptor;
+			boost::thread *connection_thread;
+			boost::mutex mutex_clients;
+			std::list<client_ptr_t> clients;
+			bool stopping;
+			unsigned nclients, nlost;
+
 		public:
-			ExporterSocket(robot_ptr_t robPtr, short port): ExporterAbstract(robPtr),
-				condition_send(0), port(port)
-			{
-				boost::thread thread_connection(boost::bind(&ExporterSocket::connectionTask, this));
-				boost::thread thread_send(boost::bind(&ExporterSocket::sendTask, this));
-			}
-			
-			virtual void exportCurrentState()
-			{
-				if (mutex_data.try_lock())
-				{
-					// FIXME works only for inertial, should be fixed with the general state framework
-					/*
-					(1 double)   time
-					(16 double) pos(x,y,z) quat(qw,qx,qy,qz) euler(yaw,pitch,roll)
-					vel(vx,vy,vz) avel(vyaw,vpitch,vroll)
-					(16 double) variances
-					
-					robot : p q v ab wb g
-					*/
-					jblas::vec &state = robPtr->mapPtr()->filterPtr->x();
-					jblas::sym_mat &stateCov = robPtr->mapPtr()->filterPtr->P();
-					message[0] = robPtr->self_time;
-					for(int i = 0; i < 3; ++i) message[i+1] = state(i)+robPtr->origin_sensors(i)-robPtr->origin_export(i);
-					for(int i = 3; i < 7; ++i) message[i+1] = state(i);
-					jblas::vec3 euler = quaternion::q2e(ublas::subrange(state,3,7));
-					for(int i = 7; i < 10; ++i) message[i+1] = euler(i-7);
-					std::swap(message[7+1], message[9+1]); // convention roll/pitch/yaw to yaw/pitch/roll
-					for(int i = 10; i < 13; ++i) message[i+1] = state(i-3);
-					for(int i = 13; i < 16; ++i) message[i+1] = 0.; // TODO get value from MTI, with some "non filtered state" feature
-					
-					for(int i = 0; i < 7; ++i) message[i+1+17] = sqrt(stateCov(i,i));
-					for(int i = 7; i < 10; ++i); //TODO euler cov
-					for(int i = 10; i < 13; ++i) message[i+1+17] = sqrt(stateCov(i-3,i-3));
-					for(int i = 13; i < 16; ++i) message[i+1+17] = 0.; // TODO get value from MTI, with some "non filtered state" feature
-					
-					mutex_data.unlock();
-					condition_send.setAndNotify(1);
-				} else
-					std::cout << "ExporterSocket: not finished sending previous message, connect less clients!" << std::endl;
-			}
-			
-			virtual void stop() { condition_send.setAndNotify(-1); }
+			/**
+			@param port the tcp port on which clients can connect
+			@param with_map also export the changes of the map after each filter update
+			@param queue_size maximal number of messages waiting for each client
+			@param keyframe_period number of filter updates between two keyframes of the map
+			*/
+			ExporterSocket(robot_ptr_t robPtr, unsigned short port, bool with_map = false, size_t queue_size = 64, unsigned keyframe_period = 50);
+			~ExporterSocket();
+
+			/// the robot state and covariance after a filter update, and the map if required
+			virtual void exportCurrentState();
+			/// only the mean of the state propagated between two filter updates
+			virtual void exportPropagatedState(double time, jblas::vec const &x);
+			/// closes the connections, after which nothing is exported anymore
+			virtual void stop();
+
+			size_t nConnected() { boost::unique_lock<boost::mutex> l(mutex_clients); return clients.size(); }
 	};
-	
+
 
 }}
 
@@ -0,0 +1,132 @@
+/**
+ * \file frameEncoder.hpp
+ *
+ * Header file for the encoder that writes the frames rendered by the displays
+ * in a background thread, as images or as a video.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef FRAME_ENCODER_HPP_
+#define FRAME_ENCODER_HPP_
+
+#include <deque>
+#include <map>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include <boost/thread.hpp>
+
+#include <opencv/cv.h>
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+	/**
+	Minimal avi writer, with one MJPEG video stream (each frame is a jpeg image)
+	and the index, readable without any other tool than a video player.
+	All the frames have the size of the first one.
+	*/
+	class AviMjpegWriter
+	{
+		private:
+			std::ofstream f;
+			double fps;
+			int quality;
+			int width, height;
+			unsigned nframes;
+			uint32_t max_frame_size;
+			std::streamoff riff_size_pos, avih_pos, strh_length_pos, movi_size_pos, movi_pos;
+			std::vector<uint32_t> index; ///< offset and size of each frame from movi
+			std::vector<uchar> jpeg;
+			std::vector<int> params;
+
+			void writeHeaders();
+			void write32(uint32_t v) { f.write((const char*)&v, 4); }
+			void write16(uint16_t v) { f.write((const char*)&v, 2); }
+			void writeFourcc(const char *c) { f.write(c, 4); }
+			void patch32(std::streamoff pos, uint32_t v);
+		public:
+			/**
+			@param fps the frame rate of the video
+			@param quality jpeg quality, from 0 to 100
+			*/
+			AviMjpegWriter(std::string const &filename, double fps, int quality = 90);
+			~AviMjpegWriter() { close(); }
+			/// encodes and appends a BGR image
+			void write(cv::Mat const &image);
+			/// writes the index and the sizes, after which nothing can be written anymore
+			void close();
+			unsigned nFrames() const { return nframes; }
+	};
+
+
+	/**
+	Writes the frames rendered by the displays in its own thread, so that
+	neither the display nor the slam waits for the encoding and the disk.
+	The frames wait in a bounded queue, and when it is full the new frames are
+	dropped and counted, so that the display is never slowed down.
+	Each view is written in its own files, either an image sequence or an avi
+	video (see AviMjpegWriter).
+	*/
+	class FrameEncoder
+	{
+		public:
+			enum Output { ImageSequence, MjpegAvi };
+		private:
+			struct Frame { unsigned view; unsigned number; cv::Mat image; std::string file; };
+			Output output;
+			std::string pattern;
+			double fps;
+			int quality;
+			size_t capacity;
+
+			boost::mutex mutex;
+			boost::condition_variable cond;
+			std::deque<Frame> queue;
+			bool stopping;
+			unsigned nwritten, ndropped;
+			boost::thread *thread;
+
+			std::map<unsigned, AviMjpegWriter*> videos; ///< for each view, only used by the thread
+
+			void encoderTask();
+			void encode(Frame &frame);
+		public:
+			/**
+			@param pattern the files of the frames, with %d for the view and %d for the
+			  frame number for an image sequence (whose extension gives the format), and
+			  with %d for the view for a video
+			@param fps the frame rate of the videos
+			@param capacity the number of frames that can wait to be written
+			*/
+			FrameEncoder(Output output, std::string const &pattern, double fps = 10., size_t capacity = 32, int quality = 90);
+			~FrameEncoder();
+			/**
+			Adds a frame, that must not be modified anymore (it is not copied).
+			@return false if the queue was full and the frame was dropped
+			*/
+			bool push(unsigned view, unsigned number, cv::Mat const &image);
+			/**
+			Adds a frame already written in an image file by another program, that is read
+			and removed by the thread of the encoder.
+			@return false if the queue was full and the frame was dropped (and the file removed)
+			*/
+			bool pushFile(unsigned view, unsigned number, std::string const &file);
+			/// writes the frames still in the queue and closes the videos
+			void stop();
+
+			unsigned written() { boost::unique_lock<boost::mutex> l(mutex); return nwritten; }
+			unsigned dropped() { boost::unique_lock<boost::mutex> l(mutex); return ndropped; }
+			size_t waiting() { boost::unique_lock<boost::mutex> l(mutex); return queue.size(); }
+	};
+
+}}}
+
+#endif
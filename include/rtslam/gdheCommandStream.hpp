@@ -0,0 +1,133 @@
+/**
+ * \file gdheCommandStream.hpp
+ *
+ * Header file for the stream of commands sent to the gdhe 3d display, that
+ * aggregates the changes of a refresh in a few scripts.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef GDHE_COMMAND_STREAM_HPP_
+#define GDHE_COMMAND_STREAM_HPP_
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+	/**
+	Commands of a gdhe scene, where each object is an entry of the "robots"
+	array of gdhe, whose script is evaluated at each redraw.
+	The objects set their script at each refresh, but only the ones that
+	differ from what was last sent are kept, and they are all sent with the
+	removed objects at flush, aggregated in scripts of bounded size followed
+	by a single redraw, instead of one evaluation (and one redraw) per object.
+	*/
+	class GdheCommandStream
+	{
+		public:
+			typedef boost::function<void(std::string const&)> Sender;
+			struct Stats
+			{
+				unsigned updated;   ///< objects sent
+				unsigned unchanged; ///< objects refreshed with the script already sent
+				unsigned removed;
+				unsigned messages;  ///< scripts sent
+				size_t bytes;
+				double duration;    ///< of the flush (s)
+				Stats() { clear(); }
+				void clear() { updated = unchanged = removed = messages = 0; bytes = 0; duration = 0.; }
+				void add(Stats const &s);
+			};
+		private:
+			size_t max_message_size;
+			unsigned nnames;
+			std::map<std::string, std::string> sent; ///< the last script sent for each object
+			std::map<std::string, std::string> pending; ///< the new scripts of the changed objects
+			std::set<std::string> removed;
+			Stats current, last, total;
+			unsigned nflushes;
+		public:
+			/**
+			@param max_message_size the scripts are split above this size (bytes), but not the commands
+			*/
+			GdheCommandStream(size_t max_message_size = 65536);
+
+			/// a name for a new object, never returned again
+			std::string newName(std::string const &prefix);
+			/// the script of the object, that will be sent at flush only if it changed
+			void update(std::string const &name, std::string const &script);
+			/// the object will be removed from the scene at flush
+			void remove(std::string const &name);
+			bool changed() const { return !pending.empty() || !removed.empty(); }
+			/**
+			Sends the changes since the last flush with send, if any.
+			@return the statistics of this flush
+			*/
+			Stats const& flush(Sender const &send);
+
+			Stats const& lastStats() const { return last; }
+			Stats const& totalStats() const { return total; }
+			unsigned nFlushes() const { return nflushes; }
+			size_t nObjects() const { return sent.size(); }
+	};
+
+
+	/**
+	Sends the scripts of a GdheCommandStream to a GdheStubServer, each one
+	terminated by a null char, and waits for its acknowledgement.
+	*/
+	class GdheSocketSender
+	{
+		private:
+			boost::asio::io_service io_service;
+			boost::asio::ip::tcp::socket sock;
+		public:
+			GdheSocketSender(std::string const &host, unsigned short port);
+			void send(std::string const &script);
+	};
+
+
+	/**
+	Local server that stands in for gdhe to measure the refresh of the display
+	without the rendering: it counts the scripts and the commands that it receives
+	from a GdheSocketSender and acknowledges each script, as gdhe answers each
+	evaluation. One client is served at a time.
+	*/
+	class GdheStubServer
+	{
+		private:
+			boost::asio::io_service io_service;
+			boost::asio::ip::tcp::acceptor acceptor;
+			boost::thread *thread;
+			unsigned short port;
+			boost::mutex mutex;
+			boost::shared_ptr<boost::asio::ip::tcp::socket> client;
+			bool stopping;
+			unsigned nmessages, ncommands;
+			size_t nbytes;
+			void serverTask();
+		public:
+			GdheStubServer(unsigned short port);
+			~GdheStubServer();
+			void stop();
+
+			unsigned messages() { boost::unique_lock<boost::mutex> l(mutex); return nmessages; }
+			/// number of lines received
+			unsigned commands() { boost::unique_lock<boost::mutex> l(mutex); return ncommands; }
+			size_t bytes() { boost::unique_lock<boost::mutex> l(mutex); return nbytes; }
+	};
+
+}}}
+
+#endif
@@ -12,26 +12,110 @@
 #ifndef HARDWARE_ESTIMATOR_ABSTRACT_HPP_
 #define HARDWARE_ESTIMATOR_ABSTRACT_HPP_
 
+#include <cstddef>
+#include <iterator>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "jmath/jblas.hpp"
+
 namespace jafar {
 namespace rtslam {
 namespace hardware {
 
+	/**
+		Read-only view on a sequence of readings stored in the ring buffer of an estimator,
+		without copying them. Readings are rows of the buffer, that may wrap around its end ;
+		each reading is accessed as a pointer to its first element (timestamp), followed
+		by the command.
+		The rows stay valid until the next call to acquireSpan or acquireReadings of the
+		estimator, that protects them from being overwritten until then.
+
+		\ingroup rtslam
+	*/
+	class ReadingSpan
+	{
+		private:
+			const double *data; ///< first element of the buffer
+			size_t nrows, ncols; ///< size of the buffer
+			size_t first, count; ///< first row of the span in the buffer and number of rows
+			double t1, t2; ///< requested interval
+		public:
+			ReadingSpan(): data(NULL), nrows(0), ncols(0), first(0), count(0), t1(0.), t2(0.) {}
+			ReadingSpan(const jblas::mat &buffer, size_t first, size_t count, double t1, double t2):
+				data(&buffer.data()[0]), nrows(buffer.size1()), ncols(buffer.size2()),
+				first(first), count(count), t1(t1), t2(t2) {}
+
+			class const_iterator
+			{
+				public:
+					typedef std::forward_iterator_tag iterator_category;
+					typedef const double* value_type;
+					typedef std::ptrdiff_t difference_type;
+					typedef const value_type* pointer;
+					typedef const value_type& reference;
+				private:
+					const ReadingSpan *span;
+					size_t i;
+				public:
+					const_iterator(const ReadingSpan *span, size_t i): span(span), i(i) {}
+					const double* operator*() const { return (*span)[i]; }
+					const_iterator& operator++() { ++i; return *this; }
+					const_iterator operator++(int) { const_iterator it = *this; ++i; return it; }
+					bool operator==(const const_iterator &it) const { return i == it.i; }
+					bool operator!=(const const_iterator &it) const { return i != it.i; }
+			};
+
+			size_t size() const { return count; }
+			bool empty() const { return count == 0; }
+			/// number of elements of a reading, timestamp included
+			size_t width() const { return ncols; }
+			double startTime() const { return t1; }
+			double endTime() const { return t2; }
+			const double* operator[](size_t i) const { size_t r = first+i; if (r >= nrows) r -= nrows; return data + r*ncols; }
+			const_iterator begin() const { return const_iterator(this, 0); }
+			const_iterator end() const { return const_iterator(this, count); }
+	};
+
+
 	class HardwareEstimatorAbstract;
 	typedef boost::shared_ptr<HardwareEstimatorAbstract> hardware_estimator_ptr_t;
 
 
 	class HardwareEstimatorAbstract
 	{
+		public:
+			/// called with each new reading (timestamp first, then the command), its size and its arrival date
+			typedef boost::function<void (const double *reading, size_t size, double arrival)> reading_callback_t;
 		protected:
 			bool started;
+			reading_callback_t reading_callback;
+			boost::mutex mutex_callback; ///< so that the callback is not changed while it is called
+			/// to be called by the acquisition thread once a reading is in the buffer, without holding the buffer lock
+			void notifyReading(const double *reading, size_t size, double arrival)
+				{ boost::unique_lock<boost::mutex> l(mutex_callback); if (reading_callback) reading_callback(reading, size, arrival); }
 		public:
 			HardwareEstimatorAbstract(): started(false) {}
 			/**
+			Be notified of each new reading as soon as it is acquired, in the acquisition thread,
+			for instance to propagate the pose at the rate of the readings (see PosePropagator).
+			The callback must return quickly. Once this function returns, the previous callback
+			is not being called any more, so an empty callback can be set before destroying its target.
+			*/
+			void setReadingCallback(reading_callback_t callback) { boost::unique_lock<boost::mutex> l(mutex_callback); reading_callback = callback; }
+			/**
 			Returns all reading between t1 and t2, plus the last before t1 and the first after t2.
 			Each line is one reading, first element is timestamp (double seconds), the rest is the command.
 			*/
 			virtual jblas::mat_indirect acquireReadings(double t1, double t2) = 0;
 			/**
+			Same as acquireReadings, but returns a view on the readings in the estimator buffer
+			instead of building index arrays, the buffer being locked only to find the indexes.
+			*/
+			virtual ReadingSpan acquireSpan(double t1, double t2) = 0;
+			/**
 			If acquireReadings blocked some values the time they are used, this function must release them.
 			*/
 			virtual void releaseReadings() = 0;
@@ -48,6 +132,26 @@ namespace hardware {
 			virtual jblas::ind_array incrementValues() = 0;
 		
 			virtual void start() {}
+			/**
+			Waits until the estimator has enough readings to be used, for instance to initialize
+			the biases, or the timeout (s) has expired. The default estimator is always ready.
+			@return whether the estimator is ready
+			*/
+			virtual bool waitReady(double timeout) { return true; }
+		protected:
+			/**
+			Find the readings between t1 and t2 in a ring buffer whose first column is the timestamp,
+			the oldest reading being at write_position, and empty rows having negative timestamps.
+			@param i1 the index of the last reading before t1
+			@param i2 the index of the first reading after t2 (or the last one if there is none)
+			@return false if there is no data at all
+			*/
+			bool findReadings(const jblas::mat &buffer, int write_position, double t1, double t2, int &i1, int &i2);
+			/**
+			The span of the readings found by findReadings, for acquireSpan.
+			@param i1 the row of its first reading, that must not be overwritten while it is used, -1 if there is no data at all
+			*/
+			ReadingSpan findSpan(const jblas::mat &buffer, int write_position, double t1, double t2, int &i1);
 	};
 
 }}}
@@ -95,7 +95,9 @@ namespace hardware {
 				params.acc_noise = new MultiDimNormalDistribution(x, P, rtslam::rand());
 			}
 			
-			jblas::mat_indirect acquireReadings(double t1, double t2)
+		private:
+			/// simulate the readings between t1 and t2 at the beginning of the buffer, and return their number
+			size_t simulateReadings(double t1, double t2)
 			{
 				size_t n1 = (int)(t1/dt);
 				size_t n2 = (int)(t2/dt +1-1e-4);
@@ -121,11 +123,23 @@ namespace hardware {
 					buffer(i,8) = 0.;
 					buffer(i,9) = 0.; // TODO magneto
 				}
+				return i;
+			}
+
+		public:
+			jblas::mat_indirect acquireReadings(double t1, double t2)
+			{
+				size_t i = simulateReadings(t1, t2);
 				return ublas::project(buffer, 
 					jmath::ublasExtra::ia_set(ublas::range(0,i)),
 					jmath::ublasExtra::ia_set(ublas::range(0,buffer.size2())));
 			}
 			
+			ReadingSpan acquireSpan(double t1, double t2)
+			{
+				return ReadingSpan(buffer, 0, simulateReadings(t1, t2), t1, t2);
+			}
+			
 			void releaseReadings() { }
 			jblas::ind_array instantValues() { return jmath::ublasExtra::ia_set(1,10); }
 			jblas::ind_array incrementValues() { return jmath::ublasExtra::ia_set(1,1); }
@@ -48,6 +48,9 @@ namespace hardware {
 			boost::condition_variable cond_offline; // to be sure we don't need data before they are read
 			int write_position; // next position where to write, oldest available reading
 			int read_position; // oldest position not released (being read or not read at all)
+			boost::condition_variable cond_ready; // notified when enough readings have been acquired
+			unsigned nreadings; // number of readings acquired since the start
+			unsigned ready_readings; // number of readings needed before the estimator is ready
 			
 			double timestamps_correction;
 //			bool tighly_synchronized;
@@ -66,11 +69,16 @@ namespace hardware {
 			~HardwareEstimatorMti();
 			virtual void start();
 			void setSyncConfig(double timestamps_correction = 0.0/*, bool tightly_synchronized = false, double tight_offset*/);
+			/// number of readings needed to initialize the biases before the estimator is ready (100 by default, one second at 100 Hz)
+			void setReadyReadings(unsigned n) { ready_readings = n; }
+			/// ready once enough readings have been acquired live, or immediately in replay
+			virtual bool waitReady(double timeout);
 			
 			/**
 			 * @return data with 10 columns: time, accelero (3), gyro (3), magneto (3)
 			 */
 			jblas::mat_indirect acquireReadings(double t1, double t2);
+			ReadingSpan acquireSpan(double t1, double t2);
 			void releaseReadings() { }
 			jblas::ind_array instantValues() { return jmath::ublasExtra::ia_set(1,10); }
 			jblas::ind_array incrementValues() { return jmath::ublasExtra::ia_set(1,1); }
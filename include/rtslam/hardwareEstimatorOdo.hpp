@@ -60,6 +60,7 @@ namespace hardware {
 			 * @return data position: x y z roll pitch yaw
 			 */
 			jblas::mat_indirect acquireReadings(double t1, double t2);
+			ReadingSpan acquireSpan(double t1, double t2);
 			void releaseReadings() { }
 			jblas::ind_array instantValues() { return jmath::ublasExtra::ia_set(1,7); }
 			jblas::ind_array incrementValues() { return jmath::ublasExtra::ia_set(1,1); }
@@ -68,6 +69,8 @@ namespace hardware {
 			
 			Position loadPosition(unsigned int index_) const;
 			void loadPosition(unsigned int index_, Position& pos) const;
+			/// convert a position to a reading: date x y z roll pitch yaw
+			static void positionToReading(Position const &pos, jblas::vec &row);
 	};
 	
 	class Position: public kernel::KeyValueFileLoad 
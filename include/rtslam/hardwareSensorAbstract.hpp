@@ -12,11 +12,15 @@
 #ifndef HARDWARE_SENSOR_HPP_
 #define HARDWARE_SENSOR_HPP_
 
+#include <algorithm>
+
 #include "kernel/threads.hpp"
+#include "kernel/timingTools.hpp"
 
 #include "jmath/indirectArray.hpp"
 
 #include "rtslam/rawAbstract.hpp"
+#include "rtslam/replayClock.hpp"
 
 namespace jafar {
 namespace rtslam {
@@ -36,7 +40,7 @@ struct RawVec
 	double arrival;
 	RawVec(unsigned n): data(n), arrival(0.) {}
 	void resize(unsigned n) { data.resize(n); }
-	RawVec() {}
+	RawVec(): arrival(0.) {}
 };
 
 namespace hardware {
@@ -86,13 +90,16 @@ class HardwareSensorAbstract
 		boost::mutex mutex_data; /// mutex for using this object
 		boost::condition_variable cond_offline_full;
 		boost::condition_variable cond_offline_freed;
+		boost::condition_variable cond_written; /// notified with mutex_data when a new raw is in the buffer
 		int data_count; /// image count since last image read
+		unsigned received; /// number of raws written in the buffer since the start
 		int last_sent_pos; /// position of the last raw sent
 		bool no_more_data;
 		double timestamps_correction;
 		double data_period;
 		double arrival_delay;
 		bool started; /// has the start() command been already run ?
+		replay_clock_ptr_t replay_clock; /// virtual clock when emulating real-time in replay
 		
 		int bufferSize; /// size of the ring buffer
 		VecT buffer; /// the ring buffer
@@ -108,6 +115,13 @@ class HardwareSensorAbstract
 			if (write_pos >= bufferSize) write_pos = 0;
 			if (write_pos == read_pos) buffer_full = true; // full
 			++data_count;
+			++received;
+			cond_written.notify_all();
+		}
+		/// to be called with mutex_data locked when the sensor will not acquire any more raw, wakes up waitReady
+		void setNoMoreData() {
+			no_more_data = true;
+			cond_written.notify_all();
 		}
 		int getFirstUnreadPos() {
 			/// \warning check that buffer is not empty before
@@ -149,6 +163,35 @@ class HardwareSensorAbstract
 			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t()); if (!locked) l.lock();
 			return (getFirstUnreadPos() == write_pos && !buffer_full);
 		}
+		/// number of positions that can be written before the buffer is full
+		int getFreeSpace(bool locked = false)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t()); if (!locked) l.lock();
+			if (buffer_full) return 0;
+			int free = (read_pos - write_pos + bufferSize) % bufferSize;
+			return (free == 0 ? bufferSize : free);
+		}
+		/// date at which the raw at pos would have been available live
+		double getRawArrival(int pos) {
+			double timestamp = extractRawTimestamp(buffer(pos)), arrival = extractRawArrival(buffer(pos));
+			return (arrival >= timestamp ? arrival : timestamp + arrival_delay);
+		}
+		/// tells if the raw at pos has arrived according to the replay clock
+		bool hasArrived(int pos) {
+			return (!replay_clock || !replay_clock->isStarted() || getRawArrival(pos) <= replay_clock->now());
+		}
+		/**
+			Delay between two polls, for the sensors that cannot block until new data arrive
+			(posters): sleep until shortly before the next data is expected if the data period
+			is known, and then poll every millisecond.
+			@param last_arrival the arrival date of the last data
+		*/
+		void pollDelay(double last_arrival) {
+			double delay = 0.001;
+			if (data_period > 0. && last_arrival > 0.)
+				delay = std::max(delay, last_arrival + 0.9*data_period - kernel::Clock::getTime());
+			boost::this_thread::sleep(boost::posix_time::microseconds((long)(delay*1e6)));
+		}
 		
 	public:
 		/** Constructor
@@ -157,7 +200,7 @@ class HardwareSensorAbstract
 		HardwareSensorAbstract(kernel::VariableCondition<int> &condition, unsigned bufferSize):
 			write_pos(0), read_pos(0), buffer_full(false), read_pos_used(false),
 		  condition(condition), index(-1),
-		  data_count(0), no_more_data(false), timestamps_correction(0.0), started(false),
+		  data_count(0), received(0), no_more_data(false), timestamps_correction(0.0), data_period(0.0), arrival_delay(0.0), started(false),
 		  bufferSize(bufferSize), buffer(bufferSize)
 		{}
 		virtual void start() = 0; ///< start the acquisition thread, once the object is configured
@@ -174,6 +217,36 @@ class HardwareSensorAbstract
 			{ data_period = this->data_period; arrival_delay = this->arrival_delay; }
 		virtual void setTimingInfos(double data_period, double arrival_delay)
 			{ this->data_period = data_period; this->arrival_delay = arrival_delay; }
+		/**
+			Emulate real-time in replay: raws are only made available when the
+			clock reaches their arrival date (or timestamp + arrival delay if
+			it was not recorded).
+		*/
+		void setReplayClock(replay_clock_ptr_t clock) { replay_clock = clock; }
+		/**
+			Whether the sensor provides data that can be used: by default as soon as it has
+			acquired a first raw, or if it will never have any. Sensors that need more
+			(a fix, a number of readings...) override it.
+			@param locked whether mutex_data is already locked by the caller
+		*/
+		virtual bool isReady(bool locked = false)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t()); if (!locked) l.lock();
+			return received > 0 || no_more_data;
+		}
+		/**
+			Waits until the sensor is ready or the timeout has expired, without polling.
+			@param timeout the maximum waiting time (s)
+			@return whether the sensor is ready
+		*/
+		bool waitReady(double timeout)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds((long)(timeout*1e6));
+			while (!isReady(true))
+				if (!cond_written.timed_wait(l, deadline)) return isReady(true);
+			return true;
+		}
 		
 		
 		virtual double getLastTimestamp() = 0;
@@ -331,6 +404,7 @@ template<typename T>
 int HardwareSensorAbstract<T>::getUnreadRawInfos(RawInfos &infos)
 {
 	infos.available.clear();
+	int not_arrived = -1; // first raw that has not arrived yet when emulating real-time
 	if (!isEmpty())
 	{
 		int first_stop, second_stop;
@@ -347,21 +421,36 @@ int HardwareSensorAbstract<T>::getUnreadRawInfos(RawInfos &infos)
 			second_stop = last;
 		}
 		
-		for(int pos = first; pos <= first_stop; ++pos)
-			infos.available.push_back(RawInfo(pos,extractRawTimestamp(buffer(pos)),extractRawArrival(buffer(pos))));
-		for(int pos = 0; pos <= second_stop; ++pos)
-			infos.available.push_back(RawInfo(pos,extractRawTimestamp(buffer(pos)),extractRawArrival(buffer(pos))));
+		for(int pos = first; pos <= first_stop && not_arrived < 0; ++pos)
+			if (hasArrived(pos))
+				infos.available.push_back(RawInfo(pos,extractRawTimestamp(buffer(pos)),extractRawArrival(buffer(pos))));
+			else
+				not_arrived = pos;
+		for(int pos = 0; pos <= second_stop && not_arrived < 0; ++pos)
+			if (hasArrived(pos))
+				infos.available.push_back(RawInfo(pos,extractRawTimestamp(buffer(pos)),extractRawArrival(buffer(pos))));
+			else
+				not_arrived = pos;
 	}
 	
-	double data_period, arrival_delay;
-	getTimingInfos(data_period, arrival_delay);
-	double next_date = getLastTimestamp() + data_period;
-	infos.next = RawInfo(0,next_date,next_date+arrival_delay);
+	if (not_arrived >= 0)
+	{
+		// in replay the next raw is already known
+		double next_arrival = getRawArrival(not_arrived);
+		infos.next = RawInfo(not_arrived,extractRawTimestamp(buffer(not_arrived)),next_arrival);
+		replay_clock->notifyAt(next_arrival);
+	} else
+	{
+		double data_period, arrival_delay;
+		getTimingInfos(data_period, arrival_delay);
+		double next_date = getLastTimestamp() + data_period;
+		infos.next = RawInfo(0,next_date,next_date+arrival_delay);
+	}
 	infos.process_time = 0.;
 	
 	if (infos.available.size() == 0)
 	{
-		if (no_more_data) return -2; else return -1;
+		if (no_more_data && not_arrived < 0) return -2; else return -1;
 	}
 	return 0;
 }
@@ -372,6 +461,11 @@ int HardwareSensorAbstract<T>::getNextRawInfo(RawInfo &info)
 	if (!isEmpty())
 	{
 		int first = getFirstUnreadPos();
+		if (!hasArrived(first))
+		{
+			replay_clock->notifyAt(getRawArrival(first));
+			return -1;
+		}
 		info = RawInfo(first,extractRawTimestamp(buffer(first)),0.0);
 		return 0;
 	} else
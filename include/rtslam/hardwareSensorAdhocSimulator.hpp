@@ -33,6 +33,7 @@ namespace hardware {
 				HardwareSensorExteroAbstract(condition, 3),
 				dt(1./freq), n(0), simulator(simulator), robId(robId), senId(senId) {}
 			virtual void start() {}
+			virtual bool isReady(bool locked = false) { return true; } ///< the raws are generated on demand
 			
 			int getRawInfo(size_t m, RawInfo &info)
 			{
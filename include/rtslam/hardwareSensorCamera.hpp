@@ -18,9 +18,11 @@
 #include <boost/thread.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/function.hpp>
 
 #include "rtslam/hardwareSensorAbstract.hpp"
 #include "rtslam/rawImage.hpp"
+#include "rtslam/datasetContainer.hpp"
 
 
 namespace jafar {
@@ -33,6 +35,9 @@ using triple-buffering.
 */
 class HardwareSensorCamera: public HardwareSensorExteroAbstract
 {
+	public:
+		typedef boost::function<void (rawimage_ptr_t const &)> preprocess_func_t;
+	
 	protected:
 		std::vector<IplImage*> bufferImage;
 		std::vector<rawimage_ptr_t> bufferSpecPtr;
@@ -43,8 +48,52 @@ class HardwareSensorCamera: public HardwareSensorExteroAbstract
 		
 		std::string dump_path;
 		
+		dataset_writer_ptr_t dataset_writer; /// used instead of image files when dump_path is a dataset file
+		dataset_reader_ptr_t dataset_reader;
+		int dataset_stream;
+		int dataset_camera_rank; /// which camera of the dataset to replay
+		int dataset_encoding;
+		std::vector<double> dataset_intrinsics;
+		double dataset_start_delay; /// where to start the replay, in seconds after the first image
+		int dataset_start_frame;    /// where to start the replay, overrides dataset_start_delay if >= 0
+		bool dataset_zero_copy;     /// images are used directly from the dataset mapping
+		
+		int ndigit; /// number of digits in image file names
+		
+		unsigned prefetch_threads;  /// number of threads loading and decoding images in replay
+		size_t prefetch_memory;     /// maximum memory used by images loaded in advance, 0 for no limit
+		bool prefetch_stop;         /// the threads loading images must stop
+		unsigned prefetch_claim;    /// next image to be loaded by a thread
+		unsigned prefetch_publish;  /// next image to be made available in the buffer
+		unsigned prefetch_end;      /// index of the first image that doesn't exist
+		std::vector<bool> prefetch_ready; /// buffer positions already loaded but not yet published
+		double prefetch_last_publish, prefetch_starved, prefetch_backpressure, prefetch_depth;
+		unsigned prefetch_count;
+		
 		boost::thread *preloadTask_thread;
+		boost::thread_group prefetch_group; /// the threads loading images in replay other than preloadTask_thread
 		void preloadTaskOffline(void);
+		void decodeTaskOffline(void);
+		bool loadOffline(unsigned image_index, int buff_write);
+		void reportPrefetch(void);
+		preprocess_func_t preprocess_func;
+		std::vector<double> preprocess_timestamp; /// timestamp of the image prepared at each buffer position
+		int preprocess_busy;  /// buffer position being prepared, -1 if none
+		bool preprocess_hold; /// the reader is releasing images, no new one must be started
+		bool preprocess_stop;
+		unsigned preprocess_read, preprocess_ready, preprocess_waited;
+		boost::condition_variable cond_preprocessed;
+		boost::thread *preprocessTask_thread;
+		void preprocessTask(void);
+		int nextToPreprocess(void);
+		void holdPreprocessing(int id);
+		void resumePreprocessing(void);
+		void reportPreprocessing(void);
+		/// must be called by the destructors of derived classes that free the memory of the images
+		void stopPreprocessing(void);
+		/// stops the threads loading images in replay and waits for the ones of prefetch_group, as stopPreprocessing
+		void stopPrefetch(void);
+		
 		boost::thread *savePushTask_thread;
 		void savePushTask(void);
 		kernel::VariableCondition<size_t> saveTask_cond;
@@ -53,13 +102,56 @@ class HardwareSensorCamera: public HardwareSensorExteroAbstract
 	
 	
 		void init(std::string dump_path, cv::Size imgSize);
+		/**
+		Point the image of a buffer position to memory that it does not own, the image data
+		must have been released before. The raw keeps owner alive as long as it points to it.
+		*/
+		void setBufferData(int buff, const char *data, int step, boost::shared_ptr<void> const &owner);
 	public:
 		
 		/**
 		Same as before but assumes that mode=2, and doesn't need a camera
 		*/
-		HardwareSensorCamera(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path = ".");
+		HardwareSensorCamera(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path = ".", int bufferSize = 3);
 		HardwareSensorCamera(kernel::VariableCondition<int> &condition, int bufferSize);
+		~HardwareSensorCamera();
+		
+		/**
+		Options used when dump_path is a dataset file (see datasetContainer.hpp)
+		@param camera_rank the rank of the camera stream in the dataset, when replaying
+		@param encoding the encoding of recorded images (dataset::encRaw or dataset::encPng)
+		@param intrinsics camera parameters recorded in the stream header
+		*/
+		void setDatasetOptions(int camera_rank, int encoding = dataset::encRaw, std::vector<double> const &intrinsics = std::vector<double>())
+			{ dataset_camera_rank = camera_rank; dataset_encoding = encoding; dataset_intrinsics = intrinsics; }
+		/**
+		Start the replay of a dataset file in the middle, without reading what is before.
+		Must be called before start().
+		@param delay time in seconds after the first image of the camera
+		*/
+		void seekDataset(double delay) { dataset_start_delay = delay; dataset_start_frame = -1; }
+		/// same with the index of the first image to replay
+		void seekDatasetFrame(unsigned frame) { dataset_start_frame = frame; }
+		/**
+		Configure the loading of images in replay. Images are loaded in advance
+		up to the size of the buffer, in parallel, and made available in order.
+		Must be called before start().
+		@param threads number of threads loading and decoding images
+		@param max_memory maximum memory (bytes) used by images loaded in advance, 0 for no limit other than buffer size
+		*/
+		void setPrefetch(unsigned threads, size_t max_memory = 0)
+			{ prefetch_threads = (threads < 1 ? 1 : threads); prefetch_memory = max_memory; }
+		/**
+		Prepare the images in a thread of its own as soon as they are in the buffer, while the
+		previous ones are being processed, for instance with ImagePointHarrisDetector::prepare.
+		They are prepared in order, and getRaw waits for an image that is being prepared.
+		Must be called before start().
+		@param func computes what will be needed from the image and stores it in the raw
+		*/
+		void setPreprocessing(preprocess_func_t func);
+		
+		virtual void getRaw(unsigned id, raw_ptr_t& raw);
+		virtual int getLastUnreadRaw(raw_ptr_t& raw);
 };
 
 
@@ -73,7 +73,7 @@ class HardwareSensorCameraFirewire: public HardwareSensorCamera
 		/**
 		Same as before but assumes that mode=2, and doesn't need a camera
 		*/
-		HardwareSensorCameraFirewire(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path = ".");
+		HardwareSensorCameraFirewire(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path = ".", int bufferSize = 3);
 		
 		~HardwareSensorCameraFirewire();
 
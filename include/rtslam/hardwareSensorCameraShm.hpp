@@ -0,0 +1,73 @@
+/**
+ * \file hardwareSensorCameraShm.hpp
+ *
+ * Header file for getting images from an acquisition process through shared memory
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef HARDWARE_SENSOR_CAMERA_SHM_HPP_
+#define HARDWARE_SENSOR_CAMERA_SHM_HPP_
+
+#include "rtslam/hardwareSensorCamera.hpp"
+#include "rtslam/shmImageRing.hpp"
+
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+/**
+This class gets the images written by another process in a ShmImageRing,
+for instance an acquisition process driving the camera (see demo_shm_producer).
+The images are not copied: the buffers point directly to the slots of the ring,
+that the producer doesn't overwrite until they are released.
+The ring must have more slots than the buffer of this object.
+*/
+class HardwareSensorCameraShm: public HardwareSensorCamera
+{
+	private:
+		std::string shm_name;
+		shm_image_ring_ptr_t ring;
+		std::vector<uint64_t> slot_seq; /// sequence number in the ring of the image at each position of the buffer
+		double last_timestamp;
+		double attach_timeout;
+
+		int mode;
+
+		void preloadTask(void);
+		/// @return false if there is no producer after attach_timeout
+		bool attachRing(void);
+		void releaseRing(uint64_t next_seq);
+
+		void init(int mode, std::string dump_path, cv::Size imgSize);
+	public:
+
+		/**
+		@param shm_name the name of the shared memory segment written by the producer (eg /rtslam_camera)
+		@param mode 0 = normal, 1 = dump used images, 2 = from dumped images
+		@param dump_path the path where the images are saved/read... Use a ram disk !!!
+		*/
+		HardwareSensorCameraShm(kernel::VariableCondition<int> &condition, int bufferSize, const std::string &shm_name, cv::Size size, int mode = 0, std::string dump_path = ".");
+		/**
+		Same as before but assumes that mode=2, and doesn't need a producer
+		*/
+		HardwareSensorCameraShm(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path = ".", int bufferSize = 3);
+
+		~HardwareSensorCameraShm();
+
+		/// how long to wait for the producer when starting, 10 s by default. Must be called before start().
+		void setAttachTimeout(double timeout) { attach_timeout = timeout; }
+
+		virtual void start();
+		virtual double getLastTimestamp() { boost::unique_lock<boost::mutex> l(mutex_data); return last_timestamp; }
+};
+
+typedef boost::shared_ptr<HardwareSensorCameraShm> hardware_sensor_shm_ptr_t;
+
+}}}
+
+#endif
@@ -42,12 +42,19 @@ class HardwareSensorGpsGenom: public HardwareSensorProprioAbstract
 		int mode;
 		std::string dump_path;
 		double last_timestamp;
+		bool has_fix; ///< a reading with a valid position has been acquired
 		
 	public:
 		HardwareSensorGpsGenom(kernel::VariableCondition<int> &condition, unsigned bufferSize, const std::string machine, int mode = 0, std::string dump_path = ".");
 		
 		virtual void start();
 		virtual double getLastTimestamp() { boost::unique_lock<boost::mutex> l(mutex_data); return last_timestamp; }
+		/// ready live once the gps has a fix, and in replay with the first reading
+		virtual bool isReady(bool locked = false)
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t()); if (!locked) l.lock();
+			return (mode == 2 ? received > 0 : has_fix) || no_more_data;
+		}
 		
 };
 
@@ -163,6 +163,26 @@ namespace jafar {
 				 */
 				void correct(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl);
 
+				/**
+				 * EKF correction with an out-of-sequence measurement, made before the last prediction.
+				 * The innovation and its Jacobian INN_rsl are expressed wrt the current states,
+				 * by retrodiction of the robot state at the date of the measurement
+				 * (see RobotStateHistory). The correlation between the current state and the process
+				 * noise W accumulated since this date is taken into account (Bar-Shalom's B1 algorithm):
+				 * - Z <-- Z - INN_w * W * trans(INN_w)
+				 * - P * trans(INN_rsl) <-- P * trans(INN_rsl) + W * trans(INN_w) on the rows of ia_w
+				 *
+				 * \param iax the indirect array of used indices in the map.
+				 * \param inn the Innovation, with Z computed as for a normal correction.
+				 * \param INN_rsl the Jacobian wrt the current states that contributed to the innovation
+				 * \param ia_rsl the indices to these states
+				 * \param ia_w the indices of the states affected by the process noise (the robot state), included in iax
+				 * \param INN_w the Jacobian of the innovation wrt the process noise, that is -INN_rsl on the robot state
+				 * \param W the process noise accumulated since the date of the measurement
+				 */
+				void correctDelayed(const ind_array & iax, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl,
+				                    const ind_array & ia_w, const mat & INN_w, const sym_mat & W);
+
 				
 			protected:
 				
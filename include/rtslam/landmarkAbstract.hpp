@@ -75,7 +75,8 @@ namespace jafar {
 
 
 				static IdFactory landmarkIds;
-				void setId(){id(landmarkIds.getId());}
+				/// landmarks can be created by the threads of different maps at the same time
+				void setId();
 
 				enum geometry_t {
 						POINT,
@@ -137,10 +138,6 @@ namespace jafar {
 				 */
 				virtual bool needToDie() { return false; }
 
-				/**
-				destroy the display data of itself and its children
-				*/
-				void destroyDisplay();
 				/**
 				 * Suicide
 				 *
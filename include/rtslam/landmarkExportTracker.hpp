@@ -0,0 +1,85 @@
+/**
+ * \file landmarkExportTracker.hpp
+ *
+ * Header file for the incremental export of the map: the changes of the
+ * landmarks since they were last exported.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef LANDMARK_EXPORT_TRACKER_HPP_
+#define LANDMARK_EXPORT_TRACKER_HPP_
+
+#include <map>
+#include <vector>
+
+#include "jmath/jblas.hpp"
+
+#include "rtslam/rtSlam.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+	/**
+	Remembers the landmarks as they were last exported, to export only what
+	changed: new landmarks, landmarks that moved or whose uncertainty changed
+	by more than a threshold, reparametrized and deleted landmarks.
+	Landmarks are exported in their euclidean parametrization, keyed by their id,
+	that is kept by reparametrization.
+
+	\ingroup rtslam
+	*/
+	class LandmarkExportTracker
+	{
+		public:
+			struct Change
+			{
+				unsigned op; ///< exportproto::LandmarkOperation
+				unsigned id;
+				unsigned type; ///< LandmarkAbstract::type_enum
+				jblas::vec x;
+				jblas::sym_mat P;
+			};
+		private:
+			struct Entry
+			{
+				unsigned type;
+				jblas::vec x;
+				jblas::sym_mat P;
+				double stdev; ///< square root of the trace of P
+				bool seen;
+			};
+			typedef std::map<unsigned, Entry> EntryMap;
+			EntryMap entries; ///< as last exported
+			double pos_threshold;
+			double stdev_threshold;
+			static double traceStdev(jblas::sym_mat const &P);
+		public:
+			/**
+			@param pos_threshold a landmark is updated when one of its parameters moved by more (m)
+			@param stdev_threshold or when the square root of the trace of its covariance
+			changed by more than this ratio
+			*/
+			LandmarkExportTracker(double pos_threshold = 0.01, double stdev_threshold = 0.1):
+				pos_threshold(pos_threshold), stdev_threshold(stdev_threshold) {}
+
+			/**
+			Compare the landmarks of the map with what was exported, and remember them
+			as exported.
+			@param changes the landmarks to export, in map coordinates
+			*/
+			void update(map_ptr_t mapPtr, std::vector<Change> &changes);
+			/**
+			All the landmarks as last exported, as additions, to build a keyframe
+			consistent with the changes exported until now.
+			*/
+			void keyframe(std::vector<Change> &landmarks);
+			size_t size() { return entries.size(); }
+	};
+
+}}
+
+#endif
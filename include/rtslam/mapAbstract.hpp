@@ -13,6 +13,7 @@
 #define MAPABSTRACT_HPP_
 
 #include "kernel/dataLog.hpp"
+#include "rtslam/binaryLogger.hpp"
 #include "jmath/jblas.hpp"
 #include "rtslam/rtSlam.hpp"
 
@@ -42,7 +43,7 @@ namespace jafar {
 		 */
 		class MapAbstract: public ObjectAbstract, public ChildOf<WorldAbstract>, 
 			public boost::enable_shared_from_this<MapAbstract>,
-			public ParentOf<RobotAbstract> , public ParentOf<MapManagerAbstract>, public kernel::DataLoggable {
+			public ParentOf<RobotAbstract> , public ParentOf<MapManagerAbstract>, public kernel::DataLoggable, public BinaryLoggable {
 
 			ENABLE_LINK_TO_PARENT(WorldAbstract,World,MapAbstract);
 			ENABLE_ACCESS_TO_PARENT(WorldAbstract,world);
@@ -96,6 +97,12 @@ namespace jafar {
 				size_t current_size;
 				jblas::vecb used_states;
 
+				/**
+				 * Held by the thread that processes the map while it is modified,
+				 * so that the display can read several maps processed in parallel.
+				 */
+				boost::mutex mutex_process;
+
 				/**
 				 * Map's indirect array is a function by now.
 				 * \return the indirect array of all used states in the map.
@@ -160,6 +167,9 @@ namespace jafar {
 
 				virtual void writeLogHeader(kernel::DataLogger& log) const;
 				virtual void writeLogData(kernel::DataLogger& log) const;
+				/// one row per landmark, with its state and the standard deviations
+				virtual void writeLogHeader(BinaryLogger& log) const;
+				virtual void writeLogData(BinaryLogger& log) const;
 				
 			private:
 
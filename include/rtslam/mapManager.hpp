@@ -11,6 +11,7 @@
 
 #include "rtslam/parents.hpp"
 #include "rtslam/mapAbstract.hpp"
+#include "rtslam/trace.hpp"
 #include "rtslam/landmarkFactory.hpp"
 
 namespace jafar {
@@ -109,6 +110,7 @@ namespace jafar {
 								
 				virtual void manage()
 				{
+					RTSLAM_TRACE_SCOPE("map management");
 					manageDefaultDeletion();
 					manageDeletion();
 					manageReparametrization();
@@ -15,16 +15,13 @@
 
 #include <string>
 #include <vector>
+#include <stdint.h>
 
 #include "rtslam/rtSlam.hpp"
 
 namespace jafar {
 	namespace rtslam {
 
-		namespace display {
-			class DisplayDataAbstract;
-		}
-
 		/**
 		 * Class for generic objects in rtslam.
 		 * This class defines standard members:
@@ -53,6 +50,8 @@ namespace jafar {
 
 				std::string name_;
 
+				uint64_t changeStamp_;
+
 			protected:
 				category_enum category;
 
@@ -93,8 +92,19 @@ namespace jafar {
 					id(_id);
 					name(_name);
 				}
-				virtual void destroyDisplay();
-				std::vector<display::DisplayDataAbstract*> displayData;
+
+				/**
+				 * Stamp of the last change of the object, unique among all the objects so that
+				 * a new object never has the stamp of an old one.
+				 * It lets the consumers that copy the objects (the display) copy only those that changed.
+				 */
+				inline uint64_t changeStamp() const {
+					return changeStamp_;
+				}
+				/**
+				 * Marks the object as changed, to be called by the code that changes it.
+				 */
+				void touch();
 		};
 	}
 }
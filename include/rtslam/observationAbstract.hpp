@@ -14,6 +14,7 @@
 
 #include <jmath/jblas.hpp>
 #include <boost/smart_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "rtslam/rtSlam.hpp"
 // include parents
@@ -230,6 +231,10 @@ namespace jafar {
 
 				type_enum type;
 
+			private:
+				bool shown_; ///< whether an event was set at the last touchIfShown
+			public:
+
 				void setId(){
 					id(landmarkPtr()->id());
 				}
@@ -321,6 +326,13 @@ namespace jafar {
 				void clearFlags();
 				void clearCounters();
 
+				/**
+				 * Marks the observation and its landmark as changed (see ObjectAbstract::touch)
+				 * if any event is set, or was set at the previous call, because only then the
+				 * display shows them. To be called once the sensor processed a raw.
+				 */
+				void touchIfShown();
+
 
 				/**
 				 * Predict visibility.
@@ -346,6 +358,8 @@ namespace jafar {
 					if (force || !tasks.predictedApp)
 					{
 //JFR_DEBUG("predictAppearance");
+						// the descriptor is shared with the observations of the other sensors, that can be matched in parallel
+						boost::unique_lock<boost::mutex> l(descriptorMutex(landmarkPtr()->id()));
 						if (predictAppearance_func())
 						{
 							tasks.predictedApp = true;
@@ -384,6 +398,10 @@ namespace jafar {
 				virtual void transferInfoObs(observation_ptr_t & obs);
 
 				virtual void desc_image(image::oimstream& os) const {}
+
+			private:
+				/// one of a few mutexes protecting the landmark descriptors, chosen with the id of the landmark
+				static boost::mutex& descriptorMutex(size_t lmk_id);
 				
 		};
 
@@ -0,0 +1,96 @@
+/**
+ * \file posePropagator.hpp
+ *
+ * Header file for the propagation of the robot pose at the rate of the
+ * hardware estimator, between two filter updates.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef POSE_PROPAGATOR_HPP_
+#define POSE_PROPAGATOR_HPP_
+
+#include <deque>
+#include <iostream>
+
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "kernel/threads.hpp"
+
+#include "rtslam/robotAbstract.hpp"
+#include "rtslam/exporterAbstract.hpp"
+#include "rtslam/replayClock.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+	/**
+	 * Publishes the robot state at each reading of its hardware estimator (IMU, odometry),
+	 * between two filter updates, for controllers that need a higher rate than the cameras.
+	 *
+	 * Only the mean of the robot is propagated (RobotAbstract::move_mean), from the state
+	 * given by the last filter update, in a thread of its own. After each update the
+	 * filter thread calls anchor(), and the state is propagated again from the new
+	 * estimate with the readings received since its date.
+	 *
+	 * \ingroup rtslam
+	 */
+	class PosePropagator
+	{
+		private:
+			struct Reading
+			{
+				jblas::vec data; ///< timestamp then command
+				double arrival;  ///< date at which it was acquired, for the latency
+			};
+
+			robot_ptr_t robPtr;
+			boost::shared_ptr<ExporterAbstract> exporter;
+
+			boost::mutex mutex_data;
+			kernel::VariableCondition<int> condition_data; ///< number of new readings
+			std::deque<Reading> incoming; ///< readings not processed yet
+			jblas::vec anchor_x;   ///< robot state given by the last filter update
+			double anchor_time;    ///< its date, negative if there was no update yet
+			bool anchor_new;       ///< the state must be propagated again from the anchor
+
+			// only used by the propagation thread
+			std::deque<Reading> recent; ///< readings since the anchor, and the last one before
+			static const size_t max_recent = 4096;
+			jblas::vec x;          ///< propagated state at the date of the last reading
+			Reading last;          ///< the last reading used, from which the next move starts
+			bool valid;            ///< x has been propagated from an anchor
+			bool supported;        ///< the robot implements move_mean
+			hardware::Histogram latency_hist;
+			unsigned npublished;
+
+			boost::thread *propagateTask_thread;
+			void propagateTask();
+			void onReading(const double *reading, size_t size, double arrival);
+			bool move(Reading const &reading);
+			/// propagate from the anchor with all the recent readings
+			void reanchor(jblas::vec const &x_anchor, double t_anchor);
+			void publish(Reading const &reading);
+
+		public:
+			/**
+			 * @param robPtr the robot, that must have a hardware estimator and implement move_mean
+			 * @param exporter where to publish the propagated states
+			 */
+			PosePropagator(robot_ptr_t robPtr, boost::shared_ptr<ExporterAbstract> exporter);
+			~PosePropagator() { stop(); }
+
+			/// to be called by the filter thread after each update of the robot
+			void anchor();
+			void stop();
+			/// print the number of published states and the latency between the acquisition of the readings and the publication
+			void printStatistics(std::ostream &os);
+	};
+
+}}
+
+#endif
@@ -10,6 +10,8 @@
 #ifndef QUICKHARRISDETECTOR_HPP_
 #define QUICKHARRISDETECTOR_HPP_
 
+#include <vector>
+
 #include "image/Image.hpp"
 #include "image/roi.hpp"
 
@@ -37,6 +39,20 @@
 namespace jafar{
 	namespace rtslam{
 
+		/**
+		 * Convolved products of the derivatives of a whole image, that QuickHarrisDetector::prepare()
+		 * computes in advance so that QuickHarrisDetector::detectIn() only has to look for the best
+		 * point in its region of interest.
+		 * \ingroup rtslam
+		 */
+		struct HarrisImage {
+			double timestamp; ///< of the raw it was computed for, negative if it is not valid
+			int width, height, convolutionSize;
+			/// row major, only computed where the convolution window doesn't reach the border of the image
+			std::vector<int> conv_xx, conv_xy, conv_yy;
+			HarrisImage(): timestamp(-1.), width(0), height(0), convolutionSize(0) {}
+		};
+
 		/**
 		 * Quick Harris detector class.
 		 * \ingroup rtslam
@@ -63,10 +79,20 @@ namespace jafar{
 #endif
           );
         ~QuickHarrisDetector();
-        virtual bool detectIn(image::Image const& image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi * roiPtr = 0 );
+        /**
+         * @param prepared the result of prepare() for this image, the region is then not
+         * processed again if it is inside the image, with the same result
+         */
+        virtual bool detectIn(image::Image const& image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi * roiPtr = 0, const HarrisImage * prepared = 0);
+        /**
+         * Compute the convolved products of the derivatives of the whole image, only using
+         * the parameters of the detector so that it can run in another thread than detectIn().
+         * @return false if it is not supported with these parameters
+         */
+        bool prepare(image::Image const& image, HarrisImage & prepared) const;
       private:
         void quickDerivatives(const image::Image & image, image::ConvexRoi & roi);
-        bool quickConvolutionWithBestPoint(const image::ConvexRoi & roi, int pixMax[2], float & scoreMax);
+        bool quickConvolutionWithBestPoint(const image::ConvexRoi & roi, int pixMax[2], float & scoreMax, const HarrisImage * prepared);
 
         void writeHarrisImagesAsPPM(image::ConvexRoi & roi);
 
@@ -38,6 +38,10 @@ namespace jafar {
 				virtual RawAbstract* clone();
 
 				jafarImage_ptr_t img;
+				/// computed in advance by the preprocessing thread of the camera (see HardwareSensorCamera::setPreprocessing), valid if its timestamp is the one of this raw
+				boost::shared_ptr<HarrisImage> harris;
+				/// keeps alive the memory the image points to when it does not own it (dataset mapping, shared memory ring)
+				boost::shared_ptr<void> data_owner;
 
 				void setJafarImage(jafarImage_ptr_t img) ;
 
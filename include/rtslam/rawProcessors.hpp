@@ -110,7 +110,8 @@ namespace rtslam {
 			{
 				featPtr.reset(new FeatureImagePoint(params.patchSize, params.patchSize, CV_8U));
 				featPtr->measurement.std(params.measStd);
-				if (detector.detectIn(*(rawData->img.get()), featPtr, &roi))
+				HarrisImage const *prepared = (rawData->harris && rawData->harris->timestamp == rawData->timestamp ? rawData->harris.get() : NULL);
+				if (detector.detectIn(*(rawData->img.get()), featPtr, &roi, prepared))
 				{
 					// extract appearance
 					vec pix = featPtr->measurement.x();
@@ -123,6 +124,18 @@ namespace rtslam {
 					return true;
 				} else return false;
 			}
+
+			/**
+			 * Compute in advance what detect() needs for the whole image, possibly in another
+			 * thread while the previous image is processed (see HardwareSensorCamera::setPreprocessing).
+			 */
+			void prepare(const boost::shared_ptr<RawImage> & rawData)
+			{
+				if (!rawData->harris) rawData->harris.reset(new HarrisImage());
+				rawData->harris->timestamp = -1.;
+				if (detector.prepare(*(rawData->img.get()), *(rawData->harris)))
+					rawData->harris->timestamp = rawData->timestamp;
+			}
 			
 			void fillDataObs(const boost::shared_ptr<FeatureImagePoint> & featPtr, boost::shared_ptr<ObservationAbstract> & obsPtr)
 			{
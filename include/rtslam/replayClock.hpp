@@ -0,0 +1,100 @@
+/**
+ * \file replayClock.hpp
+ *
+ * Header file for the virtual clock used to emulate real-time during replay,
+ * and for the statistics that are collected about real-time behaviour.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef REPLAY_CLOCK_HPP_
+#define REPLAY_CLOCK_HPP_
+
+#include <set>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "kernel/threads.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	/**
+		Virtual clock for replay, advancing at a given rate of the real time
+		from the date of the first data processed.
+		Hardware sensors hide the data that have not "arrived" yet according to
+		this clock, and the clock wakes up the processing loop (notifying the raw
+		data condition) when they arrive, so that replay takes exactly the
+		same decisions as live processing would have (dropping images...).
+
+		\ingroup rtslam
+	*/
+	class ReplayClock
+	{
+		private:
+			kernel::VariableCondition<int> &condition; ///< condition to notify when data arrive
+			double rate; ///< number of seconds of data per real second
+			double data_start, wall_start;
+			bool started;
+			bool stopping;
+			std::set<double> wake_dates; ///< data dates at which condition must be notified
+			boost::mutex mutex_clock;
+			boost::condition_variable cond_wake;
+			boost::thread *wakeTask_thread;
+
+			void wakeTask();
+		public:
+			ReplayClock(kernel::VariableCondition<int> &condition, double rate = 1.0);
+			~ReplayClock();
+
+			/// start the clock, the current real time corresponding to data date data_date
+			void start(double data_date);
+			bool isStarted() { boost::unique_lock<boost::mutex> l(mutex_clock); return started; }
+			double getRate() { return rate; }
+			/// current date in data time, 0 if not started
+			double now();
+			/// notify the condition when the clock reaches data_date
+			void notifyAt(double data_date);
+	};
+	typedef boost::shared_ptr<ReplayClock> replay_clock_ptr_t;
+
+
+	/**
+		Histogram with constant bin width, the last bin gathers all the larger values.
+
+		\ingroup rtslam
+	*/
+	class Histogram
+	{
+		private:
+			double bin_width;
+			std::vector<unsigned> bins;
+			unsigned count;
+			double sum, max_value;
+		public:
+			Histogram(double bin_width, unsigned nbins):
+				bin_width(bin_width), bins(nbins, 0), count(0), sum(0.), max_value(0.) {}
+			void add(double value);
+			unsigned size() { return count; }
+			unsigned nbins() { return bins.size(); }
+			/// number of values in bin i
+			unsigned bin(unsigned i) { return bins[i]; }
+			double mean() { return (count ? sum/count : 0.); }
+			double max() { return max_value; }
+			/// print the non empty bins, values being multiplied by unit_factor
+			void print(std::ostream &os, std::string const &name, double unit_factor = 1000., std::string const &unit = "ms");
+	};
+
+}}}
+
+#endif
@@ -24,6 +24,7 @@
 #include "rtslam/gaussian.hpp"
 #include "rtslam/mapObject.hpp"
 #include "rtslam/perturbation.hpp"
+#include "rtslam/robotStateHistory.hpp"
 // include parents
 #include "rtslam/mapAbstract.hpp"
 #include "rtslam/mapObject.hpp"
@@ -44,7 +45,7 @@ namespace jafar {
 		 * \ingroup rtslam
 		 */
 		class RobotAbstract: public MapObject, public ChildOf<MapAbstract> , public boost::enable_shared_from_this<
-		    RobotAbstract>, public ParentOf<SensorAbstract>, public kernel::DataLoggable {
+		    RobotAbstract>, public ParentOf<SensorAbstract>, public kernel::DataLoggable, public BinaryLoggable {
 
 				friend ostream& operator <<(ostream & s, RobotAbstract const & rob);
 
@@ -134,6 +135,7 @@ namespace jafar {
 				jblas::mat XNEW_x; ///<         Jacobian wrt state
 				jblas::mat XNEW_pert; ///<      Jacobian wrt perturbation
 				jblas::sym_mat Q; ///<          Process noise covariances matrix in state space, Q = XNEW_pert * perturbation.P * trans(XNEW_pert);
+				RobotStateHistory history; ///< past states, for out-of-sequence measurements (disabled by default)
 				
 				jblas::vec origin_sensors; ///< origin to get the initial state position at 0 / absolute sensors
 				jblas::vec origin_export; ///< origin of the exported position in absolute coordinates
@@ -181,6 +183,7 @@ namespace jafar {
 							computeStatePerturbation();
 
 						mapPtr()->filterPtr->predict(mapPtr()->ia_used_states(), XNEW_x, state.ia(), Q); // P = F*P*F' + Q
+						if (history.enabled()) history.accumulate(XNEW_x, Q);
 					}
 				}
 
@@ -218,9 +221,30 @@ namespace jafar {
 					move();
 				}
 				
+				/**
+				 * Move the robot from its current date to time, with the readings of the hardware estimator if any.
+				 * A robot never moves backwards: if time is older than its current date, a warning
+				 * is printed and the robot is not moved, the older measurements must be processed
+				 * with the history of the robot (see RobotStateHistory).
+				 */
 				virtual void move(double time);
 				void move_fake(double time);
 
+				/**
+				 * Mean of the state after a move between two readings of the hardware estimator,
+				 * without perturbation, Jacobians nor covariances, and without modifying the robot,
+				 * so that it can be called from another thread (see PosePropagator).
+				 *
+				 * Implement this function in derived classes driven by a hardware estimator.
+				 *
+				 * \param _x the state vector of the robot at the date of \a prev_reading
+				 * \param prev_reading the previous reading (timestamp first, then the command)
+				 * \param next_reading the reading at the date of \a _xnew
+				 * \param _xnew the new state vector
+				 * \return false if it is not implemented for this robot
+				 */
+				virtual bool move_mean(const vec & _x, const double *prev_reading, const double *next_reading, vec & _xnew) { return false; }
+
 				/**
 				 * Compute robot process noise \a Q in state space.
 				 * This function is called by move() at each iteration if constantPerturbation is \b false.
@@ -234,8 +258,13 @@ namespace jafar {
 
 				virtual void writeLogHeader(kernel::DataLogger& log) const;
 				virtual void writeLogData(kernel::DataLogger& log) const;
+				virtual void writeLogHeader(BinaryLogger& log) const;
+				virtual void writeLogData(BinaryLogger& log) const;
 
 			protected:
+				/// the same columns for both loggers
+				template<class Logger> void writeLogHeaderTo(Logger& log) const;
+				template<class Logger> void writeLogDataTo(Logger& log) const;
 
 
 				/**
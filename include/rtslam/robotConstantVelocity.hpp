@@ -117,8 +117,13 @@ namespace jafar {
 
 				virtual void writeLogHeader(kernel::DataLogger& log) const;
 				virtual void writeLogData(kernel::DataLogger& log) const;
+				virtual void writeLogHeader(BinaryLogger& log) const;
+				virtual void writeLogData(BinaryLogger& log) const;
 				
 			protected:
+				/// the same columns for both loggers
+				template<class Logger> void writeLogHeaderTo(Logger& log) const;
+				template<class Logger> void writeLogDataTo(Logger& log) const;
 				/**
 				 * Split state vector.
 				 *
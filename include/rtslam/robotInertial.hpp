@@ -120,6 +120,10 @@ namespace jafar {
 				 */
 				void move_func(const vec & _x, const vec & _u, const vec & _n, double _dt, vec & _xnew,
 				    mat & _XNEW_x, mat & _XNEW_pert);
+				/**
+				 * Mean of the state after a move between two IMU readings, see RobotAbstract::move_mean.
+				 */
+				bool move_mean(const vec & _x, const double *prev_reading, const double *next_reading, vec & _xnew);
 				/**
 				 * Initialize the value of g with the average value of acceleration
 				 * in the past.
@@ -168,8 +172,13 @@ namespace jafar {
 
 				virtual void writeLogHeader(kernel::DataLogger& log) const;
 				virtual void writeLogData(kernel::DataLogger& log) const;
+				virtual void writeLogHeader(BinaryLogger& log) const;
+				virtual void writeLogData(BinaryLogger& log) const;
 
 			protected:
+				/// the same columns for both loggers
+				template<class Logger> void writeLogHeaderTo(Logger& log) const;
+				template<class Logger> void writeLogDataTo(Logger& log) const;
 				/**
 				 * Split state vector.
 				 *
@@ -89,6 +89,10 @@ namespace jafar {
 				    const double _dt, vec & _xnew, mat & _XNEW_x, mat & _XNEW_u);
 				
 				void move(double time);
+				/**
+				 * Mean of the state after a move between two odometry readings, see RobotAbstract::move_mean.
+				 */
+				bool move_mean(const vec & _x, const double *prev_reading, const double *next_reading, vec & _xnew);
 
 				void init_func(const vec & _x, const vec & _u, vec & _xnew);
 
@@ -115,9 +119,13 @@ namespace jafar {
 				
 				virtual void writeLogHeader(kernel::DataLogger& log) const;
 				virtual void writeLogData(kernel::DataLogger& log) const;
+				virtual void writeLogHeader(BinaryLogger& log) const;
+				virtual void writeLogData(BinaryLogger& log) const;
 				
-
 			protected:
+				/// the same columns for both loggers
+				template<class Logger> void writeLogHeaderTo(Logger& log) const;
+				template<class Logger> void writeLogDataTo(Logger& log) const;
 				/**
 				 * Split state vector.
 				 *
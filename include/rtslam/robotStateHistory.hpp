@@ -0,0 +1,83 @@
+/**
+ * \file robotStateHistory.hpp
+ *
+ * Header file for the history of robot states, used to process
+ * out-of-sequence measurements.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef ROBOT_STATE_HISTORY_HPP_
+#define ROBOT_STATE_HISTORY_HPP_
+
+#include <deque>
+
+#include "jmath/jblas.hpp"
+
+namespace jafar {
+	namespace rtslam {
+
+		/**
+		 * Short history of the robot states, to apply measurements that arrive
+		 * after the robot has already been predicted past their date
+		 * (out-of-sequence measurements), without rolling back the filter.
+		 *
+		 * A snapshot is kept at each robot move, with the mean of the robot state
+		 * and the product of the Jacobians and the process noise of the elementary
+		 * moves since the previous snapshot. This is enough to retrodict the robot
+		 * state at the date of the measurement, and to express the measurement
+		 * wrt the current state (see ExtendedKalmanFilterIndirect::correctDelayed).
+		 *
+		 * \ingroup rtslam
+		 */
+		class RobotStateHistory
+		{
+			private:
+				struct Snapshot
+				{
+					double time;
+					jblas::vec x;       ///< mean of the robot state, corrected with the updates made at this date
+					jblas::mat F;       ///< Jacobian of this state wrt the state of the previous snapshot
+					jblas::sym_mat Q;   ///< process noise since the previous snapshot
+				};
+				double window; ///< duration of the history (s), 0 to disable it
+				std::deque<Snapshot> snapshots;
+				jblas::mat F_acc;     ///< Jacobian accumulated since the last snapshot
+				jblas::sym_mat Q_acc; ///< process noise accumulated since the last snapshot
+
+			public:
+				RobotStateHistory(): window(0.) {}
+
+				void setWindow(double window) { this->window = window; if (window <= 0.) snapshots.clear(); }
+				double getWindow() { return window; }
+				bool enabled() { return window > 0.; }
+				double oldestTime() { return (snapshots.empty() ? -1. : snapshots.front().time); }
+
+				/// accumulate an elementary move
+				void accumulate(const jblas::mat & F, const jblas::sym_mat & Q);
+				/// set the mean of the last snapshot to the current corrected state, before moving again
+				void update(const jblas::vec & x);
+				/// add a snapshot after the robot has moved, and forget those out of the window
+				void push(double time, const jblas::vec & x);
+
+				/**
+				 * Retrodict the robot state.
+				 * The step between the two snapshots around t is split at t, assuming that its
+				 * Jacobian and process noise grow linearly with time.
+				 * \param t the date of the measurement, older than the current date
+				 * \param x_now the current mean of the robot state
+				 * \param x_t the retrodicted mean at date t
+				 * \param X_x the Jacobian of x_t wrt the current state
+				 * \param W the process noise between t and now, in the current state space
+				 * \return false if t is not covered by the history
+				 */
+				bool retrodict(double t, const jblas::vec & x_now, jblas::vec & x_t, jblas::mat & X_x, jblas::sym_mat & W);
+		};
+
+	}
+}
+
+#endif
@@ -42,7 +42,8 @@ namespace jafar {
 
 	namespace rtslam {
 
-		extern unsigned int rand_state;
+		/// one random sequence per thread, so that each map processed in its own thread is reproducible
+		extern __thread unsigned int rand_state;
 		inline void srand(unsigned int seed)
 		{
 // 			JFR_DEBUG("!rand: seed " << seed);
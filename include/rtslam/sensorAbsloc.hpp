@@ -133,12 +133,28 @@ namespace jafar {
 					else
 						hardwareSensorPtr->getRaw(id, reading);
 
+					// out-of-sequence reading : use the robot state retrodicted at its date
+					bool delayed = false;
+					jblas::vec x_r;
+					jblas::mat XR_x;
+					jblas::sym_mat W;
+					if (!first && reading.data(0) < robotPtr()->self_time && robotPtr()->history.enabled())
+					{
+						if (!robotPtr()->history.retrodict(reading.data(0), robotPtr()->state.x(), x_r, XR_x, W))
+						{
+							JFR_DEBUG("AbsLoc reading " << robotPtr()->self_time - reading.data(0) << " s late is older than the robot history, discarded");
+							return;
+						}
+						delayed = true;
+					}
+					jblas::vec robot_pose = (delayed ? jblas::vec(ublas::subrange(x_r, 0, 7)) : jblas::vec(robotPtr()->pose.x()));
+
 					EXP_rs.clear();
 					expectation->P() = jblas::zero_mat(inns);
 					jblas::vec T = ublas::subrange(pose.x(), 0, 3);
 					jblas::vec r = ublas::subrange(pose.x(), 3, 7);
-					jblas::vec p = ublas::subrange(robotPtr()->pose.x(), 0, 3);
-					jblas::vec q = ublas::subrange(robotPtr()->pose.x(), 3, 7);
+					jblas::vec p = ublas::subrange(robot_pose, 0, 3);
+					jblas::vec q = ublas::subrange(robot_pose, 3, 7);
 					jblas::vec Tr = quaternion::rotate(q,T);
 
 					// POSITION
@@ -259,6 +275,19 @@ namespace jafar {
 								" ; initial position " << ublas::subrange(robotPtr()->pose.x(), 0,3) <<
 								" ; initial position var " << ublas::subrange(robotPtr()->pose.P(), 0,3, 0,3) << std::endl;
 						}
+					} else if (delayed)
+					{
+						// express the innovation wrt the current robot state
+						ind_array ia_r = robotPtr()->state.ia();
+						jblas::mat INN_r = -ublas::prod(ublas::subrange(EXP_rs, 0,inns, 0,7), ublas::subrange(XR_x, 0,7, 0,XR_x.size2()));
+						expectation->P() += ublasExtra::prod_JPJt(ublas::project(robotPtr()->mapPtr()->filterPtr->P(), ia_r, ia_r), INN_r);
+						innovation->x() = measurement->x() - expectation->x();
+						innovation->P() = measurement->P() + expectation->P();
+
+						map_ptr_t mapPtr = robotPtr()->mapPtr();
+						ind_array ia_x = mapPtr->ia_used_states();
+						jblas::mat INN_w = -INN_r;
+						mapPtr->filterPtr->correctDelayed(ia_x,*innovation,INN_r,ia_r,ia_r,INN_w,W);
 					} else
 					{
 						// compute expectation->P and innovation
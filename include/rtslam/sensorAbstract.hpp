@@ -19,6 +19,7 @@
 #include "jmath/jblas.hpp"
 #include "rtslam/rtSlam.hpp"
 #include "kernel/IdFactory.hpp"
+#include "kernel/jafarException.hpp"
 //include parents
 #include "rtslam/parents.hpp"
 #include "rtslam/mapAbstract.hpp"
@@ -84,6 +85,8 @@ namespace jafar {
 				virtual void discard(unsigned id) = 0; ///< discard a data without using it
 				virtual void init(double date) { use_for_init = false; } ///< use previous data to initialize the robot if needed
 				virtual void start() = 0;
+				/// wait at most timeout (s) for the hardware to provide data that can be used, \return whether it does
+				virtual bool waitReady(double timeout) = 0;
 
 				enum type_enum {
 					PINHOLE, BARRETO
@@ -160,6 +163,7 @@ namespace jafar {
 				void setHardwareSensor(hardware::hardware_sensorprop_ptr_t hardwareSensorPtr_)
 					{ hardwareSensorPtr = hardwareSensorPtr_; }
 				virtual void start() { hardwareSensorPtr->start(); }
+				virtual bool waitReady(double timeout) { return hardwareSensorPtr->waitReady(timeout); }
 				
 				virtual int queryAvailableRaws(RawInfos &infos)
 					{ int res = hardwareSensorPtr->getUnreadRawInfos(infos); infos.integrate_all = integrate_all; return res; }
@@ -216,6 +220,7 @@ namespace jafar {
 				void setHardwareSensor(hardware::hardware_sensorext_ptr_t hardwareSensorPtr_)
 					{ hardwareSensorPtr = hardwareSensorPtr_; }
 				virtual void start() { hardwareSensorPtr->start(); }
+				virtual bool waitReady(double timeout) { return hardwareSensorPtr->waitReady(timeout); }
 				
 //				virtual int acquireRaw() = 0;
 //				virtual raw_ptr_t getRaw() = 0;
@@ -229,6 +234,23 @@ namespace jafar {
 				void process(unsigned id);
 				void process_fake(unsigned id) { hardwareSensorPtr->getRaw(id, rawPtr); robotPtr()->move_fake(rawPtr->timestamp); rawCounter++; }
 				void discard(unsigned id) { hardwareSensorPtr->getRaw(id, rawPtr); }
+
+				/**
+				 * Process the raws of several exteroceptive sensors of the same robot taken at the same date
+				 * in a single filter step: their known observations are matched in parallel against the same
+				 * state, one thread per sensor, and all their corrections are applied with one stacked update.
+				 * The map management and the detection of new landmarks are then done for each sensor in turn,
+				 * as in process(). The result is the same as processing them one after the other,
+				 * except that all the corrections are linearized around the same state.
+				 * The sensors must not share their detectors and matchers.
+				 */
+				static void processGroup(std::vector<sensor_ptr_t> const &sensors, std::vector<unsigned> const &ids);
+			private:
+				void matchKnownGrouped(std::vector<unsigned> const &seeds);
+				/// matchKnownGrouped in its own thread, error being set to the exception it may throw
+				void matchGroupedTask(std::vector<unsigned> const &seeds, boost::shared_ptr<kernel::Exception> &error);
+				/// marks the observations of the last raw as changed for the display (see ObservationAbstract::touchIfShown)
+				void touchObservations();
 		};
 
 	}
@@ -13,7 +13,15 @@
 #ifndef SENSOR_MANAGER_HPP_
 #define SENSOR_MANAGER_HPP_
 
+#include <queue>
+#include <map>
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include "kernel/timingTools.hpp"
 #include "rtslam/sensorAbstract.hpp"
+#include "rtslam/replayClock.hpp"
 
 namespace jafar {
 namespace rtslam {
@@ -36,10 +44,6 @@ namespace rtslam {
 	*/
 	class SensorManagerAbstract
 	{
-		protected:
-			map_ptr_t mapPtr;
-			double start_date;
-			bool all_init;
 		public:
 		
 		struct ProcessInfo
@@ -52,13 +56,90 @@ namespace rtslam {
 			ProcessInfo(): sen(), id(0), no_more_data(false) {}
 		};
 		
-		SensorManagerAbstract(map_ptr_t mapPtr): mapPtr(mapPtr), start_date(0.), all_init(false) {}
+		protected:
+			map_ptr_t mapPtr;
+			double start_date;
+			bool all_init;
+			bool offline; ///< replay without notion of time, to be repeatable
+			hardware::replay_clock_ptr_t replay_clock;
+			
+			// real-time statistics
+			unsigned used_count;
+			unsigned dropped_count;
+			double last_use_date; ///< real date when the last data was returned, to measure its processing time
+			bool waiting; ///< no data was returned last time, so the caller waited for new data
+			double wake_date; ///< see getWakeDate
+			hardware::Histogram latency_hist;
+			hardware::Histogram processing_hist;
+			hardware::Histogram wakeup_hist;
+			
+			/// current date, virtual when emulating real-time in replay
+			double getTime() { return (replay_clock ? replay_clock->now() : kernel::Clock::getTime()); }
+			
+			/// update the statistics with the data that is going to be used
+			void recordUse(sensor_ptr_t sen, double timestamp)
+			{
+				if (replay_clock) replay_clock->start(timestamp); // does nothing if already started
+				++used_count;
+				if (!offline) latency_hist.add(getTime() - timestamp);
+				last_use_date = kernel::Clock::getTime();
+				// the older unread raws of this sensor will be discarded
+				RawInfos infos;
+				sen->queryAvailableRaws(infos);
+				for(std::vector<RawInfo>::iterator it = infos.available.begin(); it != infos.available.end(); ++it)
+				{
+					if (it->timestamp < timestamp) ++dropped_count;
+					// time between the arrival of the data that woke up the caller and the start of its processing
+					if (it->timestamp == timestamp && waiting && !offline && it->arrival >= it->timestamp)
+						wakeup_hist.add(getTime() - it->arrival);
+				}
+				waiting = false;
+			}
+			
+			/**
+				Init phase, that must be done before the normal processing.
+				It doesn't block when a sensor has no data yet, the caller waits for new data
+				as for any other data, so that it is woken up as soon as it arrives.
+				@return true if the init is not finished, result being then the data to use for init, or nothing to wait
+			*/
+			bool initStep(ProcessInfo &result)
+			{
+				if (all_init) return false;
+				int res = getNextDataToInit(result);
+				if (res == 0) { all_init = true; return false; }
+				if (res == 1) result = ProcessInfo(false);
+				return true;
+			}
+		public:
+		
+		SensorManagerAbstract(map_ptr_t mapPtr, bool offline = false): mapPtr(mapPtr), start_date(0.), all_init(false), offline(offline),
+			used_count(0), dropped_count(0), last_use_date(-1.), waiting(false), wake_date(std::numeric_limits<double>::infinity()),
+			latency_hist(0.005, 40), processing_hist(0.005, 40), wakeup_hist(0.0005, 40) {}
 		
 		void setStartDate(double start_date) { this->start_date = start_date; }
+		/**
+			Emulate real-time in replay with this clock. It must also be given
+			to the hardware sensors, and the manager must be one that is used live.
+		*/
+		void setReplayClock(hardware::replay_clock_ptr_t clock) { replay_clock = clock; }
 		virtual ProcessInfo getNextDataToUse_func() = 0;
+		/**
+			When getNextDataToUse returned no data, the date (kernel::Clock) at which the caller
+			must ask again even if no new data arrived, because a late sensor is then given up.
+			Infinity if only new data can change the decision. With a replay clock the clock
+			itself notifies the raw data condition at that date.
+		*/
+		double getWakeDate() { return wake_date; }
+		/// number of data returned by getNextDataToUse and getGroupedData
+		unsigned getUsedCount() { return used_count; }
+		/// number of data discarded or skipped without being used
+		unsigned getDroppedCount() { return dropped_count; }
 
 		ProcessInfo getNextDataToUse()
 		{
+			// the time since the last data was returned is the time spent processing it
+			if (last_use_date >= 0.) { processing_hist.add(kernel::Clock::getTime() - last_use_date); last_use_date = -1.; }
+			
 			ProcessInfo pinfo;
 			while (true)
 			{
@@ -68,9 +149,55 @@ namespace rtslam {
 				else
 					break;
 			}
+			if (pinfo.sen) recordUse(pinfo.sen, pinfo.sen->getRawTimestamp(pinfo.id)); else waiting = true;
 			return pinfo;
 		}
 		
+		/**
+			Complete the data returned by getNextDataToUse with the available raws of the other
+			exteroceptive sensors of the same robot that are within tolerance of its timestamp,
+			the closest one for each sensor, so that they are processed in the same filter step
+			(see SensorExteroAbstract::processGroup).
+			@param pinfo the data returned by getNextDataToUse
+			@param sensors, ids the data of the group, starting with pinfo
+		*/
+		void getGroupedData(ProcessInfo const &pinfo, double tolerance, std::vector<sensor_ptr_t> &sensors, std::vector<unsigned> &ids)
+		{
+			sensors.clear(); ids.clear();
+			if (!pinfo.sen) return;
+			sensors.push_back(pinfo.sen); ids.push_back(pinfo.id);
+			if (pinfo.sen->kind != SensorAbstract::EXTEROCEPTIVE) return;
+			double timestamp = pinfo.sen->getRawTimestamp(pinfo.id);
+			
+			RawInfos infos;
+			robot_ptr_t robPtr = pinfo.sen->robotPtr();
+			for (RobotAbstract::SensorList::iterator senIter = robPtr->sensorList().begin(); senIter != robPtr->sensorList().end(); ++senIter)
+			{
+				if (*senIter == pinfo.sen || (*senIter)->kind != SensorAbstract::EXTEROCEPTIVE) continue;
+				(*senIter)->queryAvailableRaws(infos);
+				std::vector<RawInfo>::iterator closest = infos.available.end();
+				for(std::vector<RawInfo>::iterator it = infos.available.begin(); it != infos.available.end(); ++it)
+					if (std::abs(it->timestamp - timestamp) <= tolerance &&
+					    (closest == infos.available.end() || std::abs(it->timestamp - timestamp) < std::abs(closest->timestamp - timestamp)))
+						closest = it;
+				if (closest == infos.available.end()) continue;
+				
+				sensors.push_back(*senIter); ids.push_back(closest->id);
+				recordUse(*senIter, closest->timestamp);
+			}
+		}
+		
+		/// print the number of used and dropped data, and the latency and processing time histograms
+		void printStatistics(std::ostream &os)
+		{
+			os << "Sensor manager: " << used_count << " data used, " << dropped_count << " dropped";
+			if (replay_clock) os << " (real-time emulated at rate " << replay_clock->getRate() << ")";
+			os << std::endl;
+			latency_hist.print(os, "Latency");
+			processing_hist.print(os, "Processing time");
+			wakeup_hist.print(os, "Wake-up latency");
+		}
+		
 		/**
 			@return 0 if no more sensor to init, 1 if needs to wait for data to init, 2 if returned correctly a data for init
 			*/
@@ -126,7 +253,7 @@ namespace rtslam {
 	class SensorManagerReplay: public SensorManagerAbstract
 	{
 		public:
-			SensorManagerReplay(map_ptr_t mapPtr): SensorManagerAbstract(mapPtr) {}
+			SensorManagerReplay(map_ptr_t mapPtr): SensorManagerAbstract(mapPtr, true) {}
 			
 			virtual ProcessInfo getNextDataToUse_func()
 			{
@@ -136,17 +263,8 @@ namespace rtslam {
 				result.no_more_data = true;
 				bool wait_data = false;
 				
-				if (!all_init)
-				{
-					ProcessInfo result;
-					int res;
-					do {
-						res = getNextDataToInit(result);
-						if (res == 0) { all_init = true; break; } else
-						if (res == 2) { return result; } else
-						usleep(1000);
-					} while (res == 1);
-				}
+				ProcessInfo init_result;
+				if (initStep(init_result)) return init_result;
 				
 				for (MapAbstract::RobotList::iterator robIter = mapPtr->robotList().begin();
 					robIter != mapPtr->robotList().end(); ++robIter)
@@ -172,7 +290,7 @@ namespace rtslam {
 	/**
 		This sensor managers deals in a simple way with one sensor 
 		with integrate_all policy and one sensor with integrate_last policy.
-		It is temporary waiting for a good generic solution.
+		It is temporary, see SensorManagerScheduler for the generic solution.
 		
 		\ingroup rtslam
 	*/
@@ -188,17 +306,8 @@ namespace rtslam {
 			
 			virtual ProcessInfo getNextDataToUse_func()
 			{
-				if (!all_init)
-				{
-					ProcessInfo result;
-					int res;
-					do {
-						res = getNextDataToInit(result);
-						if (res == 0) { all_init = true; break; } else
-						if (res == 2) { return result; } else
-						usleep(1000);
-					} while (res == 1);
-				}
+				ProcessInfo init_result;
+				if (initStep(init_result)) return init_result;
 
     
 				if (!senAllPtr || !senLastPtr)
@@ -245,7 +354,7 @@ namespace rtslam {
 				
 				// one of each
 				bool no_more_data = ((resAll == -2) && (resLast == -2));
-				double tnow = kernel::Clock::getTime();
+				double tnow = getTime();
 					
 				if (infosAll.available.size() > 0)
 				{ // has all
@@ -287,6 +396,183 @@ namespace rtslam {
 		
 	};
 	
+
+	/**
+		Generic sensor manager for any number of sensors, that integrates the data
+		of all sensors in chronological order.
+		
+		Each sensor has a policy that choses which of its raws can be used
+		(all of them, the latest only, one out of n, or those that are not older
+		than a deadline). These candidates are sorted by timestamp in a priority
+		queue and the oldest one is used, unless another sensor has not provided
+		yet a data that is predicted to be older : we then wait for it until its
+		predicted arrival date plus a bounded lateness, after which it is ignored.
+		
+		In replay without real-time emulation (offline) time has no meaning, so
+		we always wait for all the sensors, and the latest and deadline policies
+		behave as process all, in order to be repeatable.
+		With real-time emulation the decisions are the same as live.
+		
+		\ingroup rtslam
+	*/
+	class SensorManagerScheduler: public SensorManagerAbstract
+	{
+		public:
+			struct Policy
+			{
+				enum Type { pAll, pLatest, pDecimate, pDeadline };
+				Type type;
+				unsigned decimation; ///< for pDecimate, use one raw out of decimation
+				double deadline; ///< for pDeadline, raws older than this (s) are dropped
+				double max_lateness; ///< how long after its predicted arrival the next raw of this sensor can be waited for (s)
+				Policy(Type type = pAll, unsigned decimation = 1, double deadline = 0., double max_lateness = 0.):
+					type(type), decimation(decimation), deadline(deadline), max_lateness(max_lateness) {}
+			};
+		protected:
+			struct SensorState
+			{
+				sensor_ptr_t sen;
+				Policy policy;
+				unsigned skip; ///< number of raws to drop before the next one to use (pDecimate)
+				int status;
+				int candidate; ///< index in infos.available of the raw to use, -1 if none
+				RawInfos infos;
+				SensorState(sensor_ptr_t sen, Policy const &policy): sen(sen), policy(policy), skip(0), status(-1), candidate(-1) {}
+			};
+			struct Candidate
+			{
+				double timestamp;
+				unsigned sensor;
+				unsigned id;
+				Candidate(double timestamp, unsigned sensor, unsigned id): timestamp(timestamp), sensor(sensor), id(id) {}
+				bool operator<(Candidate const &c) const { return timestamp > c.timestamp; } // oldest on top
+			};
+			
+			std::map<SensorAbstract*, Policy> policies;
+			std::vector<SensorState> sensors;
+			
+			void buildSensors()
+			{
+				for (MapAbstract::RobotList::iterator robIter = mapPtr->robotList().begin();
+					robIter != mapPtr->robotList().end(); ++robIter)
+				{
+					for (RobotAbstract::SensorList::iterator senIter = (*robIter)->sensorList().begin();
+						senIter != (*robIter)->sensorList().end(); ++senIter)
+					{
+						std::map<SensorAbstract*, Policy>::iterator pol = policies.find(senIter->get());
+						if (pol != policies.end())
+							sensors.push_back(SensorState(*senIter, pol->second));
+						else
+							sensors.push_back(SensorState(*senIter, Policy((*senIter)->getIntegrationPolicy() ? Policy::pAll : Policy::pLatest)));
+					}
+				}
+			}
+			
+			/// discard the raws of the sensor until index k included
+			void drop(SensorState &state, int k)
+			{
+				state.sen->discard(state.infos.available[k].id);
+				state.infos.available.erase(state.infos.available.begin(), state.infos.available.begin()+k+1);
+				dropped_count += k+1;
+			}
+			
+			/**
+				Apply the policy of the sensor to find its candidate raw
+				@return true if some raws were dropped
+			*/
+			bool selectCandidate(SensorState &state, double tnow)
+			{
+				std::vector<RawInfo> &available = state.infos.available;
+				bool dropped = false;
+				Policy::Type type = state.policy.type;
+				if (offline && (type == Policy::pLatest || type == Policy::pDeadline)) type = Policy::pAll;
+				
+				if (type == Policy::pDecimate && state.skip > 0 && !available.empty())
+				{
+					unsigned n = std::min<unsigned>(state.skip, available.size());
+					drop(state, n-1);
+					state.skip -= n;
+					dropped = true;
+				}
+				if (type == Policy::pDeadline)
+				{
+					int k = -1;
+					while (k+1 < (int)available.size() && available[k+1].timestamp < tnow - state.policy.deadline) ++k;
+					if (k >= 0) { drop(state, k); dropped = true; }
+				}
+				
+				if (available.empty()) state.candidate = -1; else
+				if (type == Policy::pLatest) state.candidate = available.size()-1; else
+					state.candidate = 0;
+				return dropped;
+			}
+			
+		public:
+			SensorManagerScheduler(map_ptr_t mapPtr, bool offline = false): SensorManagerAbstract(mapPtr, offline) {}
+			
+			/// must be called before the first data is processed, default is all or latest depending on the integration policy of the sensor
+			void setPolicy(sensor_ptr_t sen, Policy const &policy) { policies[sen.get()] = policy; }
+			
+			virtual ProcessInfo getNextDataToUse_func()
+			{
+				ProcessInfo init_result;
+				if (initStep(init_result)) return init_result;
+				
+				if (sensors.empty()) buildSensors();
+				
+				double tnow = getTime();
+				wake_date = std::numeric_limits<double>::infinity();
+				bool no_more_data;
+				bool dropped;
+				do {
+					no_more_data = true;
+					dropped = false;
+					for(std::vector<SensorState>::iterator it = sensors.begin(); it != sensors.end(); ++it)
+					{
+						it->status = it->sen->queryAvailableRaws(it->infos);
+						if (it->status != -2) no_more_data = false;
+						if (selectCandidate(*it, tnow)) dropped = true;
+					}
+				} while (dropped); // query again so that the raws that were hidden by the dropped ones are available
+				
+				// the sensors that may still provide older data limit the candidates that can be used
+				double limit = std::numeric_limits<double>::infinity();
+				for(std::vector<SensorState>::iterator it = sensors.begin(); it != sensors.end(); ++it)
+				{
+					if (it->candidate >= 0 || it->status == -2) continue;
+					if (offline)
+						limit = -std::numeric_limits<double>::infinity();
+					else if (tnow <= it->infos.next.arrival + it->policy.max_lateness)
+					{
+						limit = std::min(limit, it->infos.next.timestamp);
+						double give_up = it->infos.next.arrival + it->policy.max_lateness;
+						if (replay_clock) replay_clock->notifyAt(give_up); else wake_date = std::min(wake_date, give_up);
+					}
+				}
+				
+				std::priority_queue<Candidate> queue;
+				for(unsigned i = 0; i < sensors.size(); ++i)
+				{
+					SensorState &state = sensors[i];
+					if (state.candidate < 0) continue;
+					std::vector<RawInfo> &available = state.infos.available;
+					int k = state.candidate;
+					// for the latest policy, fall back on the newest raw that won't block the other sensors
+					if (state.policy.type == Policy::pLatest && !offline)
+						while (k > 0 && available[k].timestamp >= limit) --k;
+					if (available[k].timestamp < limit)
+						queue.push(Candidate(available[k].timestamp, i, available[k].id));
+				}
+				
+				if (queue.empty()) return ProcessInfo(no_more_data); // wait
+				
+				Candidate const &best = queue.top();
+				SensorState &state = sensors[best.sensor];
+				if (state.policy.type == Policy::pDecimate && state.policy.decimation > 1) state.skip = state.policy.decimation-1;
+				return ProcessInfo(state.sen, best.id);
+			}
+	};
+	
 	
 }}
 
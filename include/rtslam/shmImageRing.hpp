@@ -0,0 +1,157 @@
+/**
+ * \file shmImageRing.hpp
+ *
+ * Header file for the ring of images in POSIX shared memory, used to get
+ * images from an acquisition process running on the same machine.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef SHM_IMAGE_RING_HPP_
+#define SHM_IMAGE_RING_HPP_
+
+#include <string>
+#include <stdint.h>
+#include <pthread.h>
+
+#include <boost/shared_ptr.hpp>
+
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	namespace shm {
+		const uint32_t magic = 0x5254534d; // "RTSM"
+		const uint32_t version = 1;
+		const size_t alignment = 64;
+
+		/**
+		Header at the beginning of the shared memory segment.
+		The segment contains then nslots slots of slot_stride bytes, each one made
+		of a FrameHeader and of the image data at data_offset from the slot.
+		*/
+		struct RingHeader
+		{
+			uint32_t magic;        ///< set last by the producer once everything is initialized
+			uint32_t version;
+			uint32_t nslots;
+			uint32_t slot_stride;  ///< bytes between two slots
+			uint32_t data_offset;  ///< bytes between the beginning of a slot and its image data
+			uint32_t data_size;    ///< maximum size of the image data of a slot
+			uint32_t closed;       ///< the producer won't write anymore
+			int32_t consumer_pid;  ///< 0 if there is no consumer, then the producer doesn't care about read_seq
+			uint64_t write_seq;    ///< number of frames published, the last one is write_seq-1
+			uint64_t read_seq;     ///< oldest frame still used by the consumer, that must not be overwritten
+			uint64_t dropped;      ///< frames dropped by the producer because the ring was full
+			pthread_mutex_t mutex; ///< process shared, protects the sequence numbers
+			pthread_cond_t cond;   ///< process shared, signaled when a frame is published
+		};
+
+		/// header of each frame, with the format of the image that follows
+		struct FrameHeader
+		{
+			uint64_t seq;          ///< sequence number of the frame in the slot
+			double timestamp;      ///< date of the image (s)
+			double arrival;        ///< date at which the producer got the image (s)
+			uint32_t size;         ///< size of the image data (bytes)
+			uint32_t width, height;
+			uint32_t depth;        ///< bits per channel
+			uint32_t channels;
+			uint32_t step;         ///< bytes per row
+		};
+	}
+
+
+	class ShmImageRing;
+	typedef boost::shared_ptr<ShmImageRing> shm_image_ring_ptr_t;
+
+	/**
+	Ring of images in a POSIX shared memory segment (shm_open), written by
+	a producer process and read by one consumer process.
+
+	The consumer uses the images in place, so the producer never overwrites
+	a frame that is still used by the consumer (newer than read_seq) as long
+	as a consumer is attached: it drops the new frame instead, so that
+	acquisition is never blocked. Frames are published by incrementing
+	write_seq under the process shared mutex, after the slot has been filled.
+
+	@ingroup rtslam
+	*/
+	class ShmImageRing
+	{
+		private:
+			std::string name;
+			int fd;
+			size_t map_size;
+			shm::RingHeader *header;
+			bool producer;
+
+			ShmImageRing(std::string const &name, int fd, size_t map_size, shm::RingHeader *header, bool producer):
+				name(name), fd(fd), map_size(map_size), header(header), producer(producer) {}
+			void lock();
+			void unlock() { pthread_mutex_unlock(&header->mutex); }
+			unsigned char* slot(uint64_t seq) { return reinterpret_cast<unsigned char*>(header) + sizeof(shm::RingHeader) + (seq % header->nslots) * header->slot_stride; }
+		public:
+			/**
+			Create the segment, replacing any existing one with the same name (producer side)
+			@param name name of the segment, eg "/rtslam_camera"
+			@param depth bits per channel
+			*/
+			static shm_image_ring_ptr_t create(std::string const &name, unsigned nslots, unsigned width, unsigned height, unsigned depth = 8, unsigned channels = 1);
+			/**
+			Open an existing segment (consumer side)
+			@return an empty pointer if the segment doesn't exist or is not initialized yet
+			*/
+			static shm_image_ring_ptr_t open(std::string const &name);
+			~ShmImageRing();
+
+			unsigned slots() { return header->nslots; }
+			unsigned dataSize() { return header->data_size; }
+			/// format of the images, as announced by the producer in the first slot
+			shm::FrameHeader const & format() { return *reinterpret_cast<shm::FrameHeader*>(slot(0)); }
+
+			/// @name Producer
+			/// @{
+			/**
+			Get the slot where the next frame can be written in place
+			@return NULL if the ring is full, in which case the frame must be dropped
+			*/
+			unsigned char* beginWrite();
+			/// tell whether the next frame would be dropped, without dropping it
+			bool isFull(bool locked = false);
+			/// publish the frame written in the slot returned by beginWrite
+			void commitWrite(double timestamp, double arrival);
+			/// copy and publish an image, @return false if it was dropped
+			bool write(const unsigned char *data, unsigned step, double timestamp, double arrival);
+			/// tell the consumer that there won't be any more frame
+			void close();
+			uint64_t dropped() { return header->dropped; }
+			/// @}
+
+			/// @name Consumer
+			/// @{
+			/// attach as the consumer, @return the sequence number of the next frame
+			uint64_t attach();
+			void detach();
+			/**
+			Wait until frame seq is published
+			@param timeout in seconds
+			@return false on timeout or if the producer closed the ring
+			*/
+			bool waitFrame(uint64_t seq, double timeout);
+			bool isClosed() { return header->closed != 0; }
+			/// @return NULL if the frame is not in the ring anymore
+			shm::FrameHeader const * frame(uint64_t seq);
+			const unsigned char* data(uint64_t seq) { return slot(seq) + header->data_offset; }
+			/// frames older than seq are not used anymore and can be overwritten
+			void releaseUntil(uint64_t seq);
+			/// @}
+	};
+
+}}}
+
+#endif
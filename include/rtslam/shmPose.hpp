@@ -0,0 +1,141 @@
+/**
+ * \file shmPose.hpp
+ *
+ * Header file for the publication of the latest robot state in POSIX shared
+ * memory, for the consumers running on the same machine (controllers, loggers).
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef SHM_POSE_HPP_
+#define SHM_POSE_HPP_
+
+#include <string>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/jblas.hpp"
+
+
+namespace jafar {
+namespace rtslam {
+
+	namespace shmpose {
+		const uint32_t magic = 0x50535452; // "RTSP"
+		const uint32_t version = 1;
+		const unsigned maxStateSize = 32;
+		const unsigned maxCovSize = maxStateSize*(maxStateSize+1)/2;
+		enum Type { typeState = 1, typePropagatedState = 2 };
+
+		/**
+		The content of the segment.
+		The sample is protected by a seqlock: the writer increments seq before and
+		after modifying it, so that a reader knows that its copy is consistent if
+		seq was even and didn't change meanwhile. The writer never waits for the
+		readers, that retry instead.
+		*/
+		struct Segment
+		{
+			uint32_t magic;        ///< set last by the writer once everything is initialized
+			uint32_t version;
+			uint32_t state_size;   ///< size of the robot state, the same for all samples
+			uint32_t closed;       ///< the writer won't write anymore
+			volatile uint64_t seq; ///< seqlock, odd while the sample is being written, 2 * number of samples
+			// the sample
+			uint32_t type;         ///< Type
+			uint32_t robot;        ///< id of the robot
+			double time;           ///< date of the state (s)
+			double export_date;    ///< date at which it was written (s)
+			double x[maxStateSize];///< robot state, positions in the export frame
+			double P[maxCovSize];  ///< covariance, upper triangle row by row, of the last filter update
+		};
+	}
+
+	/// copy of the sample of the segment
+	struct ShmPose
+	{
+		uint64_t count;        ///< number of samples written, to detect new ones
+		uint32_t type;
+		uint32_t robot;
+		double time;
+		double export_date;
+		unsigned state_size;
+		double x[shmpose::maxStateSize];
+		double P[shmpose::maxCovSize];
+	};
+
+
+	class ShmPoseWriter;
+	typedef boost::shared_ptr<ShmPoseWriter> shm_pose_writer_ptr_t;
+
+	/**
+	Writer of the segment, in the slam process.
+	*/
+	class ShmPoseWriter
+	{
+		private:
+			std::string name;
+			int fd;
+			shmpose::Segment *segment;
+			ShmPoseWriter(std::string const &name, int fd, shmpose::Segment *segment): name(name), fd(fd), segment(segment) {}
+		public:
+			/**
+			Create the segment, replacing any existing one with the same name.
+			@param name name of the segment, eg "/rtslam_pose"
+			*/
+			static shm_pose_writer_ptr_t create(std::string const &name, unsigned state_size);
+			~ShmPoseWriter();
+			/**
+			Publish a sample. Only one thread may write at a time.
+			@param P the covariance, or NULL to keep the one of the previous sample
+			*/
+			void write(uint32_t type, uint32_t robot, double time, double export_date, jblas::vec const &x, jblas::sym_mat const *P);
+			/// tell the readers that there won't be any more sample
+			void close();
+	};
+
+
+	class ShmPoseReader;
+	typedef boost::shared_ptr<ShmPoseReader> shm_pose_reader_ptr_t;
+
+	/**
+	Reader of the segment, in the consumer processes. There can be any number
+	of readers, they never block the writer.
+	*/
+	class ShmPoseReader
+	{
+		private:
+			int fd;
+			const shmpose::Segment *segment;
+			ShmPoseReader(int fd, const shmpose::Segment *segment): fd(fd), segment(segment) {}
+		public:
+			/**
+			Open an existing segment
+			@return an empty pointer if the segment doesn't exist or is not initialized yet
+			*/
+			static shm_pose_reader_ptr_t open(std::string const &name);
+			~ShmPoseReader();
+			/**
+			Copy the latest sample, retrying while it is being written.
+			@param max_retries the number of retries, writing a sample takes a few microseconds
+			@return false if there is no sample yet, or if it was still being written after
+			  max_retries retries (the writer died while writing)
+			*/
+			bool read(ShmPose &pose, unsigned max_retries = 100000);
+			/**
+			Wait for a sample newer than the given count, by polling the segment
+			@param count the ShmPose::count of the last sample read
+			@param timeout in seconds
+			@return false on timeout or if the writer closed the segment
+			*/
+			bool waitNew(uint64_t count, ShmPose &pose, double timeout, double poll_period = 0.0002);
+			bool isClosed() { return segment->closed != 0; }
+	};
+
+}}
+
+#endif
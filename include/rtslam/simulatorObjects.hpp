@@ -14,7 +14,10 @@
 #ifndef SIMUOBJECTS_HPP_
 #define SIMUOBJECTS_HPP_
 
+#include <sstream>
+
 #include "kernel/dataLog.hpp"
+#include "rtslam/binaryLogger.hpp"
 #include "jmath/jblas.hpp"
 
 namespace jafar {
@@ -48,7 +51,7 @@ namespace simu {
 	};
 	typedef std::vector<Waypoint> Trajectory;
 	
-	class MobileObject: public simu::MapObject, public kernel::DataLoggable
+	class MobileObject: public simu::MapObject, public kernel::DataLoggable, public BinaryLoggable
 	{
 		private:
 			mutable double _t;
@@ -165,6 +168,18 @@ namespace simu {
 				jblas::vec pose = getPose(_t);
 				for(int i = 0 ; i < 6 ; ++i) log.writeData(pose(i));
 			}
+			virtual void writeLogHeader(BinaryLogger& log) const
+			{
+				std::ostringstream oss; oss << "Simu robot " << id;
+				log.writeComment(oss.str()); // a table of its own, where the text log appends it to the robot line
+				log.writeLegendTokens("simu_x simu_y simu_z");
+				log.writeLegendTokens("simu_yaw simu_pitch simu_roll");
+			}
+			virtual void writeLogData(BinaryLogger& log) const
+			{
+				jblas::vec pose = getPose(_t);
+				for(int i = 0 ; i < 6 ; ++i) log.writeData(pose(i));
+			}
 
 	};
 	
@@ -0,0 +1,65 @@
+/**
+ * \file startupCoordinator.hpp
+ *
+ * Header file for waiting at startup until the hardware sensors provide
+ * data that can be used, instead of a fixed delay.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef STARTUP_COORDINATOR_HPP_
+#define STARTUP_COORDINATOR_HPP_
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <boost/function.hpp>
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	/**
+		Waits until all the registered sources (sensors, estimators) are ready, each
+		one having its own timeout. The readiness itself is decided by each source
+		(a first image, enough IMU readings for the biases, a gps fix...), that must
+		block on its data until it is ready or until the timeout expires.
+		In replay the sources are ready as soon as the data are read, so that
+		slam starts at once, and live it starts as soon as the data are there.
+
+		\ingroup rtslam
+	*/
+	class StartupCoordinator
+	{
+		public:
+			/// waits at most timeout seconds for the source to be ready, and tells whether it is
+			typedef boost::function<bool (double timeout)> wait_func_t;
+		private:
+			struct Source
+			{
+				std::string name;
+				wait_func_t wait;
+				double timeout; ///< from the call to wait() (s)
+				bool ready;
+				double delay; ///< time after which it was ready, or the timeout expired (s)
+			};
+			std::vector<Source> sources;
+		public:
+			void add(std::string const &name, wait_func_t wait, double timeout);
+			size_t size() { return sources.size(); }
+			/**
+				Waits for all the sources at the same time, the timeouts starting now.
+				@return true if all the sources are ready
+			*/
+			bool wait();
+			/// print for each source whether it was ready and when
+			void printReport(std::ostream &os);
+	};
+
+}}}
+
+#endif
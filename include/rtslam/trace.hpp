@@ -0,0 +1,86 @@
+/**
+ * \file trace.hpp
+ *
+ * Header file for the trace points of the main phases of slam, recorded by
+ * each thread in its own buffer and written in the chrome trace format.
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ * \ingroup rtslam
+ */
+
+#ifndef RTSLAM_TRACE_HPP_
+#define RTSLAM_TRACE_HPP_
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * 1 compiles the trace points, that only record after trace::start,
+ * 0 removes them at compile time.
+ */
+#ifndef RTSLAM_TRACE
+#define RTSLAM_TRACE 1
+#endif
+
+namespace jafar {
+namespace rtslam {
+namespace trace {
+
+	/// true between start and stop
+	extern volatile bool recording;
+
+	/**
+	Clears the events recorded before and starts recording. It must not be
+	called while other threads record.
+	@param capacity the maximal number of events of each thread, the next ones are dropped
+	*/
+	void start(size_t capacity = 1000000);
+	void stop();
+
+	/// the date in nanoseconds since start
+	int64_t now();
+	/// records an event of the calling thread, from start to end
+	void record(const char *name, int64_t start, int64_t end);
+	/// the name of the calling thread in the trace
+	void setThreadName(std::string const &name);
+
+	/**
+	Writes the events recorded so far as a chrome trace, that can be opened
+	with chrome://tracing or https://ui.perfetto.dev. It can be called while
+	the other threads record, their new events are not written.
+	@return the number of events written
+	*/
+	size_t writeChromeTrace(std::string const &filename);
+	/// the number of events dropped because a thread had no more room
+	size_t nDropped();
+
+
+	/**
+	Records the time spent between its construction and its destruction.
+	@param name a string literal, only its address is stored
+	*/
+	class Scope
+	{
+			const char *name;
+			int64_t start_;
+		public:
+			Scope(const char *name): name(name), start_(recording ? now() : -1) {}
+			~Scope() { if (start_ >= 0) record(name, start_, now()); }
+	};
+
+}}}
+
+#if RTSLAM_TRACE
+	#define RTSLAM_TRACE_CAT_(a,b) a##b
+	#define RTSLAM_TRACE_CAT(a,b) RTSLAM_TRACE_CAT_(a,b)
+	/// traces the rest of the enclosing scope
+	#define RTSLAM_TRACE_SCOPE(name) jafar::rtslam::trace::Scope RTSLAM_TRACE_CAT(rtslam_trace_scope_, __LINE__)(name)
+	#define RTSLAM_TRACE_THREAD(name) jafar::rtslam::trace::setThreadName(name)
+#else
+	#define RTSLAM_TRACE_SCOPE(name)
+	#define RTSLAM_TRACE_THREAD(name)
+#endif
+
+#endif
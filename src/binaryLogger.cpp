@@ -0,0 +1,391 @@
+/**
+ * \file binaryLogger.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/binaryLogger.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+	namespace binlog {
+		const char magic[] = "RTSLOG01";
+		const uint32_t byteOrder = 0x01020304;
+
+		template<typename T> void put(std::vector<char> &block, T value)
+			{ block.insert(block.end(), (const char*)&value, (const char*)&value + sizeof(T)); }
+		void putString(std::vector<char> &block, std::string const &s)
+			{ put(block, (uint32_t)s.size()); block.insert(block.end(), s.begin(), s.end()); }
+		/// starts a record, whose size is patched by endRecord
+		size_t beginRecord(std::vector<char> &block, uint8_t kind)
+			{ put(block, kind); put(block, (uint32_t)0); return block.size(); }
+		void endRecord(std::vector<char> &block, size_t start)
+			{ uint32_t size = block.size() - start; memcpy(&block[start-4], &size, 4); }
+	}
+
+
+	size_t BinaryLogger::typeSize(Type type)
+	{
+		static const size_t sizes[nTypes] = { 8, 4, 4, 4, 1 };
+		return sizes[type];
+	}
+
+	const char* BinaryLogger::typeName(Type type)
+	{
+		static const char* names[nTypes] = { "<f8", "<f4", "<i4", "<u4", "|u1" };
+		return names[type];
+	}
+
+
+	/* ###########################################################################
+	   BlockRing
+	   ######################################################################## */
+
+	bool BinaryLogger::BlockRing::push(Block *block)
+	{
+		size_t next = (head + 1) % slots.size();
+		if (next == tail) return false;
+		slots[head] = block;
+		__sync_synchronize(); // the block is in the slot before the consumer sees it
+		head = next;
+		return true;
+	}
+
+	BinaryLogger::Block* BinaryLogger::BlockRing::pop()
+	{
+		if (tail == head) return NULL;
+		__sync_synchronize(); // the slot is read after head
+		Block *block = slots[tail];
+		__sync_synchronize(); // and before the producer can reuse it
+		tail = (tail + 1) % slots.size();
+		return block;
+	}
+
+
+	/* ###########################################################################
+	   BinaryLogger
+	   ######################################################################## */
+
+	BinaryLogger::BinaryLogger(std::string const &filename, size_t queue_size):
+		current(-1), nlogs(0), f(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+		filled(queue_size), recycled(queue_size), stopping(false), nwaits(0), nbytes(0), nlost(0)
+	{
+		if (!f.is_open())
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogger: cannot open " << filename);
+		f.write(binlog::magic, 8);
+		f.write((const char*)&binlog::byteOrder, 4);
+		if (!f)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogger: cannot write " << filename);
+		thread = new boost::thread(boost::bind(&BinaryLogger::writerTask, this));
+	}
+
+	BinaryLogger::~BinaryLogger()
+	{
+		stop();
+		while (Block *block = recycled.pop()) delete block;
+	}
+
+
+	BinaryLogger::Table& BinaryLogger::currentTable(const char *caller)
+	{
+		if (current < 0)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogger::" << caller << " can only be called by a loggable");
+		return tables[current];
+	}
+
+
+	void BinaryLogger::writeComment(std::string const &comment)
+	{
+		if (current >= 0)
+		{
+			Table &table = tables[current];
+			if (table.name.empty()) table.name = comment; else table.comments.push_back(comment);
+			return;
+		}
+		Block *block = newBlock();
+		size_t start = binlog::beginRecord(*block, recComment);
+		block->insert(block->end(), comment.begin(), comment.end());
+		binlog::endRecord(*block, start);
+		pushBlock(block);
+	}
+
+	void BinaryLogger::writeCurrentDate()
+	{
+		time_t t = time(NULL);
+		char date[64];
+		strftime(date, 64, "%Y-%m-%d %H:%M:%S", localtime(&t));
+		writeComment(date);
+	}
+
+	void BinaryLogger::writeLegend(std::string const &name, Type type)
+	{
+		Column column; column.name = name; column.type = type;
+		currentTable("writeLegend").columns.push_back(column);
+	}
+
+	void BinaryLogger::writeLegendTokens(std::string const &names, Type type)
+	{
+		std::istringstream iss(names);
+		std::string name;
+		while (iss >> name) writeLegend(name, type);
+	}
+
+
+	template<typename T>
+	void BinaryLogger::writeValue(T value)
+	{
+		Table &table = currentTable("writeData");
+		if (table.columns.empty())
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogger: table " << table.name << " has no column");
+		Column &column = table.columns[table.col];
+		switch (column.type)
+		{
+			case Float64: binlog::put(column.data, (double)value); break;
+			case Float32: binlog::put(column.data, (float)value); break;
+			case Int32:   binlog::put(column.data, (int32_t)value); break;
+			case UInt32:  binlog::put(column.data, (uint32_t)value); break;
+			case UInt8:   binlog::put(column.data, (uint8_t)value); break;
+			default: break;
+		}
+		if (++table.col == table.columns.size()) { table.col = 0; ++table.nrows; }
+	}
+
+	void BinaryLogger::writeData(double value) { writeValue(value); }
+	void BinaryLogger::writeData(float value) { writeValue(value); }
+	void BinaryLogger::writeData(int value) { writeValue(value); }
+	void BinaryLogger::writeData(unsigned value) { writeValue(value); }
+
+
+	void BinaryLogger::addLoggable(BinaryLoggable &loggable)
+	{
+		Table table; table.loggable = &loggable; table.nrows = 0; table.col = 0;
+		tables.push_back(table);
+		current = tables.size()-1;
+		loggable.writeLogHeader(*this);
+		current = -1;
+
+		Table &t = tables.back();
+		if (t.name.empty()) { std::ostringstream oss; oss << "table" << tables.size()-1; t.name = oss.str(); }
+		Block *block = newBlock();
+		size_t start = binlog::beginRecord(*block, recSchema);
+		binlog::put(*block, (uint32_t)(tables.size()-1));
+		binlog::putString(*block, t.name);
+		binlog::put(*block, (uint32_t)t.comments.size());
+		for(size_t i = 0; i < t.comments.size(); ++i) binlog::putString(*block, t.comments[i]);
+		binlog::put(*block, (uint32_t)t.columns.size());
+		for(size_t i = 0; i < t.columns.size(); ++i)
+			{ binlog::put(*block, (uint8_t)t.columns[i].type); binlog::putString(*block, t.columns[i].name); }
+		binlog::endRecord(*block, start);
+		pushBlock(block);
+	}
+
+
+	void BinaryLogger::log()
+	{
+		Block *block = newBlock();
+		for(size_t i = 0; i < tables.size(); ++i)
+		{
+			Table &table = tables[i];
+			for(size_t c = 0; c < table.columns.size(); ++c) table.columns[c].data.clear();
+			table.nrows = 0; table.col = 0;
+			current = i;
+			table.loggable->writeLogData(*this);
+			current = -1;
+			if (table.col != 0)
+				JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogger: table " << table.name << " has an incomplete row");
+
+			// the values are gathered column by column
+			size_t start = binlog::beginRecord(*block, recRows);
+			binlog::put(*block, (uint32_t)i);
+			binlog::put(*block, (uint32_t)nlogs);
+			binlog::put(*block, (uint32_t)table.nrows);
+			for(size_t c = 0; c < table.columns.size(); ++c)
+				block->insert(block->end(), table.columns[c].data.begin(), table.columns[c].data.end());
+			binlog::endRecord(*block, start);
+		}
+		++nlogs;
+		pushBlock(block);
+	}
+
+
+	BinaryLogger::Block* BinaryLogger::newBlock()
+	{
+		Block *block = recycled.pop();
+		if (block) block->clear(); else block = new Block();
+		return block;
+	}
+
+	void BinaryLogger::pushBlock(Block *block)
+	{
+		if (stopping) { delete block; return; }
+		while (!filled.push(block))
+		{
+			++nwaits;
+			boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+		}
+		// the writer checks the queue with the lock held before sleeping, so it cannot miss the block
+		boost::unique_lock<boost::mutex> l(mutex_writer);
+		cond_filled.notify_one();
+	}
+
+
+	void BinaryLogger::writeBlock(Block *block)
+	{
+		// once the disk has refused some data the stream stays failed, the following blocks are lost too
+		if (!block->empty() && f) f.write(&(*block)[0], block->size());
+		if (f) nbytes += block->size(); else nlost += block->size();
+	}
+
+	void BinaryLogger::writerTask()
+	{
+		// an exception must not terminate the process, nor stop emptying the queue that log() would wait for
+		while (true)
+		{
+			Block *block = filled.pop();
+			if (!block)
+			{
+				boost::unique_lock<boost::mutex> l(mutex_writer);
+				// the last blocks were pushed before stopping was set with the lock
+				if (!(block = filled.pop()))
+					{ if (stopping) break; cond_filled.wait(l); continue; }
+			}
+			try { writeBlock(block); }
+			catch (std::exception &e) { std::cout << "BinaryLogger: " << e.what() << std::endl; nlost += block->size(); }
+			if (!recycled.push(block)) delete block;
+		}
+		f.close();
+		if (!f && nlost == 0) std::cout << "BinaryLogger: error closing the log (disk full?)" << std::endl;
+	} // writerTask
+
+
+	void BinaryLogger::stop()
+	{
+		if (stopping) return;
+		{
+			boost::unique_lock<boost::mutex> l(mutex_writer);
+			stopping = true;
+			cond_filled.notify_one();
+		}
+		thread->join();
+		delete thread;
+		if (nwaits)
+			std::cout << "BinaryLogger: " << nlogs << " logs written, waited " << nwaits << " times for the disk" << std::endl;
+		if (nlost)
+			std::cout << "BinaryLogger: error writing the log (disk full?), " << nlost << " bytes lost" << std::endl;
+	}
+
+
+	/* ###########################################################################
+	   BinaryLogReader
+	   ######################################################################## */
+
+	double BinaryLogReader::Rows::value(size_t col, size_t row) const
+	{
+		const char *p = data(col, row);
+		switch ((*types)[col])
+		{
+			case BinaryLogger::Float64: { double v; memcpy(&v, p, 8); return v; }
+			case BinaryLogger::Float32: { float v; memcpy(&v, p, 4); return v; }
+			case BinaryLogger::Int32:   { int32_t v; memcpy(&v, p, 4); return v; }
+			case BinaryLogger::UInt32:  { uint32_t v; memcpy(&v, p, 4); return v; }
+			case BinaryLogger::UInt8:   { uint8_t v; memcpy(&v, p, 1); return v; }
+			default: return 0.;
+		}
+	}
+
+
+	namespace {
+		struct PayloadReader
+		{
+			std::vector<char> const &payload; size_t pos;
+			PayloadReader(std::vector<char> const &payload): payload(payload), pos(0) {}
+			void check(size_t n)
+			{
+				if (pos + n > payload.size())
+					JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogReader: truncated record");
+			}
+			template<typename T> T get() { check(sizeof(T)); T v; memcpy(&v, &payload[pos], sizeof(T)); pos += sizeof(T); return v; }
+			std::string getString() { uint32_t n = get<uint32_t>(); check(n); std::string s(&payload[pos], n); pos += n; return s; }
+		};
+	}
+
+	BinaryLogReader::BinaryLogReader(std::string const &filename):
+		f(filename.c_str(), std::ios::in | std::ios::binary)
+	{
+		char magic[8]; uint32_t order = 0;
+		f.read(magic, 8);
+		f.read((char*)&order, 4);
+		if (!f || memcmp(magic, binlog::magic, 8) != 0)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogReader: " << filename << " is not a binary log");
+		if (order != binlog::byteOrder)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogReader: " << filename << " was written with another byte order");
+	}
+
+	bool BinaryLogReader::next(Rows &rows)
+	{
+		while (true)
+		{
+			uint8_t kind; uint32_t size;
+			if (!f.read((char*)&kind, 1) || !f.read((char*)&size, 4)) return false;
+			payload.resize(size);
+			if (size && !f.read(&payload[0], size)) return false; // truncated at the end, as when slam was killed
+			PayloadReader r(payload);
+			switch (kind)
+			{
+				case BinaryLogger::recComment:
+					comments.push_back(std::string(payload.begin(), payload.end()));
+					break;
+				case BinaryLogger::recSchema: {
+					unsigned table = r.get<uint32_t>();
+					if (table >= schemas.size()) schemas.resize(table+1);
+					Schema &schema = schemas[table];
+					schema.name = r.getString();
+					unsigned n = r.get<uint32_t>();
+					for(unsigned i = 0; i < n; ++i) schema.comments.push_back(r.getString());
+					n = r.get<uint32_t>();
+					for(unsigned i = 0; i < n; ++i)
+					{
+						unsigned type = r.get<uint8_t>();
+						if (type >= BinaryLogger::nTypes)
+							JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogReader: unknown type " << type);
+						schema.types.push_back((BinaryLogger::Type)type);
+						schema.columns.push_back(r.getString());
+					}
+					break;
+				}
+				case BinaryLogger::recRows: {
+					rows.table = r.get<uint32_t>();
+					rows.log = r.get<uint32_t>();
+					rows.nrows = r.get<uint32_t>();
+					if (rows.table >= schemas.size())
+						JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "BinaryLogReader: rows of the unknown table " << rows.table);
+					Schema const &schema = schemas[rows.table];
+					rows.types = &schema.types;
+					rows.columns.resize(schema.types.size());
+					for(size_t c = 0; c < schema.types.size(); ++c)
+					{
+						size_t n = rows.nrows * BinaryLogger::typeSize(schema.types[c]);
+						r.check(n);
+						rows.columns[c] = &payload[0] + r.pos;
+						r.pos += n;
+					}
+					return true;
+				}
+				default: // unknown records are skipped, for the future versions
+					break;
+			}
+		}
+	}
+
+}}
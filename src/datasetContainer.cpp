@@ -0,0 +1,551 @@
+/**
+ * \file datasetContainer.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstring>
+#include <map>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/weak_ptr.hpp>
+
+#include <opencv/highgui.h>
+
+#include "kernel/jafarMacro.hpp"
+#include "kernel/timingTools.hpp"
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/datasetContainer.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	namespace dataset {
+
+		bool isDatasetPath(std::string const &path)
+		{
+			const std::string ext = ".rtds";
+			return (path.size() > ext.size() && path.compare(path.size()-ext.size(), ext.size(), ext) == 0);
+		}
+
+		static inline uint64_t padding(uint64_t size)
+			{ return (alignment - size % alignment) % alignment; }
+
+		static bool recordTimestampLess(DatasetRecordInfo const &rec, double t)
+			{ return rec.timestamp < t; }
+
+		size_t imageRowSize(DatasetStreamInfo const &info)
+			{ return info.width * info.channels * (info.depth/8); }
+
+		static int imageCvType(DatasetStreamInfo const &info)
+			{ return CV_MAKETYPE(info.depth == 16 ? CV_16U : CV_8U, info.channels); }
+
+		/// payload of a stream chunk, also copied in the index
+		static void encodeStream(DatasetStreamInfo const &info, std::vector<char> &data)
+		{
+			uint32_t header[8] = { (uint32_t)info.type, (uint32_t)info.width, (uint32_t)info.height, (uint32_t)info.depth,
+			                       (uint32_t)info.channels, (uint32_t)info.params.size(), (uint32_t)info.name.size(), 0 };
+			data.resize(sizeof(header) + info.params.size()*sizeof(double) + info.name.size());
+			memcpy(&data[0], header, sizeof(header));
+			if (info.params.size()) memcpy(&data[sizeof(header)], &info.params[0], info.params.size()*sizeof(double));
+			if (info.name.size()) memcpy(&data[sizeof(header) + info.params.size()*sizeof(double)], info.name.data(), info.name.size());
+		}
+
+		/// @return false if the payload is too small for the description it announces
+		static bool decodeStream(unsigned id, const char *data, uint64_t size, DatasetStreamInfo &info)
+		{
+			uint32_t header[8];
+			if (size < sizeof(header)) return false;
+			memcpy(header, data, sizeof(header));
+			if (sizeof(header) + (uint64_t)header[5]*sizeof(double) + header[6] > size) return false;
+			info.id = id; info.type = header[0]; info.width = header[1]; info.height = header[2];
+			info.depth = header[3]; info.channels = header[4];
+			info.params.resize(header[5]);
+			if (header[5]) memcpy(&info.params[0], data + sizeof(header), header[5]*sizeof(double));
+			info.name.assign(data + sizeof(header) + header[5]*sizeof(double), header[6]);
+			return true;
+		}
+	}
+
+
+	/* ###########################################################################
+	   DatasetWriter
+	   ######################################################################## */
+
+	void DatasetWriter::writeChunk(uint32_t tag, uint32_t stream, const char *header, size_t header_size, const char *data, size_t size)
+	{
+		const char zeros[dataset::alignment] = { 0 };
+		uint64_t payload = header_size + size;
+		f.write((const char*)&tag, 4);
+		f.write((const char*)&stream, 4);
+		f.write((const char*)&payload, 8);
+		if (header_size) f.write(header, header_size);
+		if (size) f.write(data, size);
+		uint64_t pad = dataset::padding(payload);
+		f.write(zeros, pad);
+		pos += dataset::chunkHeaderSize + payload + pad;
+		if (!f) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Could not write to dataset " << path);
+	}
+
+
+	DatasetWriter::DatasetWriter(std::string const &path): path(path), pos(0), flush_period(1.), last_flush(kernel::Clock::getTime())
+	{
+		f.open(path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!f.is_open()) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Could not create dataset " << path);
+		uint32_t reserved = 0;
+		f.write(dataset::fileMagic, 8);
+		f.write((const char*)&dataset::version, 4);
+		f.write((const char*)&reserved, 4);
+		pos = dataset::fileHeaderSize;
+	}
+
+	DatasetWriter::~DatasetWriter()
+	{
+		close();
+	}
+
+
+	unsigned DatasetWriter::addStream(DatasetStreamInfo info)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_file);
+		info.id = streams.size();
+		streams.push_back(info);
+
+		std::vector<char> data;
+		dataset::encodeStream(info, data);
+		writeChunk(dataset::tagStream, info.id, NULL, 0, &data[0], data.size());
+		return info.id;
+	}
+
+
+	void DatasetWriter::write(unsigned stream, double timestamp, double arrival, const char *data, size_t size, int encoding)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_file);
+		if (!f.is_open()) return;
+		JFR_ASSERT(stream < streams.size(), "DatasetWriter: unknown stream " << stream);
+
+		char header[dataset::recordHeaderSize];
+		uint32_t enc = encoding, reserved = 0; uint64_t size64 = size;
+		memcpy(header+0, &timestamp, 8);
+		memcpy(header+8, &arrival, 8);
+		memcpy(header+16, &enc, 4);
+		memcpy(header+20, &reserved, 4);
+		memcpy(header+24, &size64, 8);
+
+		DatasetRecordInfo rec;
+		rec.stream = stream; rec.encoding = encoding; rec.timestamp = timestamp; rec.arrival = arrival;
+		rec.offset = pos + dataset::chunkHeaderSize + dataset::recordHeaderSize; rec.size = size;
+		writeChunk(dataset::tagRecord, stream, header, dataset::recordHeaderSize, data, size);
+		index.push_back(rec);
+
+		// so that not much is lost if the process doesn't close the file, the index can be rebuilt
+		double now = kernel::Clock::getTime();
+		if (now - last_flush >= flush_period) { f.flush(); last_flush = now; }
+	}
+
+
+	void DatasetWriter::writeImage(unsigned stream, double timestamp, double arrival, const uchar *data, int step, int encoding)
+	{
+		DatasetStreamInfo info;
+		{ boost::unique_lock<boost::mutex> l(mutex_file); info = streams[stream]; }
+		size_t row = dataset::imageRowSize(info);
+		switch (encoding)
+		{
+			case dataset::encPng: {
+				std::vector<uchar> encode_buffer;
+				cv::Mat m(info.height, info.width, dataset::imageCvType(info), const_cast<uchar*>(data), step);
+				cv::imencode(".png", m, encode_buffer);
+				write(stream, timestamp, arrival, (const char*)&encode_buffer[0], encode_buffer.size(), encoding);
+				break;
+			}
+			case dataset::encRaw:
+			default: {
+				if ((size_t)step == row)
+					write(stream, timestamp, arrival, (const char*)data, row*info.height, dataset::encRaw);
+				else
+				{ // remove the padding of the rows
+					std::vector<uchar> encode_buffer(row*info.height);
+					for(int y = 0; y < info.height; ++y)
+						memcpy(&encode_buffer[y*row], data + y*step, row);
+					write(stream, timestamp, arrival, (const char*)&encode_buffer[0], encode_buffer.size(), dataset::encRaw);
+				}
+			}
+		}
+	}
+
+
+	void DatasetWriter::writeVector(unsigned stream, double timestamp, double arrival, jblas::vec const &data)
+	{
+		write(stream, timestamp, arrival, (const char*)&(data.data()[0]), data.size()*sizeof(double), dataset::encRaw);
+	}
+
+
+	void DatasetWriter::close()
+	{
+		boost::unique_lock<boost::mutex> l(mutex_file);
+		if (!f.is_open()) return;
+
+		uint64_t index_pos = pos;
+		// the streams first, so that the reader doesn't need to look for their chunks
+		std::vector<char> data(8);
+		uint32_t nstreams = streams.size(), reserved = 0;
+		memcpy(&data[0], &nstreams, 4);
+		memcpy(&data[4], &reserved, 4);
+		std::vector<char> stream_data;
+		for(size_t i = 0; i < streams.size(); ++i)
+		{
+			dataset::encodeStream(streams[i], stream_data);
+			uint64_t size = stream_data.size();
+			data.insert(data.end(), (const char*)&size, (const char*)&size + 8);
+			data.insert(data.end(), stream_data.begin(), stream_data.end());
+		}
+		size_t records_pos = data.size();
+		data.resize(records_pos + index.size()*dataset::indexEntrySize);
+		for(size_t i = 0; i < index.size(); ++i)
+		{
+			char *p = &data[records_pos + i*dataset::indexEntrySize];
+			uint32_t stream = index[i].stream, enc = index[i].encoding;
+			memcpy(p+0, &stream, 4);
+			memcpy(p+4, &enc, 4);
+			memcpy(p+8, &index[i].timestamp, 8);
+			memcpy(p+16, &index[i].arrival, 8);
+			memcpy(p+24, &index[i].offset, 8);
+			memcpy(p+32, &index[i].size, 8);
+		}
+		writeChunk(dataset::tagIndex, 0, NULL, 0, &data[0], data.size());
+		f.write((const char*)&index_pos, 8);
+		f.write(dataset::indexMagic, 8);
+		f.close();
+	}
+
+
+	namespace {
+		boost::mutex writers_mutex;
+		std::map<std::string, boost::weak_ptr<DatasetWriter> > writers;
+	}
+
+	dataset_writer_ptr_t DatasetWriter::shared(std::string const &path)
+	{
+		boost::unique_lock<boost::mutex> l(writers_mutex);
+		dataset_writer_ptr_t writer = writers[path].lock();
+		if (!writer) { writer.reset(new DatasetWriter(path)); writers[path] = writer; }
+		return writer;
+	}
+
+	void DatasetWriter::closeAll()
+	{
+		boost::unique_lock<boost::mutex> l(writers_mutex);
+		for(std::map<std::string, boost::weak_ptr<DatasetWriter> >::iterator it = writers.begin(); it != writers.end(); ++it)
+		{
+			dataset_writer_ptr_t writer = it->second.lock();
+			if (writer) writer->close(); // kept in the map, so that a late writer doesn't recreate the file
+		}
+	}
+
+
+	/* ###########################################################################
+	   DatasetReader
+	   ######################################################################## */
+
+	void DatasetReader::addRecord(DatasetRecordInfo const &rec)
+	{
+		if (rec.stream >= records.size()) records.resize(rec.stream+1);
+		records[rec.stream].push_back(rec);
+	}
+
+
+	bool DatasetReader::loadIndex(uint64_t file_size, uint32_t version)
+	{
+		if (file_size < dataset::fileHeaderSize + dataset::trailerSize) return false;
+		uint64_t index_pos; char magic[8];
+		f.seekg(file_size - dataset::trailerSize);
+		f.read((char*)&index_pos, 8);
+		f.read(magic, 8);
+		if (!f || memcmp(magic, dataset::indexMagic, 8) != 0 || index_pos >= file_size) return false;
+
+		uint32_t tag, stream; uint64_t payload;
+		f.seekg(index_pos);
+		f.read((char*)&tag, 4); f.read((char*)&stream, 4); f.read((char*)&payload, 8);
+		if (!f || tag != dataset::tagIndex) return false;
+		std::vector<char> data(payload);
+		if (payload) f.read(&data[0], payload);
+		if (!f) return false;
+
+		size_t i = 0;
+		if (version >= 2)
+		{
+			if (payload < 8) return false;
+			uint32_t nstreams;
+			memcpy(&nstreams, &data[0], 4);
+			i = 8;
+			for(uint32_t s = 0; s < nstreams; ++s)
+			{
+				uint64_t size;
+				if (i + 8 > payload) return false;
+				memcpy(&size, &data[i], 8);
+				i += 8;
+				DatasetStreamInfo info;
+				if (size > payload - i || !dataset::decodeStream(s, &data[i], size, info)) return false;
+				streams.push_back(info);
+				i += size;
+			}
+		}
+		for(; i+dataset::indexEntrySize <= payload; i += dataset::indexEntrySize)
+		{
+			const char *p = &data[i];
+			DatasetRecordInfo rec; uint32_t enc;
+			memcpy(&stream, p+0, 4); rec.stream = stream;
+			memcpy(&enc, p+4, 4); rec.encoding = enc;
+			memcpy(&rec.timestamp, p+8, 8);
+			memcpy(&rec.arrival, p+16, 8);
+			memcpy(&rec.offset, p+24, 8);
+			memcpy(&rec.size, p+32, 8);
+			addRecord(rec);
+		}
+		return true;
+	}
+
+
+	void DatasetReader::scanChunks(uint64_t file_size, bool read_records)
+	{
+		uint64_t pos = dataset::fileHeaderSize;
+		f.clear();
+		while (pos + dataset::chunkHeaderSize <= file_size)
+		{
+			uint32_t tag, stream; uint64_t payload;
+			f.seekg(pos);
+			f.read((char*)&tag, 4); f.read((char*)&stream, 4); f.read((char*)&payload, 8);
+			if (!f || pos + dataset::chunkHeaderSize + payload > file_size) break; // truncated chunk
+
+			if (tag == dataset::tagStream)
+			{
+				std::vector<char> data(payload);
+				if (payload) f.read(&data[0], payload);
+				DatasetStreamInfo info;
+				if (!f || !dataset::decodeStream(stream, (payload ? &data[0] : NULL), payload, info)) break;
+				if (stream >= streams.size()) streams.resize(stream+1);
+				streams[stream] = info;
+			} else
+			if (tag == dataset::tagRecord && read_records)
+			{
+				DatasetRecordInfo rec; uint32_t enc, reserved;
+				f.read((char*)&rec.timestamp, 8); f.read((char*)&rec.arrival, 8);
+				f.read((char*)&enc, 4); f.read((char*)&reserved, 4); f.read((char*)&rec.size, 8);
+				rec.stream = stream; rec.encoding = enc;
+				rec.offset = pos + dataset::chunkHeaderSize + dataset::recordHeaderSize;
+				addRecord(rec);
+			} else
+			if (tag == dataset::tagIndex)
+				break;
+			pos += dataset::chunkHeaderSize + payload + dataset::padding(payload);
+		}
+		f.clear();
+	}
+
+
+	DatasetReader::DatasetReader(std::string const &path): path(path), map(NULL), map_size(0)
+	{
+		f.open(path.c_str(), std::ios_base::in | std::ios_base::binary);
+		if (!f.is_open()) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Could not open dataset " << path);
+		char magic[8]; uint32_t version;
+		f.read(magic, 8); f.read((char*)&version, 4);
+		if (!f || memcmp(magic, dataset::fileMagic, 8) != 0)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, path << " is not a dataset file");
+		if (version > dataset::version)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Dataset " << path << " has unsupported version " << version);
+
+		f.seekg(0, std::ios_base::end);
+		uint64_t file_size = f.tellg();
+		bool indexed = loadIndex(file_size, version);
+		if (!indexed)
+		{
+			std::cout << "Warning: dataset " << path << " has no index (interrupted recording?), scanning it." << std::endl;
+			streams.clear();
+			records.clear();
+		}
+		// the index describes the streams since version 2, so that the records are not walked through
+		if (!indexed || version < 2) scanChunks(file_size, !indexed);
+		if (records.size() < streams.size()) records.resize(streams.size());
+
+		// map the file, records are then read without system calls nor copies
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			// private writable mapping so that a user modifying an image in place only modifies its copy of the page
+			void *addr = mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (addr != MAP_FAILED) { map = (const char*)addr; map_size = file_size; }
+			::close(fd);
+		}
+		if (!map) std::cout << "Warning: dataset " << path << " could not be memory-mapped, using file reads." << std::endl;
+	}
+
+
+	DatasetReader::~DatasetReader()
+	{
+		if (map) munmap((void*)map, map_size);
+	}
+
+
+	int DatasetReader::findStream(int type, int n)
+	{
+		for(size_t i = 0; i < streams.size(); ++i)
+			if (streams[i].type == type) { if (n == 0) return i; else --n; }
+		return -1;
+	}
+
+
+	int DatasetReader::findStream(std::string const &name)
+	{
+		for(size_t i = 0; i < streams.size(); ++i)
+			if (streams[i].name == name) return i;
+		return -1;
+	}
+
+
+	size_t DatasetReader::findRecord(unsigned stream, double timestamp)
+	{
+		std::vector<DatasetRecordInfo> const &recs = records[stream];
+		return std::lower_bound(recs.begin(), recs.end(), timestamp, dataset::recordTimestampLess) - recs.begin();
+	}
+
+
+	void DatasetReader::read(DatasetRecordInfo const &rec, std::vector<char> &data)
+	{
+		if (map)
+		{
+			data.assign(map + rec.offset, map + rec.offset + rec.size);
+			return;
+		}
+		boost::unique_lock<boost::mutex> l(mutex_file);
+		data.resize(rec.size);
+		f.seekg(rec.offset);
+		if (rec.size) f.read(&data[0], rec.size);
+		if (!f) { f.clear(); JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Could not read record in dataset " << path); }
+	}
+
+
+	void DatasetReader::readImage(DatasetRecordInfo const &rec, uchar *dst, int step)
+	{
+		if (map)
+		{
+			dataset::decodeImage(streams[rec.stream], map + rec.offset, rec.size, rec.encoding, dst, step);
+			return;
+		}
+		std::vector<char> data;
+		read(rec, data);
+		dataset::decodeImage(streams[rec.stream], (data.size() ? &data[0] : NULL), data.size(), rec.encoding, dst, step);
+	}
+
+
+	void DatasetReader::readVector(DatasetRecordInfo const &rec, jblas::vec &data)
+	{
+		if (map)
+		{
+			data.resize(rec.size/sizeof(double));
+			if (rec.size) memcpy(&(data.data()[0]), map + rec.offset, data.size()*sizeof(double));
+			return;
+		}
+		std::vector<char> raw;
+		read(rec, raw);
+		data.resize(raw.size()/sizeof(double));
+		if (raw.size()) memcpy(&(data.data()[0]), &raw[0], data.size()*sizeof(double));
+	}
+
+
+	dataset_reader_ptr_t DatasetReader::shared(std::string const &path)
+	{
+		static boost::mutex mutex;
+		static std::map<std::string, boost::weak_ptr<DatasetReader> > readers;
+		boost::unique_lock<boost::mutex> l(mutex);
+		dataset_reader_ptr_t reader = readers[path].lock();
+		if (!reader) { reader.reset(new DatasetReader(path)); readers[path] = reader; }
+		return reader;
+	}
+
+
+	/* ###########################################################################
+	   VectorLogWriter / VectorLogReader
+	   ######################################################################## */
+
+	std::string dataset::vectorLogPath(std::string const &dump_path, std::string const &name)
+	{
+		if (dataset::isDatasetPath(dump_path)) return dump_path;
+		return dump_path + "/" + name + ".rtds";
+	}
+
+
+	VectorLogWriter::VectorLogWriter(std::string const &dump_path, std::string const &name, int width, std::vector<double> const &params)
+	{
+		writer = DatasetWriter::shared(dataset::vectorLogPath(dump_path, name));
+		DatasetStreamInfo info(dataset::stVector, name, width);
+		info.params = params;
+		stream = writer->addStream(info);
+	}
+
+
+	VectorLogReader::VectorLogReader(std::string const &dump_path, std::string const &name): next(0)
+	{
+		std::string path = dataset::vectorLogPath(dump_path, name);
+		reader = DatasetReader::shared(path);
+		int id = reader->findStream(name);
+		if (id < 0 || reader->stream(id).type != dataset::stVector)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "No log " << name << " in dataset " << path);
+		stream = id;
+	}
+
+
+	bool VectorLogReader::exists(std::string const &dump_path, std::string const &name)
+	{
+		std::string path = dataset::vectorLogPath(dump_path, name);
+		struct stat st;
+		if (::stat(path.c_str(), &st) != 0) return false;
+		if (!dataset::isDatasetPath(dump_path)) return true;
+		dataset_reader_ptr_t reader = DatasetReader::shared(path);
+		return (reader->findStream(name) >= 0);
+	}
+
+
+	bool VectorLogReader::read(jblas::vec &reading, double &arrival)
+	{
+		if (next >= reader->size(stream)) return false;
+		DatasetRecordInfo const &rec = reader->record(stream, next++);
+		reader->readVector(rec, reading);
+		arrival = rec.arrival;
+		return true;
+	}
+
+
+	void dataset::decodeImage(DatasetStreamInfo const &info, const char *data, size_t size, int encoding, uchar *dst, int step)
+	{
+		size_t row = dataset::imageRowSize(info);
+		switch (encoding)
+		{
+			case dataset::encPng: {
+				std::vector<uchar> work((const uchar*)data, (const uchar*)data+size);
+				cv::Mat decoded = cv::imdecode(cv::Mat(work), -1);
+				if (decoded.cols != info.width || decoded.rows != info.height || decoded.elemSize()*decoded.cols != row)
+					JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Dataset image has not the expected size");
+				for(int y = 0; y < info.height; ++y)
+					memcpy(dst + y*step, decoded.ptr(y), row);
+				break;
+			}
+			case dataset::encRaw: {
+				if (size != row*info.height)
+					JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Dataset image has not the expected size");
+				for(int y = 0; y < info.height; ++y)
+					memcpy(dst + y*step, data + y*row, row);
+				break;
+			}
+			default:
+				JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Unknown dataset image encoding " << encoding);
+		}
+	}
+
+}}}
@@ -0,0 +1,299 @@
+/**
+ * \file displaySnapshot.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstring>
+#include <cmath>
+
+#include "rtslam/displaySnapshot.hpp"
+#include "rtslam/worldAbstract.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/robotAbstract.hpp"
+#include "rtslam/dataManagerAbstract.hpp"
+
+#ifdef HAVE_MODULE_DSEG
+#include "rtslam/appearanceSegment.hpp"
+#include "rtslam/simuData.hpp"
+#include "rtslam/descriptorImageSeg.hpp"
+#endif
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+
+	namespace {
+		template<class SymMat>
+		double traceStdev(SymMat const &P)
+		{
+			double trace = 0.;
+			for(size_t i = 0; i < P.size1(); ++i) trace += P(i,i);
+			return sqrt(trace);
+		}
+	}
+
+
+	WorldSnapshotBuffer::WorldSnapshotBuffer(bool with_images, bool with_euclidean, double pos_threshold, double stdev_threshold):
+		published(0), acquired(0), published_t(-1), with_images(with_images), with_euclidean(with_euclidean),
+		pos_threshold(pos_threshold), stdev_threshold(stdev_threshold), ncaptures(0), nstamps(0)
+	{
+		memset(&lastStats, 0, sizeof(Stats));
+	}
+
+
+	bool WorldSnapshotBuffer::publish(world_ptr_t const &world, unsigned t, bool wait)
+	{
+		boost::unique_lock<boost::mutex> write_lock(mutex_write, boost::defer_lock);
+		if (wait) write_lock.lock(); else
+		if (!write_lock.try_lock()) return false;
+
+		// the display may still be rendering the previous back buffer
+		if (!back || !back.unique()) back.reset(new WorldSnapshot());
+		back->t = t;
+		capture(world, *back);
+
+		boost::unique_lock<boost::mutex> l(mutex);
+		back->seq = ++published;
+		published_t = t;
+		std::swap(front, back);
+		l.unlock();
+		cond.notify_all();
+		return true;
+	}
+
+
+	world_snapshot_cptr_t WorldSnapshotBuffer::acquire(uint64_t last_seq, double timeout)
+	{
+		boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds((long)(timeout*1e6));
+		boost::unique_lock<boost::mutex> l(mutex);
+		while (published <= last_seq)
+			if (!cond.timed_wait(l, deadline)) break;
+		if (published <= last_seq) return world_snapshot_cptr_t();
+		acquired = published;
+		world_snapshot_cptr_t snapshot = front;
+		l.unlock();
+		cond.notify_all();
+		return snapshot;
+	}
+
+
+	bool WorldSnapshotBuffer::waitAcquired(double timeout)
+	{
+		boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds((long)(timeout*1e6));
+		boost::unique_lock<boost::mutex> l(mutex);
+		while (acquired != published)
+			if (!cond.timed_wait(l, deadline)) break;
+		return acquired == published;
+	}
+
+
+	template<class SnapshotType>
+	SnapshotType& WorldSnapshotBuffer::writable(Cached<SnapshotType> &cached)
+	{
+		// the published snapshots that still hold the last copy must not see it change
+		if (!cached.snapshot || !cached.snapshot.unique()) cached.snapshot.reset(new SnapshotType());
+		cached.snapshot->stamp = ++nstamps;
+		return *cached.snapshot;
+	}
+
+
+	template<class Key, class SnapshotType>
+	void WorldSnapshotBuffer::forgetOld(std::map<Key, Cached<SnapshotType> > &cache)
+	{
+		for(typename std::map<Key, Cached<SnapshotType> >::iterator it = cache.begin(); it != cache.end(); )
+			if (it->second.seen != ncaptures) cache.erase(it++); else ++it;
+	}
+
+
+	void WorldSnapshotBuffer::capture(world_ptr_t const &world, WorldSnapshot &snapshot)
+	{
+		++ncaptures;
+		memset(&lastStats, 0, sizeof(Stats));
+		snapshot.maps.resize(world->mapList().size());
+		std::vector<MapSnapshot>::iterator snapMap = snapshot.maps.begin();
+		for(WorldAbstract::MapList::iterator map = world->mapList().begin(); map != world->mapList().end(); ++map, ++snapMap)
+		{
+			boost::unique_lock<boost::mutex> process_lock((*map)->mutex_process);
+
+			snapMap->robots.resize((*map)->robotList().size());
+			std::vector<RobotSnapshot>::iterator snapRob = snapMap->robots.begin();
+			for(MapAbstract::RobotList::iterator rob = (*map)->robotList().begin(); rob != (*map)->robotList().end(); ++rob, ++snapRob)
+				capture(**rob, *snapRob);
+
+			// released first, so that the copies only held by this buffer can be written again
+			snapMap->landmarks.clear();
+			for(MapAbstract::MapManagerList::iterator mm = (*map)->mapManagerList().begin(); mm != (*map)->mapManagerList().end(); ++mm)
+				for(MapManagerAbstract::LandmarkList::iterator lmk = (*mm)->landmarkList().begin(); lmk != (*mm)->landmarkList().end(); ++lmk)
+					snapMap->landmarks.push_back(capture(**lmk));
+		}
+		// the objects that disappeared
+		forgetOld(landmarks);
+		forgetOld(observations);
+		lastStats.landmarks = landmarks.size();
+		lastStats.observations = observations.size();
+	}
+
+
+	void WorldSnapshotBuffer::capture(RobotAbstract &rob, RobotSnapshot &snapshot)
+	{
+		snapshot.id = rob.id();
+		snapshot.pose = rob.pose.x();
+		snapshot.poseCov = rob.pose.P();
+
+		size_t nsen = 0;
+		for(RobotAbstract::SensorList::iterator sen = rob.sensorList().begin(); sen != rob.sensorList().end(); ++sen)
+			if ((*sen)->kind == SensorAbstract::EXTEROCEPTIVE) nsen++;
+		snapshot.sensors.resize(nsen);
+		std::vector<SensorSnapshot>::iterator snapSen = snapshot.sensors.begin();
+		for(RobotAbstract::SensorList::iterator sen = rob.sensorList().begin(); sen != rob.sensorList().end(); ++sen)
+			if ((*sen)->kind == SensorAbstract::EXTEROCEPTIVE)
+				capture(*PTR_CAST<SensorExteroAbstract*>(sen->get()), *snapSen++);
+	}
+
+
+	void WorldSnapshotBuffer::capture(SensorExteroAbstract &sen, SensorSnapshot &snapshot)
+	{
+		snapshot.id = sen.id();
+		snapshot.type = sen.type;
+		snapshot.framenumber = sen.rawCounter-1;
+		snapshot.timestamp = (sen.rawCounter > 0 ? sen.rawPtr->timestamp : 0.);
+		snapshot.robot_pose = sen.robotPtr()->pose.x();
+		snapshot.has_raw = false;
+		snapshot.image.reset();
+
+		if (with_images && sen.rawCounter > 0)
+		{
+			SensorImage &last = images[sen.id()];
+			if (last.image && last.framenumber == snapshot.framenumber)
+				snapshot.has_raw = true;
+			else
+			{
+				// the raw buffers of the hardware sensor are recycled, so the image must be copied
+				raw_ptr_t raw = sen.getLastProcessedRaw();
+				if (raw)
+				{
+					snapshot.has_raw = true;
+					RawImage *rawImg = dynamic_cast<RawImage*>(raw.get());
+					if (rawImg)
+					{
+						// the front snapshot still holds the previous image, reuse the one before if no snapshot holds it anymore
+						std::swap(last.image, last.spare);
+						if (last.image && last.image.unique())
+							rawImg->img->copyTo(*last.image);
+						else
+							last.image.reset(new image::Image(rawImg->img->clone()));
+						last.framenumber = snapshot.framenumber;
+					}
+				}
+			}
+			if (last.image && last.framenumber == snapshot.framenumber) snapshot.image = last.image;
+		}
+
+		snapshot.observations.clear();
+		for(SensorExteroAbstract::DataManagerList::iterator dma = sen.dataManagerList().begin(); dma != sen.dataManagerList().end(); ++dma)
+			for(DataManagerAbstract::ObservationList::iterator obs = (*dma)->observationList().begin(); obs != (*dma)->observationList().end(); ++obs)
+				snapshot.observations.push_back(capture(sen, **obs));
+	}
+
+
+	landmark_snapshot_ptr_t WorldSnapshotBuffer::capture(LandmarkAbstract &lmk)
+	{
+		CachedLandmark &cached = landmarks[lmk.id()];
+		cached.seen = ncaptures;
+		if (cached.snapshot && cached.change_stamp == lmk.changeStamp() && !moved(lmk, *cached.snapshot))
+			return cached.snapshot;
+
+		capture(lmk, writable(cached));
+		cached.change_stamp = lmk.changeStamp();
+		++lastStats.landmarks_copied;
+		return cached.snapshot;
+	}
+
+
+	bool WorldSnapshotBuffer::moved(LandmarkAbstract &lmk, LandmarkSnapshot const &snapshot)
+	{
+		// compared with the copy and not with the previous state, so that small moves add up
+		if (snapshot.x.size() != lmk.state.x().size()) return true;
+		if (ublas::norm_inf(lmk.state.x() - snapshot.x) > pos_threshold) return true;
+		double stdev = traceStdev(snapshot.P);
+		return std::abs(traceStdev(lmk.state.P()) - stdev) > stdev_threshold * stdev;
+	}
+
+
+	void WorldSnapshotBuffer::capture(LandmarkAbstract &lmk, LandmarkSnapshot &snapshot)
+	{
+		snapshot.id = lmk.id();
+		snapshot.type = lmk.type;
+		snapshot.geom = lmk.getGeomType();
+
+		uchar *events = (uchar*)&snapshot.events;
+		memset(events, 0, sizeof(ObservationAbstract::Events));
+		for(LandmarkAbstract::ObservationList::iterator obs = lmk.observationList().begin(); obs != lmk.observationList().end(); ++obs)
+		{
+			uchar *obsevents = (uchar*)&((*obs)->events);
+			for(size_t i = 0; i < sizeof(ObservationAbstract::Events); i++) events[i] |= obsevents[i];
+		}
+
+		snapshot.x = lmk.state.x();
+		snapshot.P = lmk.state.P();
+		if (with_euclidean && lmk.type != LandmarkAbstract::PNT_EUC)
+			lmk.reparametrize(lmk.reparamSize(), snapshot.eucX, snapshot.eucP);
+		else
+			{ snapshot.eucX.resize(0); snapshot.eucP.resize(0,0); }
+
+#ifdef HAVE_MODULE_DSEG
+		snapshot.left_extremity = snapshot.right_extremity = 1.0;
+		desc_img_seg_fv_ptr_t descriptorSpec = SPTR_CAST<DescriptorImageSegFirstView>(lmk.descriptorPtr);
+		if (descriptorSpec != NULL)
+		{
+			snapshot.left_extremity = descriptorSpec->getLeftExtremity();
+			snapshot.right_extremity = descriptorSpec->getRightExtremity();
+		}
+#endif
+	}
+
+
+	observation_snapshot_ptr_t WorldSnapshotBuffer::capture(SensorExteroAbstract &sen, ObservationAbstract &obs)
+	{
+		CachedObservation &cached = observations[std::make_pair((unsigned)sen.id(), (unsigned)obs.id())];
+		cached.seen = ncaptures;
+		// the observations that are not shown are not refreshed, as they change only to be shown
+		if (cached.snapshot && cached.change_stamp == obs.changeStamp())
+			return cached.snapshot;
+
+		capture(obs, writable(cached));
+		cached.change_stamp = obs.changeStamp();
+		++lastStats.observations_copied;
+		return cached.snapshot;
+	}
+
+
+	void WorldSnapshotBuffer::capture(ObservationAbstract &obs, ObservationSnapshot &snapshot)
+	{
+		snapshot.landmark_id = obs.landmarkPtr()->id();
+		snapshot.landmark_type = obs.landmarkPtr()->type;
+		snapshot.landmark_geom = obs.landmarkPtr()->getGeomType();
+		snapshot.events = obs.events;
+		snapshot.predObs = obs.expectation.x();
+		if (obs.events.matched)
+			snapshot.predObsCov = obs.innovation.P(); else
+			snapshot.predObsCov = obs.expectation.P();
+		snapshot.measObs = obs.measurement.x();
+		snapshot.match_score = obs.getMatchScore();
+
+#ifdef HAVE_MODULE_DSEG
+		snapshot.realObs.clear();
+		AppearanceImageSegment* appSpec = dynamic_cast<AppearanceImageSegment*>(obs.observedAppearance.get());
+		simu::AppearanceSimu* simuAppSpec = dynamic_cast<simu::AppearanceSimu*>(obs.observedAppearance.get());
+		if (appSpec != NULL)
+			snapshot.realObs = appSpec->realObs();
+		else if (simuAppSpec != NULL)
+			snapshot.realObs = simuAppSpec->realObs();
+#endif
+	}
+
+}}}
@@ -12,10 +12,6 @@
 #include "rtslam/ahpTools.hpp"
 #include "rtslam/landmarkAnchoredHomogeneousPointsLine.hpp"
 
-#ifdef HAVE_MODULE_DSEG
-#include "rtslam/descriptorImageSeg.hpp"
-#endif
-
 //#define DISPLAY_SEGMENT_DEPTH
 
 #include "jmath/angle.hpp"
@@ -25,26 +21,21 @@ namespace rtslam {
 namespace display {
 
 
-	WorldGdhe::WorldGdhe(ViewerAbstract *_viewer, rtslam::WorldAbstract *_slamWor, WorldDisplay *garbage):
-		WorldDisplay(_viewer, _slamWor, garbage), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer))
+	WorldGdhe::WorldGdhe(ViewerAbstract *_viewer, WorldSnapshot const &_snapWor, WorldDisplay *garbage):
+		WorldDisplay(_viewer, _snapWor, garbage), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer))
 	{
 		
 	}
 	
-	MapGdhe::MapGdhe(ViewerAbstract *_viewer, rtslam::MapAbstract *_slamMap, WorldGdhe *_dispWorld):
-		MapDisplay(_viewer, _slamMap, _dispWorld), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)), frame(NULL)
+	MapGdhe::MapGdhe(ViewerAbstract *_viewer, MapSnapshot const &_snapMap, WorldGdhe *_dispWorld):
+		MapDisplay(_viewer, _snapMap, _dispWorld), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)), frame(NULL)
 	{ }
 	
 	MapGdhe::~MapGdhe()
 	{
-		viewerGdhe->release(frame);
+		viewerGdhe->releaseObject(frameName, frame);
 	}
 		
-	void MapGdhe::bufferize()
-	{
-		poseQuat = ublas::subrange(slamMap_->state.x(), 0, 7);
-	}
-	
 	void MapGdhe::render()
 	{
 		#if 0
@@ -60,29 +51,32 @@ namespace display {
 		{
 			frame = new gdhe::Frame(1);
 			frame->setColor(216,216,216);
-			viewerGdhe->client.addObject(frame, true);
+			frameName = viewerGdhe->addObject("frame");
+			viewerGdhe->refresh(frameName, frame);
 		}
 	}
 	
 	
 	
 	
-	RobotGdhe::RobotGdhe(ViewerAbstract *_viewer, rtslam::RobotAbstract *_slamRob, MapGdhe *_dispMap):
-		RobotDisplay(_viewer, _slamRob, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)), robot(NULL), uncertEll(NULL), traj(NULL)
+	RobotGdhe::RobotGdhe(ViewerAbstract *_viewer, RobotSnapshot const &_snapRob, MapGdhe *_dispMap):
+		RobotDisplay(_viewer, _snapRob, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)), robot(NULL), uncertEll(NULL), traj(NULL), trajPoints(0)
 	{
 	}
 	
 	RobotGdhe::~RobotGdhe()
 	{
-		viewerGdhe->release(robot);
-		viewerGdhe->release(uncertEll);
-		viewerGdhe->release(traj);
+		viewerGdhe->releaseObject(robotName, robot);
+		viewerGdhe->releaseObject(uncertEllName, uncertEll);
+		viewerGdhe->releaseObject(trajName, traj);
+		for(TrajList::iterator it = trajChunks.begin(); it != trajChunks.end(); ++it)
+			viewerGdhe->releaseObject(it->first, it->second);
 	}
 	
-	void RobotGdhe::bufferize()
+	void RobotGdhe::bufferize(RobotSnapshot const &_snapRob)
 	{
-		poseQuat = slamRob_->pose.x();
-		poseQuatUncert = slamRob_->pose.P();
+		poseQuat = _snapRob.pose;
+		poseQuatUncert = _snapRob.poseCov;
 	}
 	
 	void RobotGdhe::render()
@@ -91,19 +85,19 @@ namespace display {
 		if (robot == NULL)
 		{
 			robot = new gdhe::Robot(viewerGdhe->robot_model);
-			viewerGdhe->client.addObject(robot, false);
+			robotName = viewerGdhe->addObject("robot");
 		}
 		if (uncertEll == NULL)
 		{
 			uncertEll = new gdhe::EllipsoidWire();
 			uncertEll->setColor(255,255,0);
-			viewerGdhe->client.addObject(uncertEll, false);
+			uncertEllName = viewerGdhe->addObject("robot_ell");
 		}
 		if (traj == NULL)
 		{
 			traj = new gdhe::Trajectory();
 			traj->setColor(0,255,0);
-			viewerGdhe->client.addObject(traj, false);
+			trajName = viewerGdhe->addObject("traj");
 		}
 
 		// convert pose from quat to euler degrees
@@ -123,61 +117,81 @@ JFR_DEBUG("robot POS  : " << ublas::project(poseQuatUncert,ublas::range(0,3),ubl
 JFR_DEBUG("robot EULER: " << uncertEuler);*/
 		// uncertainty
 		uncertEll->set(ublas::subrange(poseQuat,0,3), ublas::project(poseQuatUncert,ublas::range(0,3),ublas::range(0,3)), viewerGdhe->ellipsesScale);
-		uncertEll->refresh();
+		viewerGdhe->refresh(uncertEllName, uncertEll);
 		// camera target
 		//viewerGdhe->client.setCameraTarget(poseEuler(0), poseEuler(1), poseEuler(2));
-		robot->refresh();
+		viewerGdhe->refresh(robotName, robot);
 		
-		// trajectory
+		// trajectory, a complete piece is kept as it was sent and a new one starts from its last point
+		if (trajPoints >= trajChunkSize)
+		{
+			trajChunks.push_back(std::make_pair(trajName, traj));
+			traj = new gdhe::Trajectory();
+			traj->setColor(0,255,0);
+			trajName = viewerGdhe->addObject("traj");
+			traj->addPoint(lastTrajPoint(0),lastTrajPoint(1),lastTrajPoint(2));
+			trajPoints = 1;
+		}
 		traj->addPoint(poseQuat(0),poseQuat(1),poseQuat(2));
-		traj->refresh();
+		lastTrajPoint = ublas::subrange(poseQuat,0,3);
+		++trajPoints;
+		viewerGdhe->refresh(trajName, traj);
 	}
 	
-	SensorGdhe::SensorGdhe(ViewerAbstract *_viewer, rtslam::SensorExteroAbstract *_slamRob, RobotGdhe *_dispMap):
-		SensorDisplay(_viewer, _slamRob, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)) {}
+	SensorGdhe::SensorGdhe(ViewerAbstract *_viewer, SensorSnapshot const &_snapSen, RobotGdhe *_dispMap):
+		SensorDisplay(_viewer, _snapSen, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)) {}
 	
-	LandmarkGdhe::LandmarkGdhe(ViewerAbstract *_viewer, rtslam::LandmarkAbstract *_slamLmk, MapGdhe *_dispMap):
-		LandmarkDisplay(_viewer, _slamLmk, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer))
+	LandmarkGdhe::LandmarkGdhe(ViewerAbstract *_viewer, LandmarkSnapshot const &_snapLmk, MapGdhe *_dispMap):
+		LandmarkDisplay(_viewer, _snapLmk, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer))
 	{
-		id_ = _slamLmk->id();
-		lmkType_ = _slamLmk->type;
-		state_.resize(_slamLmk->state.x().size());
-		cov_.resize(_slamLmk->state.P().size1(),_slamLmk->state.P().size2());
+		id_ = _snapLmk.id;
+		lmkType_ = _snapLmk.type;
+		stamp_ = 0;
+		changed_ = true;
+		state_.resize(_snapLmk.x.size());
+		cov_.resize(_snapLmk.P.size1(),_snapLmk.P.size2());
 	}
 	
 	LandmarkGdhe::~LandmarkGdhe()
 	{
-		for(ItemList::iterator it = items_.begin(); it != items_.end(); ++it)
-			viewerGdhe->release(*it);
+		clearItems();
 	}
 
-	
-	void LandmarkGdhe::bufferize()
+	void LandmarkGdhe::clearItems()
 	{
-		uchar *events = (uchar*)&events_;
-		memset(events, 0, sizeof(ObservationAbstract::Events));
-		for(LandmarkAbstract::ObservationList::iterator obs = slamLmk_->observationList().begin(); obs != slamLmk_->observationList().end(); ++obs)
-		{
-			uchar *obsevents = (uchar*)&((*obs)->events);
-			for(size_t i = 0; i < sizeof(ObservationAbstract::Events); i++) events[i] |= obsevents[i];
-		}
-/*		
-		events_.predicted_ = events_.visible_ = events_.measured_ = events_.matched_ = events_.updated_ = false;
-		for(LandmarkAbstract::ObservationList::iterator obs = slamLmk_->observationList().begin(); obs != slamLmk_->observationList().end(); ++obs)
-		{
-			events_.predicted |= (*obs)->events.predicted;
-			events_.visible |= (*obs)->events.visible;
-			events_.measured |= (*obs)->events.measured;
-			events_.matched |= (*obs)->events.matched;
-			events_.updated |= (*obs)->events.updated;
-		}
-*/		
-		state_ = slamLmk_->state.x();
-		cov_ = slamLmk_->state.P();
+		std::list<std::string>::iterator name = names_.begin();
+		for(ItemList::iterator it = items_.begin(); it != items_.end(); ++it, ++name)
+			viewerGdhe->releaseObject(*name, *it);
+		items_.clear(); names_.clear();
+	}
+
+	void LandmarkGdhe::addItem(gdhe::Object *item)
+	{
+		items_.push_back(item);
+		names_.push_back(viewerGdhe->addObject("lmk"));
+	}
+
+	void LandmarkGdhe::bufferize(LandmarkSnapshot const &_snapLmk)
+	{
+		// most landmarks are not observed, nothing needs to be copied nor sent for them
+		if (_snapLmk.stamp == stamp_) return;
+		stamp_ = _snapLmk.stamp;
+		changed_ = true;
+		events_ = _snapLmk.events;
+		state_ = _snapLmk.x;
+		cov_ = _snapLmk.P;
+		eucState_ = _snapLmk.eucX;
+		eucCov_ = _snapLmk.eucP;
+#ifdef HAVE_MODULE_DSEG
+		left_extremity_ = _snapLmk.left_extremity;
+		right_extremity_ = _snapLmk.right_extremity;
+#endif
 	}
 	
 	void LandmarkGdhe::render()
 	{
+		if (!changed_) return;
+		changed_ = false;
 		//const double sph_radius = 0.01;
 		switch (lmkType_)
 		{
@@ -187,7 +201,7 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 				if (items_.size() != 1)
 				{
 					// clear
-					items_.clear();
+					clearItems();
 
 /*					// sphere
 					gdhe::Sphere *sph = new gdhe::Sphere(0.01, 12);
@@ -198,8 +212,7 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 					// ellipsoid
 					gdhe::Ellipsoid *ell = new gdhe::Ellipsoid(12);
 					ell->setLabel("");
-					items_.push_back(ell);
-					viewerGdhe->client.addObject(ell, false);
+					addItem(ell);
 				}
 				// Refresh the display objects every time
 				{
@@ -225,7 +238,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 					(*it)->setColor(c.R,c.G,c.B); //
 					(*it)->setLabelColor(c.R,c.G,c.B);
 					(*it)->setLabel(jmath::toStr(id_));
-					(*it)->refresh();
 				}
 				break;
 			}
@@ -235,7 +247,7 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 				if (items_.size() != 2)
 				{
 					// clear
-					items_.clear();
+					clearItems();
 
 /*					// sphere
 					gdhe::Sphere *sph = new gdhe::Sphere(sph_radius, 12);
@@ -246,13 +258,11 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 					// ellipsoid
 					gdhe::Ellipsoid *ell = new gdhe::Ellipsoid(12);
 					ell->setLabel("");
-					items_.push_back(ell);
-					viewerGdhe->client.addObject(ell, false);
+					addItem(ell);
 					
 					// segment
 					gdhe::Polyline *seg = new gdhe::Polyline();
-					items_.push_back(seg);
-					viewerGdhe->client.addObject(seg, false);
+					addItem(seg);
 				}
 				// Refresh the display objects every time
 				{
@@ -273,15 +283,13 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 					// ellipsoid
 					ItemList::iterator it = items_.begin();
 					gdhe::Ellipsoid *ell = PTR_CAST<gdhe::Ellipsoid*>(*it);
-					jblas::vec xNew; jblas::sym_mat pNew; slamLmk_->reparametrize(LandmarkEuclideanPoint::size(), xNew, pNew);
-//std::cout << "x_ahp " << state_ << " P_ahp " << cov_ << " ; x_euc " << xNew << " P_euc " << pNew << std::endl;
-					ell->setCompressed(xNew, pNew, viewerGdhe->ellipsesScale);
+//std::cout << "x_ahp " << state_ << " P_ahp " << cov_ << " ; x_euc " << eucState_ << " P_euc " << eucCov_ << std::endl;
+					ell->setCompressed(eucState_, eucCov_, viewerGdhe->ellipsesScale);
 //					ell->set(xNew, pNew, viewerGdhe->ellipsesScale);
 					c = getColorRGB(ColorManager::getColorObject_prediction(phase_,events_)) ;
 					(*it)->setColor(c.R,c.G,c.B); //
 					(*it)->setLabelColor(c.R,c.G,c.B);
 					(*it)->setLabel(jmath::toStr(id_));
-					(*it)->refresh();
 					
 					
 					// segment
@@ -299,7 +307,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 					seg->addPoint(positionExt(0)-position(0), positionExt(1)-position(1), positionExt(2)-position(2));
 					(*it)->setColor(c.R,c.G,c.B);
 					(*it)->setPose(position(0), position(1), position(2), 0, 0, 0);
-					(*it)->refresh();
 				}
 				break;
          }
@@ -313,28 +320,23 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
             #endif
             {
                // clear
-               items_.clear();
+               clearItems();
 
                // ellipsoids
                gdhe::Ellipsoid *ell = new gdhe::Ellipsoid(12);
                ell->setLabel("");
-               items_.push_back(ell);
-               viewerGdhe->client.addObject(ell, false);
+               addItem(ell);
                ell = new gdhe::Ellipsoid(12);
                ell->setLabel("");
-               items_.push_back(ell);
-               viewerGdhe->client.addObject(ell, false);
+               addItem(ell);
                // segments
                gdhe::Polyline *seg = new gdhe::Polyline();
-               items_.push_back(seg);
-               viewerGdhe->client.addObject(seg, false);
+               addItem(seg);
                #ifdef DISPLAY_SEGMENT_DEPTH
                    seg = new gdhe::Polyline();
-                   items_.push_back(seg);
-                   viewerGdhe->client.addObject(seg, false);
+                   addItem(seg);
                    seg = new gdhe::Polyline();
-                   items_.push_back(seg);
-                   viewerGdhe->client.addObject(seg, false);
+                   addItem(seg);
                #endif
             }
             // Refresh the display objects every time
@@ -343,15 +345,12 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 
                // ellipsoids
                ItemList::iterator it = items_.begin();
-               jblas::vec xNew;  jblas::sym_mat pNew;
                jblas::vec xNew1; jblas::sym_mat pNew1;
                jblas::vec xNew2; jblas::sym_mat pNew2;
-               slamLmk_->reparametrize(LandmarkEuclideanPoint::size()*2, xNew, pNew);
-               //slamLmk_->reparametrize(LandmarkAnchoredHomogeneousPointsLine::reparamSize(), xNew, pNew);
-               xNew1 = subrange(xNew,0,3);
-               xNew2 = subrange(xNew,3,6);
-               pNew1 = subrange(pNew,0,3,0,3);
-               pNew2 = subrange(pNew,3,6,3,6);
+               xNew1 = subrange(eucState_,0,3);
+               xNew2 = subrange(eucState_,3,6);
+               pNew1 = subrange(eucCov_,0,3,0,3);
+               pNew2 = subrange(eucCov_,3,6,3,6);
 
                gdhe::Ellipsoid *ell = PTR_CAST<gdhe::Ellipsoid*>(*it);
                ell->setCompressed(xNew1, pNew1, viewerGdhe->ellipsesScale);
@@ -359,7 +358,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
                (*it)->setColor(c.R,c.G,c.B); //
                (*it)->setLabelColor(c.R,c.G,c.B);
                (*it)->setLabel(jmath::toStr(id_));
-               (*it)->refresh();
                ++it;
                ell = PTR_CAST<gdhe::Ellipsoid*>(*it);
                ell->setCompressed(xNew2, pNew2, viewerGdhe->ellipsesScale);
@@ -367,7 +365,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
                (*it)->setColor(c.R,c.G,c.B); //
                (*it)->setLabelColor(c.R,c.G,c.B);
                (*it)->setLabel(jmath::toStr(id_));
-               (*it)->refresh();
 
                // segments
                gdhe::Polyline *seg;
@@ -387,7 +384,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
                   seg->addPoint(positionExt(0)-position(0), positionExt(1)-position(1), positionExt(2)-position(2));
                   (*it)->setColor(c.R,c.G,c.B);
                   (*it)->setPose(position(0), position(1), position(2), 0, 0, 0);
-                  (*it)->refresh();
                   ++it;
                   seg = PTR_CAST<gdhe::Polyline*>(*it);
                   seg->clear();
@@ -404,20 +400,12 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
                   seg->addPoint(positionExt(0)-position(0), positionExt(1)-position(1), positionExt(2)-position(2));
                   (*it)->setColor(c.R,c.G,c.B);
                   (*it)->setPose(position(0), position(1), position(2), 0, 0, 0);
-                  (*it)->refresh();
                #endif
                // Linking segment
 				#ifdef HAVE_MODULE_DSEG
 					jblas::vec3 xMiddle = (xNew1 + xNew2)/2;
-					desc_img_seg_fv_ptr_t descriptorSpec = SPTR_CAST<DescriptorImageSegFirstView>(slamLmk_->descriptorPtr);
-					float left_extremity = 1.0;
-					float right_extremity = 1.0;
-					if(descriptorSpec != NULL) {
-						left_extremity = descriptorSpec->getLeftExtremity();
-						right_extremity = descriptorSpec->getRightExtremity();
-					}
-					xNew1 = left_extremity * (xNew1 - xMiddle) + xMiddle;
-					xNew2 = right_extremity * (xNew2 - xMiddle) + xMiddle;
+					xNew1 = left_extremity_ * (xNew1 - xMiddle) + xMiddle;
+					xNew2 = right_extremity_ * (xNew2 - xMiddle) + xMiddle;
                ++it;
                seg = PTR_CAST<gdhe::Polyline*>(*it);
                seg->clear();
@@ -425,7 +413,6 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
                seg->addPoint(xNew2(0), xNew2(1), xNew2(2));
                (*it)->setColor(c.R,c.G,c.B);
                (*it)->setPose(0,0,0,0,0,0);
-               (*it)->refresh();
 				#endif
             }
             break;
@@ -433,12 +420,16 @@ JFR_DEBUG("robot EULER: " << uncertEuler);*/
 			default:
 				JFR_ERROR(RtslamException, RtslamException::UNKNOWN_FEATURE_TYPE, "Don't know how to display this type of landmark: " << type_);
 		}
+		
+		std::list<std::string>::iterator name = names_.begin();
+		for(ItemList::iterator it = items_.begin(); it != items_.end(); ++it, ++name)
+			viewerGdhe->refresh(*name, *it);
 	}
 
 	
 	
-	ObservationGdhe::ObservationGdhe(ViewerAbstract *_viewer, rtslam::ObservationAbstract *_slamLmk, SensorGdhe *_dispMap):
-		ObservationDisplay(_viewer, _slamLmk, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)) {}
+	ObservationGdhe::ObservationGdhe(ViewerAbstract *_viewer, ObservationSnapshot const &_snapObs, SensorGdhe *_dispMap):
+		ObservationDisplay(_viewer, _snapObs, _dispMap), viewerGdhe(PTR_CAST<ViewerGdhe*>(_viewer)) {}
 
 }}}
 
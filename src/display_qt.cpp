@@ -7,11 +7,13 @@
 
 #ifdef HAVE_MODULE_QDISPLAY
 
-#include "qdisplay/imout.hpp"
+#include <QPainter>
+#include <QImage>
+
+#include "kernel/timingTools.hpp"
+
 #include "rtslam/display_qt.hpp"
 #include "rtslam/observationPinHoleAnchoredHomogeneousPointsLine.hpp"
-#include "rtslam/appearanceSegment.hpp"
-#include "rtslam/simuData.hpp"
 
 #ifdef HAVE_MODULE_DSEG
 	#include "dseg/SegmentHypothesis.hpp"
@@ -24,37 +26,63 @@ namespace display {
 
 	RunStatus ViewerQt::runStatus;
 	
+	void ViewerQt::render(bool force)
+	{
+		garbageCollect();
+		force = force || doDump;
+		double now = kernel::Clock::getTime();
+		for(std::vector<SensorQt*>::iterator sen = sensors_.current.begin(); sen != sensors_.current.end(); ++sen)
+		{
+			// the views that are not due keep showing their last render
+			if (!(*sen)->refresh_.due(now, force)) continue;
+			(*sen)->refresh_.begin(now);
+			(*sen)->render();
+			for(std::vector<ObservationQt*>::iterator obs = observations_.current.begin(); obs != observations_.current.end(); ++obs)
+				if ((*obs)->dispSen_ == *sen) (*obs)->render();
+			now = kernel::Clock::getTime();
+			(*sen)->refresh_.end(now);
+		}
+		clear();
+	}
+	
 	void ViewerQt::dump(std::string filepattern) // pattern with %d for sensor id
 	{
 		char filename[256];
-		for(std::map<int,SensorQt*>::iterator it = sensorsList.begin(); it != sensorsList.end(); ++it)
+		for(std::vector<SensorQt*>::iterator it = sensors_.current.begin(); it != sensors_.current.end(); ++it)
 		{
-			snprintf(filename, 256, filepattern.c_str(), it->first);
-			it->second->dump(filename);
+			snprintf(filename, 256, filepattern.c_str(), (*it)->id_);
+			(*it)->dump(filename);
 		}
 	}
+	
+	void ViewerQt::record(FrameEncoder &encoder, unsigned frame)
+	{
+		for(std::vector<SensorQt*>::iterator it = sensors_.current.begin(); it != sensors_.current.end(); ++it)
+			encoder.push((*it)->id_, frame, (*it)->grab());
+	}
 
-	WorldQt::WorldQt(ViewerAbstract *_viewer, rtslam::WorldAbstract *_slamWor, WorldDisplay *garbage):
-		WorldDisplay(_viewer, _slamWor, garbage), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
-	MapQt::MapQt(ViewerAbstract *_viewer, rtslam::MapAbstract *_slamMap, WorldQt *_dispWorld):
-		MapDisplay(_viewer, _slamMap, _dispWorld), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
-	RobotQt::RobotQt(ViewerAbstract *_viewer, rtslam::RobotAbstract *_slamRob, MapQt *_dispMap):
-		RobotDisplay(_viewer, _slamRob, _dispMap), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
-	LandmarkQt::LandmarkQt(ViewerAbstract *_viewer, rtslam::LandmarkAbstract *_slamLmk, MapQt *_dispMap):
-		LandmarkDisplay(_viewer, _slamLmk, _dispMap), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
+	WorldQt::WorldQt(ViewerAbstract *_viewer, WorldSnapshot const &_snapWor, WorldDisplay *garbage):
+		WorldDisplay(_viewer, _snapWor, garbage), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
+	MapQt::MapQt(ViewerAbstract *_viewer, MapSnapshot const &_snapMap, WorldQt *_dispWorld):
+		MapDisplay(_viewer, _snapMap, _dispWorld), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
+	RobotQt::RobotQt(ViewerAbstract *_viewer, RobotSnapshot const &_snapRob, MapQt *_dispMap):
+		RobotDisplay(_viewer, _snapRob, _dispMap), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
+	LandmarkQt::LandmarkQt(ViewerAbstract *_viewer, LandmarkSnapshot const &_snapLmk, MapQt *_dispMap):
+		LandmarkDisplay(_viewer, _snapLmk, _dispMap), viewerQt(PTR_CAST<ViewerQt*>(_viewer)) {}
 
 
 	/** **************************************************************************
 	
 	*/
-	SensorQt::SensorQt(ViewerAbstract *_viewer, rtslam::SensorExteroAbstract *_slamSen, RobotQt *_dispRob): 
-		SensorDisplay(_viewer, _slamSen, _dispRob), viewerQt(PTR_CAST<ViewerQt*>(_viewer)), 
-		viewer_(NULL), view_private(NULL), framenumber_label(NULL), sensorpose_label(NULL)
+	SensorQt::SensorQt(ViewerAbstract *_viewer, SensorSnapshot const &_snapSen, RobotQt *_dispRob): 
+		SensorDisplay(_viewer, _snapSen, _dispRob), viewerQt(PTR_CAST<ViewerQt*>(_viewer)), 
+		viewer_(NULL), view_private(NULL), framenumber_label(NULL), sensorpose_label(NULL),
+		refresh_(viewerQt->viewRate(_snapSen.id))
 	{
 		framenumber = -1;
 		t = 0.;
 		pose.clear();
-		id_ = slamSen_->id();
+		id_ = _snapSen.id;
 		avg_framerate = 0.;
 		size = cv::Size(640,480);
 		isImage = 2; // unknown
@@ -68,30 +96,26 @@ namespace display {
 		viewerQt->release(sensorpose_label);
 	}
 	
-	void SensorQt::bufferize()
+	void SensorQt::bufferize(SensorSnapshot const &_snapSen)
 	{
 		if (framenumber+1 <= 0) avg_framerate = 0.;
-		if (slamSen_->rawCounter != framenumber+1)
+		if (_snapSen.framenumber != framenumber)
 		{
-			if (framenumber+1 > 0) avg_framerate = (slamSen_->rawPtr->timestamp-t)/(slamSen_->rawCounter-1-framenumber);
-			framenumber = slamSen_->rawCounter-1;
-			t = slamSen_->rawPtr->timestamp;
-			raw_ptr_t raw = slamSen_->getLastProcessedRaw();
-			if (raw)
+			if (framenumber+1 > 0) avg_framerate = (_snapSen.timestamp-t)/(_snapSen.framenumber-framenumber);
+			framenumber = _snapSen.framenumber;
+			t = _snapSen.timestamp;
+			if (_snapSen.has_raw)
 			{
-				RawImage *rawImg = NULL;
 				if (isImage == 2)
 				{
-					rawImg = dynamic_cast<RawImage*>(raw.get());
-					isImage = ((rawImg != NULL) ? 1 : 0);
-					if (isImage) size = rawImg->img->size();
-				} else
-				if (isImage) rawImg = PTR_CAST<RawImage*>(raw.get());
+					isImage = (_snapSen.image ? 1 : 0);
+					if (isImage) size = _snapSen.image->size();
+				}
 				// FIXME RawSimu should export a size somehow
 
-				if (rawImg) image = rawImg->img->clone();
+				if (_snapSen.image) image = _snapSen.image;
 			}
-			pose = slamSen_->robotPtr()->pose.x();
+			pose = _snapSen.robot_pose;
 			
 		}
 	}
@@ -136,9 +160,11 @@ std::cout << "connecting slots" << std::endl;
 		switch (type_)
 		{
 			case SensorAbstract::PINHOLE:
-			case SensorAbstract::BARRETO: if (image.data()) {
-				view()->setImage(image);
-				std::ostringstream oss; oss << "#" << framenumber << "  |  " << std::setprecision(3) << avg_framerate*1000 << " ms";
+			case SensorAbstract::BARRETO: if (image) {
+				view()->setImage(*image);
+				std::ostringstream oss; oss << "#" << framenumber << "  |  " << std::setprecision(3) << avg_framerate*1000 << " ms"
+					<< "  |  disp " << std::setprecision(2) << refresh_.mean_duration*1000 << " ms";
+				if (refresh_.rate() > 0.) oss << " @" << refresh_.rate() << " Hz";
 				framenumber_label->setPlainText(oss.str().c_str());
 				
 				vec3 position = ublas::subrange(pose,0,3) * 100.0;
@@ -163,7 +189,6 @@ std::cout << "connecting slots" << std::endl;
 			snprintf(filename, 256, viewerQt->dump_pattern.c_str(), id_, framenumber);
 			dump(filename);
 		}
-		viewerQt->sensorsList[id_] = this;
 	}
 
 	void SensorQt::dump(std::string filename)
@@ -180,19 +205,36 @@ std::cout << "connecting slots" << std::endl;
 		}
 	}
 
+	cv::Mat SensorQt::grab()
+	{
+		// only the drawing and a copy are done here, the encoding is done by the encoder thread
+		QImage qimage(size.width, size.height, QImage::Format_RGB888);
+		qimage.fill(0);
+		if (view_private)
+		{
+			QPainter painter(&qimage);
+			QRectF rect(0, 0, size.width, size.height);
+			viewer_->scene()->render(&painter, rect, rect);
+		}
+		cv::Mat rgb(size.height, size.width, CV_8UC3, qimage.bits(), qimage.bytesPerLine());
+		cv::Mat bgr;
+		cv::cvtColor(rgb, bgr, CV_RGB2BGR);
+		return bgr;
+	}
+
 	/** **************************************************************************
 	
 	*/
-	ObservationQt::ObservationQt(ViewerAbstract *_viewer, rtslam::ObservationAbstract *_slamObs, SensorQt *_dispSen):
-		ObservationDisplay(_viewer, _slamObs, _dispSen), viewerQt(PTR_CAST<ViewerQt*>(_viewer)), dispSen_(_dispSen)
+	ObservationQt::ObservationQt(ViewerAbstract *_viewer, ObservationSnapshot const &_snapObs, SensorQt *_dispSen):
+		ObservationDisplay(_viewer, _snapObs, _dispSen), viewerQt(PTR_CAST<ViewerQt*>(_viewer)), dispSen_(_dispSen)
 	{
-#if EMBED_PREDICTED_APP
-		predictedApp_ = NULL;
-#endif
-		id_ = _slamObs->landmarkPtr()->id();
-		predObs_.resize(_slamObs->expectation.x().size());
-		predObsCov_.resize(_slamObs->expectation.P().size1(), slamObs_->expectation.P().size2());
-		measObs_.resize(_slamObs->measurement.x().size());
+		id_ = _snapObs.landmark_id;
+		stamp_ = 0;
+		changed_ = true;
+		match_score = 0.;
+		predObs_.resize(_snapObs.predObs.size());
+		predObsCov_.resize(_snapObs.predObsCov.size1(), _snapObs.predObsCov.size2());
+		measObs_.resize(_snapObs.measObs.size());
 	}
 	
 	ObservationQt::~ObservationQt()
@@ -207,24 +249,25 @@ std::cout << "connecting slots" << std::endl;
 		}
 	}
 	
-	void ObservationQt::bufferize()
+	void ObservationQt::bufferize(ObservationSnapshot const &_snapObs)
 	{
-		events_ = slamObs_->events;
+		// the observations that are not shown do not change, their shapes are kept as they are
+		if (_snapObs.stamp == stamp_) return;
+		stamp_ = _snapObs.stamp;
+		changed_ = true;
+		events_ = _snapObs.events;
 		
 		if (events_.visible)
 		{
 			if (events_.predicted)
 			{
-				predObs_ = slamObs_->expectation.x();
-				if (events_.matched)
-					predObsCov_ = slamObs_->innovation.P(); else
-					predObsCov_ = slamObs_->expectation.P();
-//							cout << "display: noise/exp/inn:  " << slamObs_->measurement.P() << " / " << slamObs_->expectation.P() << " / " << slamObs_->innovation.P() << " / " << endl;
+				predObs_ = _snapObs.predObs;
+				predObsCov_ = _snapObs.predObsCov;
 			}
 			if (events_.measured || events_.matched || !events_.predicted)
 			{
-				measObs_ = slamObs_->measurement.x();
-				match_score = slamObs_->getMatchScore();
+				measObs_ = _snapObs.measObs;
+				match_score = _snapObs.match_score;
 			}
 		}
 		
@@ -232,13 +275,11 @@ std::cout << "connecting slots" << std::endl;
 		switch (landmarkGeomType_)
 		{
 			case LandmarkDisplay::ltPoint:
-#if EMBED_PREDICTED_APP
-				delete predictedApp_;
-				predictedApp_ = slamObs_->predictedAppearance->clone();
-#endif
             break;
          case LandmarkDisplay::ltSeg:
-            // TODO : Implement
+#ifdef HAVE_MODULE_DSEG
+            realObs_ = _snapObs.realObs;
+#endif
             break;
 			default:
 				JFR_ERROR(RtslamException, RtslamException::UNKNOWN_FEATURE_TYPE, "Don't know how to display this type of landmark: " << landmarkGeomType_);
@@ -248,6 +289,8 @@ std::cout << "connecting slots" << std::endl;
 	
 	void ObservationQt::render()
 	{
+		if (!changed_) return;
+		changed_ = false;
 		switch (landmarkGeomType_)
 		{
 			case LandmarkDisplay::ltPoint:
@@ -351,25 +394,6 @@ std::cout << "connecting slots" << std::endl;
 						(*it)->setPos(measObs_(0), measObs_(1));
 					}
 					(*it)->setVisible(dispMeas);
-
-#if EMBED_PREDICTED_APP
-					// display predicted appearance
-					switch (slamObs_->sensorPtr()->type)
-					{
-						case SensorAbstract::PINHOLE: case SensorAbstract::BARRETO:
-						{
-							AppearanceImagePoint* appImgPtr = PTR_CAST<AppearanceImagePoint*>(slamObs_->predictedAppearance.get());
-							jblas::veci shift(2); shift(0) = (appImgPtr->patch.width()-1)/2; shift(1) = (appImgPtr->patch.height()-1)/2;
-							appImgPtr->patch.robustCopy(PTR_CAST<SensorQt*>(dispSen_)->image, 0, 0, predObs_(0)-shift(0), predObs_(1)-shift(1));
-						}
-						default:
-						{
-
-						}
-
-					}
-#endif
-
 				}
             break;
          }
@@ -380,15 +404,7 @@ std::cout << "connecting slots" << std::endl;
             bool dispMeas2 = events_.visible && (events_.measured || events_.matched || !events_.predicted);
             bool dispInit2 = events_.visible && !events_.predicted;
 
-//				ObservationPinHoleAnchoredHomogeneousPointsLine* slamObsSpec = static_cast<ObservationPinHoleAnchoredHomogeneousPointsLine*>(slamObs_);
-				AppearanceImageSegment* appSpec = dynamic_cast<AppearanceImageSegment*>(slamObs_->observedAppearance.get());
-				simu::AppearanceSimu* simuAppSpec = dynamic_cast<simu::AppearanceSimu*>(slamObs_->observedAppearance.get());
-				vec4 realObs;
-				realObs.clear();
-				if(appSpec != NULL)
-					realObs = appSpec->realObs();
-				else if(simuAppSpec != NULL)
-					realObs = simuAppSpec->realObs();
+				vec4 const &realObs = realObs_;
 
             // Build display objects if it is the first time they are displayed
             if (items_.size() != 8)
@@ -594,23 +610,6 @@ std::cout << "connecting slots" << std::endl;
                   (*it)->setVisible(false);
                }
 
-#if EMBED_PREDICTED_APP
-               // display predicted appearance
-               switch (slamObs_->sensorPtr()->type)
-               {
-                  case SensorAbstract::PINHOLE: case SensorAbstract::BARRETO:
-                  {
-                     AppearanceImagePoint* appImgPtr = PTR_CAST<AppearanceImagePoint*>(slamObs_->predictedAppearance.get());
-                     jblas::veci shift(2); shift(0) = (appImgPtr->patch.width()-1)/2; shift(1) = (appImgPtr->patch.height()-1)/2;
-                     appImgPtr->patch.robustCopy(PTR_CAST<SensorQt*>(dispSen_)->image, 0, 0, predObs_(0)-shift(0), predObs_(1)-shift(1));
-                  }
-                  default:
-                  {
-
-                  }
-
-               }
-#endif
             }
             break;
          }
@@ -664,30 +663,31 @@ std::cout << "connecting slots" << std::endl;
 	{
 		if (!isClick) return;
 		QGraphicsItem *clickedItem = viewer_->scene()->itemAt(mouseEvent->buttonDownScenePos(mouseEvent->button()));
-		ObservationAbstract *clickedObs = NULL;
+		ObservationQt *clickedObs = NULL;
 		
-		for(SensorExteroAbstract::DataManagerList::iterator itDm = slamSen_->dataManagerList().begin();
-		    !clickedObs && itDm != slamSen_->dataManagerList().end(); ++itDm)
-		for(DataManagerAbstract::ObservationList::iterator itObs = (*itDm)->observationList().begin();
-		    !clickedObs && itObs != (*itDm)->observationList().end(); ++itObs)
+		// the slam objects may not exist anymore, only what was bufferized from the snapshot is available
+		ViewerQt::ObservationObjects const &observations = viewerQt->observationDisplays();
+		for(ViewerQt::ObservationObjects::const_iterator itObs = observations.begin();
+		    !clickedObs && itObs != observations.end(); ++itObs)
 		{
-			ObservationQt *obs = PTR_CAST<ObservationQt*>((*itObs)->displayData[ViewerQt::id()]);
+			ObservationQt *obs = itObs->second;
+			if (obs->dispSen_ != this) continue;
 			
 			for(ObservationQt::ItemList::iterator itItem = obs->items_.begin();
 			    !clickedObs && itItem != obs->items_.end(); ++itItem)
-				if ((*itItem)->hasItem(clickedItem)) clickedObs = itObs->get();
+				if ((*itItem)->hasItem(clickedItem)) clickedObs = obs;
 		}
 		
 		if (clickedObs)
 		{
 			std::cout << "----------------------------------------------- at frame " << framenumber << std::endl;
-			std::cout << clickedObs->landmark() << std::endl;
-			std::cout << *clickedObs << std::endl;
-			
-			qdisplay::imout << image::clear << clickedObs->landmark() << image::endl;
-			qdisplay::imout << image::vsep << *clickedObs << image::flush;
+			std::cout << "observation of landmark " << clickedObs->id_ << (clickedObs->landmarkPhase_ == LandmarkDisplay::init ? " (init)" : " (converged)")
+				<< ": predicted " << clickedObs->events_.predicted << " visible " << clickedObs->events_.visible
+				<< " measured " << clickedObs->events_.measured << " matched " << clickedObs->events_.matched
+				<< " updated " << clickedObs->events_.updated << std::endl;
+			std::cout << "expectation " << clickedObs->predObs_ << " cov " << clickedObs->predObsCov_ << std::endl;
+			std::cout << "measurement " << clickedObs->measObs_ << " score " << clickedObs->match_score << std::endl;
 		}
-
 		
 	}
 
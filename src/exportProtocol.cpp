@@ -0,0 +1,145 @@
+/**
+ * \file exportProtocol.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include "rtslam/exportProtocol.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+
+	ExportMessageBuilder::ExportMessageBuilder(uint16_t type, uint32_t flags, uint64_t seq, double time, double export_date,
+		unsigned robot, jblas::vec const &x)
+	{
+		buf = new std::vector<char>();
+		msg.reset(buf);
+		int n = x.size();
+		buf->reserve(exportproto::headerSize + (n + n*(n+1)/2) * sizeof(double));
+		buf->resize(4); memcpy(&(*buf)[0], exportproto::magic, 4);
+		put<uint16_t>(exportproto::version);
+		put<uint16_t>(type);
+		put<uint32_t>(0); // size, see finish
+		put<uint32_t>(flags);
+		put<uint64_t>(seq);
+		put<double>(time);
+		put<double>(export_date);
+		put<uint32_t>(robot);
+		put<uint32_t>(n);
+		for(int i = 0; i < n; ++i) put<double>(x(i));
+	}
+
+	void ExportMessageBuilder::putSymUpper(jblas::sym_mat const &P)
+	{
+		for(size_t i = 0; i < P.size1(); ++i)
+			for(size_t j = i; j < P.size2(); ++j)
+				put<double>(P(i,j));
+	}
+
+	void ExportMessageBuilder::addCovariance(jblas::sym_mat const &P)
+	{
+		putSymUpper(P);
+	}
+
+	void ExportMessageBuilder::beginLandmarks(uint64_t map_seq, unsigned count)
+	{
+		put<uint64_t>(map_seq);
+		put<uint32_t>(count);
+	}
+
+	void ExportMessageBuilder::addLandmark(unsigned op, unsigned id, unsigned type, jblas::vec const &x, jblas::sym_mat const &P)
+	{
+		put<uint32_t>(op);
+		put<uint32_t>(id);
+		put<uint32_t>(type);
+		put<uint32_t>(x.size());
+		for(size_t i = 0; i < x.size(); ++i) put<double>(x(i));
+		putSymUpper(P);
+	}
+
+	void ExportMessageBuilder::addLandmarkDeletion(unsigned id, unsigned type)
+	{
+		put<uint32_t>(exportproto::opDelete);
+		put<uint32_t>(id);
+		put<uint32_t>(type);
+		put<uint32_t>(0);
+	}
+
+	export_message_ptr_t ExportMessageBuilder::finish()
+	{
+		uint32_t size = buf->size();
+		memcpy(&(*buf)[exportproto::sizeOffset], &size, sizeof(size));
+		buf = NULL;
+		return msg;
+	}
+
+
+	namespace {
+		class Reader
+		{
+			private:
+				const char *data;
+				size_t size, pos;
+			public:
+				Reader(const char *data, size_t size): data(data), size(size), pos(0) {}
+				template<typename T> bool get(T &v)
+				{
+					if (pos + sizeof(T) > size) return false;
+					memcpy(&v, data+pos, sizeof(T)); pos += sizeof(T);
+					return true;
+				}
+				bool get(std::vector<double> &v, size_t n)
+				{
+					if (pos + n*sizeof(double) > size) return false;
+					v.resize(n);
+					if (n) memcpy(&v[0], data+pos, n*sizeof(double));
+					pos += n*sizeof(double);
+					return true;
+				}
+				bool atEnd() { return pos == size; }
+				size_t remaining() { return size - pos; }
+		};
+	}
+
+	size_t exportMessageSize(const char *header)
+	{
+		uint16_t version; uint32_t size;
+		memcpy(&version, header+4, sizeof(version));
+		memcpy(&size, header+exportproto::sizeOffset, sizeof(size));
+		if (memcmp(header, exportproto::magic, 4) != 0 || version != exportproto::version || size < exportproto::headerSize)
+			return 0;
+		return size;
+	}
+
+	bool decodeExportMessage(const char *data, size_t size, ExportMessage &msg)
+	{
+		if (size < exportproto::headerSize || exportMessageSize(data) != size) return false;
+		Reader r(data+4, size-4);
+		uint32_t msg_size, robot, n;
+		r.get(msg.version); r.get(msg.type); r.get(msg_size); r.get(msg.flags); r.get(msg.seq);
+		r.get(msg.time); r.get(msg.export_date); r.get(robot); r.get(n);
+		msg.robot = robot;
+		if (!r.get(msg.x, n)) return false;
+		if (!r.get(msg.P, (msg.flags & exportproto::flagCovariance) ? (size_t)n*(n+1)/2 : 0)) return false;
+		msg.landmarks.clear();
+		msg.map_seq = 0;
+		if (msg.type == exportproto::typeMapKeyframe || msg.type == exportproto::typeMapDelta)
+		{
+			uint32_t count;
+			if (!r.get(msg.map_seq) || !r.get(count)) return false;
+			if (count > r.remaining() / 16) return false; // each landmark has at least its 4 u32, don't allocate for a corrupted count
+			msg.landmarks.resize(count);
+			for(std::vector<ExportMessage::Landmark>::iterator it = msg.landmarks.begin(); it != msg.landmarks.end(); ++it)
+			{
+				uint32_t op, id, type, m;
+				if (!r.get(op) || !r.get(id) || !r.get(type) || !r.get(m)) return false;
+				it->op = op; it->id = id; it->type = type;
+				if (!r.get(it->x, m) || !r.get(it->P, (size_t)m*(m+1)/2)) return false;
+			}
+		}
+		return r.atEnd();
+	}
+
+}}
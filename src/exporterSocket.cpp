@@ -0,0 +1,230 @@
+/**
+ * \file exporterSocket.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/exporterSocket.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+
+	bool ExportClientQueue::push(export_message_ptr_t const &msg)
+	{
+		bool kept = true;
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			if (closed) return true;
+			if (messages.size() >= capacity) { messages.pop_front(); ++dropped_; kept = false; }
+			messages.push_back(msg);
+		}
+		cond.notify_one();
+		return kept;
+	}
+
+	bool ExportClientQueue::pop(export_message_ptr_t &msg)
+	{
+		boost::unique_lock<boost::mutex> l(mutex);
+		while (messages.empty() && !closed) cond.wait(l);
+		if (closed) return false;
+		msg = messages.front();
+		messages.pop_front();
+		return true;
+	}
+
+	void ExportClientQueue::close()
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			closed = true;
+			messages.clear();
+		}
+		cond.notify_all();
+	}
+
+
+	ExporterSocket::ExporterSocket(robot_ptr_t robPtr, unsigned short port, bool with_map, size_t queue_size, unsigned keyframe_period):
+		ExporterAbstract(robPtr), port(port), with_map(with_map), queue_size(queue_size), seq(0),
+		keyframe_period(keyframe_period), updates_since_keyframe(0), keyframe_requested(false), map_seq(0),
+		acceptor(io_service), stopping(false), nclients(0), nlost(0)
+	{
+		// bound before returning, so that clients can connect at once
+		tcp::endpoint endpoint(tcp::v4(), port);
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(tcp::acceptor::reuse_address(true));
+		acceptor.bind(endpoint);
+		acceptor.listen();
+		connection_thread = new boost::thread(boost::bind(&ExporterSocket::connectionTask, this));
+	}
+
+	ExporterSocket::~ExporterSocket()
+	{
+		stop();
+	}
+
+
+	void ExporterSocket::connectionTask()
+	{ try {
+		while (true)
+		{
+			// wait for new connection
+			socket_ptr mysock(new tcp::socket(io_service));
+			boost::system::error_code error;
+			acceptor.accept(*mysock, error);
+
+			boost::unique_lock<boost::mutex> l(mutex_clients);
+			if (stopping) break;
+			if (error) continue;
+			mysock->set_option(tcp::no_delay(true));
+			client_ptr_t client(new Client(mysock, queue_size));
+			client->thread = new boost::thread(boost::bind(&ExporterSocket::clientTask, this, client));
+			clients.push_back(client);
+			++nclients;
+			keyframe_requested = true; // so that it gets the map at once
+			std::cout << "ExporterSocket: new client connected on port " << port << "." << std::endl;
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // connectionTask
+
+
+	void ExporterSocket::clientTask(client_ptr_t client)
+	{
+		export_message_ptr_t msg;
+		while (client->queue.pop(msg))
+		{
+			try {
+				boost::asio::write(*client->sock, boost::asio::buffer(*msg));
+				++client->sent;
+			} catch (std::exception &e)
+			{
+				std::cout << "ExporterSocket: client disconnected (" << client->sent << " messages sent, "
+				          << client->queue.dropped() << " dropped)" << std::endl;
+				boost::unique_lock<boost::mutex> l(mutex_clients);
+				client->dead = true;
+				break;
+			}
+		}
+	}
+
+
+	void ExporterSocket::broadcast(ExportMessageBuilder &builder)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_clients);
+		if (stopping) return; // the clients are being closed by stop()
+		builder.setSeq(seq++);
+		export_message_ptr_t msg = builder.finish();
+		for(std::list<client_ptr_t>::iterator it = clients.begin(); it != clients.end(); )
+		{
+			if ((*it)->dead)
+			{
+				// its thread has finished or is about to
+				(*it)->thread->join();
+				delete (*it)->thread;
+				it = clients.erase(it);
+				++nlost;
+			} else
+			{
+				(*it)->queue.push(msg);
+				++it;
+			}
+		}
+	}
+
+
+	void ExporterSocket::toExportFrame(jblas::vec &v, size_t pos, size_t npoints)
+	{
+		for(size_t p = 0; p < npoints; ++p)
+			for(int i = 0; i < 3; ++i)
+				v(pos+3*p+i) += robPtr->origin_sensors(i) - robPtr->origin_export(i);
+	}
+
+
+	void ExporterSocket::exportCurrentState()
+	{
+		if (isStopping()) return;
+		jblas::vec x = robPtr->state.x();
+		toExportFrame(x, 0, 1);
+		ExportMessageBuilder builder(exportproto::typeState, exportproto::flagCovariance, 0, robPtr->self_time,
+			kernel::Clock::getTime(), robPtr->id(), x);
+		builder.addCovariance(robPtr->state.P());
+		broadcast(builder);
+		if (with_map) exportMap();
+	}
+
+
+	void ExporterSocket::exportMap()
+	{
+		// the tracker must follow all the changes, even if the map is sent in a keyframe
+		tracker.update(robPtr->mapPtr(), changes);
+		bool keyframe = (++updates_since_keyframe >= keyframe_period);
+		{
+			boost::unique_lock<boost::mutex> l(mutex_clients);
+			if (keyframe_requested) keyframe = true;
+			keyframe_requested = false;
+		}
+		if (keyframe) { tracker.keyframe(changes); updates_since_keyframe = 0; }
+		else if (changes.empty()) return;
+
+		ExportMessageBuilder builder(keyframe ? exportproto::typeMapKeyframe : exportproto::typeMapDelta, 0, 0,
+			robPtr->self_time, kernel::Clock::getTime(), robPtr->id(), jblas::vec(0));
+		builder.beginLandmarks(++map_seq, changes.size());
+		for(std::vector<LandmarkExportTracker::Change>::iterator it = changes.begin(); it != changes.end(); ++it)
+		{
+			if (it->op == exportproto::opDelete) { builder.addLandmarkDeletion(it->id, it->type); continue; }
+			toExportFrame(it->x, 0, it->x.size()/3);
+			builder.addLandmark(it->op, it->id, it->type, it->x, it->P);
+		}
+		broadcast(builder);
+	}
+
+
+	void ExporterSocket::exportPropagatedState(double time, jblas::vec const &x)
+	{
+		if (isStopping()) return;
+		jblas::vec xe = x;
+		toExportFrame(xe, 0, 1);
+		ExportMessageBuilder builder(exportproto::typePropagatedState, 0, 0, time,
+			kernel::Clock::getTime(), robPtr->id(), xe);
+		broadcast(builder);
+	}
+
+
+	void ExporterSocket::stop()
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex_clients);
+			if (stopping) return;
+			stopping = true;
+		}
+
+		// wake up the accept with a connection of our own
+		try {
+			tcp::socket wakeup(io_service);
+			wakeup.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+		} catch (std::exception &e) {}
+		connection_thread->join();
+		delete connection_thread;
+		acceptor.close();
+
+		unsigned sent = 0, dropped = 0;
+		for(std::list<client_ptr_t>::iterator it = clients.begin(); it != clients.end(); ++it)
+		{
+			(*it)->queue.close();
+			boost::system::error_code error;
+			(*it)->sock->shutdown(tcp::socket::shutdown_both, error); // if it is blocked in write
+			(*it)->thread->join();
+			delete (*it)->thread;
+			sent += (*it)->sent; dropped += (*it)->queue.dropped();
+		}
+		clients.clear();
+		if (nclients)
+			std::cout << "ExporterSocket: " << nclients << " clients (" << nlost << " lost), " << seq << " messages exported, "
+			          << sent << " sent and " << dropped << " dropped to the clients still connected" << std::endl;
+	}
+
+
+}}
@@ -0,0 +1,270 @@
+/**
+ * \file frameEncoder.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstdio>
+#include <iostream>
+
+#include <boost/bind.hpp>
+
+#include <opencv/highgui.h>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/jafarMacro.hpp"
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/frameEncoder.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+
+	/* ###########################################################################
+	   AviMjpegWriter
+	   ######################################################################## */
+
+	namespace avi {
+		const uint32_t flagHasIndex = 0x10; // AVIF_HASINDEX
+		const uint32_t flagKeyFrame = 0x10; // AVIIF_KEYFRAME
+	}
+
+
+	AviMjpegWriter::AviMjpegWriter(std::string const &filename, double fps, int quality):
+		f(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+		fps(fps), quality(quality), width(0), height(0), nframes(0), max_frame_size(0)
+	{
+		if (!f.is_open())
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "AviMjpegWriter: cannot open " << filename);
+		params.push_back(CV_IMWRITE_JPEG_QUALITY);
+		params.push_back(quality);
+	}
+
+
+	void AviMjpegWriter::patch32(std::streamoff pos, uint32_t v)
+	{
+		std::streamoff cur = f.tellp();
+		f.seekp(pos);
+		write32(v);
+		f.seekp(cur);
+	}
+
+
+	void AviMjpegWriter::writeHeaders()
+	{
+		// the sizes and the counts are patched at close
+		writeFourcc("RIFF"); riff_size_pos = f.tellp(); write32(0); writeFourcc("AVI ");
+
+		writeFourcc("LIST"); write32(4 + 8+56 + 8+4 + 8+56 + 8+40); writeFourcc("hdrl");
+		writeFourcc("avih"); write32(56);
+		avih_pos = f.tellp();
+		write32((uint32_t)(1e6/fps)); // microseconds per frame
+		write32(0);                   // max bytes per second
+		write32(0);                   // padding granularity
+		write32(avi::flagHasIndex);
+		write32(0);                   // total frames
+		write32(0);                   // initial frames
+		write32(1);                   // streams
+		write32(0);                   // suggested buffer size
+		write32(width); write32(height);
+		write32(0); write32(0); write32(0); write32(0);
+
+		writeFourcc("LIST"); write32(4 + 8+56 + 8+40); writeFourcc("strl");
+		writeFourcc("strh"); write32(56);
+		writeFourcc("vids"); writeFourcc("MJPG");
+		write32(0);                   // flags
+		write16(0); write16(0);       // priority, language
+		write32(0);                   // initial frames
+		write32(1000); write32((uint32_t)(fps*1000+0.5)); // scale and rate, rate/scale = fps
+		write32(0);                   // start
+		strh_length_pos = f.tellp();
+		write32(0);                   // length
+		write32(0);                   // suggested buffer size
+		write32((uint32_t)-1);        // quality
+		write32(0);                   // sample size
+		write16(0); write16(0); write16(width); write16(height);
+
+		writeFourcc("strf"); write32(40); // BITMAPINFOHEADER
+		write32(40); write32(width); write32(height);
+		write16(1); write16(24);      // planes, bits per pixel
+		writeFourcc("MJPG");
+		write32(width*height*3);
+		write32(0); write32(0); write32(0); write32(0);
+
+		writeFourcc("LIST"); movi_size_pos = f.tellp(); write32(0);
+		movi_pos = f.tellp(); writeFourcc("movi");
+	}
+
+
+	void AviMjpegWriter::write(cv::Mat const &image)
+	{
+		if (!f.is_open()) return;
+		if (nframes == 0)
+		{
+			width = image.cols; height = image.rows;
+			writeHeaders();
+		}
+		if (image.cols != width || image.rows != height)
+		{
+			cv::Mat resized;
+			cv::resize(image, resized, cv::Size(width, height));
+			cv::imencode(".jpg", resized, jpeg, params);
+		} else
+			cv::imencode(".jpg", image, jpeg, params);
+
+		uint32_t size = jpeg.size();
+		std::streamoff pos = f.tellp();
+		index.push_back((uint32_t)(pos - movi_pos));
+		index.push_back(size);
+		writeFourcc("00dc"); write32(size);
+		f.write((const char*)&jpeg[0], size);
+		if (size % 2) f.put(0); // chunks are word aligned
+		if (size > max_frame_size) max_frame_size = size;
+		++nframes;
+	}
+
+
+	void AviMjpegWriter::close()
+	{
+		if (!f.is_open()) return;
+		if (nframes == 0) { f.close(); return; }
+
+		std::streamoff movi_end = f.tellp();
+		writeFourcc("idx1"); write32(nframes*16);
+		for(unsigned i = 0; i < nframes; ++i)
+		{
+			writeFourcc("00dc"); write32(avi::flagKeyFrame);
+			write32(index[2*i]); write32(index[2*i+1]);
+		}
+		std::streamoff end = f.tellp();
+
+		patch32(riff_size_pos, (uint32_t)(end - 8));
+		patch32(movi_size_pos, (uint32_t)(movi_end - movi_pos));
+		patch32(avih_pos + 4, (uint32_t)(max_frame_size * fps)); // max bytes per second
+		patch32(avih_pos + 16, nframes);
+		patch32(avih_pos + 28, max_frame_size + 8);
+		patch32(strh_length_pos, nframes);
+		patch32(strh_length_pos + 4, max_frame_size + 8);
+		f.close();
+	}
+
+
+	/* ###########################################################################
+	   FrameEncoder
+	   ######################################################################## */
+
+	FrameEncoder::FrameEncoder(Output output, std::string const &pattern, double fps, size_t capacity, int quality):
+		output(output), pattern(pattern), fps(fps), quality(quality), capacity(capacity),
+		stopping(false), nwritten(0), ndropped(0)
+	{
+		thread = new boost::thread(boost::bind(&FrameEncoder::encoderTask, this));
+	}
+
+	FrameEncoder::~FrameEncoder()
+	{
+		stop();
+	}
+
+
+	bool FrameEncoder::push(unsigned view, unsigned number, cv::Mat const &image)
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			if (stopping) return false;
+			if (queue.size() >= capacity) { ++ndropped; return false; }
+			Frame frame; frame.view = view; frame.number = number; frame.image = image;
+			queue.push_back(frame);
+		}
+		cond.notify_one();
+		return true;
+	}
+
+	bool FrameEncoder::pushFile(unsigned view, unsigned number, std::string const &file)
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			if (stopping || queue.size() >= capacity)
+			{
+				if (!stopping) ++ndropped;
+				l.unlock();
+				remove(file.c_str());
+				return false;
+			}
+			Frame frame; frame.view = view; frame.number = number; frame.file = file;
+			queue.push_back(frame);
+		}
+		cond.notify_one();
+		return true;
+	}
+
+
+	void FrameEncoder::encoderTask()
+	{ try {
+		Frame frame;
+		while (true)
+		{
+			{
+				boost::unique_lock<boost::mutex> l(mutex);
+				while (queue.empty() && !stopping) cond.wait(l);
+				if (queue.empty()) break; // stopping, and everything was written
+				frame = queue.front();
+				queue.pop_front();
+			}
+			encode(frame);
+			frame.image.release();
+			boost::unique_lock<boost::mutex> l(mutex);
+			++nwritten;
+		}
+
+		for(std::map<unsigned, AviMjpegWriter*>::iterator it = videos.begin(); it != videos.end(); ++it)
+			delete it->second;
+		videos.clear();
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // encoderTask
+
+
+	void FrameEncoder::encode(Frame &frame)
+	{
+		if (!frame.file.empty())
+		{
+			frame.image = cv::imread(frame.file);
+			remove(frame.file.c_str());
+			if (!frame.image.data) return;
+		}
+		char filename[256];
+		switch (output)
+		{
+			case ImageSequence:
+				snprintf(filename, 256, pattern.c_str(), frame.view, frame.number);
+				cv::imwrite(filename, frame.image);
+				break;
+			case MjpegAvi: {
+				AviMjpegWriter *&video = videos[frame.view];
+				if (video == NULL)
+				{
+					snprintf(filename, 256, pattern.c_str(), frame.view);
+					video = new AviMjpegWriter(filename, fps, quality);
+				}
+				video->write(frame.image);
+				break;
+			}
+		}
+	}
+
+
+	void FrameEncoder::stop()
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			if (stopping) return;
+			stopping = true;
+		}
+		cond.notify_all();
+		thread->join();
+		delete thread;
+		if (ndropped)
+			std::cout << "FrameEncoder: " << nwritten << " frames written, " << ndropped << " dropped because the queue was full" << std::endl;
+	}
+
+}}}
@@ -0,0 +1,206 @@
+/**
+ * \file gdheCommandStream.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <iostream>
+#include <sstream>
+#include <istream>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/array.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/gdheCommandStream.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace display {
+
+	using boost::asio::ip::tcp;
+
+
+	void GdheCommandStream::Stats::add(Stats const &s)
+	{
+		updated += s.updated; unchanged += s.unchanged; removed += s.removed;
+		messages += s.messages; bytes += s.bytes; duration += s.duration;
+	}
+
+
+	GdheCommandStream::GdheCommandStream(size_t max_message_size):
+		max_message_size(max_message_size), nnames(0), nflushes(0)
+	{}
+
+
+	std::string GdheCommandStream::newName(std::string const &prefix)
+	{
+		std::ostringstream oss; oss << "rtslam_" << prefix << nnames++;
+		return oss.str();
+	}
+
+
+	void GdheCommandStream::update(std::string const &name, std::string const &script)
+	{
+		removed.erase(name);
+		std::map<std::string, std::string>::iterator it = sent.find(name);
+		if (it != sent.end() && it->second == script)
+		{
+			pending.erase(name); // it may have been changed back during the same refresh
+			++current.unchanged;
+		} else
+			pending[name] = script;
+	}
+
+
+	void GdheCommandStream::remove(std::string const &name)
+	{
+		pending.erase(name);
+		if (sent.erase(name)) removed.insert(name);
+	}
+
+
+	GdheCommandStream::Stats const& GdheCommandStream::flush(Sender const &send)
+	{
+		double start = kernel::Clock::getTime();
+		std::string message;
+		message.reserve(max_message_size);
+
+		if (changed())
+		{
+			for(std::set<std::string>::iterator it = removed.begin(); it != removed.end(); ++it)
+			{
+				if (!message.empty() && message.size() + it->size() + 32 > max_message_size)
+					{ send(message); current.bytes += message.size(); ++current.messages; message.clear(); }
+				message += "unset -nocomplain robots(" + *it + ")\n";
+				++current.removed;
+			}
+			for(std::map<std::string, std::string>::iterator it = pending.begin(); it != pending.end(); ++it)
+			{
+				if (!message.empty() && message.size() + it->first.size() + it->second.size() + 20 > max_message_size)
+					{ send(message); current.bytes += message.size(); ++current.messages; message.clear(); }
+				message += "set robots(" + it->first + ") {" + it->second + "}\n";
+				sent[it->first].swap(it->second);
+				++current.updated;
+			}
+			message += "redraw\n";
+			send(message); current.bytes += message.size(); ++current.messages;
+			pending.clear();
+			removed.clear();
+		}
+
+		current.duration = kernel::Clock::getTime() - start;
+		last = current;
+		total.add(current);
+		current.clear();
+		++nflushes;
+		return last;
+	}
+
+
+
+	GdheSocketSender::GdheSocketSender(std::string const &host, unsigned short port):
+		sock(io_service)
+	{
+		tcp::resolver resolver(io_service);
+		std::ostringstream service; service << port;
+		tcp::resolver::query query(tcp::v4(), host, service.str());
+		sock.connect(*resolver.resolve(query));
+		sock.set_option(tcp::no_delay(true));
+	}
+
+
+	void GdheSocketSender::send(std::string const &script)
+	{
+		const char end = '\0';
+		boost::array<boost::asio::const_buffer, 2> buffers = {{ boost::asio::buffer(script), boost::asio::buffer(&end, 1) }};
+		boost::asio::write(sock, buffers);
+		char ack;
+		boost::asio::read(sock, boost::asio::buffer(&ack, 1));
+	}
+
+
+
+	GdheStubServer::GdheStubServer(unsigned short port):
+		acceptor(io_service), port(port), stopping(false), nmessages(0), ncommands(0), nbytes(0)
+	{
+		// bound before returning, so that the sender can connect at once
+		tcp::endpoint endpoint(tcp::v4(), port);
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(tcp::acceptor::reuse_address(true));
+		acceptor.bind(endpoint);
+		acceptor.listen();
+		thread = new boost::thread(boost::bind(&GdheStubServer::serverTask, this));
+	}
+
+	GdheStubServer::~GdheStubServer()
+	{
+		stop();
+	}
+
+
+	void GdheStubServer::serverTask()
+	{ try {
+		while (true)
+		{
+			boost::shared_ptr<tcp::socket> sock(new tcp::socket(io_service));
+			boost::system::error_code error;
+			acceptor.accept(*sock, error);
+			{
+				boost::unique_lock<boost::mutex> l(mutex);
+				if (stopping) break;
+				if (error) continue;
+				client = sock;
+			}
+
+			boost::asio::streambuf buffer;
+			std::istream is(&buffer);
+			std::string script;
+			while (true)
+			{
+				boost::asio::read_until(*sock, buffer, '\0', error);
+				if (error) break;
+				std::getline(is, script, '\0');
+				{
+					boost::unique_lock<boost::mutex> l(mutex);
+					++nmessages;
+					ncommands += std::count(script.begin(), script.end(), '\n');
+					nbytes += script.size();
+				}
+				const char ack = '\n';
+				boost::asio::write(*sock, boost::asio::buffer(&ack, 1), error);
+				if (error) break;
+			}
+
+			boost::unique_lock<boost::mutex> l(mutex);
+			client.reset();
+			if (stopping) break;
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } } // serverTask
+
+
+	void GdheStubServer::stop()
+	{
+		{
+			boost::unique_lock<boost::mutex> l(mutex);
+			if (stopping) return;
+			stopping = true;
+			boost::system::error_code error;
+			if (client) client->shutdown(tcp::socket::shutdown_both, error); // if it is blocked in read
+		}
+
+		// wake up the accept with a connection of our own
+		try {
+			tcp::socket wakeup(io_service);
+			wakeup.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+		} catch (std::exception &e) {}
+		thread->join();
+		delete thread;
+		acceptor.close();
+	}
+
+}}}
@@ -0,0 +1,65 @@
+/**
+ * \file hardwareEstimatorAbstract.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <boost/shared_ptr.hpp>
+
+#include "kernel/jafarMacro.hpp"
+
+#include "rtslam/hardwareEstimatorAbstract.hpp"
+#include "rtslam/rtslamException.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	bool HardwareEstimatorAbstract::findReadings(const jblas::mat &buffer, int write_position, double t1, double t2, int &i1, int &i2)
+	{
+		JFR_ASSERT(t1 <= t2, "");
+		int bufferSize = buffer.size1();
+		int i, j;
+
+		// find indexes by dichotomy
+		int i_left = write_position, i_right = write_position + bufferSize-1;
+		while(i_left != i_right)
+		{
+			j = (i_left+i_right)/2;
+			i = j % bufferSize;
+			if (buffer(i,0) >= t1) i_right = j; else i_left = j+1;
+		}
+		i = i_left % bufferSize;
+		i1 = (i-1 + bufferSize) % bufferSize;
+		if (t1 <= 1.0 && buffer(i1,0) < 0.0) i1 = i;
+		bool no_larger = (buffer(i,0) < t1);
+		bool no_smaller = (i == write_position);
+		if (no_larger && buffer(i1,0) < 0.0) return false; // no data at all
+		if (no_smaller) JFR_ERROR(RtslamException, RtslamException::BUFFER_OVERFLOW, "Missing data: increase estimator buffer size !");
+
+		if (no_larger)
+			i2 = i1;
+		else
+		{
+			i_right = write_position + bufferSize-1;
+			while(i_left != i_right)
+			{
+				j = (i_left+i_right)/2;
+				i = j % bufferSize;
+				if (buffer(i,0) >= t2) i_right = j; else i_left = j+1;
+			}
+			i2 = i_left % bufferSize;
+		}
+		return true;
+	}
+
+	ReadingSpan HardwareEstimatorAbstract::findSpan(const jblas::mat &buffer, int write_position, double t1, double t2, int &i1)
+	{
+		int i2;
+		if (!findReadings(buffer, write_position, t1, t2, i1, i2)) { i1 = -1; return ReadingSpan(buffer, 0, 0, t1, t2); }
+		int bufferSize = buffer.size1();
+		return ReadingSpan(buffer, i1, (i2-i1+bufferSize) % bufferSize + 1, t1, t2);
+	}
+
+}}}
@@ -11,10 +11,12 @@
 #include <boost/bind.hpp>
 
 #include "kernel/jafarMacro.hpp"
+#include "kernel/timingTools.hpp"
 #include "jmath/misc.hpp"
 #include "jmath/indirectArray.hpp"
 
 #include "rtslam/rtslamException.hpp"
+#include "rtslam/datasetContainer.hpp"
 
 namespace jafar {
 namespace rtslam {
@@ -29,21 +31,33 @@ namespace hardware {
 		//double date = 0.;
 		jblas::vec row(10);
 		std::fstream f;
-		if (mode == 1 || mode == 2)
+		boost::shared_ptr<VectorLogWriter> log_writer;
+		boost::shared_ptr<VectorLogReader> log_reader;
+		if (mode == 1)
+			log_writer.reset(new VectorLogWriter(dump_path, "MTI", row.size()));
+		if (mode == 2)
 		{
-			std::ostringstream oss; oss << dump_path << "/MTI.log";
-			f.open(oss.str().c_str(), (mode == 1 ? std::ios_base::out : std::ios_base::in));
+			if (VectorLogReader::exists(dump_path, "MTI"))
+				log_reader.reset(new VectorLogReader(dump_path, "MTI"));
+			else
+			{ // text log of older recordings, see demo_dataset_convert
+				std::ostringstream oss; oss << dump_path << "/MTI.log";
+				f.open(oss.str().c_str(), std::ios_base::in);
+			}
 		}
+		double arrival = 0.;
 		
 		while (true)
 		{
 			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t());
 			if (mode == 2)
 			{
-				f >> row;
+				bool eof;
+				if (log_reader) eof = !log_reader->read(row, arrival);
+				else { f >> row; eof = f.eof(); }
 				l.lock();
 				if (write_position == read_position) cond_offline.notify_all();
-				if (f.eof()) { cond_offline.notify_all(); f.close(); return; }
+				if (eof) { cond_offline.notify_all(); if (f.is_open()) f.close(); return; }
 				while (write_position == read_position) cond_data.wait(l);
 // std::cout << "MTI preload: put at write_position " << write_position << " (read_position " << read_position << ") ts " << std::setprecision(16) << row(0) << std::endl;
 			} else
@@ -51,6 +65,7 @@ namespace hardware {
 #ifdef HAVE_MTI
 				//if (!emptied_buffers) date = kernel::Clock::getTime();
 				if (!mti->read(&data)) continue;
+				arrival = kernel::Clock::getTime();
 				//if (!emptied_buffers) { date = kernel::Clock::getTime()-date; if (date < 0.002) continue; else emptied_buffers = true; }
 				l.lock();
 				if (write_position == read_position) JFR_ERROR(RtslamException, RtslamException::BUFFER_OVERFLOW, "Data not read: Increase MTI buffer size !");
@@ -68,26 +83,23 @@ namespace hardware {
 			}
 			ublas::matrix_row<jblas::mat>(buffer, write_position) = row;
 			buffer(write_position,0) += timestamps_correction;
+			int written = write_position;
 			++write_position; if (write_position >= bufferSize) write_position = 0;
+			if (++nreadings == ready_readings) cond_ready.notify_all();
 			l.unlock();
+			notifyReading(&buffer(written,0), buffer.size2(), arrival); // only this thread writes in the buffer
 			
 			if (mode == 1)
-			{
-				// we put the maximum precision because we want repeatability with the original run
-				f << std::setprecision(50) << row << std::endl;
-			}
+				log_writer->write(row, arrival);
 		}
 		
-		if (mode == 1 || mode == 2)
-			f.close();
-		
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
 
 	HardwareEstimatorMti::HardwareEstimatorMti(std::string device, double trigger_mode, double trigger_freq, double trigger_shutter, int bufferSize_, int mode, std::string dump_path):
 #ifdef HAVE_MTI
 		mti(NULL),
 #endif
-		buffer(bufferSize_, 10), bufferSize(bufferSize_), write_position(0), read_position(bufferSize_-1),
+		buffer(bufferSize_, 10), bufferSize(bufferSize_), write_position(0), read_position(bufferSize_-1), nreadings(0), ready_readings(100),
 		timestamps_correction(0.0)/*, tightly_synchronized(false)*/, mode(mode), dump_path(dump_path)
 	{
 		if (mode != 2)
@@ -153,6 +165,16 @@ namespace hardware {
 		std::cout << " done." << std::endl;
 	}
 	
+	bool HardwareEstimatorMti::waitReady(double timeout)
+	{
+		if (mode == 2) return true; // the log has already been read by start()
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds((long)(timeout*1e6));
+		while (nreadings < ready_readings)
+			if (!cond_ready.timed_wait(l, deadline)) break;
+		return nreadings >= ready_readings;
+	}
+	
 	void HardwareEstimatorMti::setSyncConfig(double timestamps_correction/*, bool tightly_synchronized, double tight_offset*/)
 	{
 		this->timestamps_correction = timestamps_correction;
@@ -163,42 +185,10 @@ namespace hardware {
 	
 	jblas::mat_indirect HardwareEstimatorMti::acquireReadings(double t1, double t2)
 	{
-		JFR_ASSERT(t1 <= t2, "");
 		boost::unique_lock<boost::mutex> l(mutex_data);
 		int i1, i2;
-		int i, j;
-
-		// find indexes by dichotomy
-		int i_left = write_position, i_right = write_position + bufferSize-1;
-		while(i_left != i_right)
-		{
-			j = (i_left+i_right)/2;
-			i = j % bufferSize;
-			if (buffer(i,0) >= t1) i_right = j; else i_left = j+1;
-		}
-		i = i_left % bufferSize;
-		i1 = (i-1 + bufferSize) % bufferSize;
-		if (t1 <= 1.0 && buffer(i1,0) < 0.0) i1 = i;
-		bool no_larger = (buffer(i,0) < t1);
-		bool no_smaller = (i == write_position);
-		if (no_larger && buffer(i1,0) < 0.0)  // no data at all
+		if (!findReadings(buffer, write_position, t1, t2, i1, i2))
 			return ublas::project(buffer, jmath::ublasExtra::ia_set(ublas::range(0,0)), jmath::ublasExtra::ia_set(ublas::range(0, buffer.size2())));
-		if (no_smaller) JFR_ERROR(RtslamException, RtslamException::BUFFER_OVERFLOW, "Missing data: increase MTI buffer size !");
-		
-		if (no_larger)
-			i2 = i1;
-		else
-		{
-			i_right = write_position + bufferSize-1;
-			while(i_left != i_right)
-			{
-				j = (i_left+i_right)/2;
-				i = j % bufferSize;
-				if (buffer(i,0) >= t2) i_right = j; else i_left = j+1;
-			}
-			i = i_left % bufferSize;
-			i2 = i;
-		}
 		
 		// handle tight sync ; or do nothing, because anyway there's a difference between the Mti pulse, the middle of the exposure of the frame which is the real  date of the frame, and the end of the frame which is supposed to be the provided frame date, and it is difficult to decide where to do the modification...
 		/*if (tightly_synced)
@@ -227,6 +217,17 @@ namespace hardware {
 		}
 	}
 
+	ReadingSpan HardwareEstimatorMti::acquireSpan(double t1, double t2)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		int i1;
+		ReadingSpan span = findSpan(buffer, write_position, t1, t2, i1);
+		if (i1 < 0) return span;
+		read_position = i1;
+		l.unlock();
+		cond_data.notify_all();
+		return span;
+	}
 
 }}}
 
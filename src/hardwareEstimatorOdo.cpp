@@ -14,6 +14,7 @@
 #include "jmath/misc.hpp"
 #include "jmath/indirectArray.hpp"
 #include "rtslam/rtslamException.hpp"
+#include "rtslam/datasetContainer.hpp"
 
 namespace jafar {
 namespace rtslam {
@@ -24,25 +25,31 @@ namespace hardware {
 
 		jblas::vec row(7);
 		Position pos1;
+		boost::shared_ptr<VectorLogReader> log_reader;
+		if (mode == 2 && VectorLogReader::exists(dump_path, "odo"))
+			log_reader.reset(new VectorLogReader(dump_path, "odo"));
+		double arrival = 0.;
 		
 		while (true)
 		{
 			boost::unique_lock<boost::mutex> l(mutex_data, boost::defer_lock_t());
-			if (mode == 2)
+			if (mode == 2 && log_reader)
 			{
+				bool eof = !log_reader->read(row, arrival);
+				l.lock();
+				if (write_position == read_position) cond_offline.notify_all();
+				if (eof) { cond_offline.notify_all(); return; }
+				while (write_position == read_position) cond_data.wait(l);
+			} else
+			if (mode == 2)
+			{ // one .pos file per reading, see demo_dataset_convert to convert them to a binary log
 				pos1 = loadPosition(index_load_);
 				l.lock();
 				if (write_position == read_position) cond_offline.notify_all();
 				while (write_position == read_position) cond_data.wait(l);
 				if (!pos1.m_date)
 					std::cout << " Failed to read position " << std::endl;
-				row(0) = pos1.m_date;
-				row(1) = pos1.m_mainToBase(0); //x
-				row(2) = pos1.m_mainToBase(1); //y
-				row(3) = pos1.m_mainToBase(2); //z
-				row(4) = pos1.m_mainToBase(5); //roll
-				row(5) = pos1.m_mainToBase(4); //pitch
-				row(6) = pos1.m_mainToBase(3); //yaw
+				positionToReading(pos1, row);
 				index_load_++;
 			} else
 			{
@@ -50,8 +57,10 @@ namespace hardware {
 			}
 			ublas::matrix_row<jblas::mat>(buffer, write_position) = row;
 // 			buffer(write_position,0) += timestamps_correction;
+			int written = write_position;
 			++write_position; if (write_position >= bufferSize) write_position = 0;
 			l.unlock();
+			notifyReading(&buffer(written,0), buffer.size2(), arrival); // only this thread writes in the buffer
 		}
 		
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
@@ -112,6 +121,17 @@ namespace hardware {
 		 pos.load(filepath.str()); 
 	}
 	
+	void HardwareEstimatorOdo::positionToReading(Position const &pos, jblas::vec &row)
+	{
+		row(0) = pos.m_date;
+		row(1) = pos.m_mainToBase(0); //x
+		row(2) = pos.m_mainToBase(1); //y
+		row(3) = pos.m_mainToBase(2); //z
+		row(4) = pos.m_mainToBase(5); //roll
+		row(5) = pos.m_mainToBase(4); //pitch
+		row(6) = pos.m_mainToBase(3); //yaw
+	}
+	
 	void Position::loadKeyValueFile(jafar::kernel::KeyValueFile const& keyValueFile)
 	{	
 		keyValueFile.getItem("date", m_date);
@@ -120,42 +140,10 @@ namespace hardware {
 
 	jblas::mat_indirect HardwareEstimatorOdo::acquireReadings(double t1, double t2)
 	{
-		JFR_ASSERT(t1 <= t2, "");
 		boost::unique_lock<boost::mutex> l(mutex_data);
 		int i1, i2;
-		int i, j;
-
-		// find indexes by dichotomy
-		int i_left = write_position, i_right = write_position + bufferSize-1;
-		while(i_left != i_right)
-		{
-			j = (i_left+i_right)/2;
-			i = j % bufferSize;
-			if (buffer(i,0) >= t1) i_right = j; else i_left = j+1;
-		}
-		i = i_left % bufferSize;
-		i1 = (i-1 + bufferSize) % bufferSize;
-		if (t1 <= 1.0 && buffer(i1,0) < 0.0) i1 = i;
-		bool no_larger = (buffer(i,0) < t1);
-		bool no_smaller = (i == write_position);
-		if (no_larger && buffer(i1,0) < 0.0)  // no data at all
+		if (!findReadings(buffer, write_position, t1, t2, i1, i2))
 			return ublas::project(buffer, jmath::ublasExtra::ia_set(ublas::range(0,0)), jmath::ublasExtra::ia_set(ublas::range(0, buffer.size2())));
-		if (no_smaller) JFR_ERROR(RtslamException, RtslamException::BUFFER_OVERFLOW, "Missing data: increase buffer size !");
-		
-		if (no_larger)
-			i2 = i1;
-		else
-		{
-			i_right = write_position + bufferSize-1;
-			while(i_left != i_right)
-			{
-				j = (i_left+i_right)/2;
-				i = j % bufferSize;
-				if (buffer(i,0) >= t2) i_right = j; else i_left = j+1;
-			}
-			i = i_left % bufferSize;
-			i2 = i;
-		}
 		
 		read_position = i1;
 		l.unlock();
@@ -174,5 +162,18 @@ namespace hardware {
 				jmath::ublasExtra::ia_set(ublas::range(0,buffer.size2())));
 		}
 	}
+
+	ReadingSpan HardwareEstimatorOdo::acquireSpan(double t1, double t2)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		int i1;
+		ReadingSpan span = findSpan(buffer, write_position, t1, t2, i1);
+		if (i1 < 0) return span;
+		read_position = i1;
+		l.unlock();
+		cond_data.notify_all();
+		return span;
+	}
+
 }}}
 
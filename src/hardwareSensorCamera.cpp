@@ -6,6 +6,7 @@
  */
 
 #include <algorithm>
+#include <limits>
 #include <sstream>
 #include <fstream>
 
@@ -17,6 +18,7 @@
 #endif
 
 #include "kernel/timingTools.hpp"
+#include "rtslam/rtslamException.hpp"
 #include "rtslam/hardwareSensorCamera.hpp"
 
 
@@ -29,48 +31,270 @@ namespace hardware {
 
 	void HardwareSensorCamera::preloadTaskOffline(void)
 	{ try {
-		int ndigit = 0;
-
-		while(true)
+		prefetch_end = std::numeric_limits<unsigned>::max();
+		
+		if (dataset::isDatasetPath(dump_path))
 		{
-			// acquire the image
-			boost::unique_lock<boost::mutex> l(mutex_data);
-			while (isFull(true)) cond_offline_freed.wait(l);
-			l.unlock();
-			int buff_write = getWritePos();
-			while (true)
+			dataset_reader = DatasetReader::shared(dump_path);
+			dataset_stream = dataset_reader->findStream(dataset::stCamera, dataset_camera_rank);
+			if (dataset_stream < 0)
+				JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "No camera " << dataset_camera_rank << " in dataset " << dump_path);
+			DatasetStreamInfo const &info = dataset_reader->stream(dataset_stream);
+			if (info.width != bufferImage[0]->width || info.height != bufferImage[0]->height)
+				JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Images of dataset " << dump_path << " are " << info.width << "x" << info.height);
+			
+			size_t nimages = dataset_reader->size(dataset_stream);
+			prefetch_end = nimages;
+			if (dataset_start_frame >= 0)
+				index_load = dataset_start_frame;
+			else if (dataset_start_delay > 0. && nimages > 0)
+				index_load = dataset_reader->findRecord(dataset_stream, dataset_reader->record(dataset_stream, 0).timestamp + dataset_start_delay);
+			if (index_load > 0) std::cout << "Replay starts at image " << index_load << "/" << nimages << std::endl;
+			
+			// if images are stored uncompressed and the file is mapped, the buffers point directly to the mapping
+			dataset_zero_copy = (nimages > 0 && dataset_reader->data(dataset_reader->record(dataset_stream, 0)) != NULL &&
+			                     info.depth == (bufferImage[0]->depth & 255) && info.channels == bufferImage[0]->nChannels);
+			for(size_t i = 0; i < nimages && dataset_zero_copy; ++i)
+				if (dataset_reader->record(dataset_stream, i).encoding != dataset::encRaw) dataset_zero_copy = false;
+			if (dataset_zero_copy) // imageDataOrigin is left NULL, so that releasing the images doesn't free the mapping
+				for(int i = 0; i < bufferSize; ++i) cvReleaseData(bufferImage[i]);
+		} else
+		{
+			// find the first image and the format of the file names
+			// FIXME manage multisensors : put sensor id in filename
+			while (!found_first && first_index < 1000)
 			{
-				// FIXME manage multisensors : put sensor id in filename
-				std::ostringstream oss;
-				for (int i = 3; i <= 7; ++i)
+				for (ndigit = 3; ndigit <= 7; ++ndigit)
 				{
-					if (!found_first) ndigit = i;
-					oss.str(""); oss << dump_path << "/image_" << std::setw(ndigit) << std::setfill('0') << index_load+first_index;
-					if (found_first != 2 && bufferSpecPtr[buff_write]->img->load(oss.str() + std::string(".pgm"), 0) && found_first == 0) { found_first = 1; std::cout << "First image " << oss.str() << ".pgm" << std::endl; }
-					if (found_first != 1 && bufferSpecPtr[buff_write]->img->load(oss.str() + std::string(".png"), 0) && found_first == 0) { found_first = 2; std::cout << "First image " << oss.str() << ".png" << std::endl; }
+					std::ostringstream oss; oss << dump_path << "/image_" << std::setw(ndigit) << std::setfill('0') << first_index;
+					if (bufferSpecPtr[0]->img->load(oss.str() + std::string(".pgm"), 0)) { found_first = 1; std::cout << "First image " << oss.str() << ".pgm" << std::endl; }
+					else if (bufferSpecPtr[0]->img->load(oss.str() + std::string(".png"), 0)) { found_first = 2; std::cout << "First image " << oss.str() << ".png" << std::endl; }
 					if (found_first) break;
 				}
-				if (!found_first) { first_index++; continue; }
+				if (!found_first) first_index++;
+			}
+			if (!found_first) prefetch_end = 0;
+		}
+		
+		prefetch_claim = prefetch_publish = index_load;
+		prefetch_ready.assign(bufferSize, false);
+		prefetch_last_publish = kernel::Clock::getTime();
+		prefetch_starved = prefetch_backpressure = prefetch_depth = 0.;
+		prefetch_count = 0;
+		
+		{
+			// locked so that stopPrefetch cannot miss a thread started meanwhile
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			for(unsigned i = 1; i < prefetch_threads && !prefetch_stop; ++i)
+				prefetch_group.create_thread(boost::bind(&HardwareSensorCamera::decodeTaskOffline,this));
+		}
+		decodeTaskOffline();
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
 
-				if (bufferSpecPtr[buff_write]->img->data() == NULL)
-				{
-					boost::unique_lock<boost::mutex> l(mutex_data);
-					no_more_data = true;
-					//std::cout << "No more images to read." << std::endl;
-					break;
-				}
-				std::fstream f((oss.str() + std::string(".time")).c_str(), std::ios_base::in);
-				f >> bufferSpecPtr[buff_write]->timestamp; f.close();
-				index_load++;
-				break;
+
+	bool HardwareSensorCamera::loadOffline(unsigned image_index, int buff_write)
+	{
+		if (dataset_reader)
+		{
+			DatasetRecordInfo const &rec = dataset_reader->record(dataset_stream, image_index);
+			if (dataset_zero_copy)
+				setBufferData(buff_write, dataset_reader->data(rec), dataset::imageRowSize(dataset_reader->stream(dataset_stream)), dataset_reader);
+			else
+				dataset_reader->readImage(rec, (uchar*)bufferImage[buff_write]->imageData, bufferImage[buff_write]->widthStep);
+			bufferSpecPtr[buff_write]->timestamp = rec.timestamp;
+			bufferSpecPtr[buff_write]->arrival = rec.arrival;
+			return true;
+		} else
+		{
+			std::ostringstream oss; oss << dump_path << "/image_" << std::setw(ndigit) << std::setfill('0') << image_index+first_index;
+			if (!bufferSpecPtr[buff_write]->img->load(oss.str() + std::string(found_first == 1 ? ".pgm" : ".png"), 0))
+				return false;
+			std::fstream f((oss.str() + std::string(".time")).c_str(), std::ios_base::in);
+			f >> bufferSpecPtr[buff_write]->timestamp; f.close();
+			bufferSpecPtr[buff_write]->arrival = 0.; // not recorded, the arrival delay will be used
+			return true;
+		}
+	}
+
+
+	void HardwareSensorCamera::setBufferData(int buff, const char *data, int step, boost::shared_ptr<void> const &owner)
+	{
+		// the jafar image wraps the IplImage header, so it is enough to move its data pointer,
+		// but not with cvSetData that would also set imageDataOrigin and make cvReleaseImage free this memory
+		IplImage *image = bufferImage[buff];
+		image->imageData = const_cast<char*>(data);
+		image->widthStep = step;
+		image->imageSize = step * image->height;
+		bufferSpecPtr[buff]->data_owner = owner;
+	}
+
+
+	void HardwareSensorCamera::decodeTaskOffline(void)
+	{ try {
+		// each thread takes the next image to load, loads it in the position of the buffer
+		// it will have once the previous ones are published, and then publishes in order
+		// all the images that are ready
+		int image_size = bufferImage[0]->imageSize;
+		int capacity = bufferSize;
+		if (prefetch_memory > 0 && !dataset_zero_copy)
+			capacity = std::max(1, std::min(bufferSize, (int)(prefetch_memory / image_size)));
+		
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		while (true)
+		{
+			unsigned image_index = prefetch_claim++;
+			double wait_start = kernel::Clock::getTime();
+			bool waited = false;
+			while (!prefetch_stop && !no_more_data && image_index < prefetch_end &&
+			       (int)(image_index - prefetch_publish) + (bufferSize - getFreeSpace(true)) >= capacity)
+				{ cond_offline_freed.wait(l); waited = true; }
+			if (waited) prefetch_backpressure += kernel::Clock::getTime() - wait_start;
+			if (prefetch_stop || no_more_data || image_index >= prefetch_end) break;
+			int buff_write = (getWritePos(true) + image_index - prefetch_publish) % bufferSize;
+			
+			l.unlock();
+			bool loaded = loadOffline(image_index, buff_write);
+			l.lock();
+			if (prefetch_stop) break;
+			
+			if (!loaded) prefetch_end = std::min(prefetch_end, image_index);
+			else prefetch_ready[buff_write] = true;
+			bool published = false;
+			while (prefetch_publish < prefetch_end && !isFull(true) && prefetch_ready[getWritePos(true)])
+			{
+				double now = kernel::Clock::getTime();
+				int depth = bufferSize - getFreeSpace(true);
+				if (depth == 0) prefetch_starved += now - prefetch_last_publish; // the reader was waiting for us
+				prefetch_depth += depth;
+				prefetch_last_publish = now;
+				prefetch_ready[getWritePos(true)] = false;
+				incWritePos(true);
+				prefetch_publish++;
+				index_load = prefetch_publish;
+				published = true;
+				if (++prefetch_count % 500 == 0) reportPrefetch();
+			}
+			if (prefetch_publish >= prefetch_end && !no_more_data)
+			{
+				setNoMoreData();
+				reportPrefetch();
 			}
-			if (no_more_data) break;
-			incWritePos();
-			condition.setAndNotify(1);
+			
+			l.unlock();
+			if (published || no_more_data) condition.setAndNotify(1);
+			cond_offline_freed.notify_all(); // other threads may wait for their turn
+			l.lock();
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
+
+
+	void HardwareSensorCamera::reportPrefetch(void)
+	{
+		std::cout << "Replay: " << prefetch_count << " images loaded by " << prefetch_threads << " thread(s)"
+		          << ", mean queue depth " << (prefetch_count ? prefetch_depth/prefetch_count : 0.) << "/" << bufferSize
+		          << ", reader starved " << prefetch_starved << " s, loading blocked " << prefetch_backpressure << " s" << std::endl;
+	}
+
+
+
+	int HardwareSensorCamera::nextToPreprocess(void)
+	{
+		// the oldest image that is not read yet and has not been prepared, mutex_data must be locked
+		if (isEmpty(true)) return -1;
+		int last = getLastUnreadPos(true);
+		for(int pos = getFirstUnreadPos(); ; pos = (pos+1) % bufferSize)
+		{
+			if (preprocess_timestamp[pos] != bufferSpecPtr[pos]->timestamp) return pos;
+			if (pos == last) return -1;
+		}
+	}
+
+
+	void HardwareSensorCamera::preprocessTask(void)
+	{ try {
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		while (true)
+		{
+			int pos = -1;
+			while (!preprocess_stop && (preprocess_hold || (pos = nextToPreprocess()) < 0)) cond_written.wait(l);
+			if (preprocess_stop) break;
+			
+			// the reader won't release this position until it is prepared, so it cannot be overwritten
+			preprocess_busy = pos;
+			rawimage_ptr_t raw = bufferSpecPtr[pos];
+			l.unlock();
+			preprocess_func(raw);
+			l.lock();
+			preprocess_timestamp[pos] = raw->timestamp;
+			preprocess_busy = -1;
+			cond_preprocessed.notify_all();
 		}
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
 
 
+	void HardwareSensorCamera::holdPreprocessing(int id)
+	{
+		if (!preprocessTask_thread) return;
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		preprocess_hold = true;
+		if (id < 0) id = getLastUnreadPos(true);
+		
+		// wait if the image being prepared is the one that is read or one that will be released
+		int first = getFirstUnreadPos();
+		bool waited = false;
+		while (preprocess_busy >= 0 && (preprocess_busy-first+bufferSize) % bufferSize <= (id-first+bufferSize) % bufferSize)
+			{ cond_preprocessed.wait(l); waited = true; }
+		
+		if (isEmpty(true)) return;
+		if (waited) ++preprocess_waited;
+		if (preprocess_timestamp[id] == bufferSpecPtr[id]->timestamp) ++preprocess_ready;
+		if (++preprocess_read % 500 == 0) reportPreprocessing();
+	}
+
+
+	void HardwareSensorCamera::resumePreprocessing(void)
+	{
+		if (!preprocessTask_thread) return;
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		preprocess_hold = false;
+		cond_written.notify_all();
+	}
+
+
+	void HardwareSensorCamera::reportPreprocessing(void)
+	{
+		std::cout << "Preprocessing: " << preprocess_read << " images read, " << preprocess_ready << " prepared in advance"
+		          << " (" << preprocess_waited << " waited for)" << std::endl;
+	}
+
+
+	void HardwareSensorCamera::setPreprocessing(preprocess_func_t func)
+	{
+		if (preprocessTask_thread) { std::cout << "Warning: preprocessing of this HardwareSensorCamera has already been set" << std::endl; return; }
+		if (!func) return;
+		preprocess_func = func;
+		preprocess_timestamp.assign(bufferSize, -1.);
+		preprocessTask_thread = new boost::thread(boost::bind(&HardwareSensorCamera::preprocessTask,this));
+	}
+
+
+	void HardwareSensorCamera::getRaw(unsigned id, raw_ptr_t& raw)
+	{
+		holdPreprocessing(id);
+		HardwareSensorExteroAbstract::getRaw(id, raw);
+		resumePreprocessing();
+	}
+
+
+	int HardwareSensorCamera::getLastUnreadRaw(raw_ptr_t& raw)
+	{
+		holdPreprocessing(-1);
+		int r = HardwareSensorExteroAbstract::getLastUnreadRaw(raw);
+		resumePreprocessing();
+		return r;
+	}
+
+
 
 	void HardwareSensorCamera::savePushTask(void)
 	{ try {
@@ -92,9 +316,12 @@ namespace hardware {
 		}
 		//remove(bdump_path / "*.pgm"); // FIXME possible ?
 		#else
-		std::ostringstream oss; oss << "mkdir -p " << dump_path << " ; rm -f " << dump_path << "/*.pgm ; rm -f " << dump_path << "/*.time" << std::endl;
-		int r = system(oss.str().c_str());
-		if (!r) {} // don't care
+		if (!dataset::isDatasetPath(dump_path))
+		{
+			std::ostringstream oss; oss << "mkdir -p " << dump_path << " ; rm -f " << dump_path << "/*.pgm ; rm -f " << dump_path << "/*.time" << std::endl;
+			int r = system(oss.str().c_str());
+			if (!r) {} // don't care
+		}
 		#endif
 		
 		while (true)
@@ -117,6 +344,15 @@ namespace hardware {
 		int save_index = index();
 		int remain = 0, prev_remain = 0;
 		
+		if (dataset::isDatasetPath(dump_path))
+		{
+			dataset_writer = DatasetWriter::shared(dump_path);
+			DatasetStreamInfo info(dataset::stCamera, "camera", bufferImage[0]->width, bufferImage[0]->height,
+			                       bufferImage[0]->depth & 255, bufferImage[0]->nChannels);
+			info.params = dataset_intrinsics;
+			dataset_stream = dataset_writer->addStream(info);
+		}
+		
 		while (true)
 		{
 			// wait for and get next data to save
@@ -127,10 +363,16 @@ namespace hardware {
 			remain = saveTask_cond.var;
 			saveTask_cond.unlock();
 			
-			std::ostringstream oss; oss << dump_path << "/image_" << std::setw(7) << std::setfill('0') << save_index;
-			image->img->save(oss.str() + std::string(".pgm"));
-			std::fstream f; f.open((oss.str() + std::string(".time")).c_str(), std::ios_base::out); 
-			f << std::setprecision(20) << image->timestamp << std::endl; f.close();
+			if (dataset_writer)
+			{
+				dataset_writer->writeImage(dataset_stream, image->timestamp, image->arrival, (const uchar*)image->img->data(), image->img->step(), dataset_encoding);
+			} else
+			{
+				std::ostringstream oss; oss << dump_path << "/image_" << std::setw(7) << std::setfill('0') << save_index;
+				image->img->save(oss.str() + std::string(".pgm"));
+				std::fstream f; f.open((oss.str() + std::string(".time")).c_str(), std::ios_base::out); 
+				f << std::setprecision(20) << image->timestamp << std::endl; f.close();
+			}
 			
 			if (remain > prev_remain || (remain == 0 && prev_remain != 0))
 				std::cout << save_index << ": " << remain << " in queue." << std::endl;
@@ -162,16 +404,50 @@ namespace hardware {
 	}
 
 	
-	HardwareSensorCamera::HardwareSensorCamera(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path):
-		HardwareSensorExteroAbstract(condition, 3), saveTask_cond(0)
+	HardwareSensorCamera::HardwareSensorCamera(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path, int bufferSize):
+		HardwareSensorExteroAbstract(condition, bufferSize), dataset_stream(-1), dataset_camera_rank(0), dataset_encoding(dataset::encRaw),
+		dataset_start_delay(0.), dataset_start_frame(-1), dataset_zero_copy(false),
+		ndigit(0), prefetch_threads(1), prefetch_memory(0), prefetch_stop(false), preprocess_busy(-1), preprocess_hold(false), preprocess_stop(false),
+		preprocess_read(0), preprocess_ready(0), preprocess_waited(0), preprocessTask_thread(NULL), saveTask_cond(0)
 	{
 		init(dump_path, imgSize);
 	}
 
 	HardwareSensorCamera::HardwareSensorCamera(kernel::VariableCondition<int> &condition, int bufferSize):
-		HardwareSensorExteroAbstract(condition, bufferSize), saveTask_cond(0)
+		HardwareSensorExteroAbstract(condition, bufferSize), dataset_stream(-1), dataset_camera_rank(0), dataset_encoding(dataset::encRaw),
+		dataset_start_delay(0.), dataset_start_frame(-1), dataset_zero_copy(false),
+		ndigit(0), prefetch_threads(1), prefetch_memory(0), prefetch_stop(false), preprocess_busy(-1), preprocess_hold(false), preprocess_stop(false),
+		preprocess_read(0), preprocess_ready(0), preprocess_waited(0), preprocessTask_thread(NULL), saveTask_cond(0)
 	{}
 
+	void HardwareSensorCamera::stopPreprocessing()
+	{
+		if (!preprocessTask_thread) return;
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		preprocess_stop = true;
+		cond_written.notify_all();
+		l.unlock();
+		preprocessTask_thread->join();
+		delete preprocessTask_thread;
+		preprocessTask_thread = NULL;
+		if (preprocess_read) reportPreprocessing();
+	}
+
+	void HardwareSensorCamera::stopPrefetch()
+	{
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		prefetch_stop = true;
+		l.unlock();
+		cond_offline_freed.notify_all();
+		prefetch_group.join_all();
+	}
+
+	HardwareSensorCamera::~HardwareSensorCamera()
+	{
+		stopPrefetch();
+		stopPreprocessing();
+	}
+
 	
 
 }}}
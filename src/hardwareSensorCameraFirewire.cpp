@@ -228,8 +228,8 @@ namespace hardware {
 	}
 		
 	
-	HardwareSensorCameraFirewire::HardwareSensorCameraFirewire(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path):
-		HardwareSensorCamera(condition, imgSize, dump_path)
+	HardwareSensorCameraFirewire::HardwareSensorCameraFirewire(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path, int bufferSize):
+		HardwareSensorCamera(condition, imgSize, dump_path, bufferSize), mode(2)
 	{}
 	
 
@@ -280,6 +280,8 @@ namespace hardware {
 
 	HardwareSensorCameraFirewire::~HardwareSensorCameraFirewire()
 	{
+		stopPrefetch();
+		stopPreprocessing(); // before the images are released with the camera
 #ifdef HAVE_VIAM
 		if (mode == 0 || mode == 1)
 			viam_release(handle);
@@ -0,0 +1,164 @@
+/**
+ * \file hardwareSensorCameraShm.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <algorithm>
+
+#include "kernel/timingTools.hpp"
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/hardwareSensorCameraShm.hpp"
+
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	bool HardwareSensorCameraShm::attachRing(void)
+	{
+		// the producer may start after us, wait for it with a growing period, but not forever
+		double deadline = kernel::Clock::getTime() + attach_timeout;
+		int period = 1;
+		bool warned = false;
+		while (!(ring = ShmImageRing::open(shm_name)))
+		{
+			if (kernel::Clock::getTime() >= deadline)
+			{
+				std::cout << "HardwareSensorCameraShm: no producer on " << shm_name << " after " << attach_timeout << " s" << std::endl;
+				return false;
+			}
+			if (!warned) { std::cout << "HardwareSensorCameraShm: waiting for producer on " << shm_name << std::endl; warned = true; }
+			boost::this_thread::sleep(boost::posix_time::milliseconds(period));
+			period = std::min(2*period, 100);
+		}
+
+		shm::FrameHeader const &format = ring->format();
+		if ((int)format.width != bufferImage[0]->width || (int)format.height != bufferImage[0]->height ||
+		    (int)format.depth != (bufferImage[0]->depth & 255) || (int)format.channels != bufferImage[0]->nChannels)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "Images of " << shm_name << " are " << format.width << "x" << format.height
+				<< " depth " << format.depth << " channels " << format.channels);
+		// one more slot than the buffer for the last processed image, that is still displayed
+		if ((int)ring->slots() <= bufferSize)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, shm_name << " has " << ring->slots() << " slots, it needs more than " << bufferSize);
+
+		// the buffers will point to the slots of the ring, imageDataOrigin is left NULL so that releasing the images doesn't free them
+		for(int i = 0; i < bufferSize; ++i) cvReleaseData(bufferImage[i]);
+		std::cout << "HardwareSensorCameraShm: reading " << shm_name << " (" << ring->slots() << " slots)" << std::endl;
+		return true;
+	}
+
+
+	void HardwareSensorCameraShm::releaseRing(uint64_t next_seq)
+	{
+		// the images still used are the ones in the buffer, that are the last written, and the last processed one
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		int used = bufferSize - getFreeSpace(true);
+		int w = getLastUnreadPos(true);
+		uint64_t oldest = (used > 0 ? slot_seq[(w - used + 1 + bufferSize) % bufferSize] : next_seq);
+		if (index() >= 0) oldest = std::min(oldest, slot_seq[last_sent_pos]);
+		l.unlock();
+		ring->releaseUntil(oldest);
+	}
+
+
+	void HardwareSensorCameraShm::preloadTask(void)
+	{ try {
+		if (!attachRing())
+		{
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			setNoMoreData();
+			l.unlock();
+			condition.setAndNotify(1);
+			return;
+		}
+		uint64_t seq = ring->attach();
+		int buff_write = getWritePos();
+
+		while(true)
+		{
+			// don't overflow the buffer, the producer will drop images instead
+			{
+				boost::unique_lock<boost::mutex> l(mutex_data);
+				while (isFull(true)) cond_offline_freed.wait(l);
+			}
+			releaseRing(seq);
+
+			if (!ring->waitFrame(seq, 0.1))
+			{
+				if (!ring->isClosed()) continue;
+				std::cout << "HardwareSensorCameraShm: producer closed " << shm_name << std::endl;
+				boost::unique_lock<boost::mutex> l(mutex_data);
+				setNoMoreData();
+				l.unlock();
+				condition.setAndNotify(1);
+				break;
+			}
+			shm::FrameHeader const *frame = ring->frame(seq);
+			if (!frame) { std::cerr << "HardwareSensorCameraShm: lost image " << seq << std::endl; ++seq; continue; }
+
+			setBufferData(buff_write, (const char*)ring->data(seq), frame->step, ring);
+			bufferSpecPtr[buff_write]->timestamp = frame->timestamp;
+			bufferSpecPtr[buff_write]->arrival = (frame->arrival > 0. ? frame->arrival : kernel::Clock::getTime());
+			slot_seq[buff_write] = seq;
+			++seq;
+
+			boost::unique_lock<boost::mutex> l(mutex_data);
+			last_timestamp = frame->timestamp;
+			incWritePos(true);
+			l.unlock();
+			condition.setAndNotify(1);
+			buff_write = (buff_write+1) % bufferSize;
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
+
+
+	void HardwareSensorCameraShm::init(int mode, std::string dump_path, cv::Size imgSize)
+	{
+		this->mode = mode;
+		HardwareSensorCamera::init(dump_path, imgSize);
+		slot_seq.assign(bufferSize, 0);
+
+		// start save tasks
+		if (mode == 1)
+		{
+			saveTask_thread = new boost::thread(boost::bind(&HardwareSensorCameraShm::saveTask,this));
+			savePushTask_thread = new boost::thread(boost::bind(&HardwareSensorCameraShm::savePushTask,this));
+		}
+	}
+
+	void HardwareSensorCameraShm::start()
+	{
+		// start acquire task
+		if (started) { std::cout << "Warning: This HardwareSensorCameraShm has already been started" << std::endl; return; }
+		started = true;
+		last_timestamp = kernel::Clock::getTime();
+		if (mode == 2)
+			preloadTask_thread = new boost::thread(boost::bind(&HardwareSensorCameraShm::preloadTaskOffline,this));
+		else
+			preloadTask_thread = new boost::thread(boost::bind(&HardwareSensorCameraShm::preloadTask,this));
+	}
+
+
+	HardwareSensorCameraShm::HardwareSensorCameraShm(kernel::VariableCondition<int> &condition, int bufferSize, const std::string &shm_name, cv::Size size, int mode, std::string dump_path):
+		HardwareSensorCamera(condition, bufferSize), shm_name(shm_name), attach_timeout(10.)
+	{
+		init(mode, dump_path, size);
+	}
+
+	HardwareSensorCameraShm::HardwareSensorCameraShm(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path, int bufferSize):
+		HardwareSensorCamera(condition, imgSize, dump_path, bufferSize), attach_timeout(10.), mode(2)
+	{
+		slot_seq.assign(bufferSize, 0);
+	}
+
+
+	HardwareSensorCameraShm::~HardwareSensorCameraShm()
+	{
+		stopPrefetch();
+		stopPreprocessing(); // the images are in the ring
+		// the raws keep the ring, that detaches when the last image that points to it is released
+	}
+
+}}}
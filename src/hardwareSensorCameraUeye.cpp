@@ -102,8 +102,8 @@ namespace hardware {
 	}
 		
 	
-	HardwareSensorCameraUeye::HardwareSensorCameraUeye(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path):
-		HardwareSensorCamera(condition, imgSize, dump_path)
+	HardwareSensorCameraUeye::HardwareSensorCameraUeye(kernel::VariableCondition<int> &condition, cv::Size imgSize, std::string dump_path, int bufferSize):
+		HardwareSensorCamera(condition, imgSize, dump_path, bufferSize), mode(2)
 	{}
 	
 
@@ -190,6 +190,8 @@ namespace hardware {
 
 	HardwareSensorCameraUeye::~HardwareSensorCameraUeye()
 	{
+		stopPrefetch();
+		stopPreprocessing(); // before the images are released with the camera
 #ifdef HAVE_UEYE
 		int r;
 		char *msg;
@@ -14,6 +14,7 @@
 #include "jmath/ublasExtra.hpp"
 #include "rtslam/quatTools.hpp"
 #include "rtslam/pinholeTools.hpp"
+#include "rtslam/datasetContainer.hpp"
 #include "rtslam/hardwareSensorExternalLoc.hpp"
 
 #ifdef HAVE_POSTERLIB
@@ -38,25 +39,47 @@ namespace hardware {
 		jblas::vec datavec;
 
 		std::fstream f;
-		if (mode == 1 || mode == 2)
+		boost::shared_ptr<VectorLogWriter> log_writer;
+		boost::shared_ptr<VectorLogReader> log_reader;
+		if (mode == 2)
 		{
-			std::ostringstream oss; oss << dump_path << "/extloc.log";
-			f.open(oss.str().c_str(), (mode == 1 ? std::ios_base::out : std::ios_base::in));
-			if (mode == 2)
+			if (VectorLogReader::exists(dump_path, "extloc"))
 			{
-				int tmp; f >> tmp; data_type = (ExtLocType)tmp;
-				datavec.resize(ExtLocSizes(data_type)+1);
+				log_reader.reset(new VectorLogReader(dump_path, "extloc"));
+				std::vector<double> const &params = log_reader->info().params;
+				if (params.size() >= 1) data_type = (ExtLocType)(int)params[0];
+			} else
+			{ // text log of older recordings, see demo_dataset_convert
+				std::ostringstream oss; oss << dump_path << "/extloc.log";
+				f.open(oss.str().c_str(), std::ios_base::in);
+				int tmp = elNExtLocType; f >> tmp; data_type = (ExtLocType)tmp;
 			}
+			if (data_type < 0 || data_type >= elNExtLocType)
+			{
+				std::cout << "HardwareSensorExternalLoc: unknown data type in the log, it is ignored" << std::endl;
+				log_reader.reset(); f.close();
+				data_type = elNExtLocType;
+			} else
+				datavec.resize(ExtLocSizes(data_type)+1);
 		}
 
 		while (true)
 		{
 			if (mode == 2)
 			{
-				f >> datavec;
+				bool eof;
+				if (log_reader) eof = !log_reader->read(datavec, reading.arrival);
+				else if (f.is_open()) { f >> datavec; reading.arrival = 0.; eof = !f; }
+				else eof = true;
+				if (!eof && datavec.size() != ExtLocSizes(data_type)+1)
+				{
+					std::cout << "HardwareSensorExternalLoc: reading of size " << datavec.size() << " in the log, ignoring it" << std::endl;
+					datavec.resize(ExtLocSizes(data_type)+1);
+					continue;
+				}
 				boost::unique_lock<boost::mutex> l(mutex_data);
 				if (isFull(true)) cond_offline_full.notify_all();
-				if (f.eof()) { no_more_data = true; cond_offline_full.notify_all(); f.close(); return; }
+				if (eof) { setNoMoreData(); cond_offline_full.notify_all(); condition.setAndNotify(1); if (f.is_open()) f.close(); return; }
 				while (isFull(true)) cond_offline_freed.wait(l);
 				
 			} else
@@ -64,7 +87,7 @@ namespace hardware {
 #ifdef HAVE_POSTERLIB
 				while (true) // wait for new data
 				{
-					usleep(1000);
+					pollDelay(reading.arrival);
 					if (posterIoctl(posterId, FIO_GETDATE, &h2timestamp) != ERROR)
 					{
 						if (h2timestamp.ntick != prev_ntick)
@@ -87,7 +110,7 @@ namespace hardware {
 				{
 					data_type = data.type;
 					datavec.resize(ExtLocSizes(data_type)+1);
-					if (mode == 1) f << data_type << std::endl;
+					if (mode == 1) log_writer.reset(new VectorLogWriter(dump_path, "extloc", datavec.size(), std::vector<double>(1, data_type)));
 				}
 				else if (data_type != data.type)
 				{
@@ -170,14 +193,13 @@ namespace hardware {
 			int buff_write = getWritePos();
 			buffer(buff_write).data = reading.data;
 			buffer(buff_write).data(0) += timestamps_correction;
+			buffer(buff_write).arrival = reading.arrival;
 			last_timestamp = reading.data(0);
 			incWritePos();
+			condition.setAndNotify(1);
 			
 			if (mode == 1)
-			{
-				// we put the maximum precision because we want repeatability with the original run
-				f << std::setprecision(50) << datavec << std::endl;
-			}
+				log_writer->write(datavec, reading.arrival);
 			
 		}
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
@@ -10,6 +10,7 @@
  */
 
 #include "kernel/timingTools.hpp"
+#include "rtslam/datasetContainer.hpp"
 #include "rtslam/hardwareSensorGpsGenom.hpp"
 
 #ifdef HAVE_POSTERLIB
@@ -21,6 +22,10 @@ namespace jafar {
 namespace rtslam {
 namespace hardware {
 
+	namespace {
+		const double max_fix_variance = 100.; // m2, position variance above which there is no real fix
+	}
+
 
 	void HardwareSensorGpsGenom::preloadTask(void)
 	{ try {
@@ -33,20 +38,31 @@ namespace hardware {
 		double *pos; float *var;
 		
 		std::fstream f;
-		if (mode == 1 || mode == 2)
+		boost::shared_ptr<VectorLogWriter> log_writer;
+		boost::shared_ptr<VectorLogReader> log_reader;
+		if (mode == 1)
+			log_writer.reset(new VectorLogWriter(dump_path, "GPS", readingSize()));
+		if (mode == 2)
 		{
-			std::ostringstream oss; oss << dump_path << "/GPS.log";
-			f.open(oss.str().c_str(), (mode == 1 ? std::ios_base::out : std::ios_base::in));
+			if (VectorLogReader::exists(dump_path, "GPS"))
+				log_reader.reset(new VectorLogReader(dump_path, "GPS"));
+			else
+			{ // text log of older recordings, see demo_dataset_convert
+				std::ostringstream oss; oss << dump_path << "/GPS.log";
+				f.open(oss.str().c_str(), std::ios_base::in);
+			}
 		}
 		
 		while (true)
 		{
 			if (mode == 2)
 			{
-				f >> reading.data;
+				bool eof;
+				if (log_reader) eof = !log_reader->read(reading.data, reading.arrival);
+				else { f >> reading.data; reading.arrival = 0.; eof = f.eof(); }
 				boost::unique_lock<boost::mutex> l(mutex_data);
 				if (isFull(true)) cond_offline_full.notify_all();
-				if (f.eof()) { no_more_data = true; cond_offline_full.notify_all(); f.close(); return; }
+				if (eof) { setNoMoreData(); cond_offline_full.notify_all(); condition.setAndNotify(1); if (f.is_open()) f.close(); return; }
 				while (isFull(true)) cond_offline_freed.wait(l);
 				
 			} else
@@ -54,7 +70,7 @@ namespace hardware {
 #ifdef HAVE_POSTERLIB
 				while (true) // wait for new data
 				{
-					usleep(1000);
+					pollDelay(reading.arrival);
 					if (posterIoctl(posterId, FIO_GETDATE, &h2timestamp) != ERROR)
 					{
 						if (h2timestamp.ntick != prev_ntick)
@@ -89,21 +105,24 @@ namespace hardware {
 			int buff_write = getWritePos();
 			buffer(buff_write).data = reading.data;
 			buffer(buff_write).data(0) += timestamps_correction;
+			buffer(buff_write).arrival = reading.arrival;
 			last_timestamp = reading.data(0);
+			// without fix the variances are not positive or not finite
+			if (reading.data(4) > 0. && reading.data(5) > 0. && reading.data(6) > 0. &&
+			    reading.data(4) < max_fix_variance && reading.data(5) < max_fix_variance && reading.data(6) < max_fix_variance)
+				has_fix = true;
 			incWritePos();
+			condition.setAndNotify(1);
 			
 			if (mode == 1)
-			{
-				// we put the maximum precision because we want repeatability with the original run
-				f << std::setprecision(50) << reading.data << std::endl;
-			}
+				log_writer->write(reading.data, reading.arrival);
 			
 		}
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
 	
 	
 	HardwareSensorGpsGenom::HardwareSensorGpsGenom(kernel::VariableCondition<int> &condition, unsigned bufferSize, const std::string machine, int mode, std::string dump_path):
-		HardwareSensorProprioAbstract(condition, bufferSize, false), mode(mode), dump_path(dump_path)
+		HardwareSensorProprioAbstract(condition, bufferSize, false), mode(mode), dump_path(dump_path), has_fix(false)
 	{
 		addQuantity(qPos);
 		//addQuantity(qAbsVel);
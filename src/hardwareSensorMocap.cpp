@@ -10,6 +10,7 @@
  */
 
 #include "kernel/timingTools.hpp"
+#include "rtslam/datasetContainer.hpp"
 #include "rtslam/hardwareSensorMocap.hpp"
 
 
@@ -22,20 +23,31 @@ namespace hardware {
 	{ try {
 
 		std::fstream f;
-		if (mode == 1 || mode == 2)
+		boost::shared_ptr<VectorLogWriter> log_writer;
+		boost::shared_ptr<VectorLogReader> log_reader;
+		if (mode == 1)
+			log_writer.reset(new VectorLogWriter(dump_path, "mocap", readingSize()));
+		if (mode == 2)
 		{
-			std::ostringstream oss; oss << dump_path << "/mocap.log";
-			f.open(oss.str().c_str(), (mode == 1 ? std::ios_base::out : std::ios_base::in));
+			if (VectorLogReader::exists(dump_path, "mocap"))
+				log_reader.reset(new VectorLogReader(dump_path, "mocap"));
+			else
+			{ // text log of older recordings, see demo_dataset_convert
+				std::ostringstream oss; oss << dump_path << "/mocap.log";
+				f.open(oss.str().c_str(), std::ios_base::in);
+			}
 		}
 		
 		while (true)
 		{
 			if (mode == 2)
 			{
-				f >> reading.data;
+				bool eof;
+				if (log_reader) eof = !log_reader->read(reading.data, reading.arrival);
+				else { f >> reading.data; reading.arrival = 0.; eof = f.eof(); }
 				boost::unique_lock<boost::mutex> l(mutex_data);
 				if (isFull(true)) cond_offline_full.notify_all();
-				if (f.eof()) { no_more_data = true; cond_offline_full.notify_all(); f.close(); return; }
+				if (eof) { setNoMoreData(); cond_offline_full.notify_all(); condition.setAndNotify(1); if (f.is_open()) f.close(); return; }
 				while (isFull(true)) cond_offline_freed.wait(l);
 			} else
 			{
@@ -46,14 +58,13 @@ namespace hardware {
 			int buff_write = getWritePos();
 			buffer(buff_write).data = reading.data;
 			buffer(buff_write).data(0) += timestamps_correction;
+			buffer(buff_write).arrival = reading.arrival;
 			last_timestamp = reading.data(0);
 			incWritePos();
+			condition.setAndNotify(1);
 			
 			if (mode == 1)
-			{
-				// we put the maximum precision because we want repeatability with the original run
-				f << std::setprecision(50) << reading.data << std::endl;
-			}
+				log_writer->write(reading.data, reading.arrival);
 			
 		}
 	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
@@ -9,6 +9,7 @@
 #include "rtslam/observationAbstract.hpp"
 #include "jmath/jblas.hpp"
 #include "jmath/ublasExtra.hpp"
+#include "rtslam/trace.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -64,6 +65,7 @@ namespace jafar {
 
 		void ExtendedKalmanFilterIndirect::correct(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl)
 		{
+			RTSLAM_TRACE_SCOPE("ekf correct");
 			// first the kalman gain
 			computeKalmanGain(ia_x, inn, INN_rsl, ia_rsl);
 
@@ -75,6 +77,29 @@ namespace jafar {
 
 
 
+		void ExtendedKalmanFilterIndirect::correctDelayed(const ind_array & ia_x, Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl,
+		                                                  const ind_array & ia_w, const mat & INN_w, const sym_mat & W)
+		{
+			RTSLAM_TRACE_SCOPE("ekf correct delayed");
+			PJt_tmp.resize(ia_x.size(),inn.size(), false);
+			K.resize(ia_x.size(),inn.size(), false);
+			ublas::noalias(PJt_tmp) = prod(project(P_, ia_x, ia_rsl), trans(INN_rsl));
+
+			// correlation between the current state and the noise since the measurement
+			mat WJt = prod(W, trans(INN_w));
+			for(size_t j = 0; j < ia_w.size(); ++j)
+				for(size_t i = 0; i < ia_x.size(); ++i)
+					if (ia_x(i) == ia_w(j)) { ublas::row(PJt_tmp, i) += ublas::row(WJt, j); break; }
+			inn.P() -= prod_JPJt(W, INN_w);
+
+			inn.invertCov();
+			ublas::noalias(K) = - prod(PJt_tmp, inn.iP_);
+
+			ublas::project(x_, ia_x) += prod(K, inn.x());
+			ublas::project(P_, ia_x, ia_x) += prod<sym_mat> (K, trans(PJt_tmp));
+		}
+
+
 		void ExtendedKalmanFilterIndirect::stackCorrection(Innovation & inn, const mat & INN_rsl, const ind_array & ia_rsl)
 		{
 			corrStack.stack.push_back(StackedCorrection(inn, INN_rsl, ia_rsl));
@@ -83,6 +108,7 @@ namespace jafar {
 		
 		void ExtendedKalmanFilterIndirect::correctAllStacked(const ind_array & ia_x)
 		{
+			RTSLAM_TRACE_SCOPE("ekf correct stacked");
 			PJt_tmp.resize(ia_x.size(), corrStack.inn_size, false);
 			stackedInnovation_x.resize(corrStack.inn_size, false);
 			stackedInnovation_P.resize(corrStack.inn_size, false);
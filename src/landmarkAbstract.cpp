@@ -5,6 +5,8 @@
  * \ingroup rtslam
  */
 
+#include <boost/thread/mutex.hpp>
+
 #include "rtslam/landmarkAbstract.hpp"
 #include "rtslam/observationAbstract.hpp"
 #include "rtslam/mapAbstract.hpp"
@@ -18,6 +20,16 @@ namespace jafar {
 
 		IdFactory LandmarkAbstract::landmarkIds = IdFactory();
 
+		namespace {
+			boost::mutex landmarkIds_mutex;
+		}
+
+		void LandmarkAbstract::setId()
+		{
+			boost::unique_lock<boost::mutex> l(landmarkIds_mutex);
+			id(landmarkIds.getId());
+		}
+
 		std::ostream& operator <<(std::ostream & s, LandmarkAbstract const & lmk) {
 			s << "LANDMARK " << lmk.id() << ": of " << lmk.typeName() << endl;
 			s << " .state:  " << lmk.state << endl;
@@ -272,13 +284,6 @@ namespace jafar {
 			return false;
 		}
 #endif
-		void LandmarkAbstract::destroyDisplay()
-		{
-			ObjectAbstract::destroyDisplay();
-			for (ObservationList::iterator obsIter = observationList().begin(); obsIter != observationList().end(); obsIter++)
-				(*obsIter)->destroyDisplay();
-		}
-
 		void LandmarkAbstract::suicide(){
 //			landmark_ptr_t selfPtr = shared_from_this();
 //			mapPtr()->liberateStates(state.ia()); // remove from map
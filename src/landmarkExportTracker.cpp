@@ -0,0 +1,92 @@
+/**
+ * \file landmarkExportTracker.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cmath>
+
+#include "rtslam/landmarkExportTracker.hpp"
+#include "rtslam/exportProtocol.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/landmarkAbstract.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+
+	double LandmarkExportTracker::traceStdev(jblas::sym_mat const &P)
+	{
+		double trace = 0.;
+		for(size_t i = 0; i < P.size1(); ++i) trace += P(i,i);
+		return sqrt(trace);
+	}
+
+
+	void LandmarkExportTracker::update(map_ptr_t mapPtr, std::vector<Change> &changes)
+	{
+		changes.clear();
+		for(EntryMap::iterator it = entries.begin(); it != entries.end(); ++it) it->second.seen = false;
+
+		Change change;
+		for(MapAbstract::MapManagerList::iterator mmIter = mapPtr->mapManagerList().begin();
+		    mmIter != mapPtr->mapManagerList().end(); ++mmIter)
+			for(MapManagerAbstract::LandmarkList::iterator lmkIter = (*mmIter)->landmarkList().begin();
+			    lmkIter != (*mmIter)->landmarkList().end(); ++lmkIter)
+			{
+				LandmarkAbstract &lmk = **lmkIter;
+				lmk.reparametrize(lmk.reparamSize(), change.x, change.P);
+				double stdev = traceStdev(change.P);
+
+				EntryMap::iterator it = entries.find(lmk.id());
+				if (it == entries.end())
+				{
+					change.op = exportproto::opAdd;
+					it = entries.insert(std::make_pair((unsigned)lmk.id(), Entry())).first;
+				} else
+				if (it->second.type != (unsigned)lmk.type)
+					change.op = exportproto::opReparametrize;
+				else
+				{
+					Entry &e = it->second;
+					e.seen = true;
+					double moved = (e.x.size() == change.x.size() ? ublas::norm_inf(change.x - e.x) : pos_threshold+1.);
+					if (moved <= pos_threshold && std::abs(stdev - e.stdev) <= stdev_threshold * e.stdev) continue;
+					change.op = exportproto::opUpdate;
+				}
+
+				Entry &e = it->second;
+				e.type = lmk.type; e.x = change.x; e.P = change.P; e.stdev = stdev; e.seen = true;
+				change.id = lmk.id(); change.type = lmk.type;
+				changes.push_back(change);
+			}
+
+		for(EntryMap::iterator it = entries.begin(); it != entries.end(); )
+		{
+			if (it->second.seen) { ++it; continue; }
+			change.op = exportproto::opDelete;
+			change.id = it->first; change.type = it->second.type;
+			change.x.resize(0); change.P.resize(0,0);
+			changes.push_back(change);
+			entries.erase(it++);
+		}
+	}
+
+
+	void LandmarkExportTracker::keyframe(std::vector<Change> &landmarks)
+	{
+		landmarks.resize(entries.size());
+		std::vector<Change>::iterator lit = landmarks.begin();
+		for(EntryMap::iterator it = entries.begin(); it != entries.end(); ++it, ++lit)
+		{
+			lit->op = exportproto::opAdd;
+			lit->id = it->first;
+			lit->type = it->second.type;
+			lit->x = it->second.x;
+			lit->P = it->second.P;
+		}
+	}
+
+}}
@@ -5,6 +5,11 @@
  * \ingroup rtslam
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
 #include "jmath/indirectArray.hpp"
 #include <boost/shared_ptr.hpp>
 #include "jmath/random.hpp"
@@ -171,14 +176,46 @@ namespace jafar {
 
 		void MapAbstract::writeLogHeader(kernel::DataLogger& log) const
 		{
-			//std::ostringstream oss; oss << "Map";
-			//log.writeComment(oss.str());
-			//log.writeLegend("time");
+			// the text log has one line per log, and cannot hold a row per landmark
 		}
 		
 		void MapAbstract::writeLogData(kernel::DataLogger& log) const
 		{
-			//log.writeData(filterPtr);
+		}
+
+		namespace {
+			const size_t logLmkSize = 11; // the largest landmark state, an anchored homogeneous points line
+		}
+
+		void MapAbstract::writeLogHeader(BinaryLogger& log) const
+		{
+			log.writeComment("Map");
+			std::ostringstream oss; oss << "Landmarks of map " << id() << ", the values after the state size are NaN";
+			log.writeComment(oss.str());
+			log.writeLegend("id", BinaryLogger::UInt32);
+			log.writeLegend("type", BinaryLogger::UInt8);
+			log.writeLegend("size", BinaryLogger::UInt8);
+			for(size_t i = 0; i < logLmkSize; ++i)
+				{ oss.str(""); oss << "x" << i; log.writeLegend(oss.str()); }
+			for(size_t i = 0; i < logLmkSize; ++i)
+				{ oss.str(""); oss << "sig" << i; log.writeLegend(oss.str(), BinaryLogger::Float32); }
+		}
+
+		void MapAbstract::writeLogData(BinaryLogger& log) const
+		{
+			const double nan = std::numeric_limits<double>::quiet_NaN();
+			for (MapManagerList::const_iterator mmIter = mapManagerList().begin(); mmIter != mapManagerList().end(); ++mmIter)
+				for (MapManagerAbstract::LandmarkList::const_iterator lmkIter = (*mmIter)->landmarkList().begin();
+				     lmkIter != (*mmIter)->landmarkList().end(); ++lmkIter)
+				{
+					const Gaussian &lmkState = (*lmkIter)->state;
+					size_t size = std::min(lmkState.size(), logLmkSize);
+					log.writeData((unsigned)(*lmkIter)->id());
+					log.writeData((unsigned)(*lmkIter)->type);
+					log.writeData((unsigned)lmkState.size());
+					for(size_t i = 0; i < logLmkSize; ++i) log.writeData(i < size ? lmkState.x()(i) : nan);
+					for(size_t i = 0; i < logLmkSize; ++i) log.writeData(i < size ? sqrt(lmkState.P()(i,i)) : nan);
+				}
 		}
 
 
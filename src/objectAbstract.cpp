@@ -8,7 +8,6 @@
 #include <iostream>
 
 #include "rtslam/objectAbstract.hpp"
-#include "rtslam/display.hpp"
 
 namespace jafar {
 	namespace rtslam {
@@ -28,17 +27,20 @@ namespace jafar {
 
 		ObjectAbstract::ObjectAbstract() :
 			id_(0), category(OBJECT) {
+			touch();
 		}
-		
-		void ObjectAbstract::destroyDisplay()
-		{
-			for(std::vector<display::DisplayDataAbstract*>::iterator it = displayData.begin(); it != displayData.end(); ++it)
-				{ delete *it; *it = NULL; }
-		}
-		
+
 		ObjectAbstract::~ObjectAbstract() {
-			destroyDisplay();
 		}
+
+		namespace {
+			uint64_t changeClock = 0; ///< shared by the threads of all the maps
+		}
+
+		void ObjectAbstract::touch() {
+			changeStamp_ = __sync_add_and_fetch(&changeClock, 1);
+		}
+		
 		
 
 	}
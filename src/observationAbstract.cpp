@@ -22,6 +22,12 @@ namespace jafar {
 		// OBSERVATION ABSTRACT
 		//////////////////////////
 
+		boost::mutex& ObservationAbstract::descriptorMutex(size_t lmk_id)
+		{
+			static boost::mutex mutexes[16];
+			return mutexes[lmk_id % 16];
+		}
+
 		/*
 		 * Operator << for class ObservationAbstract.
 		 * It shows different information of the observation.
@@ -71,6 +77,7 @@ namespace jafar {
 			clearCounters();
 			clearFlags();
 			searchSize = 0;
+			shown_ = false;
 		}
 
 		ObservationAbstract::ObservationAbstract(const sensor_ptr_t & _senPtr, const landmark_ptr_t & _lmkPtr,
@@ -98,6 +105,7 @@ namespace jafar {
 			clearCounters();
 			clearFlags();
 			searchSize = 0;
+			shown_ = false;
 		}
 
 		ObservationAbstract::~ObservationAbstract() {
@@ -235,6 +243,19 @@ namespace jafar {
 				((bool*)&tasks)[i] = false;
 		}
 
+		void ObservationAbstract::touchIfShown(){
+			bool shown = false;
+			int size = sizeof(Events)/sizeof(bool);
+			for (int i = 0; i < size; ++i)
+				shown |= ((bool*)&events)[i];
+			if (shown || shown_)
+			{
+				touch();
+				landmarkPtr()->touch();
+			}
+			shown_ = shown;
+		}
+
 		void ObservationAbstract::clearCounters(){
 			int size = sizeof(Counters)/sizeof(int);
 			for (int i = 0; i < size; ++i)
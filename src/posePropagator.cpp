@@ -0,0 +1,158 @@
+/**
+ * \file posePropagator.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <boost/bind.hpp>
+
+#include "kernel/jafarMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/posePropagator.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+	PosePropagator::PosePropagator(robot_ptr_t robPtr, boost::shared_ptr<ExporterAbstract> exporter):
+		robPtr(robPtr), exporter(exporter), condition_data(0), anchor_time(-1.), anchor_new(false),
+		valid(false), supported(true), latency_hist(0.0005, 40), npublished(0)
+	{
+		if (!robPtr->hardwareEstimatorPtr)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "PosePropagator: robot " << robPtr->id() << " has no hardware estimator");
+		propagateTask_thread = new boost::thread(boost::bind(&PosePropagator::propagateTask, this));
+		robPtr->hardwareEstimatorPtr->setReadingCallback(boost::bind(&PosePropagator::onReading, this, _1, _2, _3));
+	}
+
+
+	void PosePropagator::onReading(const double *reading, size_t size, double arrival)
+	{
+		Reading r;
+		r.data.resize(size);
+		for(size_t i = 0; i < size; ++i) r.data(i) = reading[i];
+		// the arrival date recorded in a log cannot be used for the latency in replay
+		double now = kernel::Clock::getTime();
+		r.arrival = (arrival > 0. && arrival <= now && now - arrival < 1. ? arrival : now);
+
+		condition_data.lock();
+		if (condition_data.var >= 0) { incoming.push_back(r); condition_data.var++; }
+		condition_data.unlock();
+		condition_data.notify();
+	}
+
+
+	void PosePropagator::anchor()
+	{
+		boost::unique_lock<boost::mutex> l(mutex_data);
+		anchor_x = robPtr->state.x();
+		anchor_time = robPtr->self_time;
+		anchor_new = true;
+	}
+
+
+	void PosePropagator::propagateTask()
+	{ try {
+		std::deque<Reading> readings;
+		jblas::vec x_anchor;
+		double t_anchor = -1.;
+		while (true)
+		{
+			condition_data.wait(boost::lambda::_1 != 0, false);
+			if (condition_data.var < 0) { condition_data.unlock(); break; }
+			readings.swap(incoming);
+			condition_data.var = 0;
+			condition_data.unlock();
+
+			bool reanchored;
+			{
+				boost::unique_lock<boost::mutex> l(mutex_data);
+				reanchored = anchor_new;
+				if (anchor_new) { x_anchor = anchor_x; t_anchor = anchor_time; anchor_new = false; }
+			}
+
+			bool moved = false;
+			for(std::deque<Reading>::iterator it = readings.begin(); it != readings.end(); ++it)
+			{
+				if (!recent.empty() && it->data(0) <= recent.back().data(0)) continue; // already known
+				recent.push_back(*it);
+				if (valid && !reanchored && move(*it)) moved = true;
+			}
+			readings.clear();
+			if (reanchored) { reanchor(x_anchor, t_anchor); moved = valid && last.data(0) > t_anchor; }
+			// only the readings since the anchor are needed, and not too many if the filter is not running yet
+			while (recent.size() > 2 && (recent[1].data(0) <= t_anchor || recent.size() > max_recent)) recent.pop_front();
+
+			if (moved) publish(last);
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
+
+
+	bool PosePropagator::move(Reading const &reading)
+	{
+		if (!supported || reading.data(0) <= last.data(0)) return false;
+		jblas::vec xnew;
+		if (!robPtr->move_mean(x, &last.data(0), &reading.data(0), xnew))
+		{
+			std::cout << "PosePropagator: robot " << robPtr->id() << " of type " << robPtr->typeName() << " cannot propagate its mean alone" << std::endl;
+			supported = valid = false;
+			return false;
+		}
+		x = xnew;
+		last = reading;
+		return true;
+	}
+
+
+	void PosePropagator::reanchor(jblas::vec const &x_anchor, double t_anchor)
+	{
+		x = x_anchor;
+		valid = !recent.empty();
+		if (!valid) return;
+
+		// the readings that were used by the filter are not needed anymore
+		while (recent.size() >= 2 && recent[1].data(0) <= t_anchor) recent.pop_front();
+
+		// start with the command interpolated at the date of the anchor
+		last = recent.front();
+		if (recent.size() >= 2 && last.data(0) < t_anchor)
+		{
+			jblas::vec const &next = recent[1].data;
+			double a = (next(0)-last.data(0) < 1e-6 ? 0. : (t_anchor-last.data(0))/(next(0)-last.data(0)));
+			last.data = (1.-a)*last.data + a*next;
+		}
+		last.data(0) = t_anchor;
+
+		for(std::deque<Reading>::iterator it = recent.begin(); it != recent.end() && valid; ++it)
+			if (it->data(0) > t_anchor) move(*it);
+		valid = valid && supported;
+	}
+
+
+	void PosePropagator::publish(Reading const &reading)
+	{
+		exporter->exportPropagatedState(reading.data(0), x);
+		latency_hist.add(kernel::Clock::getTime() - reading.arrival);
+		++npublished;
+	}
+
+
+	void PosePropagator::stop()
+	{
+		if (!propagateTask_thread) return;
+		robPtr->hardwareEstimatorPtr->setReadingCallback(hardware::HardwareEstimatorAbstract::reading_callback_t());
+		condition_data.setAndNotify(-1);
+		propagateTask_thread->join();
+		delete propagateTask_thread;
+		propagateTask_thread = NULL;
+	}
+
+
+	void PosePropagator::printStatistics(std::ostream &os)
+	{
+		os << "PosePropagator: " << npublished << " propagated states published" << std::endl;
+		latency_hist.print(os, "Reading to publication latency");
+	}
+
+}}
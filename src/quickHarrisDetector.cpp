@@ -98,7 +98,7 @@ namespace jafar {
 #endif
 		}
 
-		bool QuickHarrisDetector::detectIn(const jafar::image::Image & image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi *roiPtr) {
+		bool QuickHarrisDetector::detectIn(const jafar::image::Image & image, feat_img_pnt_ptr_t featPtr, const image::ConvexRoi *roiPtr, const HarrisImage *prepared) {
 			//	JFR_PRED_ERROR( image.colorSpace() == JfrImage_CS_GRAY, FdetectException, FdetectException::INVALID_COLORSPACE,"QuickHarrisDetector::detectIn image must be of the same colorspace and in Greyscale");
 			image::ConvexRoi localRoi;
 
@@ -111,11 +111,17 @@ namespace jafar {
 			int pixBest[2];
 			float scoreBest;
 
+			// the prepared data can only be used if the roi doesn't need the borders of the image
+			if (prepared && (prepared->width != image.width() || prepared->height != image.height() ||
+			    prepared->convolutionSize != m_convolutionSize || localRoi.x() < 0 || localRoi.y() < 0 ||
+			    localRoi.x() + localRoi.w() > image.width() || localRoi.y() + localRoi.h() > image.height()))
+				prepared = 0;
+
 			m_quickData = new HQuickData[localRoi.w() * localRoi.h()]; // processing data structure with integral convolution images
 
-			quickDerivatives(image, localRoi);
+			if (!prepared) quickDerivatives(image, localRoi);
 			bool success =
-			    quickConvolutionWithBestPoint(localRoi, pixBest, scoreBest);
+			    quickConvolutionWithBestPoint(localRoi, pixBest, scoreBest, prepared);
 			// writeHarrisImagesAsPPM(localRoi);
 
 			delete[] m_quickData;
@@ -214,8 +220,70 @@ namespace jafar {
 		}
 
 
+		bool QuickHarrisDetector::prepare(const jafar::image::Image & image, HarrisImage & prepared) const {
+#if GAUSSIAN_MASK_APPROX
+			return false;
+#else
+			if (shift_conv == 0) return false;
+			int width = image.width(), height = image.height(), step = image.step();
+			int win = 2 * shift_conv; // the convolution of detectIn() sums the rows and columns (c-shift_conv, c+shift_conv]
+			if (width <= win || height < 3) return false;
+
+			prepared.width = width;
+			prepared.height = height;
+			prepared.convolutionSize = m_convolutionSize;
+			prepared.conv_xx.resize(width * height);
+			prepared.conv_xy.resize(width * height);
+			prepared.conv_yy.resize(width * height);
+
+			// derivative products of the current row, horizontal sums of the last win rows, and their vertical sums
+			std::vector<int> p_xx(width, 0), p_xy(width, 0), p_yy(width, 0);
+			std::vector<int> h_xx(win * width, 0), h_xy(win * width, 0), h_yy(win * width, 0);
+			std::vector<int> acc_xx(width, 0), acc_xy(width, 0), acc_yy(width, 0);
+
+			for (int i = 1; i < height - 1; i++) {
+				const uchar* pix = image.data() + i * step;
+				for (int j = 1; j < width - 1; j++) {
+					int im_x = pix[j+1] - pix[j-1];
+					int im_y = pix[j+step] - pix[j-step];
+					p_xx[j] = im_x * im_x;
+					p_xy[j] = im_x * im_y;
+					p_yy[j] = im_y * im_y;
+				}
+
+				// the row i-win leaves the vertical window, and is replaced by the row i in the ring
+				int* row_xx = &h_xx[(i % win) * width];
+				int* row_xy = &h_xy[(i % win) * width];
+				int* row_yy = &h_yy[(i % win) * width];
+				int s_xx = 0, s_xy = 0, s_yy = 0;
+				for (int k = 1; k <= win; k++) { s_xx += p_xx[k]; s_xy += p_xy[k]; s_yy += p_yy[k]; }
+				for (int j = shift_conv; j < width - shift_conv; j++) {
+					if (j > shift_conv) {
+						s_xx += p_xx[j+shift_conv] - p_xx[j-shift_conv];
+						s_xy += p_xy[j+shift_conv] - p_xy[j-shift_conv];
+						s_yy += p_yy[j+shift_conv] - p_yy[j-shift_conv];
+					}
+					acc_xx[j] += s_xx - row_xx[j]; row_xx[j] = s_xx;
+					acc_xy[j] += s_xy - row_xy[j]; row_xy[j] = s_xy;
+					acc_yy[j] += s_yy - row_yy[j]; row_yy[j] = s_yy;
+				}
+
+				if (i >= win) {
+					int c = (i - shift_conv) * width;
+					for (int j = shift_conv; j < width - shift_conv; j++) {
+						prepared.conv_xx[c+j] = acc_xx[j];
+						prepared.conv_xy[c+j] = acc_xy[j];
+						prepared.conv_yy[c+j] = acc_yy[j];
+					}
+				}
+			}
+			return true;
+#endif
+		}
+
+
 		bool QuickHarrisDetector::quickConvolutionWithBestPoint(
-		    const image::ConvexRoi & roi, int pixMax[2], float & scoreMax) {
+		    const image::ConvexRoi & roi, int pixMax[2], float & scoreMax, const HarrisImage * prepared) {
 			
 			int shift_derv = 1;
 			int shift_derv_conv = shift_derv + shift_conv;
@@ -246,6 +314,13 @@ namespace jafar {
 			for (ri = riMin; ri < riMax; ri++) {
 
 				int_center = m_quickData + (ri * roi.w()) + rjMin;
+				const int *pre_xx = 0, *pre_xy = 0, *pre_yy = 0;
+				if (prepared) {
+					int offset = (roi.y() + ri) * prepared->width + roi.x() + rjMin;
+					pre_xx = &prepared->conv_xx[offset];
+					pre_xy = &prepared->conv_xy[offset];
+					pre_yy = &prepared->conv_yy[offset];
+				}
 
 #if GAUSSIAN_MASK_APPROX
 				for(int i = 0; i < nConvCoeffs; ++i)
@@ -264,6 +339,11 @@ namespace jafar {
 
 				for (rj = rjMin; rj < rjMax; rj++) {
 
+					if (prepared) {
+						int_center->im_conv_xx = *pre_xx++;
+						int_center->im_conv_xy = *pre_xy++;
+						int_center->im_conv_yy = *pre_yy++;
+					} else {
 #if GAUSSIAN_MASK_APPROX
 					int_center->im_conv_xx = int_center->im_conv_xy = int_center->im_conv_yy = 0.;
 					for(int i = 0; i < nConvCoeffs; ++i)
@@ -292,6 +372,7 @@ namespace jafar {
 					int_center->im_conv_yy = int_downRight->int_yy - int_upRight->int_yy
 					    - int_downLeft->int_yy + int_upLeft->int_yy;
 #endif
+					}
 					
 					// get eigenvalues: EIG/eig = I_xx + I_yy +/- sqrt((Ixx - I_yy)^2 + 4*I_xy^2)
 					sm = int_center->im_conv_xx + int_center->im_conv_yy;
@@ -0,0 +1,117 @@
+/**
+ * \file replayClock.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <iomanip>
+
+#include <boost/bind.hpp>
+
+#include "kernel/jafarException.hpp"
+#include "kernel/timingTools.hpp"
+#include "rtslam/replayClock.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+
+	ReplayClock::ReplayClock(kernel::VariableCondition<int> &condition, double rate):
+		condition(condition), rate(rate), data_start(0.), wall_start(0.), started(false), stopping(false)
+	{
+		wakeTask_thread = new boost::thread(boost::bind(&ReplayClock::wakeTask,this));
+	}
+
+	ReplayClock::~ReplayClock()
+	{
+		boost::unique_lock<boost::mutex> l(mutex_clock);
+		stopping = true;
+		l.unlock();
+		cond_wake.notify_all();
+		wakeTask_thread->join();
+		delete wakeTask_thread;
+	}
+
+	void ReplayClock::start(double data_date)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_clock);
+		if (started) return;
+		data_start = data_date;
+		wall_start = kernel::Clock::getTime();
+		started = true;
+		l.unlock();
+		cond_wake.notify_all();
+	}
+
+	double ReplayClock::now()
+	{
+		boost::unique_lock<boost::mutex> l(mutex_clock);
+		if (!started) return 0.;
+		return data_start + (kernel::Clock::getTime() - wall_start) * rate;
+	}
+
+	void ReplayClock::notifyAt(double data_date)
+	{
+		boost::unique_lock<boost::mutex> l(mutex_clock);
+		if (!wake_dates.insert(data_date).second) return;
+		l.unlock();
+		cond_wake.notify_all();
+	}
+
+	void ReplayClock::wakeTask()
+	{ try {
+		boost::unique_lock<boost::mutex> l(mutex_clock);
+		while (!stopping)
+		{
+			if (!started || wake_dates.empty()) { cond_wake.wait(l); continue; }
+
+			double next = *wake_dates.begin();
+			double wait = wall_start + (next - data_start) / rate - kernel::Clock::getTime();
+			if (wait > 0.)
+			{
+				cond_wake.timed_wait(l, boost::posix_time::microseconds((long)(wait*1e6)+1));
+				continue;
+			}
+
+			// remove all the dates that are reached at once
+			double date = data_start + (kernel::Clock::getTime() - wall_start) * rate;
+			wake_dates.erase(wake_dates.begin(), wake_dates.upper_bound(date));
+			l.unlock();
+			condition.setAndNotify(1);
+			l.lock();
+		}
+	} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
+
+
+	void Histogram::add(double value)
+	{
+		double bin = value / bin_width;
+		size_t i = (bin < 0. ? 0 : (bin >= bins.size()-1 ? bins.size()-1 : (size_t)bin));
+		++bins[i];
+		++count;
+		sum += value;
+		if (count == 1 || value > max_value) max_value = value;
+	}
+
+	void Histogram::print(std::ostream &os, std::string const &name, double unit_factor, std::string const &unit)
+	{
+		os << name << ": " << count << " values, mean " << mean()*unit_factor << " " << unit
+		   << ", max " << max_value*unit_factor << " " << unit << std::endl;
+		if (count == 0) return;
+		// the percentages are printed in fixed notation, the stream of the caller is left as it was
+		std::ios_base::fmtflags flags = os.flags();
+		std::streamsize precision = os.precision();
+		for(size_t i = 0; i < bins.size(); ++i)
+		{
+			if (bins[i] == 0) continue;
+			os << "  [" << std::setw(6) << i*bin_width*unit_factor << " - ";
+			if (i+1 < bins.size()) os << std::setw(6) << (i+1)*bin_width*unit_factor; else os << "   inf";
+			os << "[ " << std::setw(6) << bins[i] << " (" << std::fixed << std::setprecision(1)
+			   << 100.*bins[i]/count << "%)" << std::endl;
+			os.flags(flags); os.precision(precision);
+		}
+	}
+
+}}}
@@ -13,6 +13,7 @@
 #include "jmath/angle.hpp"
 
 #include <boost/shared_ptr.hpp>
+#include <iomanip>
 
 namespace jafar {
 	namespace rtslam {
@@ -129,62 +130,68 @@ namespace jafar {
 		void RobotAbstract::move(double time){
 			bool firstmove = false;
 			if (self_time < 0.) { firstmove = true; self_time = time; }
+			// never move backwards, out-of-sequence data must be processed by the sensor (see RobotStateHistory)
+			if (time < self_time)
+			{
+				JFR_WARNING("RobotAbstract::move: robot " << id() << " not moved back from " << std::setprecision(19) << self_time << " to " << time << std::setprecision(6));
+				return;
+			}
+			if (history.enabled()) history.update(state.x());
 			if (hardwareEstimatorPtr)
 			{
 //firstmove=false;
 				if (firstmove) // compute average past control and allow the robot to init its state with it
 				{
-					jblas::mat_indirect readings = hardwareEstimatorPtr->acquireReadings(0, time);
+					hardware::ReadingSpan readings = hardwareEstimatorPtr->acquireSpan(0, time);
 					self_time = 0.;
 					dt_or_dx = 0.;
-					unsigned nreadings = readings.size1();
-					if (readings(nreadings-1, 0) >= time) nreadings--; // because it could be available offline but not online
+					size_t nreadings = readings.size();
+					if (nreadings && readings[nreadings-1][0] >= time) nreadings--; // because it could be available offline but not online
+					size_t ncommand = readings.width()-1;
 
-					jblas::vec avg_u(readings.size2()-1); avg_u.clear();
+					jblas::vec avg_u(ncommand); avg_u.clear();
 					for(size_t i = 0; i < nreadings; i++)
-						avg_u += ublas::subrange(ublas::matrix_row<mat_indirect>(readings, i),1,readings.size2());
+						for(size_t j = 0; j < ncommand; j++) avg_u(j) += readings[i][j+1];
 					if (nreadings) avg_u /= nreadings;
 
-					jblas::vec var_u(readings.size2()-1); var_u.clear();
-					jblas::vec diff_u(readings.size2()-1);
-					for(size_t i = 0; i < nreadings; i++) {
-						diff_u = ublas::subrange(ublas::matrix_row<mat_indirect>(readings, i),1,readings.size2()) - avg_u;
-						var_u += ublas::element_prod(diff_u, diff_u);
-					}
+					jblas::vec var_u(ncommand); var_u.clear();
+					for(size_t i = 0; i < nreadings; i++)
+						for(size_t j = 0; j < ncommand; j++) var_u(j) += (readings[i][j+1]-avg_u(j))*(readings[i][j+1]-avg_u(j));
 					if (nreadings) var_u /= nreadings;
 
 					init(avg_u, var_u);
 				}
 				else // else just move with the available control
 				{
-					jblas::mat_indirect readings = hardwareEstimatorPtr->acquireReadings(self_time, time);
-// JFR_DEBUG("move from " << std::setprecision(19) << self_time << " to " << time << " with cur_time " << self_time << std::setprecision(6) << " using " << readings.size1() << " readings");
-					jblas::vec u(readings.size2()-1), prev_u(readings.size2()-1), next_u(readings.size2()-1);
-					
+					hardware::ReadingSpan readings = hardwareEstimatorPtr->acquireSpan(self_time, time);
+// JFR_DEBUG("move from " << std::setprecision(19) << self_time << " to " << time << " with cur_time " << self_time << std::setprecision(6) << " using " << readings.size() << " readings");
+					jblas::vec u(readings.width()-1); u.clear();
 					jblas::ind_array instantArray = hardwareEstimatorPtr->instantValues()-1;
 					jblas::ind_array incrementArray = hardwareEstimatorPtr->incrementValues()-1;
-					jblas::vec_indirect u_instant(u, instantArray), prev_u_instant(prev_u, instantArray), next_u_instant(next_u, instantArray);
-					jblas::vec_indirect u_increment(u, incrementArray), prev_u_increment(prev_u, incrementArray), next_u_increment(next_u, incrementArray);
 					
-					double a, cur_time = self_time, after_time, prev_time = readings(0, 0), next_time, average_time;
-					prev_u = ublas::subrange(ublas::matrix_row<mat_indirect>(readings, 0),1,readings.size2());
-				
-					for(size_t i = 0; i < readings.size1(); i++)
+					double a, cur_time = self_time, after_time, prev_time, next_time, average_time;
+					const double *prev_u = (readings.empty() ? NULL : readings[0]), *next_u; // readings (timestamp first), read in place
+					prev_time = (prev_u ? prev_u[0] : 0.);
+					
+					size_t i = 0;
+					for(hardware::ReadingSpan::const_iterator it = readings.begin(); it != readings.end(); ++it, ++i)
 					{
-						next_time = after_time = readings(i, 0);
-						if (after_time > time || i == readings.size1()-1) after_time = time;
+						next_u = *it;
+						next_time = after_time = next_u[0];
+						if (after_time > time || i == readings.size()-1) after_time = time;
 						if (after_time <= cur_time) continue;
 						dt_or_dx = after_time - cur_time;
 						perturbation.set_from_continuous(dt_or_dx);
-						next_u = ublas::subrange(ublas::matrix_row<mat_indirect>(readings, i),1,readings.size2());
 						
 						average_time = (after_time+cur_time)/2; // middle of the integration interval
 						if (next_time-prev_time < 1e-6) a = 0; else a = (average_time-prev_time)/(next_time-prev_time);
-						u_instant = (1-a)*prev_u_instant + a*next_u_instant; // average command for the integration interval
+						for(size_t j = 0; j < instantArray.size(); ++j) // average command for the integration interval
+							u(instantArray(j)) = (1-a)*prev_u[instantArray(j)+1] + a*next_u[instantArray(j)+1];
 						
 						if (next_time-prev_time < 1e-6) a = 0; else a = (after_time-prev_time)/(next_time-prev_time);
-						u_increment = a*next_u_increment;
-//JFR_DEBUG("elementary move between " << std::setprecision(19) << cur_time << " and " << after_time << " (dt " << dt_or_dx << std::setprecision(6) << ") with command " << u << " between " << prev_u << " at " << std::setprecision(19) << prev_time << std::setprecision(6) << " (" << (1-a) << ") and " << next_u << " at " << std::setprecision(19) << next_time << std::setprecision(6) << " (" << a << ")");
+						for(size_t j = 0; j < incrementArray.size(); ++j)
+							u(incrementArray(j)) = a*next_u[incrementArray(j)+1];
+//JFR_DEBUG("elementary move between " << std::setprecision(19) << cur_time << " and " << after_time << " (dt " << dt_or_dx << std::setprecision(6) << ") with command " << u << " at " << std::setprecision(19) << prev_time << std::setprecision(6) << " (" << (1-a) << ") and " << std::setprecision(19) << next_time << std::setprecision(6) << " (" << a << ")");
 						move(u);
 						
 						prev_time = cur_time = next_time;
@@ -200,16 +207,18 @@ namespace jafar {
 				move();
 			}
 			self_time = time;
+			if (history.enabled()) history.push(time, state.x());
 		}
 
 		void RobotAbstract::move_fake(double time){
 			if (self_time < 0.) self_time = 0.;
-			if (hardwareEstimatorPtr) hardwareEstimatorPtr->acquireReadings(self_time, time);
+			if (hardwareEstimatorPtr) hardwareEstimatorPtr->acquireSpan(self_time, time);
 			self_time = time;
 		}
 		
 
-		void RobotAbstract::writeLogHeader(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotAbstract::writeLogHeaderTo(Logger& log) const
 		{
 			std::ostringstream oss; oss << "Robot " << id();
 			log.writeComment(oss.str());
@@ -220,7 +229,8 @@ namespace jafar {
 				{ oss.str(""); oss << "sig" << i; log.writeLegend(oss.str()); }
 		}
 		
-		void RobotAbstract::writeLogData(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotAbstract::writeLogDataTo(Logger& log) const
 		{
 			log.writeData(self_time);
 			for(size_t i = 0; i < state.x().size(); ++i)
@@ -229,6 +239,11 @@ namespace jafar {
 				log.writeData(sqrt(state.P()(i,i)));
 		}
 
+		void RobotAbstract::writeLogHeader(kernel::DataLogger& log) const { writeLogHeaderTo(log); }
+		void RobotAbstract::writeLogData(kernel::DataLogger& log) const { writeLogDataTo(log); }
+		void RobotAbstract::writeLogHeader(BinaryLogger& log) const { writeLogHeaderTo(log); }
+		void RobotAbstract::writeLogData(BinaryLogger& log) const { writeLogDataTo(log); }
+
 
 	}
 }
@@ -159,7 +159,8 @@ namespace jafar {
 		}
 
 
-		void RobotConstantVelocity::writeLogHeader(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotConstantVelocity::writeLogHeaderTo(Logger& log) const
 		{
 			std::ostringstream oss; oss << "Robot " << id();
 			log.writeComment(oss.str());
@@ -178,7 +179,8 @@ namespace jafar {
 			log.writeLegendTokens("sig_vyaw sig_vpitch sig_vroll");
 		}
 		
-		void RobotConstantVelocity::writeLogData(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotConstantVelocity::writeLogDataTo(Logger& log) const
 		{
 			jblas::vec euler_x(3);
 			jblas::sym_mat euler_P(3,3);
@@ -197,6 +199,11 @@ namespace jafar {
 			for(int i = 10; i < 13; ++i) log.writeData(sqrt(state.P()(2-(i-10)+10,2-(i-10)+10)));
 		}
 
+		void RobotConstantVelocity::writeLogHeader(kernel::DataLogger& log) const { writeLogHeaderTo(log); }
+		void RobotConstantVelocity::writeLogData(kernel::DataLogger& log) const { writeLogDataTo(log); }
+		void RobotConstantVelocity::writeLogHeader(BinaryLogger& log) const { writeLogHeaderTo(log); }
+		void RobotConstantVelocity::writeLogData(BinaryLogger& log) const { writeLogDataTo(log); }
+
 
 	}
 }
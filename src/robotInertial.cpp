@@ -259,6 +259,42 @@ namespace jafar {
 			subrange(_XNEW_pert, 3, 7, 3, 6) = prod (QNORM_qnew, QNEW_w) * (1 / _dt);
 		}
 
+
+		/*
+		 * Same equations as move_func() without perturbation and Jacobians, the command being
+		 * the average of the two readings, like RobotAbstract::move does in the middle of the interval.
+		 * Only local variables are used, so that it can run in parallel with move_func().
+		 */
+		bool RobotInertial::move_mean(const vec & _x, const double *prev_reading, const double *next_reading, vec & _xnew) {
+			double dt = next_reading[0] - prev_reading[0];
+
+			vec3 p, v, ab, wb, gv;
+			vec g;
+			vec4 q;
+			splitState(_x, p, q, v, ab, wb, g);
+			if (g_size == 1) { gv = z_axis * g(0); } else { gv = g; }
+
+			vec3 am, wm;
+			for(size_t i = 0; i < 3; ++i)
+			{
+				am(i) = (prev_reading[1+i] + next_reading[1+i]) / 2;
+				wm(i) = (prev_reading[4+i] + next_reading[4+i]) / 2;
+			}
+
+			vec4 qnew = qProd(q, v2q((wm - wb) * dt));
+			vec3 vnew = v + (rotate(qnew, am - ab) + gv) * dt;
+			ublasExtra::normalize(qnew);
+			#if AVGSPEED
+			vec3 pnew = p + (v+vnew)/2 * dt;
+			#else
+			vec3 pnew = p + v * dt;
+			#endif
+
+			_xnew.resize(_x.size());
+			unsplitState(pnew, qnew, vnew, ab, wb, g, _xnew);
+			return true;
+		}
+
 #if 1
 		vec RobotInertial::e_from_g(const vec3 & _g)
 		{
@@ -373,7 +409,8 @@ namespace jafar {
 		}
 		
 		
-		void RobotInertial::writeLogHeader(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotInertial::writeLogHeaderTo(Logger& log) const
 		{
 			std::ostringstream oss; oss << "Robot " << id();
 			log.writeComment(oss.str());
@@ -397,7 +434,8 @@ namespace jafar {
 			log.writeLegendTokens("sig_gx sig_gy sig_gz");
 		}
 		
-		void RobotInertial::writeLogData(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotInertial::writeLogDataTo(Logger& log) const
 		{
 			jblas::vec euler_x(3);
 			jblas::sym_mat euler_P(3,3);
@@ -423,5 +461,10 @@ namespace jafar {
 									else { for(int i = 16; i < 16+g_size; ++i) log.writeData(sqrt(state.P()(i,i))); }
 		}
 
+		void RobotInertial::writeLogHeader(kernel::DataLogger& log) const { writeLogHeaderTo(log); }
+		void RobotInertial::writeLogData(kernel::DataLogger& log) const { writeLogDataTo(log); }
+		void RobotInertial::writeLogHeader(BinaryLogger& log) const { writeLogHeaderTo(log); }
+		void RobotInertial::writeLogData(BinaryLogger& log) const { writeLogDataTo(log); }
+
 	}
 }
@@ -114,6 +114,35 @@ namespace jafar {
 		}
 			
 
+		/*
+		 * Same as move_func() without Jacobians, the increment being the move between the two
+		 * absolute positions (x y z roll pitch yaw) given by the odometry, like in move().
+		 */
+		bool RobotOdometry::move_mean(const vec & _x, const double *prev_reading, const double *next_reading, vec & _xnew) {
+			jblas::vec7 prev_uq, next_uq, uq;
+			jblas::vec3 prev_e, next_e;
+			for(size_t i = 0; i < 3; ++i)
+			{
+				prev_uq(i) = prev_reading[1+i]; prev_e(i) = prev_reading[4+i];
+				next_uq(i) = next_reading[1+i]; next_e(i) = next_reading[4+i];
+			}
+			ublas::subrange(prev_uq, 3, 7) = quaternion::e2q(prev_e);
+			ublas::subrange(next_uq, 3, 7) = quaternion::e2q(next_e);
+			jblas::vec7 prev_uqi = quaternion::invertFrame(prev_uq);
+			uq = quaternion::composeFrames(prev_uqi, next_uq);
+
+			vec3 p, dx, dv;
+			vec4 q;
+			splitState(_x, p, q);
+			dx = ublas::subrange(uq, 0, 3);
+			dv = quaternion::q2e(ublas::subrange(uq, 3, 7));
+
+			_xnew.resize(_x.size());
+			unsplitState(quaternion::eucFromFrame(_x, dx), quaternion::qProd(q, quaternion::v2q(dv)), _xnew);
+			return true;
+		}
+
+
 		/*
 		 FIXME
 		 There should be no need of this function, RobotAbstract::move(double time)
@@ -196,7 +225,8 @@ namespace jafar {
 			unsplitState(p, q, _xnew); //FIXME temporary solution to copy the initial state
 		}
 		
-		void RobotOdometry::writeLogHeader(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotOdometry::writeLogHeaderTo(Logger& log) const
 		{
 			std::ostringstream oss; oss << "Robot " << id();
 			log.writeComment(oss.str());
@@ -213,7 +243,8 @@ namespace jafar {
 
 		}
 		
-		void RobotOdometry::writeLogData(kernel::DataLogger& log) const
+		template<class Logger>
+		void RobotOdometry::writeLogDataTo(Logger& log) const
 		{
 			jblas::vec euler_x(3);
 			jblas::sym_mat euler_P(3,3);
@@ -227,5 +258,10 @@ namespace jafar {
 			for(int i = 0 ; i < 7 ; ++i) log.writeData(sqrt(state.P()(i,i)));
 			for(int i = 0 ; i < 3 ; ++i) log.writeData(sqrt(euler_P(2-i,2-i)));
 		}
+
+		void RobotOdometry::writeLogHeader(kernel::DataLogger& log) const { writeLogHeaderTo(log); }
+		void RobotOdometry::writeLogData(kernel::DataLogger& log) const { writeLogDataTo(log); }
+		void RobotOdometry::writeLogHeader(BinaryLogger& log) const { writeLogHeaderTo(log); }
+		void RobotOdometry::writeLogData(BinaryLogger& log) const { writeLogDataTo(log); }
 	}
 }
@@ -0,0 +1,94 @@
+/**
+ * \file robotStateHistory.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include "jmath/ublasExtra.hpp"
+
+#include "rtslam/robotStateHistory.hpp"
+
+namespace jafar {
+	namespace rtslam {
+		using namespace jblas;
+
+
+		void RobotStateHistory::accumulate(const mat & F, const sym_mat & Q)
+		{
+			if (F_acc.size1() != F.size1())
+			{
+				F_acc = identity_mat(F.size1());
+				Q_acc = zero_mat(F.size1());
+			}
+			F_acc = ublas::prod(F, F_acc);
+			Q_acc = jmath::ublasExtra::prod_JPJt(Q_acc, F) + Q;
+		}
+
+		void RobotStateHistory::update(const vec & x)
+		{
+			if (!snapshots.empty()) snapshots.back().x = x;
+		}
+
+		void RobotStateHistory::push(double time, const vec & x)
+		{
+			Snapshot snap;
+			snap.time = time;
+			snap.x = x;
+			if (F_acc.size1() != x.size())
+			{
+				snap.F = identity_mat(x.size());
+				snap.Q = zero_mat(x.size());
+			} else
+			{
+				snap.F = F_acc;
+				snap.Q = Q_acc;
+			}
+			snapshots.push_back(snap);
+			F_acc = identity_mat(x.size());
+			Q_acc = zero_mat(x.size());
+
+			// keep one snapshot before the window to cover it completely
+			while (snapshots.size() > 2 && snapshots[1].time <= time - window)
+				snapshots.pop_front();
+		}
+
+		bool RobotStateHistory::retrodict(double t, const vec & x_now, vec & x_t, mat & X_x, sym_mat & W)
+		{
+			if (snapshots.size() < 2 || t < snapshots.front().time || t >= snapshots.back().time) return false;
+
+			// last snapshot before t
+			size_t i = snapshots.size()-2;
+			while (snapshots[i].time > t) --i;
+			Snapshot const & s0 = snapshots[i];
+			Snapshot const & s1 = snapshots[i+1];
+
+			double a = (s1.time > s0.time ? (t - s0.time) / (s1.time - s0.time) : 0.);
+
+			// transition from t to now: the part of the step s0->s1 after t, as the mean is
+			// interpolated linearly (exact when the Jacobian and the noise are linear in dt,
+			// as for a constant velocity), and then the following steps
+			size_t n = x_now.size();
+			mat PHI = identity_mat(n) + (1.-a) * (s1.F - identity_mat(n));
+			W = (1.-a) * s1.Q;
+			for(size_t j = i+2; j < snapshots.size(); ++j)
+			{
+				PHI = ublas::prod(snapshots[j].F, PHI);
+				W = jmath::ublasExtra::prod_JPJt(W, snapshots[j].F) + snapshots[j].Q;
+			}
+			X_x.resize(n, n, false);
+			jmath::ublasExtra::lu_inv(PHI, X_x);
+
+			// interpolate the mean between the two snapshots, and bring back the corrections made since the last one
+			x_t = (1.-a)*s0.x + a*s1.x + ublas::prod(X_x, x_now - snapshots.back().x);
+			// robot states start with the pose (position, quaternion)
+			if (x_t.size() >= 7)
+			{
+				ublas::vector_range<vec> q(x_t, ublas::range(3, 7));
+				q /= ublas::norm_2(q);
+			}
+			return true;
+		}
+
+	}
+}
@@ -8,6 +8,6 @@
 namespace jafar {
 namespace rtslam {
 
-	unsigned int rand_state = 0;
+	__thread unsigned int rand_state = 0;
 	
 }}
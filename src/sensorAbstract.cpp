@@ -7,11 +7,18 @@
 
 #include "boost/assign/std/vector.hpp"
 #include "boost/shared_ptr.hpp"
+#include "boost/bind.hpp"
+#include "boost/thread.hpp"
+#include "kernel/jafarMacro.hpp"
 #include "jmath/indirectArray.hpp"
 #include "rtslam/sensorAbstract.hpp"
 #include "rtslam/robotAbstract.hpp"
 #include "rtslam/observationAbstract.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/rtslamException.hpp"
 #include "rtslam/quatTools.hpp"
+#include "rtslam/trace.hpp"
 
 #include "jmath/angle.hpp"
 #include <vector>
@@ -131,7 +138,7 @@ namespace jafar {
 		void SensorExteroAbstract::process(unsigned id)
 		{
 			// get data
-			hardwareSensorPtr->getRaw(id, rawPtr);
+			{ RTSLAM_TRACE_SCOPE("get raw"); hardwareSensorPtr->getRaw(id, rawPtr); }
 			rawCounter++;
 			
 			// observe
@@ -142,9 +149,89 @@ namespace jafar {
 				dmaPtr->mapManagerPtr()->manage();
 				dmaPtr->detectNew(rawPtr);
 			}
+			touchObservations();
 			
 			//hardwareSensorPtr->release();
 		}
+		
+		void SensorExteroAbstract::touchObservations()
+		{
+			for (DataManagerList::iterator dmaIter = dataManagerList().begin(); dmaIter != dataManagerList().end(); ++dmaIter)
+				for (DataManagerAbstract::ObservationList::iterator obsIter = (*dmaIter)->observationList().begin(); obsIter != (*dmaIter)->observationList().end(); ++obsIter)
+					(*obsIter)->touchIfShown();
+		}
+		
+		void SensorExteroAbstract::matchKnownGrouped(std::vector<unsigned> const &seeds)
+		{ try {
+			RTSLAM_TRACE_SCOPE("grouped match");
+			std::vector<unsigned>::const_iterator seed = seeds.begin();
+			for (DataManagerList::iterator dmaIter = dataManagerList().begin(); dmaIter != dataManagerList().end(); ++dmaIter)
+				if ((*dmaIter)->supportsGroupedUpdate()) (*dmaIter)->matchKnown(rawPtr, *(seed++));
+		} catch (kernel::Exception &e) { std::cout << e.what(); throw e; } }
+		
+		void SensorExteroAbstract::matchGroupedTask(std::vector<unsigned> const &seeds, boost::shared_ptr<kernel::Exception> &error)
+		{
+			RTSLAM_TRACE_THREAD("grouped match");
+			// an exception must not leave the thread, it is thrown again by processGroup
+			try { matchKnownGrouped(seeds); }
+			catch (kernel::Exception &e) { error.reset(new kernel::Exception(e)); }
+		}
+		
+		void SensorExteroAbstract::processGroup(std::vector<sensor_ptr_t> const &sensors, std::vector<unsigned> const &ids)
+		{
+			// get data
+			std::vector<SensorExteroAbstract*> group;
+			std::vector<std::vector<unsigned> > seeds(sensors.size());
+			for (size_t i = 0; i < sensors.size(); ++i)
+			{
+				SensorExteroAbstract *sen = dynamic_cast<SensorExteroAbstract*>(sensors[i].get());
+				if (!sen || (i > 0 && sen->robotPtr() != group[0]->robotPtr()))
+					JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "SensorExteroAbstract::processGroup: sensor " << sensors[i]->id() << " is not an exteroceptive sensor of the same robot");
+				sen->hardwareSensorPtr->getRaw(ids[i], sen->rawPtr);
+				sen->rawCounter++;
+				group.push_back(sen);
+				// the random draws must not depend on the scheduling of the threads
+				for (DataManagerList::iterator dmaIter = sen->dataManagerList().begin(); dmaIter != sen->dataManagerList().end(); ++dmaIter)
+					if ((*dmaIter)->supportsGroupedUpdate()) seeds[i].push_back(rtslam::rand());
+			}
+			
+			// match in parallel against the same state
+			boost::thread_group threads;
+			std::vector<boost::shared_ptr<kernel::Exception> > errors(group.size());
+			for (size_t i = 1; i < group.size(); ++i)
+				threads.create_thread(boost::bind(&SensorExteroAbstract::matchGroupedTask, group[i], boost::cref(seeds[i]), boost::ref(errors[i])));
+			try { if (!group.empty()) group[0]->matchKnownGrouped(seeds[0]); }
+			catch (...) { threads.join_all(); throw; }
+			threads.join_all();
+			for (size_t i = 1; i < group.size(); ++i)
+				if (errors[i]) throw *errors[i];
+			
+			// correct with all the inliers at once
+			map_ptr_t mapPtr = group[0]->robotPtr()->mapPtr();
+			unsigned nstacked = 0;
+			for (size_t i = 0; i < group.size(); ++i)
+				for (DataManagerList::iterator dmaIter = group[i]->dataManagerList().begin(); dmaIter != group[i]->dataManagerList().end(); ++dmaIter)
+					if ((*dmaIter)->supportsGroupedUpdate()) nstacked += (*dmaIter)->stackKnown();
+			if (nstacked > 0) mapPtr->filterPtr->correctAllStacked(mapPtr->ia_used_states());
+			
+			// then the rest sequentially
+			for (size_t i = 0; i < group.size(); ++i)
+				for (DataManagerList::iterator dmaIter = group[i]->dataManagerList().begin(); dmaIter != group[i]->dataManagerList().end(); ++dmaIter)
+				{
+					data_manager_ptr_t dmaPtr = *dmaIter;
+					if (dmaPtr->supportsGroupedUpdate()) dmaPtr->finishKnown(nstacked > 0);
+					                                else dmaPtr->processKnown(group[i]->rawPtr);
+				}
+			for (size_t i = 0; i < group.size(); ++i)
+				for (DataManagerList::iterator dmaIter = group[i]->dataManagerList().begin(); dmaIter != group[i]->dataManagerList().end(); ++dmaIter)
+				{
+					data_manager_ptr_t dmaPtr = *dmaIter;
+					dmaPtr->mapManagerPtr()->manage();
+					dmaPtr->detectNew(group[i]->rawPtr);
+				}
+			for (size_t i = 0; i < group.size(); ++i)
+				group[i]->touchObservations();
+		}
 
 
 	}
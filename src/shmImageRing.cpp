@@ -0,0 +1,243 @@
+/**
+ * \file shmImageRing.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "kernel/jafarMacro.hpp"
+
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/shmImageRing.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+	namespace {
+		size_t align(size_t n) { return (n + shm::alignment-1) / shm::alignment * shm::alignment; }
+	}
+
+
+	shm_image_ring_ptr_t ShmImageRing::create(std::string const &name, unsigned nslots, unsigned width, unsigned height, unsigned depth, unsigned channels)
+	{
+		if (nslots < 2) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: at least 2 slots are needed");
+		unsigned step = align(width * channels * ((depth+7)/8));
+		size_t data_offset = align(sizeof(shm::FrameHeader));
+		size_t data_size = step * height;
+		size_t slot_stride = align(data_offset + data_size);
+		size_t map_size = sizeof(shm::RingHeader) + nslots * slot_stride;
+
+		shm_unlink(name.c_str()); // a consumer still attached to an old segment keeps it until it reopens
+		int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+		if (fd < 0) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: cannot create " << name << ": " << strerror(errno));
+		if (ftruncate(fd, map_size) != 0)
+			{ ::close(fd); JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: cannot resize " << name << ": " << strerror(errno)); }
+		void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+			{ ::close(fd); JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: cannot map " << name << ": " << strerror(errno)); }
+
+		shm::RingHeader *header = static_cast<shm::RingHeader*>(map);
+		memset(header, 0, sizeof(shm::RingHeader));
+		header->version = shm::version;
+		header->nslots = nslots;
+		header->slot_stride = slot_stride;
+		header->data_offset = data_offset;
+		header->data_size = data_size;
+
+		pthread_mutexattr_t mattr;
+		pthread_mutexattr_init(&mattr);
+		pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+		pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST); // the other process may die while holding it
+		pthread_mutex_init(&header->mutex, &mattr);
+		pthread_mutexattr_destroy(&mattr);
+		pthread_condattr_t cattr;
+		pthread_condattr_init(&cattr);
+		pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+		pthread_cond_init(&header->cond, &cattr);
+		pthread_condattr_destroy(&cattr);
+
+		shm_image_ring_ptr_t ring(new ShmImageRing(name, fd, map_size, header, true));
+		for(unsigned i = 0; i < nslots; ++i)
+		{
+			shm::FrameHeader *frame = reinterpret_cast<shm::FrameHeader*>(ring->slot(i));
+			memset(frame, 0, sizeof(shm::FrameHeader));
+			frame->seq = (uint64_t)-1;
+			frame->width = width; frame->height = height;
+			frame->depth = depth; frame->channels = channels;
+			frame->step = step;
+			frame->size = data_size;
+		}
+		__sync_synchronize();
+		header->magic = shm::magic;
+		return ring;
+	}
+
+
+	shm_image_ring_ptr_t ShmImageRing::open(std::string const &name)
+	{
+		int fd = shm_open(name.c_str(), O_RDWR, 0);
+		if (fd < 0) return shm_image_ring_ptr_t();
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm::RingHeader)) { ::close(fd); return shm_image_ring_ptr_t(); }
+		size_t map_size = st.st_size;
+		void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) { ::close(fd); return shm_image_ring_ptr_t(); }
+
+		shm::RingHeader *header = static_cast<shm::RingHeader*>(map);
+		shm_image_ring_ptr_t ring(new ShmImageRing(name, fd, map_size, header, false));
+		if (header->magic != shm::magic) return shm_image_ring_ptr_t(); // not initialized yet
+		__sync_synchronize();
+		if (header->version != shm::version)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: " << name << " has version " << header->version << " instead of " << shm::version);
+		if (map_size < sizeof(shm::RingHeader) + header->nslots * header->slot_stride)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmImageRing: " << name << " is truncated");
+		return ring;
+	}
+
+
+	ShmImageRing::~ShmImageRing()
+	{
+		if (header->magic == shm::magic)
+		{
+			if (producer) close(); else detach();
+		}
+		munmap(header, map_size);
+		::close(fd);
+		if (producer) shm_unlink(name.c_str());
+	}
+
+
+	void ShmImageRing::lock()
+	{
+		if (pthread_mutex_lock(&header->mutex) == EOWNERDEAD)
+			pthread_mutex_consistent(&header->mutex); // the sequence numbers are only modified by single writes
+	}
+
+
+	bool ShmImageRing::isFull(bool locked)
+	{
+		if (!locked) lock();
+		bool full = (header->consumer_pid != 0 && header->write_seq - header->read_seq >= header->nslots);
+		if (full && kill(header->consumer_pid, 0) != 0 && errno == ESRCH)
+		{
+			header->consumer_pid = 0; // the consumer died without detaching
+			full = false;
+		}
+		if (!locked) unlock();
+		return full;
+	}
+
+
+	unsigned char* ShmImageRing::beginWrite()
+	{
+		lock();
+		uint64_t seq = header->write_seq;
+		bool full = isFull(true);
+		if (full) header->dropped++;
+		unlock();
+		return (full ? NULL : slot(seq) + header->data_offset);
+	}
+
+
+	void ShmImageRing::commitWrite(double timestamp, double arrival)
+	{
+		shm::FrameHeader *frame = reinterpret_cast<shm::FrameHeader*>(slot(header->write_seq));
+		frame->timestamp = timestamp;
+		frame->arrival = arrival;
+		frame->seq = header->write_seq;
+		lock(); // also the memory barrier that makes the frame visible before write_seq
+		header->write_seq++;
+		unlock();
+		pthread_cond_broadcast(&header->cond);
+	}
+
+
+	bool ShmImageRing::write(const unsigned char *data, unsigned step, double timestamp, double arrival)
+	{
+		unsigned char *dst = beginWrite();
+		if (!dst) return false;
+		shm::FrameHeader const &f = format();
+		unsigned row = std::min(step, f.width * f.channels * ((f.depth+7)/8));
+		for(unsigned y = 0; y < f.height; ++y)
+			memcpy(dst + y*f.step, data + y*step, row);
+		commitWrite(timestamp, arrival);
+		return true;
+	}
+
+
+	void ShmImageRing::close()
+	{
+		lock();
+		header->closed = 1;
+		unlock();
+		pthread_cond_broadcast(&header->cond);
+	}
+
+
+	uint64_t ShmImageRing::attach()
+	{
+		lock();
+		header->consumer_pid = getpid();
+		header->read_seq = header->write_seq;
+		uint64_t seq = header->write_seq;
+		unlock();
+		return seq;
+	}
+
+
+	void ShmImageRing::detach()
+	{
+		lock();
+		if (header->consumer_pid == getpid()) header->consumer_pid = 0;
+		unlock();
+	}
+
+
+	bool ShmImageRing::waitFrame(uint64_t seq, double timeout)
+	{
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		long nsec = deadline.tv_nsec + (long)((timeout - (long)timeout) * 1e9);
+		deadline.tv_sec += (long)timeout + nsec / 1000000000;
+		deadline.tv_nsec = nsec % 1000000000;
+
+		lock();
+		int r = 0;
+		while (header->write_seq <= seq && !header->closed && r != ETIMEDOUT)
+		{
+			r = pthread_cond_timedwait(&header->cond, &header->mutex, &deadline);
+			if (r == EOWNERDEAD) pthread_mutex_consistent(&header->mutex);
+		}
+		bool available = (header->write_seq > seq);
+		unlock();
+		return available;
+	}
+
+
+	shm::FrameHeader const * ShmImageRing::frame(uint64_t seq)
+	{
+		shm::FrameHeader const *f = reinterpret_cast<shm::FrameHeader*>(slot(seq));
+		return (f->seq == seq ? f : NULL);
+	}
+
+
+	void ShmImageRing::releaseUntil(uint64_t seq)
+	{
+		lock();
+		if (seq > header->read_seq) header->read_seq = seq;
+		unlock();
+	}
+
+}}}
@@ -0,0 +1,155 @@
+/**
+ * \file shmPose.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "kernel/jafarMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/shmPose.hpp"
+
+namespace jafar {
+namespace rtslam {
+
+
+	shm_pose_writer_ptr_t ShmPoseWriter::create(std::string const &name, unsigned state_size)
+	{
+		if (state_size > shmpose::maxStateSize)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseWriter: state size " << state_size << " larger than " << shmpose::maxStateSize);
+		shm_unlink(name.c_str()); // a reader still using an old segment keeps it until it reopens
+		int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if (fd < 0) JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseWriter: cannot create " << name << ": " << strerror(errno));
+		if (ftruncate(fd, sizeof(shmpose::Segment)) != 0)
+			{ ::close(fd); JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseWriter: cannot resize " << name << ": " << strerror(errno)); }
+		void *map = mmap(NULL, sizeof(shmpose::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED)
+			{ ::close(fd); JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseWriter: cannot map " << name << ": " << strerror(errno)); }
+
+		shmpose::Segment *segment = static_cast<shmpose::Segment*>(map);
+		memset(segment, 0, sizeof(shmpose::Segment));
+		segment->version = shmpose::version;
+		segment->state_size = state_size;
+		__sync_synchronize();
+		segment->magic = shmpose::magic;
+		return shm_pose_writer_ptr_t(new ShmPoseWriter(name, fd, segment));
+	}
+
+
+	ShmPoseWriter::~ShmPoseWriter()
+	{
+		close();
+		munmap(segment, sizeof(shmpose::Segment));
+		::close(fd);
+		shm_unlink(name.c_str());
+	}
+
+
+	void ShmPoseWriter::write(uint32_t type, uint32_t robot, double time, double export_date, jblas::vec const &x, jblas::sym_mat const *P)
+	{
+		unsigned n = segment->state_size;
+		segment->seq++; // odd: being written
+		__sync_synchronize();
+		segment->type = type;
+		segment->robot = robot;
+		segment->time = time;
+		segment->export_date = export_date;
+		for(unsigned i = 0; i < n; ++i) segment->x[i] = x(i);
+		if (P)
+		{
+			double *p = segment->P;
+			for(unsigned i = 0; i < n; ++i)
+				for(unsigned j = i; j < n; ++j)
+					*(p++) = (*P)(i,j);
+		}
+		__sync_synchronize();
+		segment->seq++; // even: consistent
+	}
+
+
+	void ShmPoseWriter::close()
+	{
+		segment->closed = 1;
+		__sync_synchronize();
+	}
+
+
+	shm_pose_reader_ptr_t ShmPoseReader::open(std::string const &name)
+	{
+		int fd = shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0) return shm_pose_reader_ptr_t();
+		struct stat st;
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shmpose::Segment)) { ::close(fd); return shm_pose_reader_ptr_t(); }
+		void *map = mmap(NULL, sizeof(shmpose::Segment), PROT_READ, MAP_SHARED, fd, 0);
+		if (map == MAP_FAILED) { ::close(fd); return shm_pose_reader_ptr_t(); }
+
+		const shmpose::Segment *segment = static_cast<const shmpose::Segment*>(map);
+		shm_pose_reader_ptr_t reader(new ShmPoseReader(fd, segment));
+		if (segment->magic != shmpose::magic) return shm_pose_reader_ptr_t(); // not initialized yet
+		__sync_synchronize();
+		if (segment->version != shmpose::version)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseReader: " << name << " has version " << segment->version << " instead of " << shmpose::version);
+		if (segment->state_size > shmpose::maxStateSize)
+			JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "ShmPoseReader: " << name << " has state size " << segment->state_size << " larger than " << shmpose::maxStateSize);
+		return reader;
+	}
+
+
+	ShmPoseReader::~ShmPoseReader()
+	{
+		munmap(const_cast<shmpose::Segment*>(segment), sizeof(shmpose::Segment));
+		::close(fd);
+	}
+
+
+	bool ShmPoseReader::read(ShmPose &pose, unsigned max_retries)
+	{
+		// checked by open, but the segment is written by another process
+		unsigned n = std::min<unsigned>(segment->state_size, shmpose::maxStateSize);
+		for(unsigned retry = 0; retry <= max_retries; ++retry)
+		{
+			__sync_synchronize(); // load seq again at each try, the writer is in another process
+			uint64_t seq = segment->seq;
+			if (seq == 0) return false;
+			if (seq & 1) continue; // being written, it won't be long unless the writer died meanwhile
+			__sync_synchronize();
+			pose.type = segment->type;
+			pose.robot = segment->robot;
+			pose.time = segment->time;
+			pose.export_date = segment->export_date;
+			pose.state_size = n;
+			memcpy(pose.x, segment->x, n*sizeof(double));
+			memcpy(pose.P, segment->P, n*(n+1)/2*sizeof(double));
+			__sync_synchronize();
+			if (segment->seq == seq) { pose.count = seq / 2; return true; }
+		}
+		return false;
+	}
+
+
+	bool ShmPoseReader::waitNew(uint64_t count, ShmPose &pose, double timeout, double poll_period)
+	{
+		double deadline = kernel::Clock::getTime() + timeout;
+		struct timespec period = { 0, (long)(poll_period*1e9) };
+		while (true)
+		{
+			__sync_synchronize(); // load seq and closed again after each sleep
+			if (segment->seq / 2 > count && read(pose)) return true;
+			if (segment->closed || kernel::Clock::getTime() >= deadline) return false;
+			nanosleep(&period, NULL);
+		}
+	}
+
+}}
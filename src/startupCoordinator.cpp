@@ -0,0 +1,55 @@
+/**
+ * \file startupCoordinator.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <algorithm>
+
+#include "kernel/timingTools.hpp"
+#include "rtslam/startupCoordinator.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace hardware {
+
+
+	void StartupCoordinator::add(std::string const &name, wait_func_t wait, double timeout)
+	{
+		Source source;
+		source.name = name;
+		source.wait = wait;
+		source.timeout = timeout;
+		source.ready = false;
+		source.delay = 0.;
+		sources.push_back(source);
+	}
+
+
+	bool StartupCoordinator::wait()
+	{
+		// waiting for them in turn with deadlines from the same start is the same as waiting
+		// for all of them together, except that a source is only checked after the previous ones
+		double start = kernel::Clock::getTime();
+		bool all_ready = true;
+		for(std::vector<Source>::iterator it = sources.begin(); it != sources.end(); ++it)
+		{
+			it->ready = it->wait(std::max(0., it->timeout - (kernel::Clock::getTime() - start)));
+			it->delay = kernel::Clock::getTime() - start;
+			all_ready = all_ready && it->ready;
+		}
+		return all_ready;
+	}
+
+
+	void StartupCoordinator::printReport(std::ostream &os)
+	{
+		for(std::vector<Source>::iterator it = sources.begin(); it != sources.end(); ++it)
+		{
+			os << "  " << it->name << (it->ready ? ": ready after " : ": NOT ready after ")
+			   << (int)(it->delay*1000. + 0.5) << " ms" << std::endl;
+		}
+	}
+
+}}}
@@ -0,0 +1,193 @@
+/**
+ * \file trace.cpp
+ * \date 17/10/2026
+ * \author agent
+ * \ingroup rtslam
+ */
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include "rtslam/trace.hpp"
+
+namespace jafar {
+namespace rtslam {
+namespace trace {
+
+	volatile bool recording = false;
+
+	namespace {
+
+		struct Event { const char *name; int64_t start, duration; };
+
+		const size_t chunkSize = 4096;
+
+		/**
+		The events of one thread, in chunks allocated when needed so that the
+		threads that record little use little memory. Only the thread appends,
+		and the events below n are not modified anymore, so that they can be
+		written while the thread records.
+		*/
+		struct ThreadBuffer
+		{
+			unsigned tid;
+			std::string name;
+			bool free; ///< its thread ended, another one can use it
+			size_t capacity;
+			std::vector<Event*> chunks;
+			volatile size_t n;
+			size_t ndropped;
+
+			ThreadBuffer(unsigned tid, size_t capacity): tid(tid), free(false), n(0), ndropped(0) { setCapacity(capacity); }
+			~ThreadBuffer() { setCapacity(0); }
+			void setCapacity(size_t capacity_)
+			{
+				capacity = capacity_;
+				size_t nchunks = (capacity + chunkSize-1) / chunkSize;
+				for(size_t i = nchunks; i < chunks.size(); ++i) delete[] chunks[i];
+				chunks.resize(nchunks, NULL);
+			}
+			Event& at(size_t i) { return chunks[i / chunkSize][i % chunkSize]; }
+		};
+
+		boost::mutex buffersMutex;
+		std::vector<ThreadBuffer*> buffers;
+		size_t bufferCapacity = 1000000;
+		struct timespec origin;
+
+		__thread ThreadBuffer *threadBuffer = NULL;
+
+		/// gives the buffer back when its thread ends, so that the short threads do not add a buffer each
+		void releaseBuffer(ThreadBuffer *buffer)
+		{
+			boost::unique_lock<boost::mutex> l(buffersMutex);
+			buffer->free = true;
+		}
+		boost::thread_specific_ptr<ThreadBuffer> bufferReleaser(&releaseBuffer);
+
+		ThreadBuffer* acquireBuffer(std::string const &name)
+		{
+			boost::unique_lock<boost::mutex> l(buffersMutex);
+			ThreadBuffer *buffer = NULL;
+			for(size_t i = 0; i < buffers.size() && !buffer; ++i)
+				if (buffers[i]->free && buffers[i]->name == name) buffer = buffers[i];
+			if (!buffer)
+			{
+				buffer = new ThreadBuffer(buffers.size(), bufferCapacity);
+				buffer->name = name;
+				buffers.push_back(buffer);
+			}
+			buffer->free = false;
+			l.unlock();
+			threadBuffer = buffer;
+			bufferReleaser.reset(buffer);
+			return buffer;
+		}
+
+		void writeString(std::ostream &f, std::string const &s)
+		{
+			f << '"';
+			for(size_t i = 0; i < s.size(); ++i)
+			{
+				if (s[i] == '"' || s[i] == '\\') f << '\\';
+				f << s[i];
+			}
+			f << '"';
+		}
+	}
+
+
+	void start(size_t capacity)
+	{
+		boost::unique_lock<boost::mutex> l(buffersMutex);
+		bufferCapacity = capacity;
+		for(size_t i = 0; i < buffers.size(); ++i)
+			{ buffers[i]->n = 0; buffers[i]->ndropped = 0; buffers[i]->setCapacity(capacity); }
+		clock_gettime(CLOCK_MONOTONIC, &origin);
+		__sync_synchronize();
+		recording = true;
+	}
+
+	void stop()
+	{
+		recording = false;
+	}
+
+
+	int64_t now()
+	{
+		struct timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return (int64_t)(t.tv_sec - origin.tv_sec) * 1000000000 + (t.tv_nsec - origin.tv_nsec);
+	}
+
+	void record(const char *name, int64_t start, int64_t end)
+	{
+		ThreadBuffer *buffer = threadBuffer;
+		if (!buffer) buffer = acquireBuffer("");
+		size_t n = buffer->n;
+		if (n >= buffer->capacity) { ++buffer->ndropped; return; }
+		Event *&chunk = buffer->chunks[n / chunkSize];
+		if (!chunk) chunk = new Event[chunkSize];
+		Event &event = buffer->at(n);
+		event.name = name; event.start = start; event.duration = end - start;
+		__sync_synchronize(); // the event is complete before it can be written
+		buffer->n = n+1;
+	}
+
+	void setThreadName(std::string const &name)
+	{
+		ThreadBuffer *buffer = threadBuffer;
+		if (!buffer) { acquireBuffer(name); return; }
+		boost::unique_lock<boost::mutex> l(buffersMutex);
+		buffer->name = name;
+	}
+
+
+	size_t writeChromeTrace(std::string const &filename)
+	{
+		std::ofstream f(filename.c_str());
+		if (!f.is_open()) return 0;
+		boost::unique_lock<boost::mutex> l(buffersMutex);
+		size_t nwritten = 0;
+		f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		f << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"rtslam\"}}";
+		f << std::fixed << std::setprecision(3);
+		for(size_t b = 0; b < buffers.size(); ++b)
+		{
+			ThreadBuffer &buffer = *buffers[b];
+			if (!buffer.name.empty())
+			{
+				f << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.tid << ",\"args\":{\"name\":";
+				writeString(f, buffer.name);
+				f << "}}";
+			}
+			size_t n = buffer.n;
+			__sync_synchronize(); // the events are read after n
+			for(size_t i = 0; i < n; ++i)
+			{
+				Event const &event = buffer.at(i);
+				f << ",\n{\"name\":";
+				writeString(f, event.name);
+				f << ",\"cat\":\"rtslam\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.tid
+				  << ",\"ts\":" << event.start*1e-3 << ",\"dur\":" << event.duration*1e-3 << "}";
+			}
+			nwritten += n;
+		}
+		f << "\n]}\n";
+		return nwritten;
+	}
+
+	size_t nDropped()
+	{
+		boost::unique_lock<boost::mutex> l(buffersMutex);
+		size_t ndropped = 0;
+		for(size_t i = 0; i < buffers.size(); ++i) ndropped += buffers[i]->ndropped;
+		return ndropped;
+	}
+
+}}}
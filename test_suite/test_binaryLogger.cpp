@@ -0,0 +1,178 @@
+/**
+ * \file test_binaryLogger.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that the binary logger writes the typed tables that its reader
+ *  gives back, with several rows per log, measures the time of a log, and
+ *  checks that a full disk is reported.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/binaryLogger.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+struct PoseLoggable: public BinaryLoggable
+{
+	double t;
+	void writeLogHeader(BinaryLogger& log) const
+	{
+		log.writeComment("Pose");
+		log.writeComment("the robot");
+		log.writeLegendTokens("time x y z");
+	}
+	void writeLogData(BinaryLogger& log) const
+	{
+		log.writeData(t);
+		for(int i = 0; i < 3; ++i) log.writeData(t*10+i);
+	}
+};
+
+/// one row per point, with typed columns
+struct PointsLoggable: public BinaryLoggable
+{
+	unsigned n;
+	void writeLogHeader(BinaryLogger& log) const
+	{
+		log.writeComment("Points");
+		log.writeLegend("id", BinaryLogger::UInt32);
+		log.writeLegend("type", BinaryLogger::UInt8);
+		log.writeLegend("x");
+		log.writeLegend("sig", BinaryLogger::Float32);
+		log.writeLegend("offset", BinaryLogger::Int32);
+	}
+	void writeLogData(BinaryLogger& log) const
+	{
+		for(unsigned i = 0; i < n; ++i)
+		{
+			log.writeData(i);
+			log.writeData(i%3);
+			log.writeData(i*0.5);
+			log.writeData(0.25f);
+			log.writeData(-(int)i);
+		}
+	}
+};
+
+
+void test_binaryLogger01(void) {
+	// what is written is read back
+	const std::string filename = "test_binaryLogger.rtlog";
+	const unsigned nlogs = 1000;
+	PoseLoggable pose;
+	PointsLoggable points;
+	{
+		BinaryLogger logger(filename, 8);
+		logger.writeComment("options");
+		logger.addLoggable(pose);
+		logger.addLoggable(points);
+		for(unsigned i = 0; i < nlogs; ++i)
+		{
+			pose.t = i; points.n = i%5;
+			logger.log();
+		}
+		JFR_CHECK_EQUAL(logger.nLogs(), nlogs);
+		logger.stop();
+		JFR_CHECK_EQUAL(logger.nLostBytes(), 0u);
+	}
+
+	BinaryLogReader reader(filename);
+	BinaryLogReader::Rows rows;
+	unsigned nposes = 0, npoints = 0, nerrors = 0;
+	while (reader.next(rows))
+	{
+		JFR_CHECK(rows.table < 2);
+		if (rows.table == 0)
+		{
+			JFR_CHECK_EQUAL(rows.nrows, 1u);
+			if (rows.value(0,0) != rows.log || rows.value(3,0) != rows.log*10+2) ++nerrors;
+			++nposes;
+		} else
+		{
+			JFR_CHECK_EQUAL(rows.nrows, rows.log%5);
+			for(unsigned i = 0; i < rows.nrows; ++i)
+			{
+				if (rows.value(0,i) != i || rows.value(1,i) != i%3 || rows.value(2,i) != i*0.5 ||
+				    rows.value(3,i) != 0.25 || rows.value(4,i) != -(double)i) ++nerrors;
+				npoints++;
+			}
+		}
+	}
+	JFR_CHECK_EQUAL(nerrors, 0u);
+	JFR_CHECK_EQUAL(nposes, nlogs);
+	JFR_CHECK_EQUAL(npoints, 2*nlogs);
+
+	JFR_CHECK_EQUAL(reader.comments.size(), 1u);
+	JFR_CHECK_EQUAL(reader.comments[0], std::string("options"));
+	JFR_CHECK_EQUAL(reader.schemas.size(), 2u);
+	JFR_CHECK_EQUAL(reader.schemas[0].name, std::string("Pose"));
+	JFR_CHECK_EQUAL(reader.schemas[0].comments.size(), 1u);
+	JFR_CHECK_EQUAL(reader.schemas[0].columns.size(), 4u);
+	JFR_CHECK_EQUAL(reader.schemas[0].columns[3], std::string("z"));
+	JFR_CHECK_EQUAL(reader.schemas[1].types[1], BinaryLogger::UInt8);
+	JFR_CHECK_EQUAL(reader.schemas[1].types[3], BinaryLogger::Float32);
+	remove(filename.c_str());
+}
+
+void test_binaryLogger02(void) {
+	// a large table logged from the slam thread
+	const std::string filename = "test_binaryLogger_large.rtlog";
+	const unsigned nlogs = 200;
+	PointsLoggable points; points.n = 1000;
+	BinaryLogger logger(filename);
+	logger.addLoggable(points);
+	double start = kernel::Clock::getTime();
+	for(unsigned i = 0; i < nlogs; ++i) logger.log();
+	double duration = kernel::Clock::getTime() - start;
+	logger.stop();
+	std::cout << "binary logger: " << points.n << " rows in " << duration/nlogs*1e6 << " us per log, "
+	          << logger.nWaits() << " waits" << std::endl;
+
+	BinaryLogReader reader(filename);
+	BinaryLogReader::Rows rows;
+	unsigned nread = 0;
+	while (reader.next(rows)) { JFR_CHECK_EQUAL(rows.nrows, points.n); ++nread; }
+	JFR_CHECK_EQUAL(nread, nlogs);
+	remove(filename.c_str());
+}
+
+void test_binaryLogger03(void) {
+	// the data that the disk refuses is counted, and logging goes on
+	std::ifstream full("/dev/full");
+	if (!full.is_open()) return;
+	PointsLoggable points; points.n = 100;
+	BinaryLogger logger("/dev/full", 8);
+	logger.addLoggable(points);
+	for(unsigned i = 0; i < 100; ++i) logger.log();
+	logger.stop();
+	JFR_CHECK_EQUAL(logger.nLogs(), 100u);
+	JFR_CHECK(logger.nLostBytes() > 0);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_binaryLogger )
+{
+	test_binaryLogger01();
+	test_binaryLogger02();
+	test_binaryLogger03();
+}
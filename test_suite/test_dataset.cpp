@@ -0,0 +1,191 @@
+/**
+ * \file test_dataset.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Writes a small dataset file and reads it back, with and without index,
+ *  checks that an indexed file is opened from its index only, and the
+ *  binary logs of sensors.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <unistd.h>
+#include "rtslam/datasetContainer.hpp"
+
+using namespace std;
+using namespace jafar;
+using namespace jafar::rtslam::hardware;
+
+void test_dataset01(void) {
+
+	const char *path = "/tmp/test_dataset.rtds";
+	const int w = 5, h = 3, step = 8, n = 10;
+	uchar img[h*step];
+
+	{
+		DatasetWriter writer(path);
+		DatasetStreamInfo camInfo(dataset::stCamera, "camera", w, h, 8, 1);
+		camInfo.params.push_back(320.); camInfo.params.push_back(240.);
+		unsigned cam = writer.addStream(camInfo);
+		unsigned gps = writer.addStream(DatasetStreamInfo(dataset::stVector, "gps", 7));
+		for(int k = 0; k < n; ++k)
+		{
+			for(int i = 0; i < h*step; ++i) img[i] = k+i;
+			writer.writeImage(cam, k*0.1, k*0.1+0.01, img, step);
+			jblas::vec x(7); x.clear(); x(0) = k*0.2; x(6) = k;
+			writer.writeVector(gps, k*0.2, k*0.2, x);
+		}
+	}
+
+	DatasetReader reader(path);
+	JFR_CHECK_EQUAL(reader.nStreams(), 2u);
+	int cam = reader.findStream(dataset::stCamera);
+	int gps = reader.findStream(dataset::stVector);
+	JFR_CHECK_EQUAL(cam, 0);
+	JFR_CHECK_EQUAL(gps, 1);
+	JFR_CHECK_EQUAL(reader.findStream(dataset::stCamera, 1), -1);
+	JFR_CHECK_EQUAL(reader.stream(cam).params.size(), 2u);
+	JFR_CHECK_EQUAL(reader.stream(gps).name, std::string("gps"));
+	JFR_CHECK_EQUAL(reader.size(cam), (size_t)n);
+	JFR_CHECK_EQUAL(reader.size(gps), (size_t)n);
+
+	uchar out[h*w];
+	reader.readImage(reader.record(cam, 4), out, w);
+	JFR_CHECK_EQUAL(reader.record(cam, 4).timestamp, 0.4);
+	JFR_CHECK_EQUAL((int)out[0], 4);
+	JFR_CHECK_EQUAL((int)out[w], 4+step); // padding of the rows is removed
+	jblas::vec x;
+	reader.readVector(reader.record(gps, 7), x);
+	JFR_CHECK_EQUAL(x.size(), 7u);
+	JFR_CHECK_EQUAL(x(6), 7.);
+
+	// random access
+	JFR_CHECK_EQUAL(reader.findRecord(cam, 0.35), 4u);
+	JFR_CHECK_EQUAL(reader.findRecord(cam, -1.), 0u);
+	JFR_CHECK_EQUAL(reader.findRecord(cam, 10.), (size_t)n);
+	const char *mapped = reader.data(reader.record(cam, 6));
+	if (mapped) JFR_CHECK_EQUAL((int)mapped[w], 6+step);
+
+	// without the index, as if recording had been interrupted
+	JFR_CHECK_EQUAL(truncate(path, reader.record(gps, 5).offset), 0);
+	DatasetReader reader2(path);
+	JFR_CHECK_EQUAL(reader2.size(cam), 6u);
+	JFR_CHECK_EQUAL(reader2.size(gps), 5u);
+	reader2.readImage(reader2.record(cam, 5), out, w);
+	JFR_CHECK_EQUAL((int)out[0], 5);
+
+	unlink(path);
+}
+
+void test_dataset02(void) {
+
+	const char *dir = "/tmp";
+	std::string path = dataset::vectorLogPath(dir, "test_extloc");
+	JFR_CHECK_EQUAL(path, std::string("/tmp/test_extloc.rtds"));
+	JFR_CHECK_EQUAL(dataset::vectorLogPath("/tmp/all.rtds", "MTI"), std::string("/tmp/all.rtds"));
+	unlink(path.c_str());
+	JFR_CHECK(!VectorLogReader::exists(dir, "test_extloc"));
+
+	const int n = 20;
+	{
+		VectorLogWriter writer(dir, "test_extloc", 4, std::vector<double>(1, 3.));
+		jblas::vec x(4);
+		for(int k = 0; k < n; ++k)
+		{
+			x(0) = 10.+k*0.01; x(1) = k; x(2) = -k; x(3) = 0.5*k;
+			writer.write(x, (k%2 ? x(0)+0.002 : 0.));
+		}
+	}
+
+	JFR_CHECK(VectorLogReader::exists(dir, "test_extloc"));
+	VectorLogReader reader(dir, "test_extloc");
+	JFR_CHECK_EQUAL(reader.size(), (size_t)n);
+	JFR_CHECK_EQUAL(reader.info().width, 4);
+	JFR_CHECK_EQUAL(reader.info().params.at(0), 3.);
+	jblas::vec x; double arrival;
+	int k;
+	for(k = 0; reader.read(x, arrival); ++k)
+	{
+		JFR_CHECK_EQUAL(x.size(), 4u);
+		JFR_CHECK_EQUAL(x(0), 10.+k*0.01);
+		JFR_CHECK_EQUAL(x(2), (double)-k);
+		JFR_CHECK_EQUAL(arrival, (k%2 ? x(0)+0.002 : 0.));
+	}
+	JFR_CHECK_EQUAL(k, n);
+
+	unlink(path.c_str());
+
+	// the writers of the acquisition threads are never destroyed, they are closed at exit
+	std::string live_path = dataset::vectorLogPath(dir, "test_live");
+	{
+		boost::shared_ptr<VectorLogWriter> live(new VectorLogWriter(dir, "test_live", 2));
+		jblas::vec y(2);
+		for(k = 0; k < n; ++k) { y(0) = k; y(1) = 2*k; live->write(y); }
+		DatasetWriter::closeAll();
+		live->write(y); // ignored
+		VectorLogReader live_reader(dir, "test_live");
+		JFR_CHECK_EQUAL(live_reader.size(), (size_t)n);
+	}
+	unlink(live_path.c_str());
+}
+
+void test_dataset03(void) {
+
+	// the index describes all the streams, even those added after the first records
+	const char *path = "/tmp/test_dataset_index.rtds";
+	const int n = 10;
+	{
+		DatasetWriter writer(path);
+		unsigned odo = writer.addStream(DatasetStreamInfo(dataset::stVector, "odo", 3));
+		jblas::vec x(3); x.clear();
+		for(int k = 0; k < n; ++k) { x(0) = k; writer.writeVector(odo, k, k, x); }
+		unsigned gps = writer.addStream(DatasetStreamInfo(dataset::stVector, "gps", 3));
+		for(int k = 0; k < n; ++k) { x(0) = -k; writer.writeVector(gps, k+0.5, k+0.5, x); writer.writeVector(odo, n+k, n+k, x); }
+	}
+	uint64_t first_chunk;
+	{
+		DatasetReader reader(path);
+		JFR_CHECK_EQUAL(reader.nStreams(), 2u);
+		first_chunk = reader.record(0, 0).offset - dataset::recordHeaderSize - dataset::chunkHeaderSize;
+	}
+
+	// an indexed file is opened without walking its records: corrupting the first record chunk doesn't matter
+	{
+		std::fstream f(path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		uint64_t huge = (uint64_t)1 << 60;
+		f.seekp(first_chunk + 8);
+		f.write((const char*)&huge, 8);
+	}
+	DatasetReader reader(path);
+	JFR_CHECK_EQUAL(reader.nStreams(), 2u);
+	int gps = reader.findStream("gps");
+	JFR_CHECK_EQUAL(gps, 1);
+	JFR_CHECK_EQUAL(reader.stream(gps).width, 3);
+	JFR_CHECK_EQUAL(reader.size(0), (size_t)2*n);
+	JFR_CHECK_EQUAL(reader.size(gps), (size_t)n);
+	jblas::vec x;
+	reader.readVector(reader.record(gps, 3), x);
+	JFR_CHECK_EQUAL(x(0), -3.);
+
+	unlink(path);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_dataset )
+{
+	test_dataset01();
+	test_dataset02();
+	test_dataset03();
+}
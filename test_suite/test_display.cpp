@@ -23,6 +23,7 @@
 #include "rtslam/display_example.hpp"
 
 #include <iostream>
+#include <cmath>
 
 using namespace jafar::rtslam;
 using namespace std;
@@ -56,3 +57,34 @@ BOOST_AUTO_TEST_CASE( test_display )
 	*/
 }
 
+
+BOOST_AUTO_TEST_CASE( test_view_refresh )
+{
+	// 10 Hz view in a 30 Hz display loop with some jitter
+	display::ViewRefresh refresh(10.);
+	int nrendered = 0;
+	for(int i = 0; i < 30; ++i)
+	{
+		double now = 100. + i/30. + (i%2 ? 0.002 : -0.002);
+		if (refresh.due(now)) { refresh.begin(now); refresh.end(now+0.005); ++nrendered; }
+	}
+	JFR_CHECK_EQUAL(nrendered, 10);
+	JFR_CHECK_EQUAL(refresh.nrendered, 10u);
+	JFR_CHECK_EQUAL(refresh.nskipped, 20u);
+	JFR_CHECK(std::abs(refresh.mean_duration - 0.005) < 1e-6);
+
+	// a 10 Hz loop is not slowed down by its jitter
+	display::ViewRefresh refresh2(10.);
+	nrendered = 0;
+	for(int i = 0; i < 30; ++i)
+	{
+		double now = 100. + i*0.1 + (i%2 ? 0.01 : -0.01);
+		if (refresh2.due(now)) { refresh2.begin(now); refresh2.end(now); ++nrendered; }
+	}
+	JFR_CHECK_EQUAL(nrendered, 30);
+
+	// forced, and not limited
+	JFR_CHECK(refresh.due(101., true));
+	display::ViewRefresh each;
+	JFR_CHECK(each.due(0.) && each.due(0.));
+}
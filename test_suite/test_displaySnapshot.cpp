@@ -0,0 +1,285 @@
+/**
+ * \file test_displaySnapshot.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks the contents of the display snapshots, that a snapshot held by the
+ *  display is never modified by the next publications, that the buffers are
+ *  reused once released, that a snapshot is always consistent while the
+ *  slam publishes concurrently, and that only the landmarks that changed or
+ *  that a correction of the filter moved are copied again.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <boost/thread.hpp>
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/worldAbstract.hpp"
+#include "rtslam/robotOdometry.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/innovation.hpp"
+#include "rtslam/displaySnapshot.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+struct SnapshotWorld
+{
+	world_ptr_t worldPtr;
+	map_ptr_t mapPtr;
+	map_manager_ptr_t mm;
+	ahp_ptr_t ahp;
+	eucp_ptr_t euc;
+
+	SnapshotWorld(): worldPtr(new WorldAbstract()), mapPtr(new MapAbstract(100))
+	{
+		mapPtr->linkToParentWorld(worldPtr);
+		robodo_ptr_t robPtr(new RobotOdometry(mapPtr));
+		robPtr->linkToParentMap(mapPtr);
+		robPtr->pose.x(quaternion::originFrame());
+		robPtr->id(3);
+
+		landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+		mm.reset(new MapManager(lmkFactory));
+		mm->linkToParentMap(mapPtr);
+		ahp.reset(new LandmarkAnchoredHomogeneousPoint(mapPtr));
+		ahp->linkToParentMapManager(mm);
+		ahp->id(1);
+		jblas::vec7 xa; xa.clear(); xa(3) = 1.; xa(6) = 0.5; // from the origin along x at 2 m
+		ahp->state.x(xa);
+		euc.reset(new LandmarkEuclideanPoint(mapPtr));
+		euc->linkToParentMapManager(mm);
+		euc->id(2);
+		setEuc(1.);
+	}
+
+	void setEuc(double x0)
+	{
+		jblas::vec3 xe; xe(0) = x0; xe(1) = 2.; xe(2) = 3.;
+		euc->state.x(xe);
+		euc->touch();
+	}
+};
+
+
+void test_displaySnapshot01(void) {
+	// contents
+	SnapshotWorld w;
+	display::WorldSnapshotBuffer buffer(false, true);
+	JFR_CHECK(!buffer.acquire(0));
+	JFR_CHECK_EQUAL(buffer.lastT(), (unsigned)-1);
+	JFR_CHECK(buffer.publish(w.worldPtr, 5));
+	JFR_CHECK(!buffer.isAcquired());
+
+	display::world_snapshot_cptr_t snap = buffer.acquire(0);
+	JFR_CHECK(snap.get());
+	JFR_CHECK(buffer.isAcquired());
+	JFR_CHECK(!buffer.acquire(snap->seq));
+	JFR_CHECK_EQUAL(snap->seq, 1u);
+	JFR_CHECK_EQUAL(snap->t, 5u);
+	JFR_CHECK_EQUAL(snap->maps.size(), 1u);
+	JFR_CHECK_EQUAL(snap->maps[0].robots.size(), 1u);
+	JFR_CHECK_EQUAL(snap->maps[0].robots[0].id, 3u);
+	JFR_CHECK_EQUAL(snap->maps[0].robots[0].pose(3), 1.);
+	JFR_CHECK(snap->maps[0].robots[0].sensors.empty());
+	JFR_CHECK_EQUAL(snap->maps[0].landmarks.size(), 2u);
+	for(size_t i = 0; i < 2; ++i)
+	{
+		display::LandmarkSnapshot const &lmk = *snap->maps[0].landmarks[i];
+		if (lmk.id == 1)
+		{
+			JFR_CHECK_EQUAL(lmk.type, LandmarkAbstract::PNT_AH);
+			JFR_CHECK_EQUAL(lmk.x.size(), 7u);
+			JFR_CHECK_EQUAL(lmk.eucX.size(), 3u);
+			JFR_CHECK(std::abs(lmk.eucX(0) - 2.) < 1e-9);
+		} else
+		{
+			JFR_CHECK_EQUAL(lmk.id, 2u);
+			JFR_CHECK_EQUAL(lmk.x(0), 1.);
+			JFR_CHECK(lmk.eucX.size() == 0); // already euclidean
+		}
+	}
+}
+
+void test_displaySnapshot02(void) {
+	// immutable while held, reused when released
+	SnapshotWorld w;
+	display::WorldSnapshotBuffer buffer(false, false);
+	buffer.publish(w.worldPtr, 0);
+	display::world_snapshot_cptr_t held = buffer.acquire(0);
+	const display::WorldSnapshot *first = held.get();
+
+	w.setEuc(10.);
+	buffer.publish(w.worldPtr, 1);
+	buffer.publish(w.worldPtr, 2);
+	display::world_snapshot_cptr_t last = buffer.acquire(held->seq);
+	JFR_CHECK(last.get() != first);
+	JFR_CHECK_EQUAL(last->seq, 3u);
+	JFR_CHECK_EQUAL(held->seq, 1u);
+	JFR_CHECK_EQUAL(held->t, 0u);
+	for(size_t i = 0; i < 2; ++i)
+		if (held->maps[0].landmarks[i]->id == 2)
+		{
+			JFR_CHECK_EQUAL(held->maps[0].landmarks[i]->x(0), 1.);
+			JFR_CHECK_EQUAL(last->maps[0].landmarks[i]->x(0), 10.);
+		}
+
+	// nobody holds the two buffers anymore, they are swapped without allocation
+	held.reset();
+	const display::WorldSnapshot *second = last.get();
+	last.reset();
+	buffer.publish(w.worldPtr, 3);
+	last = buffer.acquire(3);
+	const display::WorldSnapshot *third = last.get();
+	last.reset();
+	buffer.publish(w.worldPtr, 4);
+	last = buffer.acquire(4);
+	JFR_CHECK(last.get() == second);
+	last.reset();
+	buffer.publish(w.worldPtr, 5);
+	last = buffer.acquire(5);
+	JFR_CHECK(last.get() == third);
+}
+
+
+struct SnapshotWriter
+{
+	SnapshotWorld *w;
+	display::WorldSnapshotBuffer *buffer;
+	int n;
+	void operator()()
+	{
+		for(int i = 1; i <= n; ++i)
+		{
+			{
+				boost::unique_lock<boost::mutex> l(w->mapPtr->mutex_process);
+				jblas::vec7 xa = w->ahp->state.x(); xa(0) = i; w->ahp->state.x(xa); w->ahp->touch();
+				w->setEuc(i);
+			}
+			buffer->publish(w->worldPtr, i);
+		}
+	}
+};
+
+void test_displaySnapshot03(void) {
+	// a snapshot is a consistent copy of the world while it is published concurrently
+	SnapshotWorld w;
+	display::WorldSnapshotBuffer buffer(false, false);
+	SnapshotWriter writer = { &w, &buffer, 20000 };
+	boost::thread thread(writer);
+
+	uint64_t seq = 0;
+	int nread = 0, ninconsistent = 0;
+	while (seq < (uint64_t)writer.n)
+	{
+		display::world_snapshot_cptr_t snap = buffer.acquire(seq, 1.);
+		if (!snap) break;
+		JFR_CHECK(snap->seq > seq);
+		seq = snap->seq;
+		display::MapSnapshot const &map = snap->maps[0];
+		if (map.landmarks[0]->x(0) != snap->t || map.landmarks[1]->x(0) != snap->t) ninconsistent++;
+		nread++;
+	}
+	thread.join();
+	JFR_CHECK_EQUAL(seq, (uint64_t)writer.n);
+	JFR_CHECK_EQUAL(ninconsistent, 0);
+	JFR_CHECK(nread > 0);
+}
+
+
+void test_displaySnapshot04(void) {
+	// only the landmarks that changed are copied again
+	SnapshotWorld w;
+	w.ahp->state.P() = 0.01 * jblas::identity_mat(7);
+	w.euc->state.P() = 0.01 * jblas::identity_mat(3);
+	display::WorldSnapshotBuffer buffer(false, true, 0.001, 0.05);
+	buffer.publish(w.worldPtr, 0);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks, 2u);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 2u);
+	display::world_snapshot_cptr_t first = buffer.acquire(0);
+
+	buffer.publish(w.worldPtr, 1);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 0u);
+	display::world_snapshot_cptr_t second = buffer.acquire(first->seq);
+	for(size_t i = 0; i < 2; ++i)
+		JFR_CHECK(second->maps[0].landmarks[i] == first->maps[0].landmarks[i]);
+
+	// the copy held by the display is not modified, the changed one is copied again
+	w.setEuc(5.);
+	buffer.publish(w.worldPtr, 2);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 1u);
+	display::world_snapshot_cptr_t third = buffer.acquire(second->seq);
+	for(size_t i = 0; i < 2; ++i)
+	{
+		display::landmark_snapshot_ptr_t before = second->maps[0].landmarks[i], after = third->maps[0].landmarks[i];
+		if (after->id == 2)
+		{
+			JFR_CHECK(after != before);
+			JFR_CHECK(after->stamp != before->stamp);
+			JFR_CHECK_EQUAL(before->x(0), 1.);
+			JFR_CHECK_EQUAL(after->x(0), 5.);
+		} else
+		{
+			JFR_CHECK(after == before);
+			JFR_CHECK(after->stamp == before->stamp);
+		}
+	}
+
+	// a correction of the filter observing the euclidean landmark only doesn't move the other one
+	jblas::ind_array ia_x = w.mapPtr->ia_used_states();
+	jblas::mat INN(1, 3); INN.clear(); INN(0,0) = -1.;
+	Innovation inn(1);
+	inn.x()(0) = 5.1 - w.euc->state.x()(0);
+	inn.P()(0,0) = 0.01 + w.euc->state.P()(0,0);
+	w.mapPtr->filterPtr->correct(ia_x, inn, INN, w.euc->state.ia());
+	buffer.publish(w.worldPtr, 3);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 1u);
+	display::world_snapshot_cptr_t fourth = buffer.acquire(third->seq);
+	for(size_t i = 0; i < 2; ++i)
+	{
+		display::landmark_snapshot_ptr_t before = third->maps[0].landmarks[i], after = fourth->maps[0].landmarks[i];
+		if (after->id == 2)
+			JFR_CHECK(std::abs(after->x(0) - 5.05) < 1e-9);
+		else
+			JFR_CHECK(after == before);
+	}
+
+	// nor does a correction that doesn't visibly move the landmark
+	inn.x()(0) = 1e-5;
+	inn.P()(0,0) = 100. + w.euc->state.P()(0,0);
+	w.mapPtr->filterPtr->correct(ia_x, inn, INN, w.euc->state.ia());
+	buffer.publish(w.worldPtr, 4);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 0u);
+
+	// but the small moves add up
+	w.euc->state.x()(1) += 0.0006;
+	buffer.publish(w.worldPtr, 5);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 0u);
+	w.euc->state.x()(1) += 0.0006;
+	buffer.publish(w.worldPtr, 6);
+	JFR_CHECK_EQUAL(buffer.lastStats.landmarks_copied, 1u);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_displaySnapshot )
+{
+	test_displaySnapshot01();
+	test_displaySnapshot02();
+	test_displaySnapshot03();
+	test_displaySnapshot04();
+}
@@ -0,0 +1,237 @@
+/**
+ * \file test_exporter.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks the binary export protocol, the drop-oldest policy of the client
+ *  queues, that a client connected on loopback receives all the messages
+ *  in order, and the changes found for the incremental export of the map.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <vector>
+#include <cmath>
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/robotOdometry.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/landmarkExportTracker.hpp"
+#include "rtslam/exportProtocol.hpp"
+#include "rtslam/exporterSocket.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+void test_exporter01(void) {
+	// encode and decode
+	jblas::vec x(4); jblas::sym_mat P(4,4);
+	for(int i = 0; i < 4; ++i) { x(i) = i+0.5; for(int j = i; j < 4; ++j) P(i,j) = 10*i+j; }
+	jblas::vec l(3); jblas::sym_mat lP(3,3);
+	for(int i = 0; i < 3; ++i) { l(i) = -i; for(int j = i; j < 3; ++j) lP(i,j) = 100+10*i+j; }
+
+	ExportMessageBuilder builder(exportproto::typeState, exportproto::flagCovariance, 42, 12.5, 13., 7, x);
+	builder.addCovariance(P);
+	export_message_ptr_t data = builder.finish();
+	JFR_CHECK_EQUAL(exportMessageSize(&(*data)[0]), data->size());
+
+	ExportMessage msg;
+	JFR_CHECK(decodeExportMessage(&(*data)[0], data->size(), msg));
+	JFR_CHECK_EQUAL(msg.type, exportproto::typeState);
+	JFR_CHECK_EQUAL(msg.seq, 42u);
+	JFR_CHECK_EQUAL(msg.time, 12.5);
+	JFR_CHECK_EQUAL(msg.robot, 7u);
+	JFR_CHECK_EQUAL(msg.x.size(), 4u);
+	JFR_CHECK_EQUAL(msg.x[3], 3.5);
+	JFR_CHECK_EQUAL(msg.P.size(), 10u);
+	JFR_CHECK_EQUAL(msg.P[4], 11.); // (1,1)
+	JFR_CHECK(msg.landmarks.empty());
+
+	// map
+	ExportMessageBuilder builder3(exportproto::typeMapDelta, 0, 44, 12.5, 13., 7, jblas::vec(0));
+	builder3.beginLandmarks(5, 2);
+	builder3.addLandmark(exportproto::opAdd, 3, LandmarkAbstract::PNT_AH, l, lP);
+	builder3.addLandmarkDeletion(9, LandmarkAbstract::PNT_EUC);
+	export_message_ptr_t data3 = builder3.finish();
+	JFR_CHECK(decodeExportMessage(&(*data3)[0], data3->size(), msg));
+	JFR_CHECK(msg.x.empty());
+	JFR_CHECK_EQUAL(msg.map_seq, 5u);
+	JFR_CHECK_EQUAL(msg.landmarks.size(), 2u);
+	JFR_CHECK_EQUAL(msg.landmarks[0].op, (unsigned)exportproto::opAdd);
+	JFR_CHECK_EQUAL(msg.landmarks[0].type, (unsigned)LandmarkAbstract::PNT_AH);
+	JFR_CHECK_EQUAL(msg.landmarks[0].x[2], -2.);
+	JFR_CHECK_EQUAL(msg.landmarks[0].P[5], 122.); // (2,2)
+	JFR_CHECK_EQUAL(msg.landmarks[1].op, (unsigned)exportproto::opDelete);
+	JFR_CHECK_EQUAL(msg.landmarks[1].id, 9u);
+	JFR_CHECK(msg.landmarks[1].x.empty());
+
+	// a corrupted landmark count is refused before allocating the landmarks
+	std::vector<char> corrupted(*data3);
+	uint32_t count = 0xffffffff;
+	memcpy(&corrupted[exportproto::headerSize + 8], &count, sizeof(count));
+	JFR_CHECK(!decodeExportMessage(&corrupted[0], corrupted.size(), msg));
+
+	// truncated
+	JFR_CHECK(!decodeExportMessage(&(*data)[0], data->size()-8, msg));
+
+	// mean only
+	ExportMessageBuilder builder2(exportproto::typePropagatedState, 0, 43, 12.6, 13., 7, x);
+	builder2.setSeq(45);
+	data = builder2.finish();
+	JFR_CHECK(decodeExportMessage(&(*data)[0], data->size(), msg));
+	JFR_CHECK_EQUAL(msg.seq, 45u);
+	JFR_CHECK_EQUAL(data->size(), exportproto::headerSize + 4*sizeof(double));
+	JFR_CHECK(msg.P.empty());
+	JFR_CHECK(msg.landmarks.empty());
+}
+
+void test_exporter02(void) {
+	// the oldest messages are dropped
+	ExportClientQueue queue(3);
+	std::vector<export_message_ptr_t> msgs;
+	jblas::vec x(1);
+	for(int i = 0; i < 5; ++i)
+	{
+		ExportMessageBuilder builder(exportproto::typePropagatedState, 0, i, i, i, 0, x);
+		msgs.push_back(builder.finish());
+		JFR_CHECK_EQUAL(queue.push(msgs.back()), i < 3);
+	}
+	JFR_CHECK_EQUAL(queue.dropped(), 2u);
+	JFR_CHECK_EQUAL(queue.size(), 3u);
+	export_message_ptr_t msg;
+	for(int i = 2; i < 5; ++i) { JFR_CHECK(queue.pop(msg)); JFR_CHECK(msg == msgs[i]); }
+	queue.close();
+	JFR_CHECK(!queue.pop(msg));
+}
+
+void test_exporter03(void) {
+	// all the messages in order on loopback, when the client reads fast enough
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robodo_ptr_t robPtr(new RobotOdometry(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+	robPtr->origin_export(0) = -1.;
+
+	const unsigned short port = 30999;
+	const int n = 200;
+	ExporterSocket exporter(robPtr, port, false, n);
+	boost::asio::io_service io_service;
+	tcp::socket sock(io_service);
+	sock.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+	double start = kernel::Clock::getTime();
+	while (exporter.nConnected() == 0 && kernel::Clock::getTime() - start < 5.)
+		boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+	JFR_CHECK_EQUAL(exporter.nConnected(), 1u);
+
+	jblas::vec x = robPtr->state.x();
+	for(int i = 0; i < n; ++i)
+	{
+		robPtr->self_time = i;
+		if (i % 2) exporter.exportPropagatedState(i, x); else exporter.exportCurrentState();
+	}
+
+	std::vector<char> data(exportproto::headerSize);
+	ExportMessage msg;
+	for(int i = 0; i < n; ++i)
+	{
+		data.resize(exportproto::headerSize);
+		boost::asio::read(sock, boost::asio::buffer(data));
+		size_t size = exportMessageSize(&data[0]);
+		JFR_CHECK(size >= exportproto::headerSize);
+		data.resize(size);
+		boost::asio::read(sock, boost::asio::buffer(&data[exportproto::headerSize], size - exportproto::headerSize));
+		JFR_CHECK(decodeExportMessage(&data[0], size, msg));
+		JFR_CHECK_EQUAL(msg.seq, (uint64_t)i);
+		JFR_CHECK_EQUAL(msg.time, (double)i);
+		JFR_CHECK_EQUAL(msg.type, (i % 2 ? exportproto::typePropagatedState : exportproto::typeState));
+		JFR_CHECK_EQUAL(msg.x.size(), robPtr->state.size());
+		JFR_CHECK_EQUAL(msg.x[0], 1.);
+	}
+	exporter.stop();
+}
+
+void test_exporter04(void) {
+	// changes of the map
+	map_ptr_t mapPtr(new MapAbstract(100));
+	landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+	map_manager_ptr_t mm(new MapManager(lmkFactory));
+	mm->linkToParentMap(mapPtr);
+
+	ahp_ptr_t ahp(new LandmarkAnchoredHomogeneousPoint(mapPtr));
+	ahp->linkToParentMapManager(mm);
+	ahp->id(1);
+	jblas::vec7 xa; xa.clear(); xa(3) = 1.; xa(6) = 0.5; // from the origin along x at 2 m
+	ahp->state.x(xa);
+	eucp_ptr_t euc(new LandmarkEuclideanPoint(mapPtr));
+	euc->linkToParentMapManager(mm);
+	euc->id(2);
+	jblas::vec3 xe; xe(0) = 1.; xe(1) = 2.; xe(2) = 3.;
+	euc->state.x(xe);
+
+	LandmarkExportTracker tracker(0.01, 0.1);
+	std::vector<LandmarkExportTracker::Change> changes;
+	tracker.update(mapPtr, changes);
+	JFR_CHECK_EQUAL(changes.size(), 2u);
+	JFR_CHECK_EQUAL(changes[0].op, (unsigned)exportproto::opAdd);
+	for(size_t i = 0; i < changes.size(); ++i)
+		if (changes[i].id == 1) { JFR_CHECK_EQUAL(changes[i].x.size(), 3u); JFR_CHECK(std::abs(changes[i].x(0) - 2.) < 1e-9); }
+	tracker.update(mapPtr, changes);
+	JFR_CHECK(changes.empty());
+
+	// moved under and over the threshold
+	xe(0) = 1.005; euc->state.x(xe);
+	tracker.update(mapPtr, changes);
+	JFR_CHECK(changes.empty());
+	xe(0) = 1.02; euc->state.x(xe);
+	tracker.update(mapPtr, changes);
+	JFR_CHECK_EQUAL(changes.size(), 1u);
+	JFR_CHECK_EQUAL(changes[0].op, (unsigned)exportproto::opUpdate);
+	JFR_CHECK_EQUAL(changes[0].id, 2u);
+
+	// reparametrized, keeping its id
+	mm->unregisterLandmark(ahp);
+	ahp.reset();
+	eucp_ptr_t conv(new LandmarkEuclideanPoint(mapPtr));
+	conv->linkToParentMapManager(mm);
+	conv->id(1);
+	xe.clear(); xe(0) = 2.; conv->state.x(xe);
+	tracker.update(mapPtr, changes);
+	JFR_CHECK_EQUAL(changes.size(), 1u);
+	JFR_CHECK_EQUAL(changes[0].op, (unsigned)exportproto::opReparametrize);
+	JFR_CHECK_EQUAL(changes[0].type, (unsigned)LandmarkAbstract::PNT_EUC);
+
+	// deleted
+	mm->unregisterLandmark(euc);
+	tracker.update(mapPtr, changes);
+	JFR_CHECK_EQUAL(changes.size(), 1u);
+	JFR_CHECK_EQUAL(changes[0].op, (unsigned)exportproto::opDelete);
+	JFR_CHECK_EQUAL(changes[0].id, 2u);
+
+	// the keyframe is the map as exported
+	tracker.keyframe(changes);
+	JFR_CHECK_EQUAL(changes.size(), 1u);
+	JFR_CHECK_EQUAL(changes[0].id, 1u);
+	JFR_CHECK_EQUAL(changes[0].op, (unsigned)exportproto::opAdd);
+}
+
+BOOST_AUTO_TEST_CASE( test_exporter )
+{
+	test_exporter01();
+	test_exporter02();
+	test_exporter03();
+	test_exporter04();
+}
@@ -16,9 +16,11 @@
 
 // jafar debug include
 #include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
 
 
 #include "rtslam/kalmanFilter.hpp"
+#include "rtslam/innovation.hpp"
 #include <iostream>
 #include "jmath/matlab.hpp"
 #include "jmath/random.hpp"
@@ -72,9 +74,60 @@ void test_filter01(void) {
 
 }
 
+/*
+ * Two linear observations corrected together with one stacked update give
+ * the same result as corrected one after the other (processGroup).
+ */
+void test_filter02(void) {
+
+	using namespace jafar::rtslam;
+	using namespace jafar::jmath;
+
+	const size_t size = 6;
+	ExtendedKalmanFilterIndirect seq(size), stacked(size);
+	randVector(seq.x());
+	jblas::mat A(size, size);
+	randMatrix(A);
+	seq.P() = ublas::prod(A, ublas::trans(A)) + jblas::identity_mat(size);
+	stacked.x() = seq.x();
+	stacked.P() = seq.P();
+	jblas::ind_array iax(size);
+	for(size_t i = 0; i < size; ++i) iax(i) = i;
+
+	// two observations sharing the state 2
+	jblas::ind_array ia1(3), ia2(3);
+	ia1(0) = 0; ia1(1) = 1; ia1(2) = 2;
+	ia2(0) = 2; ia2(1) = 3; ia2(2) = 5;
+	jblas::mat H1(2, 3), H2(2, 3);
+	randMatrix(H1); randMatrix(H2);
+	jblas::vec y1(2), y2(2);
+	randVector(y1); randVector(y2);
+	jblas::sym_mat R = 0.1 * jblas::identity_mat(2);
+
+	// innovation z = y - H x, with Jacobian -H
+	Innovation inn1(2), inn2(2);
+	inn1.x() = y1 - ublas::prod(H1, ublas::project(stacked.x(), ia1));
+	inn1.P() = R + ublasExtra::prod_JPJt(ublas::project(stacked.P(), ia1, ia1), H1);
+	inn2.x() = y2 - ublas::prod(H2, ublas::project(stacked.x(), ia2));
+	inn2.P() = R + ublasExtra::prod_JPJt(ublas::project(stacked.P(), ia2, ia2), H2);
+	jblas::mat INN1 = -H1, INN2 = -H2;
+	stacked.stackCorrection(inn1, INN1, ia1);
+	stacked.stackCorrection(inn2, INN2, ia2);
+	stacked.correctAllStacked(iax);
+
+	seq.correct(iax, inn1, INN1, ia1);
+	inn2.x() = y2 - ublas::prod(H2, ublas::project(seq.x(), ia2));
+	inn2.P() = R + ublasExtra::prod_JPJt(ublas::project(seq.P(), ia2, ia2), H2);
+	seq.correct(iax, inn2, INN2, ia2);
+
+	JFR_CHECK_VEC_EQUAL(stacked.x(), seq.x());
+	JFR_CHECK_MAT_EQUAL(stacked.P(), seq.P());
+}
+
 
 BOOST_AUTO_TEST_CASE( test_filter )
 {
 	test_filter01();
+	test_filter02();
 }
 
@@ -0,0 +1,166 @@
+/**
+ * \file test_frameEncoder.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks the avi files written by the frame encoder, that the frames that
+ *  do not fit in its queue are dropped and counted, and the frames given as files.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include <opencv/highgui.h>
+
+#include "rtslam/frameEncoder.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::rtslam::display;
+
+
+static std::vector<char> readFile(std::string const &filename)
+{
+	std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary);
+	return std::vector<char>((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+}
+
+static uint32_t read32(std::vector<char> const &data, size_t pos)
+{
+	uint32_t v; memcpy(&v, &data[pos], 4); return v;
+}
+
+static bool isFourcc(std::vector<char> const &data, size_t pos, const char *c)
+{
+	return pos+4 <= data.size() && memcmp(&data[pos], c, 4) == 0;
+}
+
+static cv::Mat testImage(int i)
+{
+	cv::Mat image(120, 160, CV_8UC3, cv::Scalar(0,0,0));
+	cv::rectangle(image, cv::Point(10*i, 10), cv::Point(10*i+40, 50), cv::Scalar(255,255,255), -1);
+	return image;
+}
+
+
+void test_frameEncoder01(void) {
+	// avi structure
+	const std::string filename = "test_frameEncoder.avi";
+	const unsigned n = 3;
+	{
+		AviMjpegWriter video(filename, 15.);
+		for(unsigned i = 0; i < n; ++i) video.write(testImage(i));
+		cv::Mat larger(240, 320, CV_8UC3, cv::Scalar(0,0,255));
+		video.write(larger); // resized to the first frame
+		JFR_CHECK_EQUAL(video.nFrames(), n+1);
+	}
+	std::vector<char> data = readFile(filename);
+	JFR_CHECK(isFourcc(data, 0, "RIFF"));
+	JFR_CHECK_EQUAL(read32(data, 4), data.size()-8);
+	JFR_CHECK(isFourcc(data, 8, "AVI "));
+	JFR_CHECK(isFourcc(data, 12, "LIST"));
+	JFR_CHECK(isFourcc(data, 20, "hdrl"));
+	JFR_CHECK(isFourcc(data, 24, "avih"));
+	JFR_CHECK_EQUAL(read32(data, 32+16), n+1); // total frames
+	JFR_CHECK_EQUAL(read32(data, 32+32), 160u);
+	JFR_CHECK_EQUAL(read32(data, 32+36), 120u);
+
+	// movi list follows hdrl
+	size_t movi = 20 + read32(data, 16);
+	JFR_CHECK(isFourcc(data, movi, "LIST"));
+	JFR_CHECK(isFourcc(data, movi+8, "movi"));
+	size_t idx1 = movi+8 + read32(data, movi+4);
+	JFR_CHECK(isFourcc(data, idx1, "idx1"));
+	JFR_CHECK_EQUAL(read32(data, idx1+4), (n+1)*16);
+	JFR_CHECK_EQUAL(idx1+8 + (n+1)*16, data.size());
+
+	// each indexed frame is a jpeg of the size of the first one
+	for(unsigned i = 0; i < n+1; ++i)
+	{
+		size_t entry = idx1+8 + i*16;
+		JFR_CHECK(isFourcc(data, entry, "00dc"));
+		size_t chunk = movi+8 + read32(data, entry+8);
+		uint32_t size = read32(data, entry+12);
+		JFR_CHECK(isFourcc(data, chunk, "00dc"));
+		JFR_CHECK_EQUAL(read32(data, chunk+4), size);
+		std::vector<uchar> jpeg(data.begin()+chunk+8, data.begin()+chunk+8+size);
+		cv::Mat image = cv::imdecode(cv::Mat(jpeg), 1);
+		JFR_CHECK_EQUAL(image.cols, 160);
+		JFR_CHECK_EQUAL(image.rows, 120);
+	}
+	remove(filename.c_str());
+}
+
+void test_frameEncoder02(void) {
+	// image sequence, and everything written at stop
+	FrameEncoder encoder(FrameEncoder::ImageSequence, "test_frameEncoder_%d-%06d.png");
+	for(unsigned i = 0; i < 5; ++i)
+		JFR_CHECK(encoder.push(1, i, testImage(i)));
+	encoder.stop();
+	JFR_CHECK_EQUAL(encoder.written(), 5u);
+	JFR_CHECK_EQUAL(encoder.dropped(), 0u);
+	JFR_CHECK(!encoder.push(1, 5, testImage(5)));
+	for(unsigned i = 0; i < 5; ++i)
+	{
+		char filename[256]; snprintf(filename, 256, "test_frameEncoder_%d-%06d.png", 1, i);
+		cv::Mat image = cv::imread(filename);
+		JFR_CHECK_EQUAL(image.cols, 160);
+		remove(filename);
+	}
+}
+
+void test_frameEncoder03(void) {
+	// a full queue drops the new frames without blocking
+	const unsigned n = 200;
+	FrameEncoder encoder(FrameEncoder::MjpegAvi, "test_frameEncoder_%d.avi", 10., 2);
+	cv::Mat image(480, 640, CV_8UC3, cv::Scalar(0,128,255));
+	cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255)); // slow to encode
+	unsigned pushed = 0;
+	for(unsigned i = 0; i < n; ++i)
+		if (encoder.push(0, i, image)) ++pushed;
+	JFR_CHECK(encoder.waiting() <= 2);
+	encoder.stop();
+	JFR_CHECK_EQUAL(encoder.written(), pushed);
+	JFR_CHECK_EQUAL(encoder.written() + encoder.dropped(), n);
+	JFR_CHECK(encoder.dropped() > 0);
+	std::cout << "frame encoder: " << encoder.written() << " frames written, " << encoder.dropped() << " dropped" << std::endl;
+	remove("test_frameEncoder_0.avi");
+}
+
+void test_frameEncoder04(void) {
+	// frames written in files by another program are read and removed by the encoder
+	FrameEncoder encoder(FrameEncoder::ImageSequence, "test_frameEncoder_%d-%06d.png");
+	const std::string tmp = "test_frameEncoder_tmp.png";
+	cv::imwrite(tmp, testImage(1));
+	JFR_CHECK(encoder.pushFile(2, 0, tmp));
+	JFR_CHECK(encoder.pushFile(2, 1, "test_frameEncoder_missing.png")); // skipped
+	encoder.stop();
+	JFR_CHECK(!std::ifstream(tmp.c_str()).is_open());
+	cv::Mat image = cv::imread("test_frameEncoder_2-000000.png");
+	JFR_CHECK_EQUAL(image.cols, 160);
+	JFR_CHECK(!std::ifstream("test_frameEncoder_2-000001.png").is_open());
+	remove("test_frameEncoder_2-000000.png");
+}
+
+
+BOOST_AUTO_TEST_CASE( test_frameEncoder )
+{
+	test_frameEncoder01();
+	test_frameEncoder02();
+	test_frameEncoder03();
+	test_frameEncoder04();
+}
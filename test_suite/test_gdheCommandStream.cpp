@@ -0,0 +1,142 @@
+/**
+ * \file test_gdheCommandStream.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that the gdhe command stream only sends the objects that changed,
+ *  aggregated in a few scripts, and measures a refresh of a large map with a
+ *  stub gdhe server on loopback.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <sstream>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include "rtslam/gdheCommandStream.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::rtslam::display;
+
+
+struct ScriptRecorder
+{
+	std::vector<std::string> scripts;
+	void send(std::string const &script) { scripts.push_back(script); }
+};
+
+static std::string ellipsoidScript(int i, double x)
+{
+	std::ostringstream oss;
+	oss << "color 255 0 0; ellipsoid " << i << " " << x << " 0 0 0.1 0.1 0.1";
+	return oss.str();
+}
+
+
+void test_gdheCommandStream01(void) {
+	// diffs
+	ScriptRecorder recorder;
+	GdheCommandStream::Sender sender = boost::bind(&ScriptRecorder::send, &recorder, _1);
+	GdheCommandStream stream(200);
+	std::vector<std::string> names;
+	for(int i = 0; i < 10; ++i)
+	{
+		names.push_back(stream.newName("lmk"));
+		stream.update(names[i], ellipsoidScript(i, 0.));
+	}
+	JFR_CHECK(names[0] != names[1]);
+	GdheCommandStream::Stats stats = stream.flush(sender);
+	JFR_CHECK_EQUAL(stats.updated, 10u);
+	JFR_CHECK(stats.messages > 1); // split at 200 bytes
+	JFR_CHECK(stats.messages < 10);
+	JFR_CHECK_EQUAL(recorder.scripts.size(), stats.messages);
+	JFR_CHECK_EQUAL(stream.nObjects(), 10u);
+	size_t redraws = 0;
+	for(size_t i = 0; i < recorder.scripts.size(); ++i)
+		if (recorder.scripts[i].find("redraw") != std::string::npos) ++redraws;
+	JFR_CHECK_EQUAL(redraws, 1u);
+
+	// nothing changed, nothing sent
+	recorder.scripts.clear();
+	for(int i = 0; i < 10; ++i) stream.update(names[i], ellipsoidScript(i, 0.));
+	stats = stream.flush(sender);
+	JFR_CHECK_EQUAL(stats.unchanged, 10u);
+	JFR_CHECK_EQUAL(stats.messages, 0u);
+	JFR_CHECK(recorder.scripts.empty());
+
+	// one changed and one removed, in a single script
+	stream.update(names[3], ellipsoidScript(3, 1.));
+	stream.remove(names[7]);
+	stats = stream.flush(sender);
+	JFR_CHECK_EQUAL(stats.updated, 1u);
+	JFR_CHECK_EQUAL(stats.removed, 1u);
+	JFR_CHECK_EQUAL(recorder.scripts.size(), 1u);
+	JFR_CHECK(recorder.scripts[0].find(names[3]) != std::string::npos);
+	JFR_CHECK(recorder.scripts[0].find("unset -nocomplain robots(" + names[7] + ")") != std::string::npos);
+	JFR_CHECK_EQUAL(stream.nObjects(), 9u);
+
+	// changed and changed back before the flush
+	stream.update(names[1], ellipsoidScript(1, 2.));
+	stream.update(names[1], ellipsoidScript(1, 0.));
+	JFR_CHECK(!stream.changed());
+	// removed before being sent
+	std::string name = stream.newName("lmk");
+	stream.update(name, ellipsoidScript(10, 0.));
+	stream.remove(name);
+	JFR_CHECK(!stream.changed());
+}
+
+void test_gdheCommandStream02(void) {
+	// refresh of a large map with a stub server
+	const unsigned short port = 30998;
+	const int n = 5000, nchanged = 50;
+	GdheStubServer server(port);
+	GdheSocketSender socket("localhost", port);
+	GdheCommandStream::Sender sender = boost::bind(&GdheSocketSender::send, &socket, _1);
+	GdheCommandStream stream;
+
+	std::vector<std::string> names;
+	for(int i = 0; i < n; ++i)
+	{
+		names.push_back(stream.newName("lmk"));
+		stream.update(names[i], ellipsoidScript(i, 0.));
+	}
+	GdheCommandStream::Stats full = stream.flush(sender);
+	JFR_CHECK_EQUAL(full.updated, (unsigned)n);
+	JFR_CHECK_EQUAL(server.messages(), full.messages);
+	JFR_CHECK_EQUAL(server.commands(), (unsigned)n+1);
+	JFR_CHECK_EQUAL(server.bytes(), full.bytes);
+
+	for(int i = 0; i < n; ++i)
+		stream.update(names[i], ellipsoidScript(i, i < nchanged ? 1. : 0.));
+	GdheCommandStream::Stats diff = stream.flush(sender);
+	JFR_CHECK_EQUAL(diff.updated, (unsigned)nchanged);
+	JFR_CHECK_EQUAL(diff.unchanged, (unsigned)(n-nchanged));
+	JFR_CHECK_EQUAL(diff.messages, 1u);
+	JFR_CHECK_EQUAL(server.commands(), (unsigned)n+1 + nchanged+1);
+	JFR_CHECK(diff.bytes < full.bytes/10);
+
+	std::cout << "gdhe refresh of " << n << " objects: " << full.messages << " scripts, " << full.bytes << " bytes, "
+	          << full.duration*1000 << " ms; with " << nchanged << " changed: " << diff.bytes << " bytes, "
+	          << diff.duration*1000 << " ms" << std::endl;
+	server.stop();
+}
+
+
+BOOST_AUTO_TEST_CASE( test_gdheCommandStream )
+{
+	test_gdheCommandStream01();
+	test_gdheCommandStream02();
+}
@@ -66,7 +66,34 @@ void test_inertial01() {
 	}
 }
 
+void test_inertial02() {
+
+	map_ptr_t mapPtr(new MapAbstract(100));
+	robinertial_ptr_t robPtr(new RobotInertial(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+
+	mapPtr->fillRndm();
+	robPtr->pose.x(quaternion::originFrame());
+
+	// with the same command in both readings, move_mean is move_func without noise
+	vec u(6);
+	randVector(u);
+	double prev_reading[7], next_reading[7];
+	prev_reading[0] = 10.0; next_reading[0] = 10.5;
+	for (size_t i = 0; i < 6; i++) prev_reading[1+i] = next_reading[1+i] = u(i);
+
+	size_t n = robPtr->state.size();
+	vec x = robPtr->state.x(), xmean, xfunc(n);
+	vec noise(12); noise.clear();
+	mat XNEW_x(n, n), XNEW_pert(n, 12);
+	robPtr->move_func(x, u, noise, 0.5, xfunc, XNEW_x, XNEW_pert);
+	JFR_CHECK(robPtr->move_mean(x, prev_reading, next_reading, xmean));
+	JFR_CHECK_EQUAL(xmean.size(), n);
+	JFR_CHECK_VEC_EQUAL(xmean, xfunc);
+}
+
 BOOST_AUTO_TEST_CASE( test_inertial )
 {
 	test_inertial01();
+	test_inertial02();
 }
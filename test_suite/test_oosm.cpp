@@ -0,0 +1,264 @@
+/**
+ * \file test_oosm.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Compares the processing of delayed GPS readings with retrodiction
+ *  (RobotStateHistory + correctDelayed) to strict in-order processing,
+ *  on a simulated 1D constant velocity robot also observed by a noisy
+ *  sensor at each step, checks that SensorAbsloc corrects a robot
+ *  with an out-of-sequence reading at its date, and the retrodiction at a
+ *  date between two snapshots.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+#include <boost/random.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <iostream>
+#include <deque>
+#include <cmath>
+
+#include "rtslam/kalmanFilter.hpp"
+#include "rtslam/robotStateHistory.hpp"
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorAbsloc.hpp"
+#include "rtslam/hardwareSensorAbstract.hpp"
+
+using namespace std;
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jblas;
+
+enum GpsMode { gpsInOrder, gpsDelayedNaive, gpsDelayedRetrodicted };
+
+void correctPosition(ExtendedKalmanFilterIndirect &filter, ind_array const &ia_x, double z, double R)
+{
+	Innovation inn(1);
+	mat INN(1,2); INN(0,0) = -1.; INN(0,1) = 0.;
+	inn.x()(0) = z - filter.x()(0);
+	inn.P()(0,0) = R + filter.P()(0,0);
+	filter.correct(ia_x, inn, INN, ia_x);
+}
+
+/// @return the RMS position error
+double simulate(GpsMode mode, boost::mt19937 &gen)
+{
+	boost::normal_distribution<> nd;
+	boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > noise(gen, nd);
+
+	const double dt = 0.05, q = 0.5, Rcam = 0.3*0.3, Rgps = 0.05*0.05;
+	const int nsteps = 600, gps_period = 20, gps_delay = 6;
+
+	mat F(2,2); F(0,0) = 1.; F(0,1) = dt; F(1,0) = 0.; F(1,1) = 1.;
+	sym_mat Q(2); Q(0,0) = q*dt*dt*dt/3.; Q(0,1) = q*dt*dt/2.; Q(1,1) = q*dt;
+	double l00 = sqrt(Q(0,0)), l10 = Q(0,1)/l00, l11 = sqrt(Q(1,1)-l10*l10);
+
+	ExtendedKalmanFilterIndirect filter(2);
+	ind_array ia_x = jmath::ublasExtra::ia_set(0,2);
+	filter.x().clear();
+	filter.P() = identity_mat(2);
+	RobotStateHistory history;
+	history.setWindow(2.);
+	history.push(0., filter.x());
+
+	vec truth(2); truth(0) = 0.; truth(1) = 1.;
+	std::deque<std::pair<double,double> > pending; // date and value of the gps readings not arrived yet
+	double sq_err = 0.;
+	int nerr = 0;
+
+	for(int k = 1; k <= nsteps; ++k)
+	{
+		double t = k*dt;
+		double n1 = noise(), n2 = noise();
+		truth = ublas::prod(F, truth);
+		truth(0) += l00*n1; truth(1) += l10*n1 + l11*n2;
+
+		history.update(filter.x());
+		filter.x() = ublas::prod(F, vec(filter.x()));
+		filter.predict(ia_x, F, ia_x, Q);
+		history.accumulate(F, Q);
+		history.push(t, filter.x());
+
+		if (k % gps_period == 0)
+		{
+			double z = truth(0) + 0.05*noise();
+			if (mode == gpsInOrder) correctPosition(filter, ia_x, z, Rgps);
+			else pending.push_back(std::make_pair(t, z));
+		}
+		while (!pending.empty() && pending.front().first + gps_delay*dt <= t + 1e-9)
+		{
+			double t_gps = pending.front().first, z = pending.front().second;
+			pending.pop_front();
+			vec x_t; mat X_x; sym_mat W;
+			if (mode == gpsDelayedRetrodicted && history.retrodict(t_gps, filter.x(), x_t, X_x, W))
+			{
+				Innovation inn(1);
+				mat INN = -ublas::subrange(X_x, 0,1, 0,2);
+				inn.x()(0) = z - x_t(0);
+				inn.P() = jmath::ublasExtra::prod_JPJt(filter.P(), INN);
+				inn.P()(0,0) += Rgps;
+				mat INN_w = -INN;
+				filter.correctDelayed(ia_x, inn, INN, ia_x, ia_x, INN_w, W);
+			} else
+				correctPosition(filter, ia_x, z, Rgps); // applied at the wrong date
+		}
+
+		correctPosition(filter, ia_x, truth(0) + 0.3*noise(), Rcam);
+
+		if (k > 50) { sq_err += (filter.x()(0)-truth(0))*(filter.x()(0)-truth(0)); ++nerr; }
+	}
+	return sqrt(sq_err/nerr);
+}
+
+
+void test_oosm01(void) {
+	const int nruns = 20;
+	double rms[3] = { 0., 0., 0. };
+	for(int mode = 0; mode < 3; ++mode)
+	{
+		boost::mt19937 gen(1);
+		for(int i = 0; i < nruns; ++i) rms[mode] += simulate(GpsMode(mode), gen) / nruns;
+	}
+	cout << "position RMS error: in order " << rms[gpsInOrder] << ", delayed naive " << rms[gpsDelayedNaive]
+	     << ", delayed retrodicted " << rms[gpsDelayedRetrodicted] << endl;
+
+	JFR_CHECK(rms[gpsDelayedRetrodicted] < rms[gpsDelayedNaive]);
+	JFR_CHECK(rms[gpsDelayedRetrodicted] < 1.5 * rms[gpsInOrder]);
+}
+
+
+/// position readings written by the test
+class HardwareSensorPos: public hardware::HardwareSensorProprioAbstract
+{
+	public:
+		HardwareSensorPos(kernel::VariableCondition<int> &condition):
+			HardwareSensorProprioAbstract(condition, 10, false) { addQuantity(qPos); }
+		virtual void start() {}
+		virtual double getLastTimestamp() { return 0.; }
+		/// @return the id of the raw
+		unsigned write(double date, double x, double y, double z, double std)
+		{
+			int pos = getWritePos();
+			RawVec &raw = buffer(pos);
+			raw.data.resize(readingSize());
+			raw.data(0) = date;
+			raw.data(1) = x; raw.data(2) = y; raw.data(3) = z;
+			raw.data(4) = raw.data(5) = raw.data(6) = std;
+			raw.arrival = date;
+			incWritePos();
+			return pos;
+		}
+};
+
+/// the robot state is set by the test instead of the first reading
+class SensorAbslocInitialized: public SensorAbsloc
+{
+	public:
+		SensorAbslocInitialized(const robot_ptr_t & robPtr): SensorAbsloc(robPtr, MapObject::UNFILTERED, true) { first = false; }
+};
+
+/**
+Moves a robot estimated 0.3 m ahead of the truth at 1 m/s during 1 s, and then
+processes a precise position reading of the date 0.5 s.
+@param window the duration of the robot history, 0 to process the reading at the current date
+@param P the variance of the position along x after the reading
+@return the position along x after the reading, 1 m being the truth
+*/
+double processLateReading(double window, double &P)
+{
+	map_ptr_t mapPtr(new MapAbstract(50));
+	robconstvel_ptr_t robPtr(new RobotConstantVelocity(mapPtr));
+	robPtr->linkToParentMap(mapPtr);
+	robPtr->pose.x(quaternion::originFrame());
+	robPtr->setPoseStd(0.3,0,0, 0,0,0, 1.,1.,1., 0,0,0);
+	robPtr->state.x()(7) = 1.; // velocity along x
+	robPtr->setVelocityStd(0.01, 0.001);
+	vec pertStd(6); pertStd.clear(); for(int i = 0; i < 6; ++i) pertStd(i) = 0.01;
+	robPtr->perturbation.set_std_continuous(pertStd);
+	robPtr->constantPerturbation = false;
+	robPtr->history.setWindow(window);
+
+	kernel::VariableCondition<int> condition(0);
+	boost::shared_ptr<HardwareSensorPos> hardPtr(new HardwareSensorPos(condition));
+	absloc_ptr_t senPtr(new SensorAbslocInitialized(robPtr));
+	senPtr->linkToParentRobot(robPtr);
+	senPtr->setPose(0,0,0, 0,0,0);
+	senPtr->setHardwareSensor(hardPtr);
+
+	for(int k = 0; k <= 10; ++k) robPtr->move(k*0.1);
+	senPtr->process(hardPtr->write(0.5, 0.5, 0., 0., 0.01));
+
+	P = robPtr->state.P()(0,0);
+	return robPtr->state.x()(0);
+}
+
+void test_oosm02(void) {
+	double P_retrodicted, P_naive, P_discarded;
+	double x_retrodicted = processLateReading(2., P_retrodicted);
+	double x_naive = processLateReading(0., P_naive);
+	double x_discarded = processLateReading(0.3, P_discarded); // the reading is older than the history
+	cout << "late absloc reading: x retrodicted " << x_retrodicted << " (var " << P_retrodicted << "), naive "
+	     << x_naive << ", discarded " << x_discarded << endl;
+
+	JFR_CHECK(fabs(x_retrodicted - 1.) < 0.05);
+	JFR_CHECK(P_retrodicted < 0.01);
+	JFR_CHECK(fabs(x_naive - 1.) > 0.4); // corrected towards the position of 0.5 s ago
+	JFR_CHECK(fabs(x_discarded - 1.3) < 1e-6);
+	JFR_CHECK(P_discarded > 0.5);
+}
+
+void test_oosm03(void) {
+	// a measurement between two snapshots is retrodicted with the part of the step after its date
+	const double q = 0.1;
+	RobotStateHistory history;
+	history.setWindow(10.);
+	vec x(2); x(0) = 0.; x(1) = 1.;
+	history.push(0., x);
+	for(int k = 1; k <= 2; ++k)
+	{
+		mat F(2,2); F(0,0) = 1.; F(0,1) = 1.; F(1,0) = 0.; F(1,1) = 1.;
+		sym_mat Q(2); Q.clear(); Q(1,1) = q;
+		history.update(x);
+		x = ublas::prod(F, x);
+		history.accumulate(F, Q);
+		history.push(k, x);
+	}
+
+	vec x_t; mat X_x; sym_mat W;
+	JFR_CHECK(history.retrodict(0.5, x, x_t, X_x, W));
+	JFR_CHECK(fabs(x_t(0) - 0.5) < 1e-12);
+	JFR_CHECK(fabs(x_t(1) - 1.) < 1e-12);
+	// inverse of the transition of 1.5 s
+	JFR_CHECK(fabs(X_x(0,0) - 1.) < 1e-12);
+	JFR_CHECK(fabs(X_x(0,1) + 1.5) < 1e-12);
+	JFR_CHECK(fabs(X_x(1,0)) < 1e-12);
+	JFR_CHECK(fabs(X_x(1,1) - 1.) < 1e-12);
+	JFR_CHECK(fabs(W(1,1) - 1.5*q) < 1e-12);
+
+	// at the date of a snapshot, the whole next step
+	JFR_CHECK(history.retrodict(1., x, x_t, X_x, W));
+	JFR_CHECK(fabs(x_t(0) - 1.) < 1e-12);
+	JFR_CHECK(fabs(X_x(0,1) + 1.) < 1e-12);
+	JFR_CHECK(fabs(W(1,1) - q) < 1e-12);
+	JFR_CHECK(!history.retrodict(2., x, x_t, X_x, W));
+}
+
+
+BOOST_AUTO_TEST_CASE( test_oosm )
+{
+	test_oosm01();
+	test_oosm02();
+	test_oosm03();
+}
@@ -0,0 +1,225 @@
+/**
+ * \file test_processGroup.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Processes a simulated robot with two cameras taking their images at the
+ *  same dates, either one camera after the other or both in a single
+ *  filter step with SensorExteroAbstract::processGroup, and checks that
+ *  both give the same estimate and maps of the same size. Also checks that
+ *  an error raised while matching in the thread of a sensor is thrown
+ *  again by processGroup.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "jmath/jblas.hpp"
+#include "jmath/ublasExtra.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/quatTools.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/mapManager.hpp"
+#include "rtslam/landmarkFactory.hpp"
+#include "rtslam/landmarkEuclideanPoint.hpp"
+#include "rtslam/landmarkAnchoredHomogeneousPoint.hpp"
+#include "rtslam/observationFactory.hpp"
+#include "rtslam/observationMakers.hpp"
+#include "rtslam/observationPinHoleEuclideanPoint.hpp"
+#include "rtslam/observationPinHoleAnchoredHomogeneous.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorPinhole.hpp"
+#include "rtslam/activeSearch.hpp"
+#include "rtslam/dataManagerOnePointRansac.hpp"
+#include "rtslam/simulator.hpp"
+#include "rtslam/simuRawProcessors.hpp"
+#include "rtslam/hardwareSensorAdhocSimulator.hpp"
+
+using namespace std;
+using namespace jblas;
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+typedef ImagePointObservationMaker<ObservationPinHoleEuclideanPoint, SensorPinhole, LandmarkEuclideanPoint,
+	 simu::AppearanceSimu, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_EUC> PinholeEucpSimuObservationMaker;
+typedef ImagePointObservationMaker<ObservationPinHoleAnchoredHomogeneousPoint, SensorPinhole, LandmarkAnchoredHomogeneousPoint,
+	simu::AppearanceSimu, SensorAbstract::PINHOLE, LandmarkAbstract::PNT_AH> PinholeAhpSimuObservationMaker;
+typedef DataManagerOnePointRansac<simu::RawSimu, SensorPinhole, simu::FeatureSimu, image::ConvexRoi, ActiveSearchGrid,
+	simu::DetectorSimu<image::ConvexRoi>, simu::MatcherSimu<image::ConvexRoi> > DataManager_ImagePoint_Ransac_Simu;
+
+const size_t simuRobotId = 1;
+const double frameFreq = 30.;
+const int imgWidth = 640, imgHeight = 480;
+
+
+/// the robot of demo_slam --simu=11 with two cameras looking forward
+struct SimuRig
+{
+	boost::shared_ptr<simu::AdhocSimulator> simulator;
+	kernel::VariableCondition<int> condition;
+	map_ptr_t mapPtr;
+	map_manager_ptr_t mmPoint;
+	robconstvel_ptr_t robPtr;
+	std::vector<sensor_ptr_t> sensors;
+
+	SimuRig(): simulator(new simu::AdhocSimulator()), condition(0), mapPtr(new MapAbstract(500))
+	{
+		// 3D regular grid
+		jblas::vec3 pose;
+		for(int z = -1; z <= 1; ++z) for(int y = -3; y <= 7; ++y) for(int x = -6; x <= 6; ++x)
+		{
+			pose(0) = x; pose(1) = y; pose(2) = z;
+			simulator->addLandmark(new simu::Landmark(LandmarkAbstract::POINT, pose));
+		}
+
+		// horizontal loop without rotation
+		simu::Robot *rob = new simu::Robot(simuRobotId, 6);
+		const double VEL = 0.5;
+		rob->addWaypoint(0,0,0, 0,0,0, 0,0,0, 0,0,0);
+		rob->addWaypoint(1,0,0, 0,0,0, VEL,0,0, 0,0,0);
+		rob->addWaypoint(3,2,0, 0,0,0, 0,VEL,0, 0,0,0);
+		rob->addWaypoint(1,4,0, 0,0,0, -VEL,0,0, 0,0,0);
+		simulator->addRobot(rob);
+
+		landmark_factory_ptr_t lmkFactory(new LandmarkFactory<LandmarkAnchoredHomogeneousPoint, LandmarkEuclideanPoint>());
+		mmPoint.reset(new MapManagerGlobal(lmkFactory, 0.1, 100000, 30, 0.5, 0.5));
+		mmPoint->linkToParentMap(mapPtr);
+
+		robPtr.reset(new RobotConstantVelocity(mapPtr));
+		robPtr->setId();
+		robPtr->linkToParentMap(mapPtr);
+		robPtr->setVelocityStd(0.5, 0.5);
+		vec pertStd(6); for(int i = 0; i < 6; ++i) pertStd(i) = 2.0;
+		robPtr->perturbation.set_std_continuous(pertStd);
+		robPtr->constantPerturbation = false;
+		robPtr->pose.x(quaternion::originFrame());
+		robPtr->setPoseStd(0,0,0, 0,0,0, 0,0,0, 0,0,0);
+
+		boost::shared_ptr<ObservationFactory> obsFact(new ObservationFactory());
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeEucpSimuObservationMaker(0.5, 13)));
+		obsFact->addMaker(boost::shared_ptr<ObservationMakerAbstract>(new PinholeAhpSimuObservationMaker(0.5, 13)));
+
+		addCamera(0.0, obsFact);
+		addCamera(0.3, obsFact);
+	}
+
+	/// each camera has its own detector, matcher and grid as required by processGroup
+	void addCamera(double y, boost::shared_ptr<ObservationFactory> obsFact)
+	{
+		pinhole_ptr_t senPtr(new SensorPinhole(robPtr, MapObject::UNFILTERED));
+		senPtr->setId();
+		senPtr->linkToParentRobot(robPtr);
+		senPtr->setPose(0, y, 0, -90, 0, -90);
+		vec4 k; k(0) = 320.; k(1) = 240.; k(2) = 500.; k(3) = 500.;
+		vec d(3); d(0) = -0.25; d(1) = 0.10; d(2) = 0.;
+		senPtr->params.setImgSize(imgWidth, imgHeight);
+		senPtr->params.setIntrinsicCalibration(k, d, 4);
+		senPtr->params.setMiscellaneous(1.0, 0.5);
+
+		jblas::vec6 pose;
+		ublas::subrange(pose, 0, 3) = ublas::subrange(senPtr->pose.x(), 0, 3);
+		ublas::subrange(pose, 3, 6) = quaternion::q2e(ublas::subrange(senPtr->pose.x(), 3, 7));
+		std::swap(pose(3), pose(5)); // FIXME-EULER-CONVENTION
+		simulator->addSensor(simuRobotId, new simu::Sensor(senPtr->id(), pose, senPtr));
+		simulator->addObservationModel(simuRobotId, senPtr->id(), LandmarkAbstract::POINT, new ObservationModelPinHoleEuclideanPoint(senPtr));
+
+		boost::shared_ptr<ActiveSearchGrid> asGrid(new ActiveSearchGrid(imgWidth, imgHeight, 3, 3, 11, 20));
+		boost::shared_ptr<simu::DetectorSimu<image::ConvexRoi> > detector(new simu::DetectorSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 13, 1.0, 0.5));
+		boost::shared_ptr<simu::MatcherSimu<image::ConvexRoi> > matcher(new simu::MatcherSimu<image::ConvexRoi>(LandmarkAbstract::POINT, 2, 13, 10000, 1.0, 0.90, 3.0, 2.0, 1.0, 0.5));
+		boost::shared_ptr<DataManager_ImagePoint_Ransac_Simu> dmPt(new DataManager_ImagePoint_Ransac_Simu(detector, matcher, asGrid, 20, 15, 6, 10, 3));
+		dmPt->linkToParentSensorSpec(senPtr);
+		dmPt->linkToParentMapManager(mmPoint);
+		dmPt->setObservationFactory(obsFact);
+
+		hardware::hardware_sensorext_ptr_t hardSen(new hardware::HardwareSensorAdhocSimulator(condition, frameFreq, simulator, simuRobotId, senPtr->id()));
+		senPtr->setHardwareSensor(hardSen);
+		sensors.push_back(senPtr);
+	}
+
+	/// process the images of both cameras, one after the other or grouped
+	void run(int nframes, bool grouped)
+	{
+		rtslam::srand(1);
+		for(int frame = 0; frame < nframes; ++frame)
+		{
+			std::vector<unsigned> ids(sensors.size(), frame);
+			robPtr->move(sensors[0]->getRawTimestamp(frame));
+			if (grouped)
+				SensorExteroAbstract::processGroup(sensors, ids);
+			else
+				for(size_t i = 0; i < sensors.size(); ++i) sensors[i]->process(ids[i]);
+		}
+	}
+};
+
+
+void test_processGroup01(void) {
+	const int nframes = 90;
+	SimuRig sequential, grouped;
+	sequential.run(nframes, false);
+	grouped.run(nframes, true);
+
+	vec truth = sequential.simulator->getRobotPose(simuRobotId, (nframes-1)/frameFreq);
+	vec3 pos_seq = ublas::subrange(sequential.robPtr->state.x(), 0, 3);
+	vec3 pos_grp = ublas::subrange(grouped.robPtr->state.x(), 0, 3);
+	vec3 pos_truth = ublas::subrange(truth, 0, 3);
+	double std_seq = sqrt(sequential.robPtr->state.P()(0,0) + sequential.robPtr->state.P()(1,1) + sequential.robPtr->state.P()(2,2));
+	double std_grp = sqrt(grouped.robPtr->state.P()(0,0) + grouped.robPtr->state.P()(1,1) + grouped.robPtr->state.P()(2,2));
+	size_t nlmk_seq = sequential.mmPoint->landmarkList().size(), nlmk_grp = grouped.mmPoint->landmarkList().size();
+	cout << "two cameras: sequential position " << pos_seq << " (std " << std_seq << ", " << nlmk_seq << " landmarks), grouped "
+	     << pos_grp << " (std " << std_grp << ", " << nlmk_grp << " landmarks), truth " << pos_truth << endl;
+
+	// only the random draws and the linearization point of the corrections differ
+	JFR_CHECK(ublas::norm_2(pos_grp - pos_seq) < 3.*std_seq + 0.05);
+	JFR_CHECK(std_grp < 2.*std_seq && std_seq < 2.*std_grp);
+	JFR_CHECK(ublas::norm_2(pos_seq - pos_truth) < 0.5);
+	JFR_CHECK(ublas::norm_2(pos_grp - pos_truth) < 0.5);
+	// the landmarks are searched and deleted as often
+	JFR_CHECK(nlmk_seq > 0);
+	JFR_CHECK(fabs((double)nlmk_grp - (double)nlmk_seq) <= 0.25*nlmk_seq + 2);
+}
+
+
+/// data manager whose matching always fails
+class DataManagerFailing: public DataManagerAbstract
+{
+	public:
+		void processKnown(raw_ptr_t data) {}
+		void detectNew(raw_ptr_t data) {}
+		bool supportsGroupedUpdate() { return true; }
+		void matchKnown(raw_ptr_t data, unsigned seed)
+			{ JFR_ERROR(RtslamException, RtslamException::GENERIC_ERROR, "matching failed"); }
+};
+
+void test_processGroup02(void) {
+	// the second sensor is matched in another thread, its error must be thrown by processGroup
+	SimuRig rig;
+	boost::shared_ptr<DataManagerFailing> dmFailing(new DataManagerFailing());
+	dmFailing->linkToParentSensor(SPTR_CAST<SensorExteroAbstract>(rig.sensors[1]));
+	std::vector<unsigned> ids(rig.sensors.size(), 0);
+	rig.robPtr->move(0.);
+	bool thrown = false;
+	try { SensorExteroAbstract::processGroup(rig.sensors, ids); }
+	catch (kernel::Exception &e) { thrown = true; }
+	JFR_CHECK(thrown);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_processGroup )
+{
+	test_processGroup01();
+	test_processGroup02();
+}
@@ -0,0 +1,74 @@
+/**
+ * \file test_quickHarris.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that QuickHarrisDetector finds the same points with the data
+ *  prepared in advance for the whole image as when it processes each
+ *  region of interest alone.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <cstdlib>
+
+#include "image/Image.hpp"
+#include "image/roi.hpp"
+
+#include "rtslam/quickHarrisDetector.hpp"
+#include "rtslam/featurePoint.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+void test_quickHarris01(void) {
+	// random texture with a bright square, so that there are corners and flat areas
+	image::Image img(97, 71, CV_8U, JfrImage_CS_GRAY);
+	srand(3);
+	for(int i = 0; i < img.height(); ++i)
+		for(int j = 0; j < img.width(); ++j)
+			img.data()[i*img.step()+j] = (i >= 20 && i < 40 && j >= 30 && j < 50 ? 250 : rand() % 256);
+
+	for(int convSize = 3; convSize <= 9; convSize += 2)
+	{
+		QuickHarrisDetector detector(convSize, 0.0, 100.0);
+		HarrisImage prepared;
+		JFR_CHECK(detector.prepare(img, prepared));
+
+		for(int k = 0; k < 200; ++k)
+		{
+			// regions touching the borders of the image too
+			int w = 5 + rand() % 40, h = 5 + rand() % 40;
+			int x = rand() % (img.width()-w+1), y = rand() % (img.height()-h+1);
+			image::ConvexRoi roi;
+			roi.init(cv::Rect(x, y, w, h));
+
+			feat_img_pnt_ptr_t feat1(new FeatureImagePoint(7, 7, CV_8U));
+			feat_img_pnt_ptr_t feat2(new FeatureImagePoint(7, 7, CV_8U));
+			bool found1 = detector.detectIn(img, feat1, &roi);
+			bool found2 = detector.detectIn(img, feat2, &roi, &prepared);
+			JFR_CHECK_EQUAL(found1, found2);
+			if (found1 && found2)
+			{
+				JFR_CHECK_EQUAL(feat1->measurement.x(0), feat2->measurement.x(0));
+				JFR_CHECK_EQUAL(feat1->measurement.x(1), feat2->measurement.x(1));
+				JFR_CHECK_EQUAL(feat1->measurement.matchScore, feat2->measurement.matchScore);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_quickHarris )
+{
+	test_quickHarris01();
+}
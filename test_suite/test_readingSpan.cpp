@@ -0,0 +1,112 @@
+/**
+ * \file test_readingSpan.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that the readings of a ring buffer are exposed in place by
+ *  ReadingSpan, in chronological order across the end of the buffer,
+ *  and the spans that the estimators acquire from their ring buffer.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <boost/shared_ptr.hpp>
+
+#include "jmath/indirectArray.hpp"
+
+#include "rtslam/hardwareEstimatorAbstract.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam::hardware;
+using namespace jblas;
+
+
+void test_readingSpan01(void) {
+	// ring buffer of 5 readings, the oldest at row 3: t = 1 2 | 3 4 5 at rows 3 4 | 0 1 2
+	mat buffer(5, 3);
+	for(int k = 0; k < 5; ++k)
+	{
+		int row = (k+3) % 5;
+		buffer(row, 0) = k+1.;
+		buffer(row, 1) = 10.*(k+1);
+		buffer(row, 2) = -1.*(k+1);
+	}
+
+	ReadingSpan span(buffer, 4, 3, 2.5, 3.5);
+	JFR_CHECK_EQUAL(span.size(), 3u);
+	JFR_CHECK_EQUAL(span.width(), 3u);
+	JFR_CHECK(span[0] == &buffer(4,0)); // no copy
+	JFR_CHECK(span[1] == &buffer(0,0));
+
+	double t = 2.;
+	for(ReadingSpan::const_iterator it = span.begin(); it != span.end(); ++it, t += 1.)
+		JFR_CHECK_EQUAL((*it)[0], t);
+	JFR_CHECK_EQUAL(t, 5.);
+
+	ReadingSpan empty(buffer, 0, 0, 0., 1.);
+	JFR_CHECK(empty.empty());
+	JFR_CHECK(empty.begin() == empty.end());
+}
+
+
+/// ring buffer of readings filled like the acquisition thread of MTI or odometry does
+class RingEstimator: public HardwareEstimatorAbstract
+{
+	public:
+		mat buffer;
+		int write_position;
+		RingEstimator(int bufferSize): buffer(bufferSize, 2), write_position(0)
+			{ for(int i = 0; i < bufferSize; ++i) buffer(i,0) = -1.; }
+		void push(double t)
+		{
+			buffer(write_position, 0) = t; buffer(write_position, 1) = 10.*t;
+			write_position = (write_position+1) % buffer.size1();
+		}
+		ReadingSpan acquireSpan(double t1, double t2) { int i1; return findSpan(buffer, write_position, t1, t2, i1); }
+		mat_indirect acquireReadings(double t1, double t2)
+			{ return ublas::project(buffer, jmath::ublasExtra::ia_set(ublas::range(0,0)), jmath::ublasExtra::ia_set(ublas::range(0,2))); }
+		void releaseReadings() {}
+		ind_array instantValues() { return jmath::ublasExtra::ia_set(ublas::range(1,2)); }
+		ind_array incrementValues() { return jmath::ublasExtra::ia_set(ublas::range(1,1)); }
+};
+
+void test_readingSpan02(void) {
+	RingEstimator estimator(8);
+	JFR_CHECK(estimator.acquireSpan(0., 1.).empty()); // no data yet
+
+	// 11 readings in 8 rows, t = 4..11 remain with t = 9 at row 0
+	for(int t = 1; t <= 11; ++t) estimator.push(t);
+
+	// the last reading before t1 and the first after t2, across the end of the buffer
+	ReadingSpan span = estimator.acquireSpan(6.5, 9.5);
+	JFR_CHECK_EQUAL(span.size(), 5u);
+	JFR_CHECK(span[0] == &estimator.buffer(5,0)); // t = 6, in place
+	double t = 6.;
+	for(ReadingSpan::const_iterator it = span.begin(); it != span.end(); ++it, t += 1.)
+	{
+		JFR_CHECK_EQUAL((*it)[0], t);
+		JFR_CHECK_EQUAL((*it)[1], 10.*t);
+	}
+	JFR_CHECK_EQUAL(t, 11.);
+
+	// exactly on readings
+	span = estimator.acquireSpan(8., 10.);
+	JFR_CHECK_EQUAL(span[0][0], 7.);
+	JFR_CHECK_EQUAL(span[span.size()-1][0], 10.);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_readingSpan )
+{
+	test_readingSpan01();
+	test_readingSpan02();
+}
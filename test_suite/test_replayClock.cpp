@@ -0,0 +1,147 @@
+/**
+ * \file test_replayClock.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that the virtual clock of replay advances at its rate from the
+ *  date it is started with, that it wakes up the processing loop at the
+ *  requested dates in chronological order and only once started, and the
+ *  bins and printing of the real-time statistics histograms.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <boost/thread.hpp>
+#include <boost/lambda/lambda.hpp>
+
+#include "rtslam/replayClock.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::rtslam::hardware;
+
+
+void sleepFor(double duration)
+{
+	boost::this_thread::sleep(boost::posix_time::microseconds((long)(duration*1e6)));
+}
+
+/// @return whether the clock notified the condition before timeout (real seconds)
+bool waitWake(kernel::VariableCondition<int> &condition, double timeout)
+{
+	bool woken = condition.timed_wait(boost::lambda::_1 != 0, boost::posix_time::microseconds((long)(timeout*1e6)));
+	condition.set(0);
+	return woken;
+}
+
+
+void test_replayClock01(void) {
+	// virtual time advance
+	kernel::VariableCondition<int> condition(0);
+	const double rate = 10.;
+	ReplayClock clock(condition, rate);
+	JFR_CHECK(!clock.isStarted());
+	JFR_CHECK_EQUAL(clock.now(), 0.);
+
+	clock.start(100.);
+	double wall_start = kernel::Clock::getTime();
+	JFR_CHECK(clock.isStarted());
+	JFR_CHECK(clock.now() >= 100. && clock.now() < 100.5);
+	sleepFor(0.05);
+	double expected = 100. + (kernel::Clock::getTime() - wall_start) * rate;
+	JFR_CHECK(std::fabs(clock.now() - expected) < 0.05*rate);
+	JFR_CHECK(clock.now() >= 100.5);
+
+	// starting again doesn't move the clock
+	clock.start(200.);
+	JFR_CHECK(clock.now() < 200.);
+}
+
+void test_replayClock02(void) {
+	// wake up in chronological order, whatever the order of the requests
+	kernel::VariableCondition<int> condition(0);
+	const double rate = 10.;
+	ReplayClock clock(condition, rate);
+	clock.start(0.);
+	const double dates[] = { 1., 2., 3. };
+	clock.notifyAt(dates[2]);
+	clock.notifyAt(dates[0]);
+	clock.notifyAt(dates[1]);
+	clock.notifyAt(dates[1]); // only once
+
+	std::vector<double> wakes;
+	while (waitWake(condition, 1.)) wakes.push_back(clock.now());
+	JFR_CHECK_EQUAL(wakes.size(), 3u);
+	for(size_t i = 0; i < wakes.size() && i < 3; ++i)
+	{
+		JFR_CHECK(wakes[i] >= dates[i]);
+		JFR_CHECK(wakes[i] < dates[i] + 0.05*rate); // loose, the machine may be loaded
+	}
+
+	// dates already reached wake up immediately
+	double start = kernel::Clock::getTime();
+	clock.notifyAt(0.5);
+	JFR_CHECK(waitWake(condition, 1.));
+	JFR_CHECK(kernel::Clock::getTime() - start < 0.1);
+}
+
+void test_replayClock03(void) {
+	// the clock doesn't wake anybody before it is started
+	kernel::VariableCondition<int> condition(0);
+	ReplayClock clock(condition, 1.);
+	clock.notifyAt(10.);
+	JFR_CHECK(!waitWake(condition, 0.1));
+	clock.start(10.);
+	JFR_CHECK(waitWake(condition, 1.));
+}
+
+void test_replayClock04(void) {
+	// bins, the last one gathering the larger values and the first one the negative ones
+	Histogram histo(0.01, 4);
+	JFR_CHECK_EQUAL(histo.nbins(), 4u);
+	const double values[] = { 0.005, 0.015, 0.017, 0.035, 0.5, -0.1 };
+	for(int i = 0; i < 6; ++i) histo.add(values[i]);
+	JFR_CHECK_EQUAL(histo.size(), 6u);
+	JFR_CHECK_EQUAL(histo.bin(0), 2u);
+	JFR_CHECK_EQUAL(histo.bin(1), 2u);
+	JFR_CHECK_EQUAL(histo.bin(2), 0u);
+	JFR_CHECK_EQUAL(histo.bin(3), 2u);
+	JFR_CHECK(std::fabs(histo.mean() - 0.472/6) < 1e-12);
+	JFR_CHECK_EQUAL(histo.max(), 0.5);
+
+	// the stream of the caller keeps its format
+	std::ostringstream oss;
+	oss << std::scientific << std::setprecision(3);
+	histo.print(oss, "test");
+	JFR_CHECK((oss.flags() & std::ios_base::floatfield) == std::ios_base::scientific);
+	JFR_CHECK_EQUAL(oss.precision(), 3);
+	std::string out = oss.str();
+	JFR_CHECK(out.find("(33.3%)") != std::string::npos);
+	JFR_CHECK(out.find("inf") != std::string::npos);
+	JFR_CHECK_EQUAL(std::count(out.begin(), out.end(), '\n'), 4);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_replayClock )
+{
+	test_replayClock01();
+	test_replayClock02();
+	test_replayClock03();
+	test_replayClock04();
+}
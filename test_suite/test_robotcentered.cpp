@@ -313,9 +313,12 @@ void demo_slam01_display(world_ptr_t *world) {
 			viewerQt = new display::ViewerQt();
 			(*world)->addDisplayViewer(viewerQt, display::ViewerQt::id());
 		}
-		viewerQt->bufferize(*world);
+		static display::WorldSnapshotBuffer snapshots;
+		snapshots.publish(*world, (*world)->t);
+		display::world_snapshot_cptr_t snapshot = snapshots.acquire(0);
 		(*world)->display_mutex.unlock();
 		
+		viewerQt->bufferize(*snapshot);
 		viewerQt->render();
 	} else
 	{
@@ -0,0 +1,260 @@
+/**
+ * \file test_sensorManager.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Drives SensorManagerScheduler with stub hardware sensors, and checks
+ *  the order in which the raws are used and those that are dropped by
+ *  each policy (all, latest, decimate, deadline), both offline (replay)
+ *  and online, as well as the waiting for a late sensor that is given up
+ *  after its maximum lateness.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include <boost/thread.hpp>
+
+#include "rtslam/rtSlam.hpp"
+#include "rtslam/mapAbstract.hpp"
+#include "rtslam/robotConstantVelocity.hpp"
+#include "rtslam/sensorAbstract.hpp"
+#include "rtslam/sensorManager.hpp"
+#include "rtslam/hardwareSensorAbstract.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+/// raws written by the test, the next one being predicted from the last timestamp and the timing infos
+class HardwareSensorStub: public hardware::HardwareSensorProprioAbstract
+{
+	private:
+		double last_timestamp;
+	public:
+		HardwareSensorStub(kernel::VariableCondition<int> &condition, double data_period, double arrival_delay, double last_timestamp):
+			HardwareSensorProprioAbstract(condition, 20, false), last_timestamp(last_timestamp)
+			{ addQuantity(qPos); setTimingInfos(data_period, arrival_delay); }
+		virtual void start() {}
+		virtual double getLastTimestamp() { return last_timestamp; }
+		void write(double timestamp)
+		{
+			RawVec &raw = buffer(getWritePos());
+			raw.data.resize(readingSize());
+			raw.data.clear();
+			raw.data(0) = timestamp;
+			raw.arrival = timestamp;
+			last_timestamp = timestamp;
+			incWritePos();
+		}
+		void finish() { boost::unique_lock<boost::mutex> l(mutex_data); setNoMoreData(); }
+};
+typedef boost::shared_ptr<HardwareSensorStub> hardware_sensor_stub_ptr_t;
+
+/// processing a raw only consumes it
+class SensorStub: public SensorProprioAbstract
+{
+	public:
+		SensorStub(const robot_ptr_t & robPtr): SensorProprioAbstract(robPtr) {}
+		void process(unsigned id) { hardwareSensorPtr->getRaw(id, reading); }
+};
+
+struct Rig
+{
+	map_ptr_t mapPtr;
+	robconstvel_ptr_t robPtr;
+	kernel::VariableCondition<int> condition;
+	std::vector<sensor_ptr_t> sensors;
+	std::vector<hardware_sensor_stub_ptr_t> hards;
+
+	Rig(): mapPtr(new MapAbstract(50)), robPtr(new RobotConstantVelocity(mapPtr)), condition(0)
+		{ robPtr->linkToParentMap(mapPtr); }
+	/// @return the rank of the sensor
+	int add(bool integrate_all, double data_period = 0., double arrival_delay = 0., double last_timestamp = 0.)
+	{
+		boost::shared_ptr<SensorStub> senPtr(new SensorStub(robPtr));
+		senPtr->linkToParentRobot(robPtr);
+		senPtr->setIntegrationPolicy(integrate_all);
+		hardware_sensor_stub_ptr_t hardPtr(new HardwareSensorStub(condition, data_period, arrival_delay, last_timestamp));
+		senPtr->setHardwareSensor(hardPtr);
+		sensors.push_back(senPtr); hards.push_back(hardPtr);
+		return sensors.size()-1;
+	}
+};
+
+struct Use
+{
+	int sensor; double timestamp;
+	Use(int sensor, double timestamp): sensor(sensor), timestamp(timestamp) {}
+};
+
+/**
+Processes the data returned by the manager until it has none.
+@return whether the manager returned no data because there will never be any more
+*/
+bool runManager(SensorManagerAbstract &manager, Rig &rig, std::vector<Use> &uses)
+{
+	while (true)
+	{
+		SensorManagerAbstract::ProcessInfo pinfo = manager.getNextDataToUse();
+		if (!pinfo.sen) return pinfo.no_more_data;
+		int sensor = -1;
+		for(unsigned i = 0; i < rig.sensors.size(); ++i) if (rig.sensors[i] == pinfo.sen) sensor = i;
+		uses.push_back(Use(sensor, pinfo.sen->getRawTimestamp(pinfo.id)));
+		pinfo.sen->process(pinfo.id);
+	}
+}
+
+void checkUses(std::vector<Use> const &uses, int const *sensors, double const *timestamps, unsigned n, double t0 = 0.)
+{
+	JFR_CHECK_EQUAL(uses.size(), n);
+	for(unsigned i = 0; i < n && i < uses.size(); ++i)
+	{
+		JFR_CHECK_EQUAL(uses[i].sensor, sensors[i]);
+		JFR_CHECK(std::fabs(uses[i].timestamp - (t0 + timestamps[i])) < 1e-6);
+	}
+}
+
+
+void test_sensorManager01(void) {
+	// offline all and latest: waits for all the sensors, and the latest policy behaves as all to be repeatable
+	Rig rig;
+	int all = rig.add(true), latest = rig.add(false);
+	SensorManagerScheduler manager(rig.mapPtr, true);
+	rig.hards[all]->write(1.); rig.hards[all]->write(2.); rig.hards[all]->write(3.);
+
+	std::vector<Use> uses;
+	JFR_CHECK(!runManager(manager, rig, uses)); // the latest sensor may still provide older data
+	JFR_CHECK_EQUAL(uses.size(), 0u);
+
+	rig.hards[latest]->write(1.5); rig.hards[latest]->write(2.5);
+	rig.hards[all]->finish(); rig.hards[latest]->finish();
+	JFR_CHECK(runManager(manager, rig, uses));
+	const int sensors[] = { all, latest, all, latest, all };
+	const double timestamps[] = { 1., 1.5, 2., 2.5, 3. };
+	checkUses(uses, sensors, timestamps, 5);
+	JFR_CHECK_EQUAL(manager.getUsedCount(), 5u);
+	JFR_CHECK_EQUAL(manager.getDroppedCount(), 0u);
+}
+
+void test_sensorManager02(void) {
+	// decimate: one raw out of 3, the same offline and online
+	for(int offline = 1; offline >= 0; --offline)
+	{
+		Rig rig;
+		int dec = rig.add(true);
+		SensorManagerScheduler manager(rig.mapPtr, offline);
+		manager.setPolicy(rig.sensors[dec], SensorManagerScheduler::Policy(SensorManagerScheduler::Policy::pDecimate, 3));
+		for(int i = 1; i <= 7; ++i) rig.hards[dec]->write(i);
+		rig.hards[dec]->finish();
+
+		std::vector<Use> uses;
+		JFR_CHECK(runManager(manager, rig, uses));
+		const int sensors[] = { dec, dec, dec };
+		const double timestamps[] = { 1., 4., 7. };
+		checkUses(uses, sensors, timestamps, 3);
+		JFR_CHECK_EQUAL(manager.getDroppedCount(), 4u);
+	}
+}
+
+void test_sensorManager03(void) {
+	// deadline: online the raws older than the deadline are dropped, offline they are all used
+	for(int offline = 1; offline >= 0; --offline)
+	{
+		Rig rig;
+		int dl = rig.add(true);
+		SensorManagerScheduler manager(rig.mapPtr, offline);
+		manager.setPolicy(rig.sensors[dl], SensorManagerScheduler::Policy(SensorManagerScheduler::Policy::pDeadline, 1, 0.2));
+		double t0 = kernel::Clock::getTime();
+		const double written[] = { -0.5, -0.3, -0.1, -0.05 };
+		for(int i = 0; i < 4; ++i) rig.hards[dl]->write(t0 + written[i]);
+		rig.hards[dl]->finish();
+
+		std::vector<Use> uses;
+		JFR_CHECK(runManager(manager, rig, uses));
+		const int sensors[] = { dl, dl, dl, dl };
+		if (offline)
+		{
+			checkUses(uses, sensors, written, 4, t0);
+			JFR_CHECK_EQUAL(manager.getDroppedCount(), 0u);
+		} else
+		{
+			checkUses(uses, sensors, written+2, 2, t0);
+			JFR_CHECK_EQUAL(manager.getDroppedCount(), 2u);
+		}
+	}
+}
+
+void test_sensorManager04(void) {
+	// online all and latest: chronological order, the latest policy skips its older raws
+	Rig rig;
+	double t0 = kernel::Clock::getTime();
+	// the next raw of the all sensor should already have arrived, so it doesn't block
+	int all = rig.add(true, 0.1, 0., t0), latest = rig.add(false);
+	SensorManagerScheduler manager(rig.mapPtr);
+	rig.hards[all]->write(t0-0.3); rig.hards[all]->write(t0-0.2);
+	rig.hards[latest]->write(t0-0.35); rig.hards[latest]->write(t0-0.25); rig.hards[latest]->write(t0-0.15);
+
+	std::vector<Use> uses;
+	JFR_CHECK(!runManager(manager, rig, uses));
+	const int sensors[] = { all, all, latest };
+	const double timestamps[] = { -0.3, -0.2, -0.15 };
+	checkUses(uses, sensors, timestamps, 3, t0);
+	JFR_CHECK_EQUAL(manager.getDroppedCount(), 2u);
+	JFR_CHECK(manager.getWakeDate() == std::numeric_limits<double>::infinity());
+}
+
+void test_sensorManager05(void) {
+	// online, waiting for a late sensor: the latest policy falls back on a raw older than its next predicted raw,
+	// then the manager waits until its predicted arrival plus its max lateness, and gives it up
+	Rig rig;
+	double t0 = kernel::Clock::getTime();
+	// next raw predicted at t0-0.1, arriving at t0+0.4
+	int late = rig.add(true, 0.1, 0.5, t0-0.2), latest = rig.add(false);
+	SensorManagerScheduler manager(rig.mapPtr);
+	const double max_lateness = 0.05;
+	manager.setPolicy(rig.sensors[late], SensorManagerScheduler::Policy(SensorManagerScheduler::Policy::pAll, 1, 0., max_lateness));
+	rig.hards[latest]->write(t0-0.25); rig.hards[latest]->write(t0-0.15); rig.hards[latest]->write(t0-0.05);
+
+	std::vector<Use> uses;
+	JFR_CHECK(!runManager(manager, rig, uses));
+	const int sensors[] = { latest, latest };
+	const double timestamps[] = { -0.15, -0.05 };
+	checkUses(uses, sensors, timestamps, 1, t0);
+	JFR_CHECK_EQUAL(manager.getDroppedCount(), 1u);
+	double wake_date = manager.getWakeDate();
+	JFR_CHECK(std::fabs(wake_date - (t0 + 0.4 + max_lateness)) < 1e-5);
+
+	// nothing changes before the wake date
+	JFR_CHECK(!runManager(manager, rig, uses));
+	JFR_CHECK_EQUAL(uses.size(), 1u);
+
+	double wait = wake_date + 0.01 - kernel::Clock::getTime();
+	if (wait > 0.) boost::this_thread::sleep(boost::posix_time::microseconds((long)(wait*1e6)));
+	JFR_CHECK(!runManager(manager, rig, uses));
+	checkUses(uses, sensors, timestamps, 2, t0);
+	JFR_CHECK(manager.getWakeDate() == std::numeric_limits<double>::infinity());
+}
+
+
+BOOST_AUTO_TEST_CASE( test_sensorManager )
+{
+	test_sensorManager01();
+	test_sensorManager02();
+	test_sensorManager03();
+	test_sensorManager04();
+	test_sensorManager05();
+}
@@ -0,0 +1,227 @@
+/**
+ * \file test_shmImageRing.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Runs the producer and the consumer of the shared memory image ring in
+ *  the same process, and checks that the frames are delivered in order and
+ *  in place, that the producer drops the new frames instead of overwriting
+ *  those still used by the consumer, the returns of waitFrame on timeout
+ *  and when the ring is closed, and that a consumer that died without
+ *  detaching does not block the producer.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sstream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "rtslam/shmImageRing.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+using namespace jafar::rtslam::hardware;
+
+
+const unsigned width = 8, height = 4, nslots = 3;
+
+std::string testSegmentName()
+{
+	std::ostringstream oss; oss << "/rtslam_test_ring_" << getpid();
+	return oss.str();
+}
+
+/// every pixel of frame k is k
+bool writeFrame(shm_image_ring_ptr_t producer, int k)
+{
+	std::vector<unsigned char> image(width*height, (unsigned char)k);
+	return producer->write(&image[0], width, k, k+0.5);
+}
+
+/// @return whether frame k is in the ring with all its pixels
+bool checkFrame(shm_image_ring_ptr_t consumer, int k)
+{
+	shm::FrameHeader const *f = consumer->frame(k);
+	if (!f || f->timestamp != k || f->arrival != k+0.5) return false;
+	const unsigned char *data = consumer->data(k);
+	for(unsigned y = 0; y < f->height; ++y)
+		for(unsigned x = 0; x < f->width; ++x)
+			if (data[y*f->step + x] != (unsigned char)k) return false;
+	return true;
+}
+
+void closeLater(shm_image_ring_ptr_t producer, double delay)
+{
+	boost::this_thread::sleep(boost::posix_time::microseconds((long)(delay*1e6)));
+	producer->close();
+}
+
+void writeLater(shm_image_ring_ptr_t producer, int k, double delay)
+{
+	boost::this_thread::sleep(boost::posix_time::microseconds((long)(delay*1e6)));
+	writeFrame(producer, k);
+}
+
+
+void test_shmImageRing01(void) {
+	// frames delivered in order and in place
+	std::string name = testSegmentName();
+	JFR_CHECK(!ShmImageRing::open(name).get());
+	shm_image_ring_ptr_t producer = ShmImageRing::create(name, nslots, width, height);
+	shm_image_ring_ptr_t consumer = ShmImageRing::open(name);
+	JFR_CHECK(consumer.get());
+	JFR_CHECK_EQUAL(consumer->slots(), nslots);
+	JFR_CHECK_EQUAL(consumer->format().width, width);
+	JFR_CHECK_EQUAL(consumer->format().height, height);
+	JFR_CHECK(consumer->format().step >= width);
+
+	uint64_t seq = consumer->attach();
+	JFR_CHECK_EQUAL(seq, 0u);
+	for(int k = 0; k < (int)nslots; ++k) JFR_CHECK(writeFrame(producer, k));
+	for(int k = 0; k < (int)nslots; ++k)
+	{
+		JFR_CHECK(consumer->waitFrame(k, 0.));
+		JFR_CHECK(checkFrame(consumer, k));
+		JFR_CHECK_EQUAL(consumer->frame(k)->seq, (uint64_t)k);
+	}
+	JFR_CHECK(!consumer->frame(nslots));
+
+	// the consumer sees the slot written by the producer, not a copy of it
+	consumer->releaseUntil(1);
+	unsigned char *slot = producer->beginWrite();
+	JFR_CHECK(slot);
+	const unsigned char *data = consumer->data(nslots);
+	slot[0] = 42;
+	JFR_CHECK_EQUAL((int)data[0], 42);
+	producer->commitWrite(nslots, nslots+0.5);
+	JFR_CHECK(consumer->waitFrame(nslots, 0.));
+	JFR_CHECK(consumer->data(nslots) == data);
+	JFR_CHECK(!consumer->frame(0)); // overwritten by frame nslots
+	JFR_CHECK(checkFrame(consumer, 1));
+	JFR_CHECK_EQUAL(producer->dropped(), 0u);
+
+	producer.reset();
+	JFR_CHECK(!ShmImageRing::open(name).get());
+}
+
+void test_shmImageRing02(void) {
+	// frames still used by the consumer are not overwritten, the new ones are dropped
+	std::string name = testSegmentName();
+	shm_image_ring_ptr_t producer = ShmImageRing::create(name, nslots, width, height);
+	shm_image_ring_ptr_t consumer = ShmImageRing::open(name);
+
+	// without consumer, the producer overwrites freely
+	for(int k = 0; k < 5; ++k) JFR_CHECK(writeFrame(producer, k));
+	JFR_CHECK_EQUAL(producer->dropped(), 0u);
+	JFR_CHECK(!consumer->frame(1));
+
+	// the consumer gets the frames written after it attached
+	uint64_t seq = consumer->attach();
+	JFR_CHECK_EQUAL(seq, 5u);
+	for(int k = 5; k < 5+(int)nslots; ++k) JFR_CHECK(writeFrame(producer, k));
+	JFR_CHECK(producer->isFull());
+	JFR_CHECK(!writeFrame(producer, 8));
+	JFR_CHECK(!writeFrame(producer, 9));
+	JFR_CHECK_EQUAL(producer->dropped(), 2u);
+	for(int k = 5; k < 5+(int)nslots; ++k) JFR_CHECK(checkFrame(consumer, k));
+
+	// releasing the oldest frame frees one slot
+	consumer->releaseUntil(6);
+	JFR_CHECK(!producer->isFull());
+	JFR_CHECK(writeFrame(producer, 8));
+	JFR_CHECK(!consumer->frame(5));
+	JFR_CHECK(checkFrame(consumer, 6));
+	JFR_CHECK(checkFrame(consumer, 8));
+	// releasing an older frame doesn't give back the slots
+	consumer->releaseUntil(5);
+	JFR_CHECK(!writeFrame(producer, 9));
+	JFR_CHECK_EQUAL(producer->dropped(), 3u);
+	JFR_CHECK(checkFrame(consumer, 6));
+
+	// once detached, the producer doesn't care anymore
+	consumer->detach();
+	JFR_CHECK(writeFrame(producer, 9));
+	JFR_CHECK(!consumer->frame(6));
+}
+
+void test_shmImageRing03(void) {
+	// waitFrame on timeout, on a new frame and when the ring is closed
+	std::string name = testSegmentName();
+	shm_image_ring_ptr_t producer = ShmImageRing::create(name, nslots, width, height);
+	shm_image_ring_ptr_t consumer = ShmImageRing::open(name);
+	uint64_t seq = consumer->attach();
+
+	double start = kernel::Clock::getTime();
+	JFR_CHECK(!consumer->waitFrame(seq, 0.05));
+	double waited = kernel::Clock::getTime() - start;
+	JFR_CHECK(waited >= 0.04 && waited < 1.);
+	JFR_CHECK(!consumer->isClosed());
+
+	boost::thread writer(boost::bind(writeLater, producer, 0, 0.05));
+	JFR_CHECK(consumer->waitFrame(seq, 5.));
+	writer.join();
+	JFR_CHECK(checkFrame(consumer, 0));
+
+	start = kernel::Clock::getTime();
+	boost::thread closer(boost::bind(closeLater, producer, 0.05));
+	JFR_CHECK(!consumer->waitFrame(seq+1, 5.));
+	closer.join();
+	JFR_CHECK(kernel::Clock::getTime() - start < 1.);
+	JFR_CHECK(consumer->isClosed());
+	// the frames published before closing can still be waited for
+	JFR_CHECK(consumer->waitFrame(seq, 0.));
+}
+
+void test_shmImageRing04(void) {
+	// a consumer that died without detaching doesn't make the producer drop every frame
+	std::string name = testSegmentName();
+	shm_image_ring_ptr_t producer = ShmImageRing::create(name, nslots, width, height);
+
+	pid_t pid = fork();
+	JFR_CHECK(pid >= 0);
+	if (pid == 0)
+	{
+		shm_image_ring_ptr_t consumer = ShmImageRing::open(name);
+		if (consumer) consumer->attach();
+		_exit(consumer ? 0 : 1); // without destroying the ring, so without detaching
+	}
+	int status = 0;
+	JFR_CHECK_EQUAL(waitpid(pid, &status, 0), pid);
+	JFR_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	// the consumer doesn't release anything, but the producer finds out it is dead once the ring is full
+	for(int k = 0; k < 3*(int)nslots; ++k) JFR_CHECK(writeFrame(producer, k));
+	JFR_CHECK_EQUAL(producer->dropped(), 0u);
+
+	// another consumer can attach and is protected again
+	shm_image_ring_ptr_t consumer = ShmImageRing::open(name);
+	uint64_t seq = consumer->attach();
+	JFR_CHECK_EQUAL(seq, 3u*nslots);
+	for(int k = 0; k < (int)nslots; ++k) JFR_CHECK(writeFrame(producer, (int)seq+k));
+	JFR_CHECK(!writeFrame(producer, (int)(seq+nslots)));
+	JFR_CHECK_EQUAL(producer->dropped(), 1u);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_shmImageRing )
+{
+	test_shmImageRing01();
+	test_shmImageRing02();
+	test_shmImageRing03();
+	test_shmImageRing04();
+}
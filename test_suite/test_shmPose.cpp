@@ -0,0 +1,209 @@
+/**
+ * \file test_shmPose.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that readers of the shared memory pose always get consistent
+ *  samples while the writer keeps publishing, measures the latency
+ *  between the publication and the reading, and checks that a writer that
+ *  died while writing does not block the readers, nor a segment with a
+ *  corrupted state size overflow them.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "rtslam/shmPose.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+std::string testSegmentName()
+{
+	std::ostringstream oss; oss << "/rtslam_test_pose_" << getpid();
+	return oss.str();
+}
+
+/// every value of sample k is k
+void writeSamples(shm_pose_writer_ptr_t writer, unsigned n, int nsamples, double period)
+{
+	jblas::vec x(n); jblas::sym_mat P(n,n);
+	for(int k = 1; k <= nsamples; ++k)
+	{
+		for(unsigned i = 0; i < n; ++i) { x(i) = k; for(unsigned j = i; j < n; ++j) P(i,j) = k; }
+		writer->write(shmpose::typeState, 0, k, kernel::Clock::getTime(), x, &P);
+		if (period > 0.) boost::this_thread::sleep(boost::posix_time::microseconds((long)(period*1e6)));
+	}
+	writer->close();
+}
+
+
+void test_shmPose01(void) {
+	std::string name = testSegmentName();
+	shm_pose_writer_ptr_t writer = ShmPoseWriter::create(name, 4);
+	shm_pose_reader_ptr_t reader = ShmPoseReader::open(name);
+	JFR_CHECK(reader.get());
+	ShmPose pose;
+	JFR_CHECK(!reader->read(pose));
+
+	jblas::vec x(4); jblas::sym_mat P(4,4);
+	for(int i = 0; i < 4; ++i) { x(i) = i; for(int j = i; j < 4; ++j) P(i,j) = 10*i+j; }
+	writer->write(shmpose::typeState, 3, 1.5, 2., x, &P);
+	JFR_CHECK(reader->read(pose));
+	JFR_CHECK_EQUAL(pose.count, 1u);
+	JFR_CHECK_EQUAL(pose.robot, 3u);
+	JFR_CHECK_EQUAL(pose.time, 1.5);
+	JFR_CHECK_EQUAL(pose.state_size, 4u);
+	JFR_CHECK_EQUAL(pose.x[3], 3.);
+	JFR_CHECK_EQUAL(pose.P[4], 11.); // (1,1)
+
+	// the propagated state keeps the covariance of the update
+	x(0) = 7.;
+	writer->write(shmpose::typePropagatedState, 3, 1.6, 2.1, x, NULL);
+	JFR_CHECK(reader->waitNew(1, pose, 0.));
+	JFR_CHECK_EQUAL(pose.count, 2u);
+	JFR_CHECK_EQUAL(pose.type, (uint32_t)shmpose::typePropagatedState);
+	JFR_CHECK_EQUAL(pose.x[0], 7.);
+	JFR_CHECK_EQUAL(pose.P[4], 11.);
+	JFR_CHECK(!reader->waitNew(2, pose, 0.01));
+
+	writer.reset();
+	JFR_CHECK(reader->isClosed());
+	JFR_CHECK(!ShmPoseReader::open(name).get());
+}
+
+void test_shmPose02(void) {
+	// consistency while the writer publishes as fast as it can
+	std::string name = testSegmentName();
+	const unsigned n = 19;
+	const int nsamples = 200000;
+	shm_pose_writer_ptr_t writer = ShmPoseWriter::create(name, n);
+	shm_pose_reader_ptr_t reader = ShmPoseReader::open(name);
+	boost::thread thread(boost::bind(writeSamples, writer, n, nsamples, 0.));
+
+	ShmPose pose;
+	uint64_t last = 0;
+	int nreads = 0, ninconsistent = 0, nunordered = 0;
+	while (reader->waitNew(last, pose, 5., 0.))
+	{
+		for(unsigned i = 0; i < n; ++i) if (pose.x[i] != pose.time) ++ninconsistent;
+		for(unsigned i = 0; i < n*(n+1)/2; ++i) if (pose.P[i] != pose.time) ++ninconsistent;
+		if (pose.count <= last || pose.time != (double)pose.count) ++nunordered;
+		last = pose.count;
+		++nreads;
+	}
+	thread.join();
+	JFR_CHECK(nreads > 0);
+	JFR_CHECK_EQUAL(ninconsistent, 0);
+	JFR_CHECK_EQUAL(nunordered, 0);
+	JFR_CHECK(reader->read(pose));
+	JFR_CHECK_EQUAL(pose.count, (uint64_t)nsamples);
+}
+
+void test_shmPose03(void) {
+	// latency from the publication to the reading, at the rate of an IMU
+	std::string name = testSegmentName();
+	const unsigned n = 19;
+	const int nsamples = 500;
+	shm_pose_writer_ptr_t writer = ShmPoseWriter::create(name, n);
+	shm_pose_reader_ptr_t reader = ShmPoseReader::open(name);
+	boost::thread thread(boost::bind(writeSamples, writer, n, nsamples, 0.002));
+
+	ShmPose pose;
+	uint64_t last = 0;
+	int nreads = 0;
+	double sum_latency = 0., max_latency = 0.;
+	while (reader->waitNew(last, pose, 5., 0.))
+	{
+		double latency = kernel::Clock::getTime() - pose.export_date;
+		sum_latency += latency;
+		if (latency > max_latency) max_latency = latency;
+		last = pose.count;
+		++nreads;
+	}
+	thread.join();
+	std::cout << "shm pose latency: " << nreads << " samples read out of " << nsamples << ", mean "
+	          << sum_latency/nreads*1e6 << " us, max " << max_latency*1e6 << " us" << std::endl;
+	JFR_CHECK(nreads > nsamples/2);
+	JFR_CHECK(sum_latency/nreads < 0.005); // loose, the machine may be loaded
+}
+void test_shmPose04(void) {
+	// the writer died while writing: the reader gives up instead of spinning forever
+	std::string name = testSegmentName();
+	shm_pose_writer_ptr_t writer = ShmPoseWriter::create(name, 4);
+	shm_pose_reader_ptr_t reader = ShmPoseReader::open(name);
+	jblas::vec x(4); x.clear();
+	writer->write(shmpose::typeState, 0, 1., 1., x, NULL);
+
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+	JFR_CHECK(fd >= 0);
+	void *map = mmap(NULL, sizeof(shmpose::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	JFR_CHECK(map != MAP_FAILED);
+	shmpose::Segment *segment = static_cast<shmpose::Segment*>(map);
+	segment->seq++; // as the writer does before modifying the sample
+
+	ShmPose pose;
+	double start = kernel::Clock::getTime();
+	JFR_CHECK(!reader->read(pose));
+	JFR_CHECK(!reader->waitNew(0, pose, 0.01));
+	JFR_CHECK(kernel::Clock::getTime() - start < 1.);
+
+	munmap(map, sizeof(shmpose::Segment));
+	::close(fd);
+}
+
+void test_shmPose05(void) {
+	// a segment announcing a state larger than a sample can hold is refused, and never overflows a sample
+	std::string name = testSegmentName();
+	shm_pose_writer_ptr_t writer = ShmPoseWriter::create(name, 4);
+	shm_pose_reader_ptr_t reader = ShmPoseReader::open(name);
+	jblas::vec x(4); x.clear();
+	writer->write(shmpose::typeState, 0, 1., 1., x, NULL);
+
+	int fd = shm_open(name.c_str(), O_RDWR, 0);
+	JFR_CHECK(fd >= 0);
+	void *map = mmap(NULL, sizeof(shmpose::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	JFR_CHECK(map != MAP_FAILED);
+	shmpose::Segment *segment = static_cast<shmpose::Segment*>(map);
+	segment->state_size = 1000;
+
+	bool thrown = false;
+	try { ShmPoseReader::open(name); }
+	catch (kernel::Exception &e) { thrown = true; }
+	JFR_CHECK(thrown);
+
+	ShmPose pose;
+	JFR_CHECK(reader->read(pose));
+	JFR_CHECK_EQUAL(pose.state_size, shmpose::maxStateSize);
+
+	munmap(map, sizeof(shmpose::Segment));
+	::close(fd);
+}
+
+
+BOOST_AUTO_TEST_CASE( test_shmPose )
+{
+	test_shmPose01();
+	test_shmPose02();
+	test_shmPose03();
+	test_shmPose04();
+	test_shmPose05();
+}
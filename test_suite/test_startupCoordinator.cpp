@@ -0,0 +1,111 @@
+/**
+ * \file test_startupCoordinator.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks that StartupCoordinator returns as soon as all the sources are
+ *  ready, and after their timeout when they are not, and that hardware
+ *  sensors are woken up by their first data.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+#include "kernel/timingTools.hpp"
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "rtslam/rtslamException.hpp"
+#include "rtslam/hardwareSensorAbstract.hpp"
+#include "rtslam/startupCoordinator.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+/// source that becomes ready at the given date
+bool readyAt(double date, double timeout)
+{
+	double wait = std::min(timeout, date - kernel::Clock::getTime());
+	if (wait > 0.) boost::this_thread::sleep(boost::posix_time::microseconds((long)(wait*1e6)));
+	return kernel::Clock::getTime() >= date;
+}
+
+
+class HardwareSensorTest: public hardware::HardwareSensorProprioAbstract
+{
+	public:
+		HardwareSensorTest(kernel::VariableCondition<int> &condition):
+			HardwareSensorProprioAbstract(condition, 10, false) { addQuantity(qPos); }
+		virtual void start() {}
+		virtual double getLastTimestamp() { return 0.; }
+		void write() { getWritePos(); incWritePos(); }
+};
+
+void writeAfter(HardwareSensorTest *sensor, double delay)
+{
+	boost::this_thread::sleep(boost::posix_time::microseconds((long)(delay*1e6)));
+	sensor->write();
+}
+
+
+void test_startupCoordinator01(void) {
+	// all ready: returns when the last one is, much before the timeouts
+	double start = kernel::Clock::getTime();
+	hardware::StartupCoordinator startup;
+	startup.add("immediate", boost::bind(readyAt, start, _1), 5.);
+	startup.add("later", boost::bind(readyAt, start+0.1, _1), 5.);
+	JFR_CHECK(startup.wait());
+	double elapsed = kernel::Clock::getTime() - start;
+	JFR_CHECK(elapsed >= 0.09);
+	JFR_CHECK(elapsed < 1.);
+}
+
+void test_startupCoordinator02(void) {
+	// one never ready: the others are still checked, and it gives up after its timeout
+	double start = kernel::Clock::getTime();
+	hardware::StartupCoordinator startup;
+	startup.add("never", boost::bind(readyAt, start+100., _1), 0.1);
+	startup.add("immediate", boost::bind(readyAt, start, _1), 0.1);
+	JFR_CHECK(!startup.wait());
+	double elapsed = kernel::Clock::getTime() - start;
+	JFR_CHECK(elapsed >= 0.09);
+	JFR_CHECK(elapsed < 1.);
+}
+
+void test_startupCoordinator03(void) {
+	// a hardware sensor is ready with its first data, and the waiting thread is woken up
+	kernel::VariableCondition<int> condition(0);
+	HardwareSensorTest sensor(condition);
+	JFR_CHECK(!sensor.isReady());
+	JFR_CHECK(!sensor.waitReady(0.02));
+
+	sensor.write();
+	JFR_CHECK(sensor.isReady());
+	JFR_CHECK(sensor.waitReady(0.));
+
+	// written by another thread while waiting
+	HardwareSensorTest sensor2(condition);
+	double start = kernel::Clock::getTime();
+	boost::thread writer(boost::bind(writeAfter, &sensor2, 0.05));
+	JFR_CHECK(sensor2.waitReady(5.));
+	writer.join();
+	JFR_CHECK(kernel::Clock::getTime() - start < 1.);
+}
+
+BOOST_AUTO_TEST_CASE( test_startupCoordinator )
+{
+	test_startupCoordinator01();
+	test_startupCoordinator02();
+	test_startupCoordinator03();
+}
@@ -0,0 +1,119 @@
+/**
+ * \file test_trace.cpp
+ *
+ * \date 17/10/2026
+ * \author agent
+ *
+ *
+ *  Checks the chrome trace written from the scopes of several threads,
+ *  and measures the cost of a trace point.
+ *
+ * \ingroup rtslam
+ */
+
+// boost unit test includes
+#include <boost/test/auto_unit_test.hpp>
+
+// jafar debug include
+#include "kernel/jafarDebug.hpp"
+#include "kernel/jafarTestMacro.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include "kernel/timingTools.hpp"
+
+#include "rtslam/trace.hpp"
+
+using namespace jafar;
+using namespace jafar::rtslam;
+
+
+static std::string readFile(std::string const &filename)
+{
+	std::ifstream f(filename.c_str());
+	std::ostringstream oss; oss << f.rdbuf();
+	return oss.str();
+}
+
+static size_t count(std::string const &s, std::string const &pattern)
+{
+	size_t n = 0;
+	for(size_t pos = s.find(pattern); pos != std::string::npos; pos = s.find(pattern, pos+1)) ++n;
+	return n;
+}
+
+static void tracedTask(const char *name, unsigned n)
+{
+	RTSLAM_TRACE_THREAD(name);
+	for(unsigned i = 0; i < n; ++i)
+	{
+		RTSLAM_TRACE_SCOPE("outer");
+		{
+			RTSLAM_TRACE_SCOPE("inner");
+			boost::this_thread::sleep(boost::posix_time::microseconds(100));
+		}
+	}
+}
+
+
+void test_trace01(void) {
+	// events of several threads, nested
+	const std::string filename = "test_trace.json";
+	{ RTSLAM_TRACE_SCOPE("not recorded"); }
+	trace::start();
+	boost::thread other(boost::bind(tracedTask, "other", 5));
+	tracedTask("main", 10);
+	other.join();
+	// a short thread reuses the buffer of the ended one with the same name
+	boost::thread again(boost::bind(tracedTask, "other", 5));
+	again.join();
+	trace::stop();
+	{ RTSLAM_TRACE_SCOPE("not recorded"); }
+
+	JFR_CHECK_EQUAL(trace::writeChromeTrace(filename), 40u);
+	std::string json = readFile(filename);
+	JFR_CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+	JFR_CHECK_EQUAL(count(json, "\"ph\":\"X\""), 40u);
+	JFR_CHECK_EQUAL(count(json, "\"name\":\"outer\""), 20u);
+	JFR_CHECK_EQUAL(count(json, "\"name\":\"not recorded\""), 0u);
+	JFR_CHECK_EQUAL(count(json, "\"thread_name\""), 2u);
+	JFR_CHECK_EQUAL(count(json, "{\"name\":\"main\"}"), 1u);
+	JFR_CHECK_EQUAL(count(json, "{\"name\":\"other\"}"), 1u);
+	JFR_CHECK_EQUAL(trace::nDropped(), 0u);
+	remove(filename.c_str());
+}
+
+void test_trace02(void) {
+	// the events over the capacity are dropped, the earlier ones are kept
+	trace::start(10000);
+	tracedTask("main", 6000);
+	trace::stop();
+	JFR_CHECK_EQUAL(trace::nDropped(), 2000u);
+	JFR_CHECK_EQUAL(trace::writeChromeTrace("test_trace.json"), 10000u);
+	remove("test_trace.json");
+
+	// cost of a trace point
+	const unsigned n = 100000;
+	trace::start(n);
+	double start = kernel::Clock::getTime();
+	for(unsigned i = 0; i < n; ++i) { RTSLAM_TRACE_SCOPE("empty"); }
+	double duration = kernel::Clock::getTime() - start;
+	trace::stop();
+	start = kernel::Clock::getTime();
+	for(unsigned i = 0; i < n; ++i) { RTSLAM_TRACE_SCOPE("empty"); }
+	double duration_off = kernel::Clock::getTime() - start;
+	std::cout << "trace: " << duration/n*1e9 << " ns per scope recording, " << duration_off/n*1e9 << " ns when not recording" << std::endl;
+}
+
+
+BOOST_AUTO_TEST_CASE( test_trace )
+{
+	test_trace01();
+	test_trace02();
+}